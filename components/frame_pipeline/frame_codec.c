@@ -0,0 +1,85 @@
+#include <limits.h>
+#include <string.h>
+#include "lvgl.h"
+#if LV_USE_LZ4_EXTERNAL
+#include <lz4.h>
+#elif LV_USE_LZ4_INTERNAL
+#include "libs/lz4/lz4.h"
+#endif
+#include "frame_codec.h"
+
+#define RGB565_BYTES_PER_PIXEL 2
+
+static const char *const format_names[] = {
+    [FRAME_FORMAT_RGB565] = "rgb565",
+    [FRAME_FORMAT_RGB565_LZ4] = "rgb565-lz4",
+    [FRAME_FORMAT_RGB565_RLE] = "rgb565-rle",
+};
+
+bool frame_format_parse(const char *name, frame_format_t *format)
+{
+    if (!name) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(format_names) / sizeof(format_names[0]); i++) {
+        if (strcmp(name, format_names[i]) == 0) {
+            *format = (frame_format_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *frame_format_name(frame_format_t format)
+{
+    if ((size_t)format >= sizeof(format_names) / sizeof(format_names[0])) {
+        return "unknown";
+    }
+    return format_names[format];
+}
+
+bool frame_format_is_compressed(frame_format_t format)
+{
+    return format != FRAME_FORMAT_RGB565;
+}
+
+bool frame_codec_supported(frame_format_t format)
+{
+    switch (format) {
+    case FRAME_FORMAT_RGB565:
+        return true;
+    case FRAME_FORMAT_RGB565_LZ4:
+        return LV_USE_LZ4;
+    case FRAME_FORMAT_RGB565_RLE:
+        return LV_USE_RLE;
+    default:
+        return false;
+    }
+}
+
+size_t frame_codec_decode(frame_format_t format, const uint8_t *src, size_t len, uint8_t *dst, size_t capacity)
+{
+    // Both decoders take 32-bit lengths
+    if (len > INT_MAX || capacity > INT_MAX) {
+        return 0;
+    }
+
+    switch (format) {
+    case FRAME_FORMAT_RGB565_LZ4: {
+#if LV_USE_LZ4
+        int ret = LZ4_decompress_safe((const char *)src, (char *)dst, (int)len, (int)capacity);
+        return ret > 0 ? (size_t)ret : 0;
+#else
+        return 0;
+#endif
+    }
+    case FRAME_FORMAT_RGB565_RLE:
+#if LV_USE_RLE
+        return lv_rle_decompress(src, (uint32_t)len, dst, (uint32_t)capacity, RGB565_BYTES_PER_PIXEL);
+#else
+        return 0;
+#endif
+    default:
+        return 0;
+    }
+}
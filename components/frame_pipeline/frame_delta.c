@@ -0,0 +1,127 @@
+#include <string.h>
+#include "frame_delta.h"
+
+#define BYTES_PER_PIXEL 2
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool frame_delta_is_delta(const uint8_t *data, size_t len)
+{
+    return len >= 4 && memcmp(data, FRAME_DELTA_MAGIC, 4) == 0;
+}
+
+frame_delta_status_t frame_delta_parse(const uint8_t *data, size_t len, frame_delta_t *delta)
+{
+    if (!frame_delta_is_delta(data, len)) {
+        return FRAME_DELTA_NOT_DELTA;
+    }
+    if (len < FRAME_DELTA_HEADER_LEN) {
+        return FRAME_DELTA_TRUNCATED;
+    }
+    if (data[4] != FRAME_DELTA_VERSION) {
+        return FRAME_DELTA_BAD_VERSION;
+    }
+    if (data[5] != FRAME_DELTA_FORMAT_RGB565) {
+        return FRAME_DELTA_BAD_FORMAT;
+    }
+
+    memset(delta, 0, sizeof(*delta));
+    delta->format = (frame_delta_format_t)data[5];
+    delta->rect_count = get_u16(data + 6);
+    delta->seq = get_u32(data + 8);
+    delta->width = get_u16(data + 12);
+    delta->height = get_u16(data + 14);
+
+    size_t rects_len = (size_t)delta->rect_count * FRAME_DELTA_RECT_LEN;
+    if (len - FRAME_DELTA_HEADER_LEN < rects_len) {
+        return FRAME_DELTA_TRUNCATED;
+    }
+    delta->rects = data + FRAME_DELTA_HEADER_LEN;
+    delta->pixels = delta->rects + rects_len;
+    delta->pixels_len = len - FRAME_DELTA_HEADER_LEN - rects_len;
+
+    size_t expected = 0;
+    for (size_t i = 0; i < delta->rect_count; i++) {
+        frame_rect_t r = frame_delta_rect(delta, i);
+        if (r.w == 0 || r.h == 0 || (uint32_t)r.x + r.w > delta->width || (uint32_t)r.y + r.h > delta->height) {
+            return FRAME_DELTA_BAD_RECT;
+        }
+        expected += (size_t)r.w * r.h * BYTES_PER_PIXEL;
+    }
+    if (expected != delta->pixels_len) {
+        return FRAME_DELTA_SIZE_MISMATCH;
+    }
+    return FRAME_DELTA_OK;
+}
+
+frame_rect_t frame_delta_rect(const frame_delta_t *delta, size_t index)
+{
+    const uint8_t *p = delta->rects + index * FRAME_DELTA_RECT_LEN;
+    frame_rect_t r = {
+        .x = get_u16(p),
+        .y = get_u16(p + 2),
+        .w = get_u16(p + 4),
+        .h = get_u16(p + 6),
+    };
+    return r;
+}
+
+bool frame_delta_is_key(const frame_delta_t *delta)
+{
+    // Either one rectangle over everything, or rectangles tiling the frame in
+    // bands: left to right, every band as high as its first rectangle
+    bool tiled = delta->rect_count > 0;
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t band = 0;
+    for (size_t i = 0; i < delta->rect_count; i++) {
+        frame_rect_t r = frame_delta_rect(delta, i);
+        if (r.x == 0 && r.y == 0 && r.w == delta->width && r.h == delta->height) {
+            return true;
+        }
+        if (!tiled || r.x != x || r.y != y || (x != 0 && r.h != band)) {
+            tiled = false;
+            continue;
+        }
+        if (x == 0) {
+            band = r.h;
+        }
+        x += r.w;
+        if (x == delta->width) {
+            x = 0;
+            y += band;
+        }
+    }
+    return tiled && x == 0 && y == delta->height;
+}
+
+void frame_delta_apply(const frame_delta_t *delta, uint8_t *canvas, size_t stride)
+{
+    const uint8_t *src = delta->pixels;
+
+    for (size_t i = 0; i < delta->rect_count; i++) {
+        frame_rect_t r = frame_delta_rect(delta, i);
+        size_t row_len = (size_t)r.w * BYTES_PER_PIXEL;
+        uint8_t *dst = canvas + (size_t)r.y * stride + (size_t)r.x * BYTES_PER_PIXEL;
+
+        if (r.x == 0 && row_len == stride) {
+            // Full-width rectangle: one contiguous block
+            memcpy(dst, src, row_len * r.h);
+            src += row_len * r.h;
+            continue;
+        }
+        for (uint16_t y = 0; y < r.h; y++) {
+            memcpy(dst, src, row_len);
+            dst += stride;
+            src += row_len;
+        }
+    }
+}
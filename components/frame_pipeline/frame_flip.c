@@ -0,0 +1,131 @@
+#include <stdlib.h>
+#include <string.h>
+#include "frame_flip.h"
+
+#define NO_BUFFER (-1)
+
+struct frame_flip_s {
+    frame_flip_config_t cfg;
+    int front;      // Scanned out
+    int pending;    // Presented, scanned out from the next vsync on
+    int back;       // Handed out by frame_flip_begin()
+    frame_flip_stats_t stats;
+};
+
+frame_flip_t *frame_flip_create(const frame_flip_config_t *cfg)
+{
+    if (!cfg || !cfg->panel.present || !cfg->panel.wait_vsync || cfg->buffer_count == 0 ||
+            cfg->buffer_count > FRAME_FLIP_MAX_BUFFERS || cfg->front >= cfg->buffer_count || cfg->buffer_size == 0) {
+        return NULL;
+    }
+    for (size_t i = 0; i < cfg->buffer_count; i++) {
+        if (!cfg->buffers[i]) {
+            return NULL;
+        }
+    }
+
+    frame_flip_t *flip = calloc(1, sizeof(frame_flip_t));
+    if (!flip) {
+        return NULL;
+    }
+    flip->cfg = *cfg;
+    flip->front = (int)cfg->front;
+    flip->pending = NO_BUFFER;
+    flip->back = NO_BUFFER;
+    return flip;
+}
+
+void frame_flip_delete(frame_flip_t *flip)
+{
+    free(flip);
+}
+
+// The pending buffer becomes the front one once the panel refreshed after present()
+static bool retire_pending(frame_flip_t *flip, uint32_t timeout_ms)
+{
+    if (flip->pending == NO_BUFFER) {
+        return true;
+    }
+    if (timeout_ms) {
+        flip->stats.vsync_waits++;
+    }
+    if (!flip->cfg.panel.wait_vsync(flip->cfg.panel.ctx, timeout_ms)) {
+        if (timeout_ms) {
+            flip->stats.vsync_timeouts++;
+        }
+        return false;
+    }
+    flip->front = flip->pending;
+    flip->pending = NO_BUFFER;
+    return true;
+}
+
+static int free_buffer(const frame_flip_t *flip)
+{
+    for (int i = 0; i < (int)flip->cfg.buffer_count; i++) {
+        if (i != flip->front && i != flip->pending) {
+            return i;
+        }
+    }
+    return NO_BUFFER;
+}
+
+uint8_t *frame_flip_begin(frame_flip_t *flip)
+{
+    if (flip->cfg.buffer_count == 1) {
+        // Nothing to flip to, the one buffer is written while it is scanned out
+        flip->back = 0;
+        return flip->cfg.buffers[0];
+    }
+
+    retire_pending(flip, 0);
+    int back = free_buffer(flip);
+    if (back == NO_BUFFER) {
+        if (!retire_pending(flip, flip->cfg.vsync_timeout_ms)) {
+            flip->stats.dropped++;
+            return NULL;
+        }
+        back = free_buffer(flip);
+    }
+    flip->back = back;
+    return flip->cfg.buffers[back];
+}
+
+void frame_flip_end(frame_flip_t *flip)
+{
+    if (flip->back == NO_BUFFER) {
+        return;
+    }
+
+    if (flip->cfg.buffer_count > 1 && !retire_pending(flip, flip->cfg.vsync_timeout_ms)) {
+        // The panel stopped refreshing; carry on rather than wedge, it may tear
+        flip->front = flip->pending;
+        flip->pending = NO_BUFFER;
+    }
+
+    flip->cfg.panel.present(flip->cfg.panel.ctx, flip->cfg.buffers[flip->back], flip->cfg.buffer_size);
+    if (flip->cfg.buffer_count > 1) {
+        flip->pending = flip->back;
+    }
+    flip->back = NO_BUFFER;
+    flip->stats.flips++;
+}
+
+bool frame_flip_show(frame_flip_t *flip, const uint8_t *frame, size_t len)
+{
+    if (len != flip->cfg.buffer_size) {
+        return false;
+    }
+    uint8_t *buffer = frame_flip_begin(flip);
+    if (!buffer) {
+        return false;
+    }
+    memcpy(buffer, frame, len);
+    frame_flip_end(flip);
+    return true;
+}
+
+void frame_flip_get_stats(frame_flip_t *flip, frame_flip_stats_t *stats)
+{
+    *stats = flip->stats;
+}
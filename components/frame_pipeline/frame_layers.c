@@ -0,0 +1,110 @@
+#include <string.h>
+#include "frame_layers.h"
+
+void frame_layers_init(frame_layers_t *layers, uint32_t screen_width, uint32_t screen_height)
+{
+    memset(layers, 0, sizeof(*layers));
+    layers->screen_width = screen_width;
+    layers->screen_height = screen_height;
+}
+
+// Clip to the screen, false if nothing is left of it
+static bool region_clip(const frame_layers_t *layers, const frame_region_t *region, frame_region_t *clipped)
+{
+    if (!region || region->width == 0 || region->height == 0) {
+        *clipped = (frame_region_t) {
+            .width = layers->screen_width,
+            .height = layers->screen_height,
+        };
+        return true;
+    }
+    if (region->x >= layers->screen_width || region->y >= layers->screen_height) {
+        return false;
+    }
+    *clipped = *region;
+    // Subtracted, so a huge width cannot overflow x + width
+    if (clipped->width > layers->screen_width - clipped->x) {
+        clipped->width = layers->screen_width - clipped->x;
+    }
+    if (clipped->height > layers->screen_height - clipped->y) {
+        clipped->height = layers->screen_height - clipped->y;
+    }
+    return true;
+}
+
+frame_layers_status_t frame_layers_claim(frame_layers_t *layers, uint8_t z, uint32_t owner,
+                                         const frame_region_t *region)
+{
+    if (z >= FRAME_LAYERS_MAX || owner == FRAME_LAYERS_NO_OWNER) {
+        return FRAME_LAYERS_BAD_LAYER;
+    }
+    frame_layer_t *layer = &layers->layers[z];
+    if (layer->owner != FRAME_LAYERS_NO_OWNER && layer->owner != owner) {
+        return FRAME_LAYERS_BUSY;
+    }
+    frame_region_t clipped;
+    if (!region_clip(layers, region, &clipped)) {
+        return FRAME_LAYERS_OFF_SCREEN;
+    }
+
+    for (uint8_t i = 0; i < FRAME_LAYERS_MAX; i++) {
+        if (i != z && layers->layers[i].owner == owner) {
+            memset(&layers->layers[i], 0, sizeof(frame_layer_t));
+        }
+    }
+    if (layer->owner != owner || memcmp(&layer->region, &clipped, sizeof(clipped)) != 0) {
+        layer->owner = owner;
+        layer->region = clipped;
+        layer->generation = ++layers->generation;
+    }
+    return FRAME_LAYERS_OK;
+}
+
+size_t frame_layers_release(frame_layers_t *layers, uint32_t owner)
+{
+    size_t released = 0;
+    for (uint8_t i = 0; i < FRAME_LAYERS_MAX; i++) {
+        if (owner != FRAME_LAYERS_NO_OWNER && layers->layers[i].owner == owner) {
+            memset(&layers->layers[i], 0, sizeof(frame_layer_t));
+            released++;
+        }
+    }
+    return released;
+}
+
+bool frame_layers_in_use(const frame_layers_t *layers, uint8_t z)
+{
+    return z < FRAME_LAYERS_MAX && layers->layers[z].owner != FRAME_LAYERS_NO_OWNER;
+}
+
+size_t frame_layers_count(const frame_layers_t *layers)
+{
+    return frame_layers_stack_index(layers, FRAME_LAYERS_MAX);
+}
+
+size_t frame_layers_stack_index(const frame_layers_t *layers, uint8_t z)
+{
+    size_t index = 0;
+    for (uint8_t i = 0; i < z && i < FRAME_LAYERS_MAX; i++) {
+        if (layers->layers[i].owner != FRAME_LAYERS_NO_OWNER) {
+            index++;
+        }
+    }
+    return index;
+}
+
+const char *frame_layers_status_name(frame_layers_status_t status)
+{
+    switch (status) {
+    case FRAME_LAYERS_OK:
+        return "ok";
+    case FRAME_LAYERS_BAD_LAYER:
+        return "bad-layer";
+    case FRAME_LAYERS_BUSY:
+        return "layer-busy";
+    case FRAME_LAYERS_OFF_SCREEN:
+        return "off-screen";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,278 @@
+#include <string.h>
+#include "frame_msg.h"
+#include "json_pull.h"
+
+static const char *const type_names[FRAME_MSG_TYPE_COUNT] = {
+    [FRAME_MSG_NONE] = "none",
+    [FRAME_MSG_FRAME] = "frame",
+    [FRAME_MSG_BLIT_CONFIG] = "blit_config",
+    [FRAME_MSG_SCREEN_CONFIG] = "config",
+    [FRAME_MSG_SENSOR] = "sensor",
+    [FRAME_MSG_PING] = "ping",
+    [FRAME_MSG_TEXT] = "text",
+};
+
+// JSON "type" values the senders use, several of them old aliases
+static const struct {
+    const char *name;
+    frame_msg_type_t type;
+} json_types[] = {
+    { "blit_config", FRAME_MSG_BLIT_CONFIG },
+    { "config", FRAME_MSG_SCREEN_CONFIG },
+    { "rive_config", FRAME_MSG_SCREEN_CONFIG },
+    { "sensor", FRAME_MSG_SENSOR },
+    { "rive_sensor", FRAME_MSG_SENSOR },
+    { "ping", FRAME_MSG_PING },
+};
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+bool frame_msg_is_envelope(const uint8_t *data, size_t len)
+{
+    return len >= 4 && memcmp(data, FRAME_MSG_MAGIC, 4) == 0;
+}
+
+frame_msg_status_t frame_msg_parse(const uint8_t *data, size_t len, frame_msg_t *msg)
+{
+    if (!frame_msg_is_envelope(data, len)) {
+        return FRAME_MSG_NOT_ENVELOPE;
+    }
+    if (len < FRAME_MSG_HEADER_LEN) {
+        return FRAME_MSG_TRUNCATED;
+    }
+    if (data[4] != FRAME_MSG_VERSION) {
+        return FRAME_MSG_BAD_VERSION;
+    }
+    if (data[5] == FRAME_MSG_NONE || data[5] >= FRAME_MSG_TYPE_COUNT || data[6] || data[7]) {
+        return FRAME_MSG_BAD_TYPE;
+    }
+    if (get_u32(data + 12) != len - FRAME_MSG_HEADER_LEN) {
+        return FRAME_MSG_SIZE_MISMATCH;
+    }
+
+    msg->type = (frame_msg_type_t)data[5];
+    msg->seq = get_u32(data + 8);
+    msg->payload = data + FRAME_MSG_HEADER_LEN;
+    msg->len = len - FRAME_MSG_HEADER_LEN;
+    return FRAME_MSG_OK;
+}
+
+size_t frame_msg_write_header(uint8_t *buf, size_t size, frame_msg_type_t type, uint32_t seq,
+                              uint32_t payload_len)
+{
+    if (size < FRAME_MSG_HEADER_LEN || type == FRAME_MSG_NONE || (unsigned)type >= FRAME_MSG_TYPE_COUNT) {
+        return 0;
+    }
+    memcpy(buf, FRAME_MSG_MAGIC, 4);
+    buf[4] = FRAME_MSG_VERSION;
+    buf[5] = (uint8_t)type;
+    buf[6] = 0;
+    buf[7] = 0;
+    put_u32(buf + 8, seq);
+    put_u32(buf + 12, payload_len);
+    return FRAME_MSG_HEADER_LEN;
+}
+
+frame_msg_type_t frame_msg_type_from_name(const char *name, size_t len)
+{
+    for (size_t i = 0; i < sizeof(json_types) / sizeof(json_types[0]); i++) {
+        if (strlen(json_types[i].name) == len && memcmp(json_types[i].name, name, len) == 0) {
+            return json_types[i].type;
+        }
+    }
+    return FRAME_MSG_TEXT;
+}
+
+const char *frame_msg_type_name(frame_msg_type_t type)
+{
+    return (unsigned)type < FRAME_MSG_TYPE_COUNT ? type_names[type] : "unknown";
+}
+
+// The top-level "type" string of a JSON object, false if there is none
+static bool find_json_type(const char *text, size_t len, const char **name, size_t *name_len)
+{
+    json_pull_t pull;
+    json_pull_init(&pull, text, len);
+    if (json_pull_next(&pull) != JSON_PULL_OBJECT_START) {
+        return false;
+    }
+    while (json_pull_next(&pull) == JSON_PULL_KEY) {
+        if (json_pull_key_is(&pull, "type")) {
+            if (json_pull_next(&pull) != JSON_PULL_STRING) {
+                return false;
+            }
+            *name = pull.str;
+            *name_len = pull.str_len;
+            return true;
+        }
+        if (!json_pull_skip(&pull)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+void frame_msg_from_text(const char *text, size_t len, frame_msg_t *msg)
+{
+    msg->type = FRAME_MSG_TEXT;
+    msg->seq = 0;
+    msg->payload = (const uint8_t *)text;
+    msg->len = len;
+
+    const char *name;
+    size_t name_len;
+    if (len >= 4 && memcmp(text, "ping", 4) == 0) {
+        msg->type = FRAME_MSG_PING;
+    } else if (find_json_type(text, len, &name, &name_len)) {
+        msg->type = frame_msg_type_from_name(name, name_len);
+    }
+}
+
+// Walks the members of a top-level object: returns true at each key, false
+// at the end of the object or on an error (then *ok is false as well)
+static bool next_member(json_pull_t *pull, bool *ok)
+{
+    json_pull_token_t token = json_pull_next(pull);
+    *ok = token != JSON_PULL_ERROR && (token != JSON_PULL_OBJECT_END || json_pull_next(pull) == JSON_PULL_END);
+    return token == JSON_PULL_KEY;
+}
+
+static bool pull_object(json_pull_t *pull, const frame_msg_t *msg)
+{
+    json_pull_init(pull, (const char *)msg->payload, msg->len);
+    return json_pull_next(pull) == JSON_PULL_OBJECT_START;
+}
+
+// The value of the current member, if it is a number that fits a uint32_t
+static void read_u32(json_pull_t *pull, uint32_t *out)
+{
+    if (json_pull_next(pull) == JSON_PULL_NUMBER && pull->number >= 0 && pull->number <= UINT32_MAX) {
+        *out = (uint32_t)pull->number;
+    }
+}
+
+// The value of the current member, if it is a string
+static void read_string(json_pull_t *pull, char *out, size_t size)
+{
+    if (json_pull_next(pull) == JSON_PULL_STRING) {
+        json_pull_string_copy(pull, out, size);
+    }
+}
+
+// {"x":..,"y":..,"width":..,"height":..}, members missing or of the wrong type are 0
+static void read_region(json_pull_t *pull, frame_region_t *region)
+{
+    if (json_pull_next(pull) != JSON_PULL_OBJECT_START) {
+        return;
+    }
+    while (json_pull_next(pull) == JSON_PULL_KEY) {
+        if (json_pull_key_is(pull, "x")) {
+            read_u32(pull, &region->x);
+        } else if (json_pull_key_is(pull, "y")) {
+            read_u32(pull, &region->y);
+        } else if (json_pull_key_is(pull, "width")) {
+            read_u32(pull, &region->width);
+        } else if (json_pull_key_is(pull, "height")) {
+            read_u32(pull, &region->height);
+        }
+        json_pull_skip(pull);
+    }
+}
+
+bool frame_msg_parse_blit_config(const frame_msg_t *msg, frame_blit_config_t *config)
+{
+    memset(config, 0, sizeof(*config));
+    json_pull_t pull;
+    if (!pull_object(&pull, msg)) {
+        return false;
+    }
+
+    bool ok;
+    while (next_member(&pull, &ok)) {
+        if (json_pull_key_is(&pull, "mode")) {
+            read_string(&pull, config->mode, sizeof(config->mode));
+        } else if (json_pull_key_is(&pull, "frameFormat")) {
+            read_string(&pull, config->format, sizeof(config->format));
+        } else if (json_pull_key_is(&pull, "description")) {
+            read_string(&pull, config->description, sizeof(config->description));
+        } else if (json_pull_key_is(&pull, "frameWidth")) {
+            read_u32(&pull, &config->width);
+        } else if (json_pull_key_is(&pull, "frameHeight")) {
+            read_u32(&pull, &config->height);
+        } else if (json_pull_key_is(&pull, "frameSize")) {
+            read_u32(&pull, &config->size);
+        } else if (json_pull_key_is(&pull, "layer")) {
+            config->layer = UINT32_MAX;
+            read_u32(&pull, &config->layer);
+            config->has_layer = true;
+        } else if (json_pull_key_is(&pull, "region")) {
+            read_region(&pull, &config->region);
+        }
+        // Skips unknown members, and containers where a string or number was expected
+        json_pull_skip(&pull);
+    }
+    return ok;
+}
+
+bool frame_msg_parse_screen_config(const frame_msg_t *msg, frame_screen_config_t *config)
+{
+    memset(config, 0, sizeof(*config));
+    json_pull_t pull;
+    if (!pull_object(&pull, msg)) {
+        return false;
+    }
+
+    bool ok;
+    while (next_member(&pull, &ok)) {
+        if (json_pull_key_is(&pull, "screenId")) {
+            read_string(&pull, config->screen_id, sizeof(config->screen_id));
+        } else if (json_pull_key_is(&pull, "layout")) {
+            json_pull_token_t token = json_pull_next(&pull);
+            config->has_layout = token == JSON_PULL_STRING || token == JSON_PULL_NULL;
+            if (token == JSON_PULL_STRING) {
+                config->layout = pull.str;
+                config->layout_len = pull.str_len;
+            }
+        }
+        json_pull_skip(&pull);
+    }
+    return ok;
+}
+
+void frame_msg_dispatcher_init(frame_msg_dispatcher_t *dispatcher)
+{
+    memset(dispatcher, 0, sizeof(*dispatcher));
+}
+
+bool frame_msg_dispatcher_set(frame_msg_dispatcher_t *dispatcher, frame_msg_type_t type,
+                              frame_msg_handler_t handler)
+{
+    if (type == FRAME_MSG_NONE || (unsigned)type >= FRAME_MSG_TYPE_COUNT) {
+        return false;
+    }
+    dispatcher->handlers[type] = handler;
+    return true;
+}
+
+bool frame_msg_dispatch(frame_msg_dispatcher_t *dispatcher, const frame_msg_t *msg, void *ctx)
+{
+    frame_msg_handler_t handler = (unsigned)msg->type < FRAME_MSG_TYPE_COUNT ? dispatcher->handlers[msg->type] : NULL;
+    if (!handler) {
+        dispatcher->unhandled++;
+        return false;
+    }
+    dispatcher->dispatched[msg->type]++;
+    handler(msg, ctx);
+    return true;
+}
@@ -0,0 +1,163 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frame_pool.h"
+
+struct frame_pool_s {
+    frame_slot_t        slots[FRAME_POOL_MAX_SLOTS];
+    uint8_t            *memory[FRAME_POOL_MAX_SLOTS];   // Start of every slot, data may be moved past it
+    size_t              slot_count;
+    size_t              slot_size;
+    void               (*free_fn)(void *ptr, void *user_ctx);
+    void               *user_ctx;
+    atomic_uint_fast32_t free_mask;     // Bit n set: slots[n] is free
+    atomic_uint_fast32_t acquired;
+    atomic_uint_fast32_t released;
+    atomic_uint_fast32_t exhausted;
+    atomic_uint_fast32_t peak_in_use;
+};
+
+static void *default_alloc(size_t alignment, size_t size, void *user_ctx)
+{
+    (void)user_ctx;
+    return aligned_alloc(alignment, size);
+}
+
+static void default_free(void *ptr, void *user_ctx)
+{
+    (void)user_ctx;
+    free(ptr);
+}
+
+frame_pool_t *frame_pool_create(const frame_pool_config_t *cfg)
+{
+    if (!cfg || cfg->slot_count == 0 || cfg->slot_count > FRAME_POOL_MAX_SLOTS || cfg->slot_size == 0) {
+        return NULL;
+    }
+
+    size_t alignment = cfg->alignment ? cfg->alignment : FRAME_POOL_DEFAULT_ALIGN;
+    if (alignment & (alignment - 1)) {
+        return NULL;
+    }
+
+    frame_pool_t *pool = calloc(1, sizeof(frame_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+
+    void *(*alloc_fn)(size_t, size_t, void *) = cfg->alloc ? cfg->alloc : default_alloc;
+    pool->free_fn = cfg->free ? cfg->free : default_free;
+    pool->user_ctx = cfg->user_ctx;
+    pool->slot_count = cfg->slot_count;
+    // aligned_alloc() wants the size to be a multiple of the alignment
+    pool->slot_size = (cfg->slot_size + alignment - 1) & ~(alignment - 1);
+
+    for (size_t i = 0; i < pool->slot_count; i++) {
+        frame_slot_t *slot = &pool->slots[i];
+        pool->memory[i] = alloc_fn(alignment, pool->slot_size, pool->user_ctx);
+        if (!pool->memory[i]) {
+            frame_pool_delete(pool);
+            return NULL;
+        }
+        slot->data = pool->memory[i];
+        slot->capacity = pool->slot_size;
+        slot->index = (uint8_t)i;
+    }
+
+    uint32_t mask = (pool->slot_count == 32) ? UINT32_MAX : ((1UL << pool->slot_count) - 1);
+    atomic_init(&pool->free_mask, mask);
+    return pool;
+}
+
+void frame_pool_delete(frame_pool_t *pool)
+{
+    if (!pool) {
+        return;
+    }
+    for (size_t i = 0; i < pool->slot_count; i++) {
+        if (pool->memory[i]) {
+            pool->free_fn(pool->memory[i], pool->user_ctx);
+        }
+    }
+    free(pool);
+}
+
+frame_slot_t *frame_pool_acquire(frame_pool_t *pool)
+{
+    uint_fast32_t mask = atomic_load(&pool->free_mask);
+    uint_fast32_t bit;
+
+    do {
+        if ((mask & UINT32_MAX) == 0) {
+            atomic_fetch_add(&pool->exhausted, 1);
+            return NULL;
+        }
+        bit = mask & (~mask + 1);   // Lowest free slot
+    } while (!atomic_compare_exchange_weak(&pool->free_mask, &mask, mask & ~bit));
+
+    frame_slot_t *slot = &pool->slots[__builtin_ctzl((unsigned long)bit)];
+    slot->data = pool->memory[slot->index];
+    slot->capacity = pool->slot_size;
+    slot->size = 0;
+    slot->width = 0;
+    slot->height = 0;
+    slot->seq = 0;
+    slot->recv_start_us = 0;
+    slot->queued_us = 0;
+    slot->layer = 0;
+    slot->self_contained = false;
+
+    // Derived from the mask we just installed, so it is exact at the moment of the acquire
+    atomic_fetch_add(&pool->acquired, 1);
+    uint_fast32_t in_use = pool->slot_count - __builtin_popcountl((unsigned long)(mask & ~bit));
+    uint_fast32_t peak = atomic_load(&pool->peak_in_use);
+    while (in_use > peak && !atomic_compare_exchange_weak(&pool->peak_in_use, &peak, in_use)) {
+    }
+    return slot;
+}
+
+bool frame_pool_release(frame_pool_t *pool, frame_slot_t *slot)
+{
+    if (!slot || slot < &pool->slots[0] || slot >= &pool->slots[pool->slot_count]) {
+        return false;
+    }
+
+    uint_fast32_t bit = (uint_fast32_t)1 << slot->index;
+    uint_fast32_t prev = atomic_fetch_or(&pool->free_mask, bit);
+    if (prev & bit) {
+        return false;   // Double release
+    }
+
+    atomic_fetch_add(&pool->released, 1);
+    return true;
+}
+
+bool frame_slot_skip(frame_slot_t *slot, size_t len)
+{
+    if (len > slot->capacity) {
+        return false;
+    }
+    slot->data += len;
+    slot->capacity -= len;
+    slot->size = slot->size > len ? slot->size - len : 0;
+    return true;
+}
+
+size_t frame_pool_slot_count(const frame_pool_t *pool)
+{
+    return pool->slot_count;
+}
+
+size_t frame_pool_slot_size(const frame_pool_t *pool)
+{
+    return pool->slot_size;
+}
+
+void frame_pool_get_stats(frame_pool_t *pool, frame_pool_stats_t *stats)
+{
+    stats->acquired = (uint32_t)atomic_load(&pool->acquired);
+    stats->released = (uint32_t)atomic_load(&pool->released);
+    stats->exhausted = (uint32_t)atomic_load(&pool->exhausted);
+    stats->in_use = (uint32_t)(pool->slot_count - __builtin_popcountl((unsigned long)atomic_load(&pool->free_mask)));
+    stats->peak_in_use = (uint32_t)atomic_load(&pool->peak_in_use);
+}
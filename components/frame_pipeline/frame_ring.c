@@ -0,0 +1,165 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "frame_ring.h"
+
+// head and tail count up forever and are reduced modulo the capacity on
+// access. Only the producer moves head; tail is moved by whoever wins the
+// compare-and-swap, so a frame is owned by exactly one side once claimed.
+// The layer and self_contained of every item are copied at push, so the
+// producer can tell stale frames apart without touching slots the consumer
+// may have taken and released meanwhile.
+struct frame_ring_s {
+    size_t capacity;
+    _Atomic(frame_slot_t *) items[FRAME_RING_MAX_CAPACITY];
+    uint8_t layers[FRAME_RING_MAX_CAPACITY];            // Producer only
+    bool self_contained[FRAME_RING_MAX_CAPACITY];       // Producer only
+    atomic_uint_fast32_t head;      // Next position the producer writes
+    atomic_uint_fast32_t tail;      // Oldest queued position
+    atomic_uint_fast32_t pushed;
+    atomic_uint_fast32_t popped;
+    atomic_uint_fast32_t evicted;
+    atomic_uint_fast32_t stale_taken;
+    atomic_uint_fast32_t refused;
+};
+
+frame_ring_t *frame_ring_create(size_t capacity)
+{
+    if (capacity == 0 || capacity > FRAME_RING_MAX_CAPACITY) {
+        return NULL;
+    }
+    frame_ring_t *ring = calloc(1, sizeof(frame_ring_t));
+    if (!ring) {
+        return NULL;
+    }
+    ring->capacity = capacity;
+    return ring;
+}
+
+void frame_ring_delete(frame_ring_t *ring)
+{
+    free(ring);
+}
+
+// Claim the frame at the tail. The item is read before the claim: if the
+// claim fails somebody else took it and the slot may already be reused.
+static frame_slot_t *claim_oldest(frame_ring_t *ring)
+{
+    uint_fast32_t tail = atomic_load(&ring->tail);
+    for (;;) {
+        if (tail == atomic_load(&ring->head)) {
+            return NULL;
+        }
+        frame_slot_t *slot = atomic_load(&ring->items[tail % ring->capacity]);
+        if (atomic_compare_exchange_weak(&ring->tail, &tail, tail + 1)) {
+            return slot;
+        }
+    }
+}
+
+// Whether a newer self-contained frame of the same layer is queued after the
+// one at pos. Producer only.
+static bool is_stale(const frame_ring_t *ring, uint_fast32_t pos, uint_fast32_t head)
+{
+    uint8_t layer = ring->layers[pos % ring->capacity];
+    for (uint_fast32_t i = pos + 1; i != head; i++) {
+        if (ring->layers[i % ring->capacity] == layer && ring->self_contained[i % ring->capacity]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void store(frame_ring_t *ring, uint_fast32_t head, frame_slot_t *slot)
+{
+    ring->layers[head % ring->capacity] = slot->layer;
+    ring->self_contained[head % ring->capacity] = slot->self_contained;
+    atomic_store(&ring->items[head % ring->capacity], slot);
+    atomic_store(&ring->head, head + 1);
+    atomic_fetch_add(&ring->pushed, 1);
+}
+
+frame_slot_t *frame_ring_push(frame_ring_t *ring, frame_slot_t *slot)
+{
+    uint_fast32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint_fast32_t tail = atomic_load(&ring->tail);
+    frame_slot_t *evicted = NULL;
+
+    if (head - tail >= ring->capacity) {
+        // Full: the oldest frame makes room. If the consumer took it first
+        // there is room already and nothing else is evicted.
+        frame_slot_t *oldest = atomic_load(&ring->items[tail % ring->capacity]);
+        if (atomic_compare_exchange_strong(&ring->tail, &tail, tail + 1)) {
+            evicted = oldest;
+            atomic_fetch_add(&ring->evicted, 1);
+        }
+    }
+
+    store(ring, head, slot);
+    return evicted;
+}
+
+bool frame_ring_push_if_stale(frame_ring_t *ring, frame_slot_t *slot, frame_slot_t **evicted)
+{
+    uint_fast32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint_fast32_t tail = atomic_load(&ring->tail);
+
+    *evicted = NULL;
+    if (head - tail >= ring->capacity) {
+        // The consumer may take the oldest frame meanwhile, then there is room
+        // without evicting. It only moves tail forward, so tail..head stays
+        // the frames the producer queued last.
+        if (!is_stale(ring, tail, head)) {
+            atomic_fetch_add(&ring->refused, 1);
+            return false;
+        }
+        frame_slot_t *oldest = atomic_load(&ring->items[tail % ring->capacity]);
+        if (atomic_compare_exchange_strong(&ring->tail, &tail, tail + 1)) {
+            *evicted = oldest;
+            atomic_fetch_add(&ring->evicted, 1);
+        }
+    }
+
+    store(ring, head, slot);
+    return true;
+}
+
+frame_slot_t *frame_ring_pop_stale(frame_ring_t *ring)
+{
+    uint_fast32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint_fast32_t tail = atomic_load(&ring->tail);
+
+    if (tail == head || !is_stale(ring, tail, head)) {
+        return NULL;
+    }
+    // Read before the claim, as in claim_oldest()
+    frame_slot_t *slot = atomic_load(&ring->items[tail % ring->capacity]);
+    if (!atomic_compare_exchange_strong(&ring->tail, &tail, tail + 1)) {
+        return NULL;    // The consumer took it
+    }
+    atomic_fetch_add(&ring->stale_taken, 1);
+    return slot;
+}
+
+frame_slot_t *frame_ring_pop(frame_ring_t *ring)
+{
+    frame_slot_t *slot = claim_oldest(ring);
+    if (slot) {
+        atomic_fetch_add(&ring->popped, 1);
+    }
+    return slot;
+}
+
+size_t frame_ring_count(frame_ring_t *ring)
+{
+    uint_fast32_t tail = atomic_load(&ring->tail);
+    return (size_t)(uint32_t)(atomic_load(&ring->head) - tail);
+}
+
+void frame_ring_get_stats(frame_ring_t *ring, frame_ring_stats_t *stats)
+{
+    stats->pushed = (uint32_t)atomic_load(&ring->pushed);
+    stats->popped = (uint32_t)atomic_load(&ring->popped);
+    stats->evicted = (uint32_t)atomic_load(&ring->evicted);
+    stats->stale_taken = (uint32_t)atomic_load(&ring->stale_taken);
+    stats->refused = (uint32_t)atomic_load(&ring->refused);
+}
@@ -0,0 +1,66 @@
+#include <string.h>
+#include "frame_rx.h"
+
+frame_rx_status_t frame_rx_begin(frame_rx_t *rx, frame_rx_stats_t *stats, uint8_t *dst, size_t capacity, size_t total)
+{
+    memset(rx, 0, sizeof(*rx));
+    rx->stats = stats;
+    rx->dst = dst;
+    rx->capacity = capacity;
+    rx->total = total;
+
+    if (total > capacity) {
+        if (stats) {
+            stats->too_large++;
+        }
+        rx->total = 0;
+        return FRAME_RX_TOO_LARGE;
+    }
+    return FRAME_RX_OK;
+}
+
+size_t frame_rx_next(frame_rx_t *rx, uint8_t **dst, size_t max_chunk)
+{
+    size_t left = rx->total - rx->received;
+    if (max_chunk && left > max_chunk) {
+        left = max_chunk;
+    }
+    *dst = rx->dst + rx->received;
+    return left;
+}
+
+void frame_rx_commit(frame_rx_t *rx, size_t len)
+{
+    size_t left = rx->total - rx->received;
+    rx->received += (len < left) ? len : left;
+}
+
+bool frame_rx_done(const frame_rx_t *rx)
+{
+    return rx->received == rx->total;
+}
+
+frame_rx_status_t frame_rx_end(frame_rx_t *rx)
+{
+    frame_rx_status_t status = frame_rx_done(rx) ? FRAME_RX_OK : FRAME_RX_INCOMPLETE;
+    if (rx->stats) {
+        if (status == FRAME_RX_OK) {
+            rx->stats->complete++;
+        } else {
+            rx->stats->incomplete++;
+        }
+        rx->stats->bytes += rx->received;
+    }
+    return status;
+}
+
+frame_rx_status_t frame_rx_check_size(frame_rx_stats_t *stats, size_t size, size_t expected_size)
+{
+    if (expected_size == 0 || expected_size == size) {
+        return FRAME_RX_OK;
+    }
+    if (stats) {
+        stats->size_mismatch++;
+    }
+    return FRAME_RX_SIZE_MISMATCH;
+}
@@ -0,0 +1,166 @@
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "frame_stats.h"
+
+typedef struct {
+    atomic_uint_fast32_t count;
+    atomic_uint_fast64_t sum_us;
+    atomic_uint_fast32_t max_us;
+    atomic_uint_fast32_t buckets[FRAME_STATS_BUCKETS];
+} stage_hist_t;
+
+struct frame_stats_s {
+    stage_hist_t stages[FRAME_STAGE_COUNT];
+};
+
+static const char *const stage_names[FRAME_STAGE_COUNT] = {
+    [FRAME_STAGE_RECV] = "recv",
+    [FRAME_STAGE_DECODE] = "decode",
+    [FRAME_STAGE_QUEUE] = "queue",
+    [FRAME_STAGE_PRESENT] = "present",
+    [FRAME_STAGE_RENDER] = "render",
+    [FRAME_STAGE_FLUSH] = "flush",
+    [FRAME_STAGE_TOTAL] = "total",
+};
+
+frame_stats_t *frame_stats_create(void)
+{
+    // All zero is a valid, empty histogram
+    return calloc(1, sizeof(frame_stats_t));
+}
+
+void frame_stats_delete(frame_stats_t *stats)
+{
+    free(stats);
+}
+
+static size_t bucket_of(uint32_t duration_us)
+{
+    size_t bucket = 0;
+    uint32_t bound = FRAME_STATS_FIRST_BOUND_US;
+    while (bucket < FRAME_STATS_BUCKETS - 1 && duration_us >= bound) {
+        bucket++;
+        bound <<= 1;
+    }
+    return bucket;
+}
+
+void frame_stats_record(frame_stats_t *stats, frame_stage_t stage, uint32_t duration_us)
+{
+    if (!stats || (unsigned)stage >= FRAME_STAGE_COUNT) {
+        return;
+    }
+    stage_hist_t *hist = &stats->stages[stage];
+    atomic_fetch_add_explicit(&hist->buckets[bucket_of(duration_us)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hist->sum_us, duration_us, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hist->count, 1, memory_order_relaxed);
+
+    uint_fast32_t max = atomic_load_explicit(&hist->max_us, memory_order_relaxed);
+    while (duration_us > max &&
+            !atomic_compare_exchange_weak_explicit(&hist->max_us, &max, duration_us, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void frame_stats_get(frame_stats_t *stats, frame_stage_t stage, frame_stage_stats_t *out)
+{
+    const stage_hist_t *hist = &stats->stages[stage];
+    out->count = (uint32_t)atomic_load_explicit(&hist->count, memory_order_relaxed);
+    out->sum_us = (uint64_t)atomic_load_explicit(&hist->sum_us, memory_order_relaxed);
+    out->max_us = (uint32_t)atomic_load_explicit(&hist->max_us, memory_order_relaxed);
+    for (size_t i = 0; i < FRAME_STATS_BUCKETS; i++) {
+        out->buckets[i] = (uint32_t)atomic_load_explicit(&hist->buckets[i], memory_order_relaxed);
+    }
+}
+
+void frame_stats_reset(frame_stats_t *stats)
+{
+    for (size_t s = 0; s < FRAME_STAGE_COUNT; s++) {
+        stage_hist_t *hist = &stats->stages[s];
+        atomic_store(&hist->count, 0);
+        atomic_store(&hist->sum_us, 0);
+        atomic_store(&hist->max_us, 0);
+        for (size_t i = 0; i < FRAME_STATS_BUCKETS; i++) {
+            atomic_store(&hist->buckets[i], 0);
+        }
+    }
+}
+
+const char *frame_stage_name(frame_stage_t stage)
+{
+    return (unsigned)stage < FRAME_STAGE_COUNT ? stage_names[stage] : "unknown";
+}
+
+uint32_t frame_stage_percentile_us(const frame_stage_stats_t *stage, unsigned percent)
+{
+    // Bucket counts are read one by one while samples keep coming, so go by their sum
+    uint64_t total = 0;
+    for (size_t i = 0; i < FRAME_STATS_BUCKETS; i++) {
+        total += stage->buckets[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (total * (percent > 100 ? 100 : percent) + 99) / 100;
+    uint64_t seen = 0;
+    uint32_t bound = FRAME_STATS_FIRST_BOUND_US;
+    for (size_t i = 0; i < FRAME_STATS_BUCKETS - 1; i++, bound <<= 1) {
+        seen += stage->buckets[i];
+        if (seen >= rank && seen > 0) {
+            return bound < stage->max_us ? bound : stage->max_us;
+        }
+    }
+    return stage->max_us;
+}
+
+// snprintf into buf at *len, false once it no longer fits
+static bool append(char *buf, size_t size, size_t *len, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + *len, size - *len, fmt, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= size - *len) {
+        return false;
+    }
+    *len += (size_t)n;
+    return true;
+}
+
+size_t frame_stats_to_json(frame_stats_t *stats, char *buf, size_t size)
+{
+    size_t len = 0;
+    if (!buf || size == 0 || !append(buf, size, &len, "{")) {
+        return 0;
+    }
+
+    for (size_t s = 0; s < FRAME_STAGE_COUNT; s++) {
+        frame_stage_stats_t stage;
+        frame_stats_get(stats, (frame_stage_t)s, &stage);
+        uint32_t mean = stage.count ? (uint32_t)(stage.sum_us / stage.count) : 0;
+
+        if (!append(buf, size, &len, "%s\"%s\":{\"count\":%u,\"meanUs\":%u,\"maxUs\":%u,"
+                    "\"p50Us\":%u,\"p90Us\":%u,\"p99Us\":%u,\"buckets\":[",
+                    s ? "," : "", stage_names[s], (unsigned) stage.count, (unsigned) mean, (unsigned) stage.max_us,
+                    (unsigned) frame_stage_percentile_us(&stage, 50), (unsigned) frame_stage_percentile_us(&stage, 90),
+                    (unsigned) frame_stage_percentile_us(&stage, 99))) {
+            return 0;
+        }
+        for (size_t i = 0; i < FRAME_STATS_BUCKETS; i++) {
+            if (!append(buf, size, &len, "%s%u", i ? "," : "", (unsigned) stage.buckets[i])) {
+                return 0;
+            }
+        }
+        if (!append(buf, size, &len, "]}")) {
+            return 0;
+        }
+    }
+
+    if (!append(buf, size, &len, "}")) {
+        return 0;
+    }
+    return len;
+}
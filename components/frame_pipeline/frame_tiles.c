@@ -0,0 +1,422 @@
+#include <stdlib.h>
+#include <string.h>
+#include "frame_tiles.h"
+
+#define BYTES_PER_PIXEL 2
+
+struct frame_tiles_s {
+    frame_tiles_config_t cfg;
+    frame_tiles_stats_t stats;
+
+    // The frame being assembled, slot is NULL while there is none. The rect list
+    // is collected at the start of the slot, the pixels after room for a full one.
+    frame_slot_t *slot;
+    uint32_t frame_id;
+    uint16_t count;
+    uint16_t received;
+    uint16_t width;
+    uint16_t height;
+    size_t pixels_at;
+    size_t pixels_len;
+    int64_t first_us;
+    int64_t last_us;                // Of the last tile, or NACK
+    uint8_t nacks;
+    uint8_t have[FRAME_TILES_MAX_TILES / 8];
+
+    bool sent_any;
+    uint32_t last_sent_id;          // Frame that went out last, older ones are late
+
+    frame_slot_t *ready[2];         // Frames gone out, oldest first
+    size_t ready_count;
+};
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+// Frame ids wrap around, a is older than b if it is less than half the range behind
+static bool id_before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+frame_tiles_status_t frame_tile_parse(const uint8_t *data, size_t len, frame_tile_t *tile)
+{
+    if (len < 4 || memcmp(data, FRAME_TILES_MAGIC, 4) != 0) {
+        return FRAME_TILES_NOT_TILE;
+    }
+    if (len < FRAME_TILES_HEADER_LEN) {
+        return FRAME_TILES_TRUNCATED;
+    }
+    if (data[4] != FRAME_TILES_VERSION) {
+        return FRAME_TILES_BAD_VERSION;
+    }
+    if (data[5] > FRAME_FORMAT_RGB565_RLE) {
+        return FRAME_TILES_BAD_FORMAT;
+    }
+
+    memset(tile, 0, sizeof(*tile));
+    tile->format = (frame_format_t)data[5];
+    tile->index = get_u16(data + 6);
+    tile->count = get_u16(data + 8);
+    tile->width = get_u16(data + 10);
+    tile->height = get_u16(data + 12);
+    tile->frame_id = get_u32(data + 16);
+    tile->rect.x = get_u16(data + 20);
+    tile->rect.y = get_u16(data + 22);
+    tile->rect.w = get_u16(data + 24);
+    tile->rect.h = get_u16(data + 26);
+    tile->payload = data + FRAME_TILES_HEADER_LEN;
+    tile->payload_len = len - FRAME_TILES_HEADER_LEN;
+
+    if (!frame_codec_supported(tile->format)) {
+        return FRAME_TILES_BAD_FORMAT;
+    }
+    const frame_rect_t *r = &tile->rect;
+    if (tile->count == 0 || tile->count > FRAME_TILES_MAX_TILES || tile->index >= tile->count ||
+        r->w == 0 || r->h == 0 || (uint32_t)r->x + r->w > tile->width || (uint32_t)r->y + r->h > tile->height) {
+        return FRAME_TILES_BAD_TILE;
+    }
+    return FRAME_TILES_OK;
+}
+
+size_t frame_tile_write_header(const frame_tile_t *tile, uint8_t *dst, size_t capacity)
+{
+    if (capacity < FRAME_TILES_HEADER_LEN) {
+        return 0;
+    }
+    memcpy(dst, FRAME_TILES_MAGIC, 4);
+    dst[4] = FRAME_TILES_VERSION;
+    dst[5] = (uint8_t)tile->format;
+    put_u16(dst + 6, tile->index);
+    put_u16(dst + 8, tile->count);
+    put_u16(dst + 10, tile->width);
+    put_u16(dst + 12, tile->height);
+    put_u16(dst + 14, 0);
+    put_u32(dst + 16, tile->frame_id);
+    put_u16(dst + 20, tile->rect.x);
+    put_u16(dst + 22, tile->rect.y);
+    put_u16(dst + 24, tile->rect.w);
+    put_u16(dst + 26, tile->rect.h);
+    return FRAME_TILES_HEADER_LEN;
+}
+
+frame_tiles_status_t frame_tiles_parse_nack(const uint8_t *data, size_t len, frame_tiles_nack_t *nack)
+{
+    if (len < 4 || memcmp(data, FRAME_TILES_NACK_MAGIC, 4) != 0) {
+        return FRAME_TILES_NOT_TILE;
+    }
+    if (len < FRAME_TILES_NACK_HEADER_LEN) {
+        return FRAME_TILES_TRUNCATED;
+    }
+    if (data[4] != FRAME_TILES_VERSION) {
+        return FRAME_TILES_BAD_VERSION;
+    }
+    nack->count = get_u16(data + 6);
+    nack->frame_id = get_u32(data + 8);
+    nack->indexes = data + FRAME_TILES_NACK_HEADER_LEN;
+    if ((len - FRAME_TILES_NACK_HEADER_LEN) / 2 < nack->count) {
+        return FRAME_TILES_TRUNCATED;
+    }
+    return FRAME_TILES_OK;
+}
+
+uint16_t frame_tiles_nack_index(const frame_tiles_nack_t *nack, size_t i)
+{
+    return get_u16(nack->indexes + i * 2);
+}
+
+const char *frame_tiles_status_name(frame_tiles_status_t status)
+{
+    switch (status) {
+    case FRAME_TILES_OK:            return "ok";
+    case FRAME_TILES_NOT_TILE:      return "not-tile";
+    case FRAME_TILES_TRUNCATED:     return "truncated";
+    case FRAME_TILES_BAD_VERSION:   return "bad-version";
+    case FRAME_TILES_BAD_FORMAT:    return "bad-format";
+    case FRAME_TILES_BAD_TILE:      return "bad-tile";
+    case FRAME_TILES_MISMATCH:      return "mismatch";
+    case FRAME_TILES_CORRUPT:       return "corrupt";
+    case FRAME_TILES_TOO_LARGE:     return "too-large";
+    case FRAME_TILES_DUPLICATE:     return "duplicate";
+    case FRAME_TILES_LATE:          return "late";
+    case FRAME_TILES_NO_BUFFER:     return "no-buffer";
+    }
+    return "unknown";
+}
+
+frame_tiles_t *frame_tiles_create(const frame_tiles_config_t *cfg)
+{
+    if (!cfg->pool) {
+        return NULL;
+    }
+    frame_tiles_t *tiles = calloc(1, sizeof(frame_tiles_t));
+    if (!tiles) {
+        return NULL;
+    }
+    tiles->cfg = *cfg;
+    return tiles;
+}
+
+void frame_tiles_delete(frame_tiles_t *tiles)
+{
+    if (!tiles) {
+        return;
+    }
+    frame_pool_release(tiles->cfg.pool, tiles->slot);
+    for (size_t i = 0; i < tiles->ready_count; i++) {
+        frame_pool_release(tiles->cfg.pool, tiles->ready[i]);
+    }
+    free(tiles);
+}
+
+static bool have_tile(const frame_tiles_t *tiles, uint16_t index)
+{
+    return tiles->have[index / 8] & (1u << (index % 8));
+}
+
+// Turn the frame being assembled into a delta frame right in front of its pixels
+// and queue it, however many tiles it has
+static void frame_finish(frame_tiles_t *tiles)
+{
+    frame_slot_t *slot = tiles->slot;
+    tiles->slot = NULL;
+    tiles->sent_any = true;
+    tiles->last_sent_id = tiles->frame_id;
+    if (tiles->received < tiles->count) {
+        tiles->stats.frames_partial++;
+        tiles->stats.tiles_missing += tiles->count - tiles->received;
+    } else {
+        tiles->stats.frames_complete++;
+    }
+    if (!tiles->received) {
+        frame_pool_release(tiles->cfg.pool, slot);
+        return;
+    }
+
+    size_t rects_len = (size_t)tiles->received * FRAME_DELTA_RECT_LEN;
+    size_t start = tiles->pixels_at - rects_len - FRAME_DELTA_HEADER_LEN;
+
+    memmove(slot->data + start + FRAME_DELTA_HEADER_LEN, slot->data, rects_len);
+    uint8_t *header = slot->data + start;
+    memcpy(header, FRAME_DELTA_MAGIC, 4);
+    header[4] = FRAME_DELTA_VERSION;
+    header[5] = FRAME_DELTA_FORMAT_RGB565;
+    put_u16(header + 6, tiles->received);
+    put_u32(header + 8, tiles->frame_id);
+    put_u16(header + 12, tiles->width);
+    put_u16(header + 14, tiles->height);
+
+    frame_slot_skip(slot, start);
+    slot->size = FRAME_DELTA_HEADER_LEN + rects_len + tiles->pixels_len;
+    slot->width = tiles->width;
+    slot->height = tiles->height;
+    slot->seq = tiles->frame_id;
+    slot->recv_start_us = tiles->first_us;
+
+    // Only one push ever goes by between polls, so this is just a safeguard: the
+    // newest frame wins, the same as in a full frame_ring
+    if (tiles->ready_count == 2) {
+        frame_pool_release(tiles->cfg.pool, tiles->ready[0]);
+        tiles->ready[0] = tiles->ready[1];
+        tiles->ready_count = 1;
+    }
+    tiles->ready[tiles->ready_count++] = slot;
+}
+
+static frame_tiles_status_t frame_start(frame_tiles_t *tiles, const frame_tile_t *tile, int64_t now_us)
+{
+    size_t pixels_at = FRAME_DELTA_HEADER_LEN + (size_t)tile->count * FRAME_DELTA_RECT_LEN;
+    if (pixels_at > frame_pool_slot_size(tiles->cfg.pool)) {
+        return FRAME_TILES_TOO_LARGE;
+    }
+    frame_slot_t *slot = frame_pool_acquire(tiles->cfg.pool);
+    if (!slot) {
+        return FRAME_TILES_NO_BUFFER;
+    }
+
+    tiles->slot = slot;
+    tiles->frame_id = tile->frame_id;
+    tiles->count = tile->count;
+    tiles->received = 0;
+    tiles->width = tile->width;
+    tiles->height = tile->height;
+    tiles->pixels_at = pixels_at;
+    tiles->pixels_len = 0;
+    tiles->first_us = now_us;
+    tiles->last_us = now_us;
+    tiles->nacks = 0;
+    memset(tiles->have, 0, (tile->count + 7) / 8);
+    return FRAME_TILES_OK;
+}
+
+// Decode the tile's pixels behind those of the tiles before it
+static frame_tiles_status_t frame_add(frame_tiles_t *tiles, const frame_tile_t *tile)
+{
+    frame_slot_t *slot = tiles->slot;
+    size_t expected = (size_t)tile->rect.w * tile->rect.h * BYTES_PER_PIXEL;
+    uint8_t *dst = slot->data + tiles->pixels_at + tiles->pixels_len;
+    size_t capacity = slot->capacity - tiles->pixels_at - tiles->pixels_len;
+
+    if (tile->format == FRAME_FORMAT_RGB565) {
+        if (tile->payload_len != expected) {
+            return FRAME_TILES_CORRUPT;
+        }
+        if (expected > capacity) {
+            return FRAME_TILES_TOO_LARGE;
+        }
+        memcpy(dst, tile->payload, expected);
+    } else {
+        if (expected > capacity) {
+            return FRAME_TILES_TOO_LARGE;
+        }
+        // Decoding a corrupt tile may scribble past `expected`, which is still free space
+        if (frame_codec_decode(tile->format, tile->payload, tile->payload_len, dst, capacity) != expected) {
+            return FRAME_TILES_CORRUPT;
+        }
+    }
+
+    uint8_t *r = slot->data + (size_t)tiles->received * FRAME_DELTA_RECT_LEN;
+    put_u16(r, tile->rect.x);
+    put_u16(r + 2, tile->rect.y);
+    put_u16(r + 4, tile->rect.w);
+    put_u16(r + 6, tile->rect.h);
+    tiles->received++;
+    tiles->pixels_len += expected;
+    tiles->have[tile->index / 8] |= (uint8_t)(1u << (tile->index % 8));
+    return FRAME_TILES_OK;
+}
+
+frame_tiles_status_t frame_tiles_push(frame_tiles_t *tiles, const uint8_t *data, size_t len, int64_t now_us)
+{
+    frame_tile_t tile;
+    frame_tiles_status_t status = frame_tile_parse(data, len, &tile);
+    if (status != FRAME_TILES_OK) {
+        tiles->stats.tiles_bad++;
+        return status;
+    }
+
+    if (tiles->slot && id_before(tile.frame_id, tiles->frame_id)) {
+        tiles->stats.tiles_late++;
+        return FRAME_TILES_LATE;
+    }
+    if (!tiles->slot && tiles->sent_any && !id_before(tiles->last_sent_id, tile.frame_id)) {
+        tiles->stats.tiles_late++;
+        return FRAME_TILES_LATE;
+    }
+
+    // The sender moved on, whatever did not arrive of this frame will not anymore
+    if (tiles->slot && tile.frame_id != tiles->frame_id) {
+        frame_finish(tiles);
+    }
+    if (!tiles->slot) {
+        status = frame_start(tiles, &tile, now_us);
+        if (status == FRAME_TILES_NO_BUFFER) {
+            tiles->stats.no_buffer++;
+            return status;
+        }
+        if (status != FRAME_TILES_OK) {
+            tiles->stats.tiles_bad++;
+            return status;
+        }
+    }
+
+    if (tile.count != tiles->count || tile.width != tiles->width || tile.height != tiles->height) {
+        tiles->stats.tiles_bad++;
+        return FRAME_TILES_MISMATCH;
+    }
+    if (have_tile(tiles, tile.index)) {
+        tiles->stats.tiles_duplicate++;
+        return FRAME_TILES_DUPLICATE;
+    }
+    status = frame_add(tiles, &tile);
+    if (status != FRAME_TILES_OK) {
+        tiles->stats.tiles_bad++;
+        return status;
+    }
+    tiles->stats.tiles++;
+    tiles->last_us = now_us;
+
+    if (tiles->received == tiles->count) {
+        frame_finish(tiles);
+    }
+    return FRAME_TILES_OK;
+}
+
+frame_slot_t *frame_tiles_poll(frame_tiles_t *tiles, int64_t now_us)
+{
+    if (tiles->slot && now_us - tiles->first_us >= (int64_t)tiles->cfg.deadline_us) {
+        frame_finish(tiles);
+    }
+    if (!tiles->ready_count) {
+        return NULL;
+    }
+    frame_slot_t *slot = tiles->ready[0];
+    tiles->ready[0] = tiles->ready[1];
+    tiles->ready_count--;
+    return slot;
+}
+
+size_t frame_tiles_nack(frame_tiles_t *tiles, int64_t now_us, uint8_t *dst, size_t capacity)
+{
+    if (!tiles->slot || tiles->nacks >= tiles->cfg.max_nacks ||
+        now_us - tiles->last_us < (int64_t)tiles->cfg.nack_delay_us ||
+        capacity < FRAME_TILES_NACK_HEADER_LEN + 2) {
+        return 0;
+    }
+
+    size_t room = (capacity - FRAME_TILES_NACK_HEADER_LEN) / 2;
+    uint16_t count = 0;
+    for (uint16_t index = 0; index < tiles->count && count < room; index++) {
+        if (!have_tile(tiles, index)) {
+            put_u16(dst + FRAME_TILES_NACK_HEADER_LEN + count * 2, index);
+            count++;
+        }
+    }
+    memcpy(dst, FRAME_TILES_NACK_MAGIC, 4);
+    dst[4] = FRAME_TILES_VERSION;
+    dst[5] = 0;
+    put_u16(dst + 6, count);
+    put_u32(dst + 8, tiles->frame_id);
+
+    tiles->nacks++;
+    tiles->last_us = now_us;
+    tiles->stats.nacks++;
+    tiles->stats.tiles_requested += count;
+    return FRAME_TILES_NACK_HEADER_LEN + (size_t)count * 2;
+}
+
+int64_t frame_tiles_next_event_us(const frame_tiles_t *tiles)
+{
+    if (!tiles->slot) {
+        return INT64_MAX;
+    }
+    int64_t next = tiles->first_us + tiles->cfg.deadline_us;
+    if (tiles->nacks < tiles->cfg.max_nacks && tiles->last_us + tiles->cfg.nack_delay_us < next) {
+        next = tiles->last_us + tiles->cfg.nack_delay_us;
+    }
+    return next;
+}
+
+void frame_tiles_get_stats(const frame_tiles_t *tiles, frame_tiles_stats_t *stats)
+{
+    *stats = tiles->stats;
+}
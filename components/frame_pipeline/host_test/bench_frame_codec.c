@@ -0,0 +1,126 @@
+/* Decode throughput of the compressed frame formats.
+ *
+ *   bench_frame_codec                      synthetic 1280x720 dashboard and noise frames
+ *   bench_frame_codec frame.rgb565 ...     recorded raw RGB565 frames
+ *
+ * Every frame is compressed on the host, then decoded repeatedly; MB/s counts
+ * decoded (RGB565) bytes, memcpy of the raw frame is the baseline. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lvgl.h"
+#include "libs/lz4/lz4.h"
+#include "frame_codec.h"
+#include "rle_encode.h"
+#include "test_frames.h"
+
+#define SYNTH_W 1280
+#define SYNTH_H 720
+#define MIN_BENCH_NS 200000000ULL   // Decode each frame for at least 0.2 s
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double bench_decode(frame_format_t format, const uint8_t *src, size_t len, uint8_t *dst, size_t raw_len)
+{
+    uint64_t iterations = 0;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+    do {
+        size_t out;
+        if (format == FRAME_FORMAT_RGB565) {
+            memcpy(dst, src, len);
+            out = len;
+        } else {
+            out = frame_codec_decode(format, src, len, dst, raw_len);
+        }
+        if (out != raw_len) {
+            fprintf(stderr, "%s: decoded %zu of %zu bytes\n", frame_format_name(format), out, raw_len);
+            exit(EXIT_FAILURE);
+        }
+        iterations++;
+        elapsed = now_ns() - start;
+    } while (elapsed < MIN_BENCH_NS);
+
+    return (double)raw_len * (double)iterations / ((double)elapsed / 1e9) / 1e6;
+}
+
+static void bench_frame(const char *name, const uint8_t *frame, size_t raw_len)
+{
+    // Worst cases: LZ4_compressBound(), and for RLE one control byte per 127 literal blocks
+    int bound = LZ4_compressBound((int)raw_len);
+    size_t rle_bound = raw_len + raw_len / (RLE_MAX_COUNT * 2) + 1;
+    uint8_t *encoded = malloc((size_t)bound > rle_bound ? (size_t)bound : rle_bound);
+    uint8_t *decoded = malloc(raw_len);
+    if (!encoded || !decoded) {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (frame_format_t format = FRAME_FORMAT_RGB565; format <= FRAME_FORMAT_RGB565_RLE; format++) {
+        size_t len = raw_len;
+        const uint8_t *src = frame;
+        if (format == FRAME_FORMAT_RGB565_LZ4) {
+            len = (size_t)LZ4_compress_default((const char *)frame, (char *)encoded, (int)raw_len, bound);
+            src = encoded;
+        } else if (format == FRAME_FORMAT_RGB565_RLE) {
+            len = rle_encode(frame, raw_len, encoded, 2);
+            src = encoded;
+        }
+
+        double mbps = bench_decode(format, src, len, decoded, raw_len);
+        printf("%-24s %-11s %9zu -> %9zu bytes  ratio %6.2f  %8.1f MB/s\n",
+               name, frame_format_name(format), len, raw_len, (double)raw_len / (double)len, mbps);
+    }
+
+    free(encoded);
+    free(decoded);
+}
+
+static uint8_t *read_file(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = size > 0 ? malloc((size_t)size) : NULL;
+    if (data && fread(data, 1, (size_t)size, f) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *len = (size_t)size;
+    return data;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            size_t len;
+            uint8_t *frame = read_file(argv[i], &len);
+            if (!frame || len % 2) {
+                fprintf(stderr, "%s: not a raw RGB565 frame\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            bench_frame(argv[i], frame, len);
+            free(frame);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    static uint8_t frame[SYNTH_W * SYNTH_H * 2];
+    make_dashboard_frame(frame, SYNTH_W, SYNTH_H, 1);
+    bench_frame("dashboard 1280x720", frame, sizeof(frame));
+    make_noise_frame(frame, SYNTH_W, SYNTH_H, 1);
+    bench_frame("noise 1280x720", frame, sizeof(frame));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,275 @@
+/* Parse cost of the JSON messages: json_pull against cJSON.
+ *
+ *   bench_sensor_json                      synthetic sensor bursts and config messages
+ *   bench_sensor_json message.json ...     recorded messages, one per file
+ *
+ * json_pull reads sensor messages into a sensor_table, change detection
+ * included, and config messages into their structs. cJSON parses into a
+ * tree, reads the same members through cJSON_GetObjectItem() and deletes the
+ * tree again, the way main.c used to. Heap calls are counted through
+ * cJSON_InitHooks(). The cJSON side is only built with -DCJSON_DIR=<dir of
+ * cJSON.c>, e.g. $IDF_PATH/components/json/cJSON. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "frame_msg.h"
+#include "json_pull.h"
+#include "sensor_table.h"
+#if BENCH_WITH_CJSON
+#include "cJSON.h"
+#endif
+
+#define MIN_BENCH_NS 200000000ULL   // Parse each message set for at least 0.2 s
+#define SYNTH_SENSORS 128
+#define SYNTH_VARIANTS 8            // Bursts in a row differ in a few values, like real ones
+#define MESSAGE_MAX 16384
+#define TABLE_SIZE 256             // CONFIG_SENSOR_TABLE_SIZE default
+
+typedef struct {
+    const char *name;
+    char *text[SYNTH_VARIANTS];
+    size_t len[SYNTH_VARIANTS];
+    size_t variants;
+} message_set_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static sensor_table_t *table;
+static volatile uint32_t sink;
+
+static void pull_parse(const char *text, size_t len)
+{
+    frame_msg_t msg;
+    frame_msg_from_text(text, len, &msg);
+    frame_blit_config_t blit;
+    frame_screen_config_t screen;
+    switch (msg.type) {
+    case FRAME_MSG_SENSOR:
+        sink += sensor_table_apply_json(table, text, len, NULL, NULL);
+        break;
+    case FRAME_MSG_BLIT_CONFIG:
+        sink += frame_msg_parse_blit_config(&msg, &blit) + blit.width;
+        break;
+    case FRAME_MSG_SCREEN_CONFIG:
+        sink += frame_msg_parse_screen_config(&msg, &screen) + (uint32_t)screen.layout_len;
+        break;
+    default:
+        break;
+    }
+}
+
+#if BENCH_WITH_CJSON
+static uint64_t heap_calls;
+
+static void *counting_malloc(size_t size)
+{
+    heap_calls++;
+    return malloc(size);
+}
+
+static void counting_free(void *ptr)
+{
+    if (ptr) {
+        heap_calls++;
+    }
+    free(ptr);
+}
+
+static void cjson_read_string(const cJSON *json, const char *name)
+{
+    const char *s = cJSON_GetStringValue(cJSON_GetObjectItem(json, name));
+    sink += s ? (uint32_t)s[0] : 0;
+}
+
+static void cjson_parse(const char *text, size_t len)
+{
+    frame_msg_t msg;
+    frame_msg_from_text(text, len, &msg);
+    cJSON *json = cJSON_ParseWithLength(text, len);
+    if (!json) {
+        return;
+    }
+    if (msg.type == FRAME_MSG_SENSOR) {
+        cJSON *sensor;
+        cJSON_ArrayForEach(sensor, cJSON_GetObjectItem(json, "sensors")) {
+            cJSON *value = cJSON_GetObjectItem(sensor, "value");
+            cJSON *display_value = cJSON_GetObjectItem(sensor, "displayValue");
+            sink += cJSON_IsNumber(value) ? (uint32_t)cJSON_GetNumberValue(value) : 0;
+            sink += cJSON_IsString(display_value) ? (uint32_t)cJSON_GetStringValue(display_value)[0] : 0;
+        }
+    } else if (msg.type == FRAME_MSG_BLIT_CONFIG) {
+        static const char *const numbers[] = { "frameWidth", "frameHeight", "frameSize" };
+        for (size_t i = 0; i < 3; i++) {
+            sink += (uint32_t)cJSON_GetNumberValue(cJSON_GetObjectItem(json, numbers[i]));
+        }
+        cjson_read_string(json, "mode");
+        cjson_read_string(json, "frameFormat");
+        cjson_read_string(json, "description");
+    } else if (msg.type == FRAME_MSG_SCREEN_CONFIG) {
+        cjson_read_string(json, "screenId");
+        cjson_read_string(json, "layout");
+    }
+    cJSON_Delete(json);
+}
+#endif
+
+// Nanoseconds per message, cycling through the variants
+static double bench_parser(const message_set_t *set, void (*parse)(const char *, size_t))
+{
+    uint64_t iterations = 0;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+    do {
+        for (size_t i = 0; i < set->variants; i++) {
+            parse(set->text[i], set->len[i]);
+        }
+        iterations += set->variants;
+        elapsed = now_ns() - start;
+    } while (elapsed < MIN_BENCH_NS);
+    return (double)elapsed / (double)iterations;
+}
+
+static void bench_set(const message_set_t *set)
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < set->variants; i++) {
+        bytes += set->len[i];
+    }
+    double avg_len = (double)bytes / (double)set->variants;
+
+    table = sensor_table_create(TABLE_SIZE);
+    double pull_ns = bench_parser(set, pull_parse);
+    sensor_table_stats_t stats;
+    sensor_table_get_stats(table, &stats);
+    printf("%-24s %7.0f bytes  json_pull %9.0f ns/msg %8.1f MB/s  heap calls/msg %6.1f",
+           set->name, avg_len, pull_ns, avg_len / pull_ns * 1e3, 0.0);
+    if (stats.messages) {
+        printf("  changed/msg %5.1f", (double)stats.changed / (double)stats.messages);
+    }
+    printf("\n");
+    sensor_table_delete(table);
+
+#if BENCH_WITH_CJSON
+    double cjson_ns = bench_parser(set, cjson_parse);
+    // Heap calls of one pass over the set, measured separately from the timing loop
+    heap_calls = 0;
+    for (size_t i = 0; i < set->variants; i++) {
+        cjson_parse(set->text[i], set->len[i]);
+    }
+    printf("%-24s %7.0f bytes  cJSON     %9.0f ns/msg %8.1f MB/s  heap calls/msg %6.1f  (%.1fx json_pull)\n",
+           set->name, avg_len, cjson_ns, avg_len / cjson_ns * 1e3,
+           (double)heap_calls / (double)set->variants, cjson_ns / pull_ns);
+#endif
+}
+
+// A sensor burst as the sender writes them: value and displayValue per sensor,
+// a few of them changing from one burst to the next
+static void make_sensor_set(message_set_t *set)
+{
+    set->name = "sensor burst";
+    set->variants = SYNTH_VARIANTS;
+    for (size_t v = 0; v < SYNTH_VARIANTS; v++) {
+        char *text = malloc(MESSAGE_MAX);
+        size_t len = (size_t)snprintf(text, MESSAGE_MAX, "{\"type\":\"sensor\",\"screenId\":\"main\",\"sensors\":{");
+        for (int i = 0; i < SYNTH_SENSORS; i++) {
+            double value = (i % 8 == (int)v % 8) ? i * 1.25 + (double)v : i * 1.25;
+            len += (size_t)snprintf(text + len, MESSAGE_MAX - len,
+                                    "%s\"sensor_%03d\":{\"value\":%.2f,\"displayValue\":\"%.1f %s\",\"unit\":\"%s\"}",
+                                    i ? "," : "", i, value, value, i % 2 ? "C" : "%", i % 2 ? "C" : "%");
+        }
+        len += (size_t)snprintf(text + len, MESSAGE_MAX - len, "},\"timestamp\":%u}", (unsigned)(1700000000u + v));
+        set->text[v] = text;
+        set->len[v] = len;
+    }
+}
+
+static void make_single(message_set_t *set, const char *name, const char *json)
+{
+    set->name = name;
+    set->variants = 1;
+    set->text[0] = strdup(json);
+    set->len[0] = strlen(json);
+}
+
+static void free_set(message_set_t *set)
+{
+    for (size_t i = 0; i < set->variants; i++) {
+        free(set->text[i]);
+    }
+}
+
+static char *read_file(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *data = size > 0 ? malloc((size_t)size) : NULL;
+    if (data && fread(data, 1, (size_t)size, f) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *len = (size_t)size;
+    return data;
+}
+
+int main(int argc, char **argv)
+{
+#if BENCH_WITH_CJSON
+    cJSON_Hooks hooks = { .malloc_fn = counting_malloc, .free_fn = counting_free };
+    cJSON_InitHooks(&hooks);
+#else
+    printf("cJSON not built in, configure with -DCJSON_DIR=<dir of cJSON.c> to compare\n");
+#endif
+
+    message_set_t set;
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            set.name = argv[i];
+            set.variants = 1;
+            set.text[0] = read_file(argv[i], &set.len[0]);
+            if (!set.text[0]) {
+                fprintf(stderr, "%s: cannot read\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            bench_set(&set);
+            free_set(&set);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    make_sensor_set(&set);
+    bench_set(&set);
+    free_set(&set);
+
+    make_single(&set, "blit_config",
+                "{\"type\":\"blit_config\",\"mode\":\"blit\",\"frameFormat\":\"lz4\",\"frameWidth\":1280,"
+                "\"frameHeight\":720,\"frameSize\":1843200,\"description\":\"Main dashboard\"}");
+    bench_set(&set);
+    free_set(&set);
+
+    make_single(&set, "config with layout",
+                "{\"type\":\"config\",\"screenId\":\"main\",\"layout\":\"<component>\\n"
+                "  <view extends=\\\"lv_obj\\\" width=\\\"100%\\\" height=\\\"100%\\\" flex_flow=\\\"column\\\">\\n"
+                "    <lv_label bind_text=\\\"cpu_text 'CPU %s'\\\"/>\\n"
+                "    <lv_arc bind_value=\\\"cpu\\\"/>\\n"
+                "    <sensor_bar bind_value=\\\"gpu\\\" range=\\\"0 100\\\"/>\\n"
+                "    <sensor_chart bind_value=\\\"fps\\\" point_count=\\\"60\\\">\\n"
+                "      <lv_chart-series color=\\\"0x00ff00\\\"/>\\n"
+                "    </sensor_chart>\\n"
+                "  </view>\\n"
+                "</component>\"}");
+    bench_set(&set);
+    free_set(&set);
+    return EXIT_SUCCESS;
+}
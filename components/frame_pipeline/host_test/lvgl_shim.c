@@ -0,0 +1,19 @@
+/* The few LVGL runtime functions the vendored LZ4 and RLE decoders call,
+ * so the host tests do not need to build the whole library. */
+#include <string.h>
+#include "lvgl.h"
+
+void *lv_memcpy(void *dst, const void *src, size_t len)
+{
+    return memcpy(dst, src, len);
+}
+
+void lv_memset(void *dst, uint8_t v, size_t len)
+{
+    memset(dst, v, len);
+}
+
+void *lv_memmove(void *dst, const void *src, size_t len)
+{
+    return memmove(dst, src, len);
+}
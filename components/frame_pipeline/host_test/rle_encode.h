@@ -0,0 +1,48 @@
+/* Encoder for LVGL's RLE format (the inverse of lv_rle_decompress()), the way
+ * LVGLImage.py writes it: a control byte with bit 7 set is followed by
+ * (ctrl & 0x7f) literal blocks, otherwise by one block repeated ctrl times. */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define RLE_MAX_COUNT 127
+
+static size_t rle_run_length(const uint8_t *src, size_t blocks, size_t blk)
+{
+    size_t n = 1;
+    while (n < blocks && n < RLE_MAX_COUNT && memcmp(src, src + n * blk, blk) == 0) {
+        n++;
+    }
+    return n;
+}
+
+/* Returns the encoded length, at most len + len / (RLE_MAX_COUNT * blk) + 1 bytes. */
+static size_t rle_encode(const uint8_t *src, size_t len, uint8_t *dst, size_t blk)
+{
+    size_t blocks = len / blk;
+    size_t out = 0;
+    size_t i = 0;
+
+    while (i < blocks) {
+        size_t run = rle_run_length(src + i * blk, blocks - i, blk);
+        if (run >= 3) {
+            dst[out++] = (uint8_t)run;
+            memcpy(dst + out, src + i * blk, blk);
+            out += blk;
+            i += run;
+            continue;
+        }
+
+        // Literals up to the next run worth encoding
+        size_t start = i;
+        while (i < blocks && i - start < RLE_MAX_COUNT && rle_run_length(src + i * blk, blocks - i, blk) < 3) {
+            i++;
+        }
+        dst[out++] = (uint8_t)(0x80 | (i - start));
+        memcpy(dst + out, src + start * blk, (i - start) * blk);
+        out += (i - start) * blk;
+    }
+    return out;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file
+ * @brief Minimal Unity-style assertions for the frame_pipeline host tests
+ *
+ * The host tests build with a plain C compiler, without ESP-IDF and without
+ * the Unity component, so this header provides the handful of TEST_ASSERT_*
+ * macros they use. A failing assertion aborts the current test case.
+ */
+
+#pragma once
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int test_failures;
+static int test_count;
+static jmp_buf test_jmp;
+
+#define TEST_FAIL_MESSAGE(msg) do {                                             \
+        fprintf(stderr, "%s:%d: FAIL: %s\n", __FILE__, __LINE__, (msg));         \
+        longjmp(test_jmp, 1);                                                   \
+    } while (0)
+
+#define TEST_ASSERT_MESSAGE(cond, msg)  do { if (!(cond)) TEST_FAIL_MESSAGE(msg); } while (0)
+#define TEST_ASSERT(cond)               TEST_ASSERT_MESSAGE((cond), #cond)
+#define TEST_ASSERT_TRUE(cond)          TEST_ASSERT_MESSAGE((cond), #cond " is false")
+#define TEST_ASSERT_FALSE(cond)         TEST_ASSERT_MESSAGE(!(cond), #cond " is true")
+#define TEST_ASSERT_NULL(ptr)           TEST_ASSERT_MESSAGE((ptr) == NULL, #ptr " is not NULL")
+#define TEST_ASSERT_NOT_NULL(ptr)       TEST_ASSERT_MESSAGE((ptr) != NULL, #ptr " is NULL")
+
+#define TEST_ASSERT_EQUAL(expected, actual) do {                                \
+        long long e_ = (long long)(expected), a_ = (long long)(actual);         \
+        if (e_ != a_) {                                                         \
+            fprintf(stderr, "%s:%d: FAIL: %s: expected %lld, got %lld\n",       \
+                    __FILE__, __LINE__, #actual, e_, a_);                        \
+            longjmp(test_jmp, 1);                                               \
+        }                                                                       \
+    } while (0)
+
+#define TEST_ASSERT_EQUAL_MEMORY(expected, actual, len) \
+    TEST_ASSERT_MESSAGE(memcmp((expected), (actual), (len)) == 0, #actual " differs from " #expected)
+
+#define TEST_ASSERT_EQUAL_STRING(expected, actual) \
+    TEST_ASSERT_MESSAGE(strcmp((expected), (actual)) == 0, #actual " differs from " #expected)
+
+#define RUN_TEST(fn) do {                                                       \
+        test_count++;                                                           \
+        if (setjmp(test_jmp) == 0) {                                            \
+            fn();                                                               \
+            printf("PASS %s\n", #fn);                                           \
+        } else {                                                                \
+            test_failures++;                                                    \
+            printf("FAIL %s\n", #fn);                                           \
+        }                                                                       \
+    } while (0)
+
+#define TEST_REPORT() (printf("%d tests, %d failures\n", test_count, test_failures), \
+                       test_failures ? EXIT_FAILURE : EXIT_SUCCESS)
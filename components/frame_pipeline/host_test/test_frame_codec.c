@@ -0,0 +1,109 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lvgl.h"
+#include "libs/lz4/lz4.h"
+#include "frame_codec.h"
+#include "rle_encode.h"
+#include "test_common.h"
+#include "test_frames.h"
+
+#define FRAME_W 320
+#define FRAME_H 240
+#define FRAME_BYTES (FRAME_W * FRAME_H * 2)
+
+static uint8_t frame[FRAME_BYTES];
+static uint8_t encoded[FRAME_BYTES * 2];
+static uint8_t decoded[FRAME_BYTES];
+
+static void test_format_names(void)
+{
+    frame_format_t format = FRAME_FORMAT_RGB565;
+    TEST_ASSERT_TRUE(frame_format_parse("rgb565-lz4", &format));
+    TEST_ASSERT_EQUAL(FRAME_FORMAT_RGB565_LZ4, format);
+    TEST_ASSERT_TRUE(frame_format_parse("rgb565-rle", &format));
+    TEST_ASSERT_EQUAL(FRAME_FORMAT_RGB565_RLE, format);
+    TEST_ASSERT_TRUE(frame_format_parse("rgb565", &format));
+    TEST_ASSERT_EQUAL(FRAME_FORMAT_RGB565, format);
+
+    TEST_ASSERT_FALSE(frame_format_parse("rgb565-zstd", &format));
+    TEST_ASSERT_FALSE(frame_format_parse(NULL, &format));
+    TEST_ASSERT_EQUAL(FRAME_FORMAT_RGB565, format);
+
+    TEST_ASSERT_EQUAL_STRING("rgb565-rle", frame_format_name(FRAME_FORMAT_RGB565_RLE));
+    TEST_ASSERT_FALSE(frame_format_is_compressed(FRAME_FORMAT_RGB565));
+    TEST_ASSERT_TRUE(frame_format_is_compressed(FRAME_FORMAT_RGB565_LZ4));
+    TEST_ASSERT_TRUE(frame_codec_supported(FRAME_FORMAT_RGB565_LZ4));
+    TEST_ASSERT_TRUE(frame_codec_supported(FRAME_FORMAT_RGB565_RLE));
+}
+
+static void round_trip(frame_format_t format)
+{
+    size_t len;
+    if (format == FRAME_FORMAT_RGB565_LZ4) {
+        len = (size_t)LZ4_compress_default((const char *)frame, (char *)encoded, FRAME_BYTES, sizeof(encoded));
+    } else {
+        len = rle_encode(frame, FRAME_BYTES, encoded, 2);
+    }
+    TEST_ASSERT(len > 0 && len <= sizeof(encoded));
+
+    memset(decoded, 0xa5, sizeof(decoded));
+    TEST_ASSERT_EQUAL(FRAME_BYTES, frame_codec_decode(format, encoded, len, decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL_MEMORY(frame, decoded, FRAME_BYTES);
+}
+
+static void test_dashboard_round_trip(void)
+{
+    make_dashboard_frame(frame, FRAME_W, FRAME_H, 1);
+    round_trip(FRAME_FORMAT_RGB565_LZ4);
+    round_trip(FRAME_FORMAT_RGB565_RLE);
+}
+
+static void test_noise_round_trip(void)
+{
+    make_noise_frame(frame, FRAME_W, FRAME_H, 2);
+    round_trip(FRAME_FORMAT_RGB565_LZ4);
+    round_trip(FRAME_FORMAT_RGB565_RLE);
+}
+
+static void test_lz4_rejects_bad_input(void)
+{
+    make_dashboard_frame(frame, FRAME_W, FRAME_H, 3);
+    int len = LZ4_compress_default((const char *)frame, (char *)encoded, FRAME_BYTES, sizeof(encoded));
+    TEST_ASSERT(len > 0);
+
+    // Destination too small
+    TEST_ASSERT_EQUAL(0, frame_codec_decode(FRAME_FORMAT_RGB565_LZ4, encoded, len, decoded, FRAME_BYTES / 2));
+    // Truncated stream
+    TEST_ASSERT_EQUAL(0, frame_codec_decode(FRAME_FORMAT_RGB565_LZ4, encoded, len / 2, decoded, sizeof(decoded)));
+}
+
+static void test_rle_rejects_bad_input(void)
+{
+    // Literal run announcing more blocks than the input has
+    const uint8_t truncated[] = {0x85, 0x11, 0x22};
+    TEST_ASSERT_EQUAL(0, frame_codec_decode(FRAME_FORMAT_RGB565_RLE, truncated, sizeof(truncated), decoded, sizeof(decoded)));
+
+    // A run of 100 pixels does not fit 10, but exactly fits 100
+    const uint8_t run[] = {100, 0x34, 0x12};
+    TEST_ASSERT_EQUAL(0, frame_codec_decode(FRAME_FORMAT_RGB565_RLE, run, sizeof(run), decoded, 20));
+    TEST_ASSERT_EQUAL(200, frame_codec_decode(FRAME_FORMAT_RGB565_RLE, run, sizeof(run), decoded, 200));
+    TEST_ASSERT_EQUAL(0x34, decoded[198]);
+    TEST_ASSERT_EQUAL(0x12, decoded[199]);
+}
+
+static void test_raw_is_not_decoded(void)
+{
+    TEST_ASSERT_EQUAL(0, frame_codec_decode(FRAME_FORMAT_RGB565, frame, 16, decoded, sizeof(decoded)));
+}
+
+int main(void)
+{
+    RUN_TEST(test_format_names);
+    RUN_TEST(test_dashboard_round_trip);
+    RUN_TEST(test_noise_round_trip);
+    RUN_TEST(test_lz4_rejects_bad_input);
+    RUN_TEST(test_rle_rejects_bad_input);
+    RUN_TEST(test_raw_is_not_decoded);
+    return TEST_REPORT();
+}
@@ -0,0 +1,235 @@
+#include <stdint.h>
+#include <string.h>
+#include "frame_delta.h"
+#include "test_common.h"
+
+#define CANVAS_W 64
+#define CANVAS_H 48
+#define STRIDE   (CANVAS_W * 2)
+
+/* Builds delta frames the way the sender does. */
+typedef struct {
+    uint8_t data[CANVAS_W * CANVAS_H * 2 * 2 + 1024];
+    size_t  len;
+    size_t  rect_count;
+    size_t  pixels_at;
+} delta_builder_t;
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void builder_begin(delta_builder_t *b, uint32_t seq, size_t rect_count)
+{
+    memset(b, 0, sizeof(*b));
+    memcpy(b->data, FRAME_DELTA_MAGIC, 4);
+    b->data[4] = FRAME_DELTA_VERSION;
+    b->data[5] = FRAME_DELTA_FORMAT_RGB565;
+    put_u16(b->data + 6, (uint16_t)rect_count);
+    b->data[8] = (uint8_t)seq;
+    b->data[9] = (uint8_t)(seq >> 8);
+    b->data[10] = (uint8_t)(seq >> 16);
+    b->data[11] = (uint8_t)(seq >> 24);
+    put_u16(b->data + 12, CANVAS_W);
+    put_u16(b->data + 14, CANVAS_H);
+    b->pixels_at = FRAME_DELTA_HEADER_LEN + rect_count * FRAME_DELTA_RECT_LEN;
+    b->len = b->pixels_at;
+}
+
+/* Appends a rectangle filled with `color`. Rects must be added in order. */
+static void builder_rect(delta_builder_t *b, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+    uint8_t *r = b->data + FRAME_DELTA_HEADER_LEN + b->rect_count++ * FRAME_DELTA_RECT_LEN;
+    put_u16(r, x);
+    put_u16(r + 2, y);
+    put_u16(r + 4, w);
+    put_u16(r + 6, h);
+    for (size_t i = 0; i < (size_t)w * h; i++) {
+        put_u16(b->data + b->len, color);
+        b->len += 2;
+    }
+}
+
+static uint16_t pixel_at(const uint8_t *canvas, int x, int y)
+{
+    const uint8_t *p = canvas + y * STRIDE + x * 2;
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void test_plain_frame_is_not_a_delta(void)
+{
+    uint8_t raw[32] = {0x1f, 0x00, 0xe0, 0x07};
+    frame_delta_t delta;
+    TEST_ASSERT_FALSE(frame_delta_is_delta(raw, sizeof(raw)));
+    TEST_ASSERT_EQUAL(FRAME_DELTA_NOT_DELTA, frame_delta_parse(raw, sizeof(raw), &delta));
+    TEST_ASSERT_EQUAL(FRAME_DELTA_NOT_DELTA, frame_delta_parse(raw, 2, &delta));
+}
+
+static void test_header_fields(void)
+{
+    static delta_builder_t b;
+    frame_delta_t delta;
+    builder_begin(&b, 0x01020304, 2);
+    builder_rect(&b, 1, 2, 3, 4, 0xf800);
+    builder_rect(&b, 10, 20, 5, 6, 0x07e0);
+
+    TEST_ASSERT_TRUE(frame_delta_is_delta(b.data, b.len));
+    TEST_ASSERT_EQUAL(FRAME_DELTA_OK, frame_delta_parse(b.data, b.len, &delta));
+    TEST_ASSERT_EQUAL(0x01020304, delta.seq);
+    TEST_ASSERT_EQUAL(CANVAS_W, delta.width);
+    TEST_ASSERT_EQUAL(CANVAS_H, delta.height);
+    TEST_ASSERT_EQUAL(2, delta.rect_count);
+    TEST_ASSERT_EQUAL((3 * 4 + 5 * 6) * 2, delta.pixels_len);
+
+    frame_rect_t r = frame_delta_rect(&delta, 1);
+    TEST_ASSERT_EQUAL(10, r.x);
+    TEST_ASSERT_EQUAL(20, r.y);
+    TEST_ASSERT_EQUAL(5, r.w);
+    TEST_ASSERT_EQUAL(6, r.h);
+    TEST_ASSERT_FALSE(frame_delta_is_key(&delta));
+}
+
+static void test_patches_only_touch_their_rects(void)
+{
+    static delta_builder_t b;
+    static uint8_t canvas[CANVAS_H * STRIDE];
+    frame_delta_t delta;
+
+    // Key frame first
+    builder_begin(&b, 1, 1);
+    builder_rect(&b, 0, 0, CANVAS_W, CANVAS_H, 0x1234);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_OK, frame_delta_parse(b.data, b.len, &delta));
+    TEST_ASSERT_TRUE(frame_delta_is_key(&delta));
+    frame_delta_apply(&delta, canvas, STRIDE);
+
+    // Two small patches, one of them on the right and bottom edge
+    builder_begin(&b, 2, 2);
+    builder_rect(&b, 3, 5, 4, 2, 0xabcd);
+    builder_rect(&b, CANVAS_W - 2, CANVAS_H - 1, 2, 1, 0x5555);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_OK, frame_delta_parse(b.data, b.len, &delta));
+    frame_delta_apply(&delta, canvas, STRIDE);
+
+    for (int y = 0; y < CANVAS_H; y++) {
+        for (int x = 0; x < CANVAS_W; x++) {
+            uint16_t expected = 0x1234;
+            if (x >= 3 && x < 7 && y >= 5 && y < 7) {
+                expected = 0xabcd;
+            } else if (x >= CANVAS_W - 2 && y == CANVAS_H - 1) {
+                expected = 0x5555;
+            }
+            TEST_ASSERT_EQUAL(expected, pixel_at(canvas, x, y));
+        }
+    }
+}
+
+static void test_full_width_band(void)
+{
+    static delta_builder_t b;
+    static uint8_t canvas[CANVAS_H * STRIDE];
+    frame_delta_t delta;
+    memset(canvas, 0, sizeof(canvas));
+
+    builder_begin(&b, 7, 1);
+    builder_rect(&b, 0, 10, CANVAS_W, 3, 0xffff);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_OK, frame_delta_parse(b.data, b.len, &delta));
+    frame_delta_apply(&delta, canvas, STRIDE);
+
+    TEST_ASSERT_EQUAL(0, pixel_at(canvas, CANVAS_W - 1, 9));
+    TEST_ASSERT_EQUAL(0xffff, pixel_at(canvas, 0, 10));
+    TEST_ASSERT_EQUAL(0xffff, pixel_at(canvas, CANVAS_W - 1, 12));
+    TEST_ASSERT_EQUAL(0, pixel_at(canvas, 0, 13));
+}
+
+static void test_tiled_key_frames(void)
+{
+    static delta_builder_t b;
+    frame_delta_t delta;
+
+    // Two bands of different height, each split into tiles of its height
+    builder_begin(&b, 1, 5);
+    builder_rect(&b, 0, 0, 32, 16, 1);
+    builder_rect(&b, 32, 0, 32, 16, 2);
+    builder_rect(&b, 0, 16, 20, 32, 3);
+    builder_rect(&b, 20, 16, 20, 32, 4);
+    builder_rect(&b, 40, 16, 24, 32, 5);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_OK, frame_delta_parse(b.data, b.len, &delta));
+    TEST_ASSERT_TRUE(frame_delta_is_key(&delta));
+
+    // A tile short at the bottom
+    builder_begin(&b, 1, 2);
+    builder_rect(&b, 0, 0, CANVAS_W, 16, 1);
+    builder_rect(&b, 0, 16, CANVAS_W, 31, 2);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_OK, frame_delta_parse(b.data, b.len, &delta));
+    TEST_ASSERT_FALSE(frame_delta_is_key(&delta));
+
+    // Out of order, e.g. a tile that had to be sent again
+    builder_begin(&b, 1, 2);
+    builder_rect(&b, 0, 24, CANVAS_W, 24, 1);
+    builder_rect(&b, 0, 0, CANVAS_W, 24, 2);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_OK, frame_delta_parse(b.data, b.len, &delta));
+    TEST_ASSERT_FALSE(frame_delta_is_key(&delta));
+
+    // Tiles of a band that differ in height leave a hole
+    builder_begin(&b, 1, 3);
+    builder_rect(&b, 0, 0, 32, 48, 1);
+    builder_rect(&b, 32, 0, 32, 24, 2);
+    builder_rect(&b, 32, 24, 32, 24, 3);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_OK, frame_delta_parse(b.data, b.len, &delta));
+    TEST_ASSERT_FALSE(frame_delta_is_key(&delta));
+}
+
+static void test_malformed_deltas_are_rejected(void)
+{
+    static delta_builder_t b;
+    frame_delta_t delta;
+
+    builder_begin(&b, 1, 1);
+    builder_rect(&b, 0, 0, 2, 2, 0);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_TRUNCATED, frame_delta_parse(b.data, FRAME_DELTA_HEADER_LEN - 1, &delta));
+    TEST_ASSERT_EQUAL(FRAME_DELTA_TRUNCATED, frame_delta_parse(b.data, FRAME_DELTA_HEADER_LEN + 4, &delta));
+    TEST_ASSERT_EQUAL(FRAME_DELTA_SIZE_MISMATCH, frame_delta_parse(b.data, b.len - 1, &delta));
+
+    b.data[4] = FRAME_DELTA_VERSION + 1;
+    TEST_ASSERT_EQUAL(FRAME_DELTA_BAD_VERSION, frame_delta_parse(b.data, b.len, &delta));
+    b.data[4] = FRAME_DELTA_VERSION;
+    b.data[5] = 0x7f;
+    TEST_ASSERT_EQUAL(FRAME_DELTA_BAD_FORMAT, frame_delta_parse(b.data, b.len, &delta));
+
+    // Outside the frame, on either axis
+    builder_begin(&b, 1, 1);
+    builder_rect(&b, CANVAS_W - 1, 0, 2, 1, 0);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_BAD_RECT, frame_delta_parse(b.data, b.len, &delta));
+    builder_begin(&b, 1, 1);
+    builder_rect(&b, 0, 0xffff, 1, 2, 0);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_BAD_RECT, frame_delta_parse(b.data, b.len, &delta));
+
+    // Empty rectangle
+    builder_begin(&b, 1, 1);
+    builder_rect(&b, 0, 0, 0, 4, 0);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_BAD_RECT, frame_delta_parse(b.data, b.len, &delta));
+}
+
+static void test_no_rects(void)
+{
+    static delta_builder_t b;
+    frame_delta_t delta;
+    builder_begin(&b, 3, 0);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_OK, frame_delta_parse(b.data, b.len, &delta));
+    TEST_ASSERT_EQUAL(0, delta.rect_count);
+    TEST_ASSERT_EQUAL(0, delta.pixels_len);
+    TEST_ASSERT_FALSE(frame_delta_is_key(&delta));
+}
+
+int main(void)
+{
+    RUN_TEST(test_plain_frame_is_not_a_delta);
+    RUN_TEST(test_header_fields);
+    RUN_TEST(test_patches_only_touch_their_rects);
+    RUN_TEST(test_full_width_band);
+    RUN_TEST(test_tiled_key_frames);
+    RUN_TEST(test_malformed_deltas_are_rejected);
+    RUN_TEST(test_no_rects);
+    return TEST_REPORT();
+}
@@ -0,0 +1,370 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "frame_flip.h"
+#include "test_common.h"
+
+#define BUFFER_SIZE 64
+
+// Stands in for a DPI panel: present() queues a buffer that the next vsync
+// latches, either on demand (auto_vsync) or from fake_vsync().
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t *scanning;      // Buffer the panel reads from
+    uint8_t *next;          // Presented, latched at the next vsync
+    bool refreshed;         // A vsync happened since the last present()
+    bool auto_vsync;        // Waiting with a timeout triggers a vsync right away
+    int presents;
+    int vsyncs;
+} fake_panel_t;
+
+static uint8_t buffers[FRAME_FLIP_MAX_BUFFERS][BUFFER_SIZE];
+
+static void fake_vsync(fake_panel_t *panel)
+{
+    pthread_mutex_lock(&panel->lock);
+    if (panel->next) {
+        panel->scanning = panel->next;
+        panel->next = NULL;
+    }
+    panel->refreshed = true;
+    panel->vsyncs++;
+    pthread_cond_broadcast(&panel->cond);
+    pthread_mutex_unlock(&panel->lock);
+}
+
+static void fake_present(void *ctx, uint8_t *buffer, size_t size)
+{
+    fake_panel_t *panel = ctx;
+    TEST_ASSERT_EQUAL(BUFFER_SIZE, size);
+    pthread_mutex_lock(&panel->lock);
+    panel->next = buffer;
+    panel->refreshed = false;
+    panel->presents++;
+    pthread_mutex_unlock(&panel->lock);
+}
+
+static bool fake_wait_vsync(void *ctx, uint32_t timeout_ms)
+{
+    fake_panel_t *panel = ctx;
+    if (panel->auto_vsync && timeout_ms) {
+        fake_vsync(panel);
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&panel->lock);
+    while (!panel->refreshed && timeout_ms) {
+        if (pthread_cond_timedwait(&panel->cond, &panel->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    bool refreshed = panel->refreshed;
+    pthread_mutex_unlock(&panel->lock);
+    return refreshed;
+}
+
+static void fake_panel_init(fake_panel_t *panel, bool auto_vsync)
+{
+    memset(panel, 0, sizeof(*panel));
+    pthread_mutex_init(&panel->lock, NULL);
+    pthread_cond_init(&panel->cond, NULL);
+    panel->scanning = buffers[0];
+    panel->refreshed = true;
+    panel->auto_vsync = auto_vsync;
+}
+
+static frame_flip_t *make_flip(fake_panel_t *panel, size_t count, uint32_t timeout_ms)
+{
+    frame_flip_config_t cfg = {
+        .panel = {
+            .present = fake_present,
+            .wait_vsync = fake_wait_vsync,
+            .ctx = panel,
+        },
+        .buffer_count = count,
+        .buffer_size = BUFFER_SIZE,
+        .front = 0,
+        .vsync_timeout_ms = timeout_ms,
+    };
+    for (size_t i = 0; i < count; i++) {
+        cfg.buffers[i] = buffers[i];
+    }
+    return frame_flip_create(&cfg);
+}
+
+// The buffer handed out must be neither read by the panel now nor after the next vsync
+static void assert_not_busy(fake_panel_t *panel, const uint8_t *buffer)
+{
+    pthread_mutex_lock(&panel->lock);
+    bool busy = buffer == panel->scanning || buffer == panel->next;
+    pthread_mutex_unlock(&panel->lock);
+    TEST_ASSERT_FALSE(busy);
+}
+
+static void test_rejects_bad_config(void)
+{
+    fake_panel_t panel;
+    fake_panel_init(&panel, true);
+
+    TEST_ASSERT_NULL(frame_flip_create(NULL));
+    TEST_ASSERT_NULL(make_flip(&panel, 0, 10));
+    TEST_ASSERT_NULL(make_flip(&panel, FRAME_FLIP_MAX_BUFFERS + 1, 10));
+
+    frame_flip_config_t cfg = {
+        .panel = { .present = fake_present, .wait_vsync = fake_wait_vsync, .ctx = &panel },
+        .buffers = { buffers[0], NULL },
+        .buffer_count = 2,
+        .buffer_size = BUFFER_SIZE,
+    };
+    TEST_ASSERT_NULL(frame_flip_create(&cfg));
+    cfg.buffers[1] = buffers[1];
+    cfg.front = 2;
+    TEST_ASSERT_NULL(frame_flip_create(&cfg));
+    cfg.front = 1;
+    cfg.panel.wait_vsync = NULL;
+    TEST_ASSERT_NULL(frame_flip_create(&cfg));
+    cfg.panel.wait_vsync = fake_wait_vsync;
+    frame_flip_t *flip = frame_flip_create(&cfg);
+    TEST_ASSERT_NOT_NULL(flip);
+    frame_flip_delete(flip);
+}
+
+static void test_triple_buffering_writes_without_waiting(void)
+{
+    fake_panel_t panel;
+    fake_panel_init(&panel, true);
+    frame_flip_t *flip = make_flip(&panel, 3, 100);
+    TEST_ASSERT_NOT_NULL(flip);
+
+    uint8_t *first = frame_flip_begin(flip);
+    TEST_ASSERT_NOT_NULL(first);
+    assert_not_busy(&panel, first);
+    frame_flip_end(flip);
+    TEST_ASSERT(panel.next == first);
+
+    // The first frame is still pending, the third buffer is free
+    uint8_t *second = frame_flip_begin(flip);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT(second != first);
+    assert_not_busy(&panel, second);
+
+    frame_flip_stats_t stats;
+    frame_flip_get_stats(flip, &stats);
+    TEST_ASSERT_EQUAL(0, stats.vsync_waits);
+
+    // Presenting waits until the first frame was scanned out, so none is skipped
+    frame_flip_end(flip);
+    TEST_ASSERT(panel.scanning == first);
+    TEST_ASSERT(panel.next == second);
+    frame_flip_get_stats(flip, &stats);
+    TEST_ASSERT_EQUAL(2, stats.flips);
+    TEST_ASSERT_EQUAL(1, stats.vsync_waits);
+    TEST_ASSERT_EQUAL(0, stats.vsync_timeouts);
+
+    frame_flip_delete(flip);
+}
+
+static void test_double_buffering_waits_for_vsync(void)
+{
+    fake_panel_t panel;
+    fake_panel_init(&panel, true);
+    frame_flip_t *flip = make_flip(&panel, 2, 100);
+    TEST_ASSERT_NOT_NULL(flip);
+
+    TEST_ASSERT(frame_flip_begin(flip) == buffers[1]);
+    frame_flip_end(flip);
+
+    // Both buffers are busy until the panel latched buffers[1]
+    uint8_t *next = frame_flip_begin(flip);
+    TEST_ASSERT(next == buffers[0]);
+    TEST_ASSERT(panel.scanning == buffers[1]);
+    assert_not_busy(&panel, next);
+    frame_flip_end(flip);
+
+    frame_flip_stats_t stats;
+    frame_flip_get_stats(flip, &stats);
+    TEST_ASSERT_EQUAL(2, stats.flips);
+    TEST_ASSERT_EQUAL(1, stats.vsync_waits);
+    TEST_ASSERT_EQUAL(2, panel.presents);
+
+    frame_flip_delete(flip);
+}
+
+static void test_vsync_after_present_frees_buffer(void)
+{
+    fake_panel_t panel;
+    fake_panel_init(&panel, false);
+    frame_flip_t *flip = make_flip(&panel, 2, 100);
+    TEST_ASSERT_NOT_NULL(flip);
+
+    TEST_ASSERT(frame_flip_begin(flip) == buffers[1]);
+    frame_flip_end(flip);
+    fake_vsync(&panel);
+
+    // The vsync already happened, so the old front buffer is free without waiting
+    TEST_ASSERT(frame_flip_begin(flip) == buffers[0]);
+    frame_flip_stats_t stats;
+    frame_flip_get_stats(flip, &stats);
+    TEST_ASSERT_EQUAL(0, stats.vsync_waits);
+    frame_flip_end(flip);
+
+    frame_flip_delete(flip);
+}
+
+static void test_vsync_timeout_drops_frame(void)
+{
+    fake_panel_t panel;
+    fake_panel_init(&panel, false);
+    frame_flip_t *flip = make_flip(&panel, 2, 5);
+    TEST_ASSERT_NOT_NULL(flip);
+
+    TEST_ASSERT_NOT_NULL(frame_flip_begin(flip));
+    frame_flip_end(flip);
+
+    // The panel never refreshes
+    TEST_ASSERT_NULL(frame_flip_begin(flip));
+    uint8_t frame[BUFFER_SIZE] = { 0 };
+    TEST_ASSERT_FALSE(frame_flip_show(flip, frame, sizeof(frame)));
+
+    frame_flip_stats_t stats;
+    frame_flip_get_stats(flip, &stats);
+    TEST_ASSERT_EQUAL(1, stats.flips);
+    TEST_ASSERT_EQUAL(2, stats.dropped);
+    TEST_ASSERT_EQUAL(2, stats.vsync_timeouts);
+
+    // It recovers with the next vsync
+    fake_vsync(&panel);
+    TEST_ASSERT_TRUE(frame_flip_show(flip, frame, sizeof(frame)));
+
+    frame_flip_delete(flip);
+}
+
+static void test_single_buffer_is_written_in_place(void)
+{
+    fake_panel_t panel;
+    fake_panel_init(&panel, false);
+    frame_flip_t *flip = make_flip(&panel, 1, 5);
+    TEST_ASSERT_NOT_NULL(flip);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT(frame_flip_begin(flip) == buffers[0]);
+        frame_flip_end(flip);
+    }
+
+    frame_flip_stats_t stats;
+    frame_flip_get_stats(flip, &stats);
+    TEST_ASSERT_EQUAL(3, stats.flips);
+    TEST_ASSERT_EQUAL(0, stats.vsync_waits);
+    TEST_ASSERT_EQUAL(3, panel.presents);
+
+    frame_flip_delete(flip);
+}
+
+static void test_show_copies_frame(void)
+{
+    fake_panel_t panel;
+    fake_panel_init(&panel, true);
+    frame_flip_t *flip = make_flip(&panel, 3, 100);
+    TEST_ASSERT_NOT_NULL(flip);
+
+    uint8_t frame[BUFFER_SIZE];
+    for (size_t i = 0; i < sizeof(frame); i++) {
+        frame[i] = (uint8_t)(i * 7);
+    }
+    TEST_ASSERT_FALSE(frame_flip_show(flip, frame, sizeof(frame) - 1));
+    TEST_ASSERT_EQUAL(0, panel.presents);
+
+    TEST_ASSERT_TRUE(frame_flip_show(flip, frame, sizeof(frame)));
+    TEST_ASSERT_NOT_NULL(panel.next);
+    TEST_ASSERT_EQUAL_MEMORY(frame, panel.next, sizeof(frame));
+
+    frame_flip_delete(flip);
+}
+
+typedef struct {
+    fake_panel_t *panel;
+    volatile bool stop;
+} vsync_thread_arg_t;
+
+static void *vsync_thread(void *arg)
+{
+    vsync_thread_arg_t *vsync = arg;
+    while (!vsync->stop) {
+        usleep(50);
+        fake_vsync(vsync->panel);
+    }
+    return NULL;
+}
+
+// A free running panel, the writer must never touch a buffer it reads
+static void flip_against_running_panel(size_t count)
+{
+    fake_panel_t panel;
+    fake_panel_init(&panel, false);
+    frame_flip_t *flip = make_flip(&panel, count, 1000);
+    TEST_ASSERT_NOT_NULL(flip);
+
+    vsync_thread_arg_t vsync = { .panel = &panel };
+    pthread_t thread;
+    TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL, vsync_thread, &vsync));
+
+    bool clean = true;
+    for (int i = 0; i < 2000 && clean; i++) {
+        uint8_t *buffer = frame_flip_begin(flip);
+        if (!buffer) {
+            clean = false;
+            break;
+        }
+        pthread_mutex_lock(&panel.lock);
+        clean = buffer != panel.scanning && buffer != panel.next;
+        pthread_mutex_unlock(&panel.lock);
+        memset(buffer, i, BUFFER_SIZE);
+        frame_flip_end(flip);
+    }
+
+    vsync.stop = true;
+    pthread_join(thread, NULL);
+    TEST_ASSERT_TRUE(clean);
+
+    frame_flip_stats_t stats;
+    frame_flip_get_stats(flip, &stats);
+    TEST_ASSERT_EQUAL(2000, stats.flips);
+    TEST_ASSERT_EQUAL(0, stats.vsync_timeouts);
+
+    frame_flip_delete(flip);
+}
+
+static void test_double_buffering_against_running_panel(void)
+{
+    flip_against_running_panel(2);
+}
+
+static void test_triple_buffering_against_running_panel(void)
+{
+    flip_against_running_panel(3);
+}
+
+int main(void)
+{
+    RUN_TEST(test_rejects_bad_config);
+    RUN_TEST(test_triple_buffering_writes_without_waiting);
+    RUN_TEST(test_double_buffering_waits_for_vsync);
+    RUN_TEST(test_vsync_after_present_frees_buffer);
+    RUN_TEST(test_vsync_timeout_drops_frame);
+    RUN_TEST(test_single_buffer_is_written_in_place);
+    RUN_TEST(test_show_copies_frame);
+    RUN_TEST(test_double_buffering_against_running_panel);
+    RUN_TEST(test_triple_buffering_against_running_panel);
+    return TEST_REPORT();
+}
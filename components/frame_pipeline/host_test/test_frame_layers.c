@@ -0,0 +1,121 @@
+#include <stdint.h>
+#include "frame_layers.h"
+#include "test_common.h"
+
+#define SCREEN_W 1280
+#define SCREEN_H 720
+
+static void test_claim_and_stack(void)
+{
+    frame_layers_t layers;
+    frame_layers_init(&layers, SCREEN_W, SCREEN_H);
+    TEST_ASSERT_EQUAL(0, frame_layers_count(&layers));
+
+    // A dashboard on the whole screen, an overlay in a corner above it
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 0, 1, NULL));
+    frame_region_t corner = { .x = 960, .y = 0, .width = 320, .height = 240 };
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 5, 2, &corner));
+    TEST_ASSERT_EQUAL(2, frame_layers_count(&layers));
+    TEST_ASSERT_TRUE(frame_layers_in_use(&layers, 0));
+    TEST_ASSERT_FALSE(frame_layers_in_use(&layers, 3));
+    TEST_ASSERT_FALSE(frame_layers_in_use(&layers, FRAME_LAYERS_MAX));
+
+    TEST_ASSERT_EQUAL(SCREEN_W, layers.layers[0].region.width);
+    TEST_ASSERT_EQUAL(SCREEN_H, layers.layers[0].region.height);
+    TEST_ASSERT_EQUAL(960, layers.layers[5].region.x);
+    TEST_ASSERT_EQUAL(320, layers.layers[5].region.width);
+
+    TEST_ASSERT_EQUAL(0, frame_layers_stack_index(&layers, 0));
+    TEST_ASSERT_EQUAL(1, frame_layers_stack_index(&layers, 3));
+    TEST_ASSERT_EQUAL(1, frame_layers_stack_index(&layers, 5));
+    TEST_ASSERT_EQUAL(2, frame_layers_stack_index(&layers, 7));
+
+    // A third sender slides in between
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 2, 3, NULL));
+    TEST_ASSERT_EQUAL(2, frame_layers_stack_index(&layers, 5));
+}
+
+static void test_ownership(void)
+{
+    frame_layers_t layers;
+    frame_layers_init(&layers, SCREEN_W, SCREEN_H);
+
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 1, 10, NULL));
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_BUSY, frame_layers_claim(&layers, 1, 11, NULL));
+    TEST_ASSERT_EQUAL(10, layers.layers[1].owner);
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_BAD_LAYER, frame_layers_claim(&layers, FRAME_LAYERS_MAX, 11, NULL));
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_BAD_LAYER, frame_layers_claim(&layers, 0, FRAME_LAYERS_NO_OWNER, NULL));
+
+    // Moving to another layer gives up the first one
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 4, 10, NULL));
+    TEST_ASSERT_FALSE(frame_layers_in_use(&layers, 1));
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 1, 11, NULL));
+    TEST_ASSERT_EQUAL(2, frame_layers_count(&layers));
+
+    // Disconnecting frees its layer for others
+    TEST_ASSERT_EQUAL(1, frame_layers_release(&layers, 10));
+    TEST_ASSERT_EQUAL(0, frame_layers_release(&layers, 10));
+    TEST_ASSERT_EQUAL(0, frame_layers_release(&layers, FRAME_LAYERS_NO_OWNER));
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 4, 12, NULL));
+    TEST_ASSERT_EQUAL(2, frame_layers_count(&layers));
+}
+
+static void test_regions_clipped(void)
+{
+    frame_layers_t layers;
+    frame_layers_init(&layers, SCREEN_W, SCREEN_H);
+
+    frame_region_t overhang = { .x = 1200, .y = 700, .width = 200, .height = 100 };
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 0, 1, &overhang));
+    TEST_ASSERT_EQUAL(80, layers.layers[0].region.width);
+    TEST_ASSERT_EQUAL(20, layers.layers[0].region.height);
+
+    frame_region_t huge = { .x = 100, .y = 100, .width = UINT32_MAX, .height = UINT32_MAX };
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 1, 2, &huge));
+    TEST_ASSERT_EQUAL(SCREEN_W - 100, layers.layers[1].region.width);
+    TEST_ASSERT_EQUAL(SCREEN_H - 100, layers.layers[1].region.height);
+
+    frame_region_t off_screen = { .x = SCREEN_W, .y = 0, .width = 10, .height = 10 };
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OFF_SCREEN, frame_layers_claim(&layers, 2, 3, &off_screen));
+    TEST_ASSERT_FALSE(frame_layers_in_use(&layers, 2));
+
+    // An empty region is the whole screen
+    frame_region_t empty = { .x = 50, .y = 50 };
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 2, 3, &empty));
+    TEST_ASSERT_EQUAL(0, layers.layers[2].region.x);
+    TEST_ASSERT_EQUAL(SCREEN_W, layers.layers[2].region.width);
+}
+
+static void test_generation(void)
+{
+    frame_layers_t layers;
+    frame_layers_init(&layers, SCREEN_W, SCREEN_H);
+    frame_region_t region = { .x = 10, .y = 10, .width = 100, .height = 100 };
+
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 3, 1, &region));
+    uint32_t generation = layers.layers[3].generation;
+    TEST_ASSERT(generation != 0);
+
+    // The same claim again changes nothing the compositor would have to redo
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 3, 1, &region));
+    TEST_ASSERT_EQUAL(generation, layers.layers[3].generation);
+
+    region.x = 20;
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 3, 1, &region));
+    TEST_ASSERT(layers.layers[3].generation != generation);
+    generation = layers.layers[3].generation;
+
+    // Another client on the same spot after a disconnect is a new layer
+    frame_layers_release(&layers, 1);
+    TEST_ASSERT_EQUAL(FRAME_LAYERS_OK, frame_layers_claim(&layers, 3, 2, &region));
+    TEST_ASSERT(layers.layers[3].generation != generation);
+}
+
+int main(void)
+{
+    RUN_TEST(test_claim_and_stack);
+    RUN_TEST(test_ownership);
+    RUN_TEST(test_regions_clipped);
+    RUN_TEST(test_generation);
+    return TEST_REPORT();
+}
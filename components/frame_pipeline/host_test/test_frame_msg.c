@@ -0,0 +1,305 @@
+#include <stdint.h>
+#include "frame_msg.h"
+#include "json_pull.h"
+#include "test_common.h"
+
+#define FUZZ_ROUNDS 200000
+#define FUZZ_MAX_LEN 160
+
+static size_t make_envelope(uint8_t *buf, frame_msg_type_t type, uint32_t seq, const char *payload)
+{
+    size_t len = strlen(payload);
+    size_t header = frame_msg_write_header(buf, FRAME_MSG_HEADER_LEN, type, seq, (uint32_t)len);
+    memcpy(buf + header, payload, len);
+    return header + len;
+}
+
+static void test_envelope_round_trip(void)
+{
+    uint8_t buf[64];
+    size_t len = make_envelope(buf, FRAME_MSG_FRAME, 0x01020304, "pixels");
+    TEST_ASSERT_EQUAL(FRAME_MSG_HEADER_LEN + 6, len);
+    TEST_ASSERT_TRUE(frame_msg_is_envelope(buf, len));
+
+    frame_msg_t msg;
+    TEST_ASSERT_EQUAL(FRAME_MSG_OK, frame_msg_parse(buf, len, &msg));
+    TEST_ASSERT_EQUAL(FRAME_MSG_FRAME, msg.type);
+    TEST_ASSERT_EQUAL(0x01020304, msg.seq);
+    TEST_ASSERT(msg.payload == buf + FRAME_MSG_HEADER_LEN);
+    TEST_ASSERT_EQUAL(6, msg.len);
+
+    // An empty payload is fine
+    len = make_envelope(buf, FRAME_MSG_PING, 0, "");
+    TEST_ASSERT_EQUAL(FRAME_MSG_OK, frame_msg_parse(buf, len, &msg));
+    TEST_ASSERT_EQUAL(FRAME_MSG_PING, msg.type);
+    TEST_ASSERT_EQUAL(0, msg.len);
+
+    TEST_ASSERT_EQUAL(0, frame_msg_write_header(buf, FRAME_MSG_HEADER_LEN - 1, FRAME_MSG_FRAME, 0, 0));
+    TEST_ASSERT_EQUAL(0, frame_msg_write_header(buf, sizeof(buf), FRAME_MSG_NONE, 0, 0));
+    TEST_ASSERT_EQUAL(0, frame_msg_write_header(buf, sizeof(buf), FRAME_MSG_TYPE_COUNT, 0, 0));
+}
+
+static void test_envelope_rejects_malformed(void)
+{
+    uint8_t buf[64];
+    frame_msg_t msg;
+    size_t len = make_envelope(buf, FRAME_MSG_SENSOR, 1, "{}");
+
+    // A frame whose first bytes happen to be printable is still no envelope
+    static const uint8_t printable[32] = { 0x7b, 0x22, 0x74, 0x79 };
+    TEST_ASSERT_EQUAL(FRAME_MSG_NOT_ENVELOPE, frame_msg_parse(printable, sizeof(printable), &msg));
+    TEST_ASSERT_EQUAL(FRAME_MSG_NOT_ENVELOPE, frame_msg_parse(buf, 3, &msg));
+    TEST_ASSERT_EQUAL(FRAME_MSG_TRUNCATED, frame_msg_parse(buf, FRAME_MSG_HEADER_LEN - 1, &msg));
+    TEST_ASSERT_EQUAL(FRAME_MSG_SIZE_MISMATCH, frame_msg_parse(buf, len - 1, &msg));
+
+    buf[4] = FRAME_MSG_VERSION + 1;
+    TEST_ASSERT_EQUAL(FRAME_MSG_BAD_VERSION, frame_msg_parse(buf, len, &msg));
+    buf[4] = FRAME_MSG_VERSION;
+
+    buf[5] = FRAME_MSG_TYPE_COUNT;
+    TEST_ASSERT_EQUAL(FRAME_MSG_BAD_TYPE, frame_msg_parse(buf, len, &msg));
+    buf[5] = FRAME_MSG_NONE;
+    TEST_ASSERT_EQUAL(FRAME_MSG_BAD_TYPE, frame_msg_parse(buf, len, &msg));
+    buf[5] = FRAME_MSG_SENSOR;
+
+    buf[7] = 1;
+    TEST_ASSERT_EQUAL(FRAME_MSG_BAD_TYPE, frame_msg_parse(buf, len, &msg));
+}
+
+static frame_msg_type_t text_type(const char *text)
+{
+    frame_msg_t msg;
+    frame_msg_from_text(text, strlen(text), &msg);
+    TEST_ASSERT(msg.payload == (const uint8_t *)text);
+    TEST_ASSERT_EQUAL(strlen(text), msg.len);
+    return msg.type;
+}
+
+static void test_text_types(void)
+{
+    TEST_ASSERT_EQUAL(FRAME_MSG_PING, text_type("ping"));
+    TEST_ASSERT_EQUAL(FRAME_MSG_BLIT_CONFIG, text_type("{\"type\":\"blit_config\",\"frameWidth\":800}"));
+    TEST_ASSERT_EQUAL(FRAME_MSG_SCREEN_CONFIG, text_type(" {\n \"type\" : \"config\" }"));
+    TEST_ASSERT_EQUAL(FRAME_MSG_SCREEN_CONFIG, text_type("{\"type\":\"rive_config\"}"));
+    TEST_ASSERT_EQUAL(FRAME_MSG_SENSOR, text_type("{\"type\":\"rive_sensor\",\"sensors\":{}}"));
+    TEST_ASSERT_EQUAL(FRAME_MSG_PING, text_type("{\"type\":\"ping\"}"));
+
+    // "type" after other members, nested values skipped on the way
+    TEST_ASSERT_EQUAL(FRAME_MSG_SENSOR,
+                      text_type("{\"sensors\":{\"t\":{\"type\":\"config\",\"v\":[1,{\"a\":\"}\"}]}},"
+                                "\"n\":-1.5e3,\"ok\":true,\"s\":\"a\\\"b\",\"type\":\"sensor\"}"));
+
+    // Nested "type" members do not count
+    TEST_ASSERT_EQUAL(FRAME_MSG_TEXT, text_type("{\"data\":{\"type\":\"sensor\"}}"));
+    TEST_ASSERT_EQUAL(FRAME_MSG_TEXT, text_type("[{\"type\":\"sensor\"}]"));
+    TEST_ASSERT_EQUAL(FRAME_MSG_TEXT, text_type("{\"type\":\"unknown\"}"));
+    TEST_ASSERT_EQUAL(FRAME_MSG_TEXT, text_type("{\"type\":7}"));
+    TEST_ASSERT_EQUAL(FRAME_MSG_TEXT, text_type("{\"type\":\"sensor"));
+    TEST_ASSERT_EQUAL(FRAME_MSG_TEXT, text_type("{\"a\":1 \"type\":\"sensor\"}"));
+    TEST_ASSERT_EQUAL(FRAME_MSG_TEXT, text_type("hello"));
+    TEST_ASSERT_EQUAL(FRAME_MSG_TEXT, text_type(""));
+}
+
+static frame_msg_t text_msg(const char *text)
+{
+    frame_msg_t msg;
+    frame_msg_from_text(text, strlen(text), &msg);
+    return msg;
+}
+
+static void test_blit_config(void)
+{
+    frame_blit_config_t config;
+    frame_msg_t msg = text_msg("{\"type\":\"blit_config\",\"mode\":\"blit\",\"frameFormat\":\"lz4\","
+                               "\"frameWidth\":800,\"frameHeight\":480.0,\"frameSize\":768000,"
+                               "\"extra\":{\"frameWidth\":1},\"description\":\"Dash \\\"main\\\"\"}");
+    TEST_ASSERT_TRUE(frame_msg_parse_blit_config(&msg, &config));
+    TEST_ASSERT_EQUAL_STRING("blit", config.mode);
+    TEST_ASSERT_EQUAL_STRING("lz4", config.format);
+    TEST_ASSERT_EQUAL_STRING("Dash \"main\"", config.description);
+    TEST_ASSERT_EQUAL(800, config.width);
+    TEST_ASSERT_EQUAL(480, config.height);
+    TEST_ASSERT_EQUAL(768000, config.size);
+    TEST_ASSERT_FALSE(config.has_layer);
+    TEST_ASSERT_EQUAL(0, config.region.width);
+
+    // Layer and region of a sender that only draws part of the screen
+    msg = text_msg("{\"type\":\"blit_config\",\"layer\":3,"
+                   "\"region\":{\"x\":960,\"y\":20,\"width\":320,\"height\":240,\"z\":{}}}");
+    TEST_ASSERT_TRUE(frame_msg_parse_blit_config(&msg, &config));
+    TEST_ASSERT_TRUE(config.has_layer);
+    TEST_ASSERT_EQUAL(3, config.layer);
+    TEST_ASSERT_EQUAL(960, config.region.x);
+    TEST_ASSERT_EQUAL(20, config.region.y);
+    TEST_ASSERT_EQUAL(320, config.region.width);
+    TEST_ASSERT_EQUAL(240, config.region.height);
+
+    // A layer that is not a valid number stays out of range
+    msg = text_msg("{\"layer\":\"top\",\"region\":[1,2]}");
+    TEST_ASSERT_TRUE(frame_msg_parse_blit_config(&msg, &config));
+    TEST_ASSERT_TRUE(config.has_layer);
+    TEST_ASSERT_EQUAL(UINT32_MAX, config.layer);
+    TEST_ASSERT_EQUAL(0, config.region.x);
+    msg = text_msg("{\"region\":{\"x\":1,}}");
+    TEST_ASSERT_FALSE(frame_msg_parse_blit_config(&msg, &config));
+
+    // Wrong types and out of range numbers count as absent
+    msg = text_msg("{\"frameFormat\":[\"lz4\"],\"frameWidth\":\"800\",\"frameHeight\":-1,\"frameSize\":1e10}");
+    TEST_ASSERT_TRUE(frame_msg_parse_blit_config(&msg, &config));
+    TEST_ASSERT_EQUAL_STRING("", config.format);
+    TEST_ASSERT_EQUAL(0, config.width);
+    TEST_ASSERT_EQUAL(0, config.height);
+    TEST_ASSERT_EQUAL(0, config.size);
+
+    msg = text_msg("{\"frameWidth\":800,");
+    TEST_ASSERT_FALSE(frame_msg_parse_blit_config(&msg, &config));
+    msg = text_msg("{\"frameWidth\":800} {}");
+    TEST_ASSERT_FALSE(frame_msg_parse_blit_config(&msg, &config));
+    msg = text_msg("[]");
+    TEST_ASSERT_FALSE(frame_msg_parse_blit_config(&msg, &config));
+}
+
+static void test_screen_config(void)
+{
+    frame_screen_config_t config;
+    frame_msg_t msg = text_msg("{\"type\":\"config\",\"screenId\":\"main\","
+                               "\"layout\":\"<component>\\n<view/>\\n</component>\"}");
+    TEST_ASSERT_TRUE(frame_msg_parse_screen_config(&msg, &config));
+    TEST_ASSERT_EQUAL_STRING("main", config.screen_id);
+    TEST_ASSERT_TRUE(config.has_layout);
+    TEST_ASSERT_NOT_NULL(config.layout);
+
+    char xml[64];
+    TEST_ASSERT(config.layout_len < sizeof(xml));
+    json_pull_unescape(config.layout, config.layout_len, xml, config.layout_len + 1);
+    TEST_ASSERT_EQUAL_STRING("<component>\n<view/>\n</component>", xml);
+
+    msg = text_msg("{\"layout\":null}");
+    TEST_ASSERT_TRUE(frame_msg_parse_screen_config(&msg, &config));
+    TEST_ASSERT_TRUE(config.has_layout);
+    TEST_ASSERT_NULL(config.layout);
+    TEST_ASSERT_EQUAL_STRING("", config.screen_id);
+
+    msg = text_msg("{\"layout\":{\"view\":1},\"screenId\":\"x\"}");
+    TEST_ASSERT_TRUE(frame_msg_parse_screen_config(&msg, &config));
+    TEST_ASSERT_FALSE(config.has_layout);
+    TEST_ASSERT_EQUAL_STRING("x", config.screen_id);
+}
+
+static int handled_type;
+static void *handled_ctx;
+
+static void record_handler(const frame_msg_t *msg, void *ctx)
+{
+    handled_type = msg->type;
+    handled_ctx = ctx;
+}
+
+static void test_dispatch(void)
+{
+    frame_msg_dispatcher_t dispatcher;
+    frame_msg_dispatcher_init(&dispatcher);
+    TEST_ASSERT_FALSE(frame_msg_dispatcher_set(&dispatcher, FRAME_MSG_NONE, record_handler));
+    TEST_ASSERT_FALSE(frame_msg_dispatcher_set(&dispatcher, FRAME_MSG_TYPE_COUNT, record_handler));
+    TEST_ASSERT_TRUE(frame_msg_dispatcher_set(&dispatcher, FRAME_MSG_SENSOR, record_handler));
+
+    int ctx;
+    frame_msg_t msg = { .type = FRAME_MSG_SENSOR };
+    TEST_ASSERT_TRUE(frame_msg_dispatch(&dispatcher, &msg, &ctx));
+    TEST_ASSERT_EQUAL(FRAME_MSG_SENSOR, handled_type);
+    TEST_ASSERT(handled_ctx == &ctx);
+
+    handled_type = FRAME_MSG_NONE;
+    msg.type = FRAME_MSG_FRAME;
+    TEST_ASSERT_FALSE(frame_msg_dispatch(&dispatcher, &msg, &ctx));
+    msg.type = (frame_msg_type_t)200;
+    TEST_ASSERT_FALSE(frame_msg_dispatch(&dispatcher, &msg, &ctx));
+    TEST_ASSERT_EQUAL(FRAME_MSG_NONE, handled_type);
+
+    TEST_ASSERT_EQUAL(1, dispatcher.dispatched[FRAME_MSG_SENSOR]);
+    TEST_ASSERT_EQUAL(2, dispatcher.unhandled);
+}
+
+// xorshift32, fixed seed so a failure reproduces
+static uint32_t fuzz_state = 0x12345678;
+
+static uint32_t fuzz_next(void)
+{
+    fuzz_state ^= fuzz_state << 13;
+    fuzz_state ^= fuzz_state >> 17;
+    fuzz_state ^= fuzz_state << 5;
+    return fuzz_state;
+}
+
+// Random mutations of valid messages. Inputs live in exactly sized heap
+// buffers, so building with -DFRAME_PIPELINE_SANITIZE=ON catches any read
+// past the end.
+static void test_fuzz(void)
+{
+    static const char *const seeds[] = {
+        "ping",
+        "{\"type\":\"blit_config\",\"frameFormat\":\"lz4\",\"frameWidth\":800,\"frameHeight\":480}",
+        "{\"sensors\":{\"cpu\":{\"value\":42.5,\"displayValue\":\"42 %\"}},\"type\":\"sensor\"}",
+        "{\"a\":[1,[2,{\"b\":\"\\\\\"}]],\"type\":\"rive_config\",\"screenId\":\"x\"}",
+    };
+    const char alphabet[] = "{}[]\":,\\ type0";
+
+    for (uint32_t round = 0; round < FUZZ_ROUNDS; round++) {
+        uint8_t input[FUZZ_MAX_LEN];
+        const char *seed = seeds[fuzz_next() % (sizeof(seeds) / sizeof(seeds[0]))];
+        size_t len;
+        if (fuzz_next() & 1) {
+            len = make_envelope(input, (frame_msg_type_t)(1 + fuzz_next() % (FRAME_MSG_TYPE_COUNT - 1)),
+                                fuzz_next(), seed);
+        } else {
+            len = strlen(seed);
+            memcpy(input, seed, len);
+        }
+
+        // Flip, overwrite or drop a few bytes
+        for (uint32_t n = fuzz_next() % 4; n > 0 && len > 0; n--) {
+            size_t at = fuzz_next() % len;
+            switch (fuzz_next() % 4) {
+            case 0:
+                input[at] ^= (uint8_t)(1u << (fuzz_next() % 8));
+                break;
+            case 1:
+                input[at] = (uint8_t)alphabet[fuzz_next() % (sizeof(alphabet) - 1)];
+                break;
+            case 2:
+                input[at] = (uint8_t)fuzz_next();
+                break;
+            default:
+                len = at;
+                break;
+            }
+        }
+
+        uint8_t *data = malloc(len ? len : 1);
+        TEST_ASSERT_NOT_NULL(data);
+        memcpy(data, input, len);
+
+        frame_msg_t msg;
+        if (frame_msg_parse(data, len, &msg) == FRAME_MSG_OK) {
+            TEST_ASSERT(msg.type > FRAME_MSG_NONE && msg.type < FRAME_MSG_TYPE_COUNT);
+            TEST_ASSERT(msg.payload == data + FRAME_MSG_HEADER_LEN);
+            TEST_ASSERT_EQUAL(len - FRAME_MSG_HEADER_LEN, msg.len);
+        }
+        frame_msg_from_text((const char *)data, len, &msg);
+        TEST_ASSERT(msg.type > FRAME_MSG_NONE && msg.type < FRAME_MSG_TYPE_COUNT);
+        TEST_ASSERT(msg.payload == data);
+        free(data);
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(test_envelope_round_trip);
+    RUN_TEST(test_envelope_rejects_malformed);
+    RUN_TEST(test_text_types);
+    RUN_TEST(test_blit_config);
+    RUN_TEST(test_screen_config);
+    RUN_TEST(test_dispatch);
+    RUN_TEST(test_fuzz);
+    return TEST_REPORT();
+}
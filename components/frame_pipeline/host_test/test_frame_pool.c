@@ -0,0 +1,228 @@
+#include <pthread.h>
+#include <stdint.h>
+#include "frame_pool.h"
+#include "test_common.h"
+
+static frame_pool_t *make_pool(size_t count, size_t size)
+{
+    const frame_pool_config_t cfg = {
+        .slot_count = count,
+        .slot_size = size,
+    };
+    return frame_pool_create(&cfg);
+}
+
+static void test_rejects_bad_config(void)
+{
+    TEST_ASSERT_NULL(frame_pool_create(NULL));
+    TEST_ASSERT_NULL(make_pool(0, 1024));
+    TEST_ASSERT_NULL(make_pool(FRAME_POOL_MAX_SLOTS + 1, 1024));
+    TEST_ASSERT_NULL(make_pool(2, 0));
+
+    const frame_pool_config_t cfg = {
+        .slot_count = 2,
+        .slot_size = 1024,
+        .alignment = 48,
+    };
+    TEST_ASSERT_NULL(frame_pool_create(&cfg));
+}
+
+static void test_slots_are_aligned(void)
+{
+    const frame_pool_config_t cfg = {
+        .slot_count = 4,
+        .slot_size = 1000,
+        .alignment = 128,
+    };
+    frame_pool_t *pool = frame_pool_create(&cfg);
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_EQUAL(1024, frame_pool_slot_size(pool));
+
+    frame_slot_t *slots[4];
+    for (int i = 0; i < 4; i++) {
+        slots[i] = frame_pool_acquire(pool);
+        TEST_ASSERT_NOT_NULL(slots[i]);
+        TEST_ASSERT_EQUAL(0, (uintptr_t)slots[i]->data % 128);
+        TEST_ASSERT_EQUAL(1024, slots[i]->capacity);
+        memset(slots[i]->data, i, slots[i]->capacity);
+    }
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(frame_pool_release(pool, slots[i]));
+    }
+    frame_pool_delete(pool);
+}
+
+static void test_exhaustion_is_counted(void)
+{
+    frame_pool_t *pool = make_pool(2, 256);
+    TEST_ASSERT_NOT_NULL(pool);
+
+    frame_slot_t *a = frame_pool_acquire(pool);
+    frame_slot_t *b = frame_pool_acquire(pool);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT(a != b);
+    TEST_ASSERT_NULL(frame_pool_acquire(pool));
+    TEST_ASSERT_NULL(frame_pool_acquire(pool));
+
+    frame_pool_stats_t stats;
+    frame_pool_get_stats(pool, &stats);
+    TEST_ASSERT_EQUAL(2, stats.acquired);
+    TEST_ASSERT_EQUAL(2, stats.exhausted);
+    TEST_ASSERT_EQUAL(2, stats.in_use);
+    TEST_ASSERT_EQUAL(2, stats.peak_in_use);
+
+    TEST_ASSERT_TRUE(frame_pool_release(pool, a));
+    frame_slot_t *c = frame_pool_acquire(pool);
+    TEST_ASSERT(c == a);
+
+    TEST_ASSERT_TRUE(frame_pool_release(pool, b));
+    TEST_ASSERT_TRUE(frame_pool_release(pool, c));
+    frame_pool_get_stats(pool, &stats);
+    TEST_ASSERT_EQUAL(3, stats.released);
+    TEST_ASSERT_EQUAL(0, stats.in_use);
+    TEST_ASSERT_EQUAL(2, stats.peak_in_use);
+    frame_pool_delete(pool);
+}
+
+static void test_release_is_checked(void)
+{
+    frame_pool_t *pool = make_pool(2, 256);
+    frame_pool_t *other = make_pool(2, 256);
+
+    frame_slot_t *slot = frame_pool_acquire(pool);
+    frame_slot_t *foreign = frame_pool_acquire(other);
+    TEST_ASSERT_FALSE(frame_pool_release(pool, foreign));
+    TEST_ASSERT_FALSE(frame_pool_release(pool, NULL));
+    TEST_ASSERT_TRUE(frame_pool_release(pool, slot));
+    TEST_ASSERT_FALSE(frame_pool_release(pool, slot));
+
+    frame_pool_stats_t stats;
+    frame_pool_get_stats(pool, &stats);
+    TEST_ASSERT_EQUAL(1, stats.released);
+    TEST_ASSERT_EQUAL(0, stats.in_use);
+
+    frame_pool_release(other, foreign);
+    frame_pool_delete(other);
+    frame_pool_delete(pool);
+}
+
+static void test_acquire_clears_metadata(void)
+{
+    frame_pool_t *pool = make_pool(1, 256);
+    frame_slot_t *slot = frame_pool_acquire(pool);
+    slot->size = 100;
+    slot->width = 10;
+    slot->height = 5;
+    slot->seq = 42;
+    frame_pool_release(pool, slot);
+
+    slot = frame_pool_acquire(pool);
+    TEST_ASSERT_EQUAL(0, slot->size);
+    TEST_ASSERT_EQUAL(0, slot->width);
+    TEST_ASSERT_EQUAL(0, slot->height);
+    TEST_ASSERT_EQUAL(0, slot->seq);
+    frame_pool_release(pool, slot);
+    frame_pool_delete(pool);
+}
+
+static void test_skip_is_undone_by_acquire(void)
+{
+    frame_pool_t *pool = make_pool(1, 256);
+    frame_slot_t *slot = frame_pool_acquire(pool);
+    uint8_t *data = slot->data;
+    slot->size = 100;
+
+    TEST_ASSERT_FALSE(frame_slot_skip(slot, 257));
+    TEST_ASSERT_TRUE(frame_slot_skip(slot, 16));
+    TEST_ASSERT(slot->data == data + 16);
+    TEST_ASSERT_EQUAL(240, slot->capacity);
+    TEST_ASSERT_EQUAL(84, slot->size);
+    frame_pool_release(pool, slot);
+
+    slot = frame_pool_acquire(pool);
+    TEST_ASSERT(slot->data == data);
+    TEST_ASSERT_EQUAL(256, slot->capacity);
+    frame_pool_release(pool, slot);
+    // Frees what was allocated, not the moved data pointer
+    frame_pool_delete(pool);
+}
+
+static size_t custom_allocs;
+
+static void *counting_alloc(size_t alignment, size_t size, void *user_ctx)
+{
+    (*(size_t *)user_ctx)++;
+    return aligned_alloc(alignment, size);
+}
+
+static void counting_free(void *ptr, void *user_ctx)
+{
+    (*(size_t *)user_ctx)--;
+    free(ptr);
+}
+
+static void test_custom_allocator(void)
+{
+    custom_allocs = 0;
+    const frame_pool_config_t cfg = {
+        .slot_count = 3,
+        .slot_size = 512,
+        .alloc = counting_alloc,
+        .free = counting_free,
+        .user_ctx = &custom_allocs,
+    };
+    frame_pool_t *pool = frame_pool_create(&cfg);
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_EQUAL(3, custom_allocs);
+    frame_pool_delete(pool);
+    TEST_ASSERT_EQUAL(0, custom_allocs);
+}
+
+#define STRESS_ROUNDS 200000
+
+static void *stress_consumer(void *arg)
+{
+    frame_pool_t *pool = arg;
+    for (int i = 0; i < STRESS_ROUNDS; i++) {
+        frame_slot_t *slot;
+        while ((slot = frame_pool_acquire(pool)) == NULL) {
+        }
+        slot->data[0] = (uint8_t)i;
+        frame_pool_release(pool, slot);
+    }
+    return NULL;
+}
+
+static void test_concurrent_acquire_release(void)
+{
+    frame_pool_t *pool = make_pool(3, 64);
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, stress_consumer, pool);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    frame_pool_stats_t stats;
+    frame_pool_get_stats(pool, &stats);
+    TEST_ASSERT_EQUAL(4 * STRESS_ROUNDS, stats.acquired);
+    TEST_ASSERT_EQUAL(4 * STRESS_ROUNDS, stats.released);
+    TEST_ASSERT_EQUAL(0, stats.in_use);
+    TEST_ASSERT(stats.peak_in_use <= 3);
+    frame_pool_delete(pool);
+}
+
+int main(void)
+{
+    RUN_TEST(test_rejects_bad_config);
+    RUN_TEST(test_slots_are_aligned);
+    RUN_TEST(test_exhaustion_is_counted);
+    RUN_TEST(test_release_is_checked);
+    RUN_TEST(test_acquire_clears_metadata);
+    RUN_TEST(test_skip_is_undone_by_acquire);
+    RUN_TEST(test_custom_allocator);
+    RUN_TEST(test_concurrent_acquire_release);
+    return TEST_REPORT();
+}
@@ -0,0 +1,275 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include "frame_ring.h"
+#include "test_common.h"
+
+#define STRESS_FRAMES 100000
+
+static void test_rejects_bad_capacity(void)
+{
+    TEST_ASSERT_NULL(frame_ring_create(0));
+    TEST_ASSERT_NULL(frame_ring_create(FRAME_RING_MAX_CAPACITY + 1));
+    frame_ring_t *ring = frame_ring_create(FRAME_RING_MAX_CAPACITY);
+    TEST_ASSERT_NOT_NULL(ring);
+    frame_ring_delete(ring);
+}
+
+static void test_pops_in_order(void)
+{
+    frame_slot_t slots[3] = { { .seq = 1 }, { .seq = 2 }, { .seq = 3 } };
+    frame_ring_t *ring = frame_ring_create(4);
+    TEST_ASSERT_NOT_NULL(ring);
+
+    TEST_ASSERT_NULL(frame_ring_pop(ring));
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_NULL(frame_ring_push(ring, &slots[i]));
+    }
+    TEST_ASSERT_EQUAL(3, frame_ring_count(ring));
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT(frame_ring_pop(ring) == &slots[i]);
+    }
+    TEST_ASSERT_NULL(frame_ring_pop(ring));
+    TEST_ASSERT_EQUAL(0, frame_ring_count(ring));
+
+    frame_ring_delete(ring);
+}
+
+static void test_full_ring_evicts_oldest(void)
+{
+    frame_slot_t slots[5];
+    frame_ring_t *ring = frame_ring_create(3);
+    TEST_ASSERT_NOT_NULL(ring);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_NULL(frame_ring_push(ring, &slots[i]));
+    }
+    // The newest frame always gets in, the oldest is handed back
+    TEST_ASSERT(frame_ring_push(ring, &slots[3]) == &slots[0]);
+    TEST_ASSERT(frame_ring_push(ring, &slots[4]) == &slots[1]);
+    TEST_ASSERT_EQUAL(3, frame_ring_count(ring));
+
+    TEST_ASSERT(frame_ring_pop(ring) == &slots[2]);
+    TEST_ASSERT(frame_ring_pop(ring) == &slots[3]);
+    TEST_ASSERT(frame_ring_pop(ring) == &slots[4]);
+
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL(5, stats.pushed);
+    TEST_ASSERT_EQUAL(3, stats.popped);
+    TEST_ASSERT_EQUAL(2, stats.evicted);
+
+    frame_ring_delete(ring);
+}
+
+static void test_capacity_one_is_a_mailbox(void)
+{
+    frame_slot_t slots[3];
+    frame_ring_t *ring = frame_ring_create(1);
+    TEST_ASSERT_NOT_NULL(ring);
+
+    TEST_ASSERT_NULL(frame_ring_push(ring, &slots[0]));
+    TEST_ASSERT(frame_ring_push(ring, &slots[1]) == &slots[0]);
+    TEST_ASSERT(frame_ring_push(ring, &slots[2]) == &slots[1]);
+    TEST_ASSERT(frame_ring_pop(ring) == &slots[2]);
+    TEST_ASSERT_NULL(frame_ring_pop(ring));
+
+    frame_ring_delete(ring);
+}
+
+// The oldest frame makes room only for a newer self-contained frame of its own layer
+static void test_push_if_stale_keeps_needed_frames(void)
+{
+    frame_slot_t slots[5] = {
+        { .seq = 1, .layer = 1, .self_contained = false },
+        { .seq = 2, .layer = 0, .self_contained = true },
+        { .seq = 3, .layer = 0, .self_contained = false },
+        { .seq = 4, .layer = 1, .self_contained = true },
+        { .seq = 5, .layer = 0, .self_contained = false },
+    };
+    frame_slot_t *evicted;
+    frame_ring_t *ring = frame_ring_create(3);
+    TEST_ASSERT_NOT_NULL(ring);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(frame_ring_push_if_stale(ring, &slots[i], &evicted));
+        TEST_ASSERT_NULL(evicted);
+    }
+    // The key frame of layer 0 does not make the delta of layer 1 stale
+    TEST_ASSERT_FALSE(frame_ring_push_if_stale(ring, &slots[4], &evicted));
+    TEST_ASSERT_NULL(evicted);
+    TEST_ASSERT_EQUAL(3, frame_ring_count(ring));
+
+    // A self-contained frame is needed too until a newer one of its layer is queued
+    TEST_ASSERT(frame_ring_pop(ring) == &slots[0]);
+    TEST_ASSERT_TRUE(frame_ring_push_if_stale(ring, &slots[3], &evicted));
+    TEST_ASSERT_NULL(evicted);
+    TEST_ASSERT_FALSE(frame_ring_push_if_stale(ring, &slots[4], &evicted));
+
+    TEST_ASSERT(frame_ring_pop(ring) == &slots[1]);
+    TEST_ASSERT(frame_ring_pop(ring) == &slots[2]);
+    TEST_ASSERT_TRUE(frame_ring_push_if_stale(ring, &slots[0], &evicted));
+    TEST_ASSERT_TRUE(frame_ring_push_if_stale(ring, &slots[1], &evicted));
+    // Queued: key 4 and delta 1 of layer 1, key 2 of layer 0; the oldest is not stale
+    TEST_ASSERT_FALSE(frame_ring_push_if_stale(ring, &slots[2], &evicted));
+
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL(6, stats.pushed);
+    TEST_ASSERT_EQUAL(0, stats.evicted);
+    TEST_ASSERT_EQUAL(3, stats.refused);
+
+    frame_ring_delete(ring);
+}
+
+static void test_push_if_stale_evicts_stale_frame(void)
+{
+    frame_slot_t slots[4] = {
+        { .seq = 1, .layer = 0, .self_contained = true },
+        { .seq = 2, .layer = 1, .self_contained = false },
+        { .seq = 3, .layer = 0, .self_contained = true },
+        { .seq = 4, .layer = 1, .self_contained = false },
+    };
+    frame_slot_t *evicted;
+    frame_ring_t *ring = frame_ring_create(3);
+    TEST_ASSERT_NOT_NULL(ring);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(frame_ring_push_if_stale(ring, &slots[i], &evicted));
+    }
+    TEST_ASSERT_TRUE(frame_ring_push_if_stale(ring, &slots[3], &evicted));
+    TEST_ASSERT(evicted == &slots[0]);
+
+    TEST_ASSERT(frame_ring_pop(ring) == &slots[1]);
+    TEST_ASSERT(frame_ring_pop(ring) == &slots[2]);
+    TEST_ASSERT(frame_ring_pop(ring) == &slots[3]);
+
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL(1, stats.evicted);
+    TEST_ASSERT_EQUAL(0, stats.refused);
+
+    frame_ring_delete(ring);
+}
+
+static void test_pop_stale(void)
+{
+    frame_slot_t slots[3] = {
+        { .seq = 1, .layer = 0, .self_contained = false },
+        { .seq = 2, .layer = 1, .self_contained = true },
+        { .seq = 3, .layer = 0, .self_contained = true },
+    };
+    frame_ring_t *ring = frame_ring_create(4);
+    TEST_ASSERT_NOT_NULL(ring);
+
+    TEST_ASSERT_NULL(frame_ring_pop_stale(ring));
+    TEST_ASSERT_NULL(frame_ring_push(ring, &slots[0]));
+    TEST_ASSERT_NULL(frame_ring_push(ring, &slots[1]));
+    TEST_ASSERT_NULL(frame_ring_pop_stale(ring));
+    TEST_ASSERT_NULL(frame_ring_push(ring, &slots[2]));
+    TEST_ASSERT(frame_ring_pop_stale(ring) == &slots[0]);
+    // Nothing newer of layer 1 is queued
+    TEST_ASSERT_NULL(frame_ring_pop_stale(ring));
+    TEST_ASSERT_EQUAL(2, frame_ring_count(ring));
+
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL(1, stats.stale_taken);
+    TEST_ASSERT_EQUAL(0, stats.popped);
+
+    frame_ring_delete(ring);
+}
+
+typedef struct {
+    frame_ring_t *ring;
+    frame_slot_t *slots;
+    uint8_t *owned_by_producer;     // Per frame: 1 if it came back evicted
+    atomic_int done;
+    uint32_t popped;
+    uint32_t out_of_order;
+} stress_t;
+
+static void *consumer_thread(void *arg)
+{
+    stress_t *stress = arg;
+    uint32_t last_seq = 0;
+
+    for (;;) {
+        bool done = atomic_load(&stress->done);
+        frame_slot_t *slot;
+        while ((slot = frame_ring_pop(stress->ring)) != NULL) {
+            if (slot->seq <= last_seq) {
+                stress->out_of_order++;
+            }
+            last_seq = slot->seq;
+            stress->popped++;
+        }
+        if (done) {
+            return NULL;
+        }
+    }
+}
+
+// One producer, one consumer: every frame ends up exactly once either at the
+// consumer or evicted, and the consumer sees them in order
+static void test_spsc_stress(void)
+{
+    stress_t stress = {
+        .ring = frame_ring_create(4),
+        .slots = calloc(STRESS_FRAMES, sizeof(frame_slot_t)),
+        .owned_by_producer = calloc(STRESS_FRAMES, 1),
+    };
+    TEST_ASSERT_NOT_NULL(stress.ring);
+    TEST_ASSERT_NOT_NULL(stress.slots);
+    TEST_ASSERT_NOT_NULL(stress.owned_by_producer);
+
+    pthread_t consumer;
+    TEST_ASSERT_EQUAL(0, pthread_create(&consumer, NULL, consumer_thread, &stress));
+
+    uint32_t evicted = 0;
+    bool twice = false;
+    for (uint32_t i = 0; i < STRESS_FRAMES; i++) {
+        stress.slots[i].seq = i + 1;
+        frame_slot_t *old = frame_ring_push(stress.ring, &stress.slots[i]);
+        if (old) {
+            size_t n = (size_t)(old - stress.slots);
+            twice |= stress.owned_by_producer[n] != 0;
+            stress.owned_by_producer[n] = 1;
+            evicted++;
+        }
+        if (i % 64 == 0) {
+            sched_yield();  // Let the consumer catch up now and then
+        }
+    }
+    atomic_store(&stress.done, 1);
+    pthread_join(consumer, NULL);
+
+    TEST_ASSERT_FALSE(twice);
+    TEST_ASSERT_EQUAL(0, stress.out_of_order);
+    TEST_ASSERT_EQUAL(STRESS_FRAMES, stress.popped + evicted);
+
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(stress.ring, &stats);
+    TEST_ASSERT_EQUAL(STRESS_FRAMES, stats.pushed);
+    TEST_ASSERT_EQUAL(evicted, stats.evicted);
+    TEST_ASSERT_EQUAL(stress.popped, stats.popped);
+    printf("  %u frames: %u displayed, %u evicted\n", STRESS_FRAMES, (unsigned) stress.popped, (unsigned) evicted);
+
+    frame_ring_delete(stress.ring);
+    free(stress.slots);
+    free(stress.owned_by_producer);
+}
+
+int main(void)
+{
+    RUN_TEST(test_rejects_bad_capacity);
+    RUN_TEST(test_pops_in_order);
+    RUN_TEST(test_full_ring_evicts_oldest);
+    RUN_TEST(test_capacity_one_is_a_mailbox);
+    RUN_TEST(test_push_if_stale_keeps_needed_frames);
+    RUN_TEST(test_push_if_stale_evicts_stale_frame);
+    RUN_TEST(test_pop_stale);
+    RUN_TEST(test_spsc_stress);
+    return TEST_REPORT();
+}
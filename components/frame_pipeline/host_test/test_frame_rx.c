@@ -0,0 +1,155 @@
+#include <stdint.h>
+#include "frame_rx.h"
+#include "test_common.h"
+
+#define FRAME_W 1280
+#define FRAME_H 720
+#define FRAME_BYTES (FRAME_W * FRAME_H * 2)
+
+/* Fake transport: serves `len` bytes of a pattern, at most `chunk` per read,
+ * and fails with -1 after `fail_after` bytes (0: never). */
+typedef struct {
+    size_t len;
+    size_t pos;
+    size_t chunk;
+    size_t fail_after;
+} fake_stream_t;
+
+static int fake_read(fake_stream_t *s, uint8_t *dst, size_t want)
+{
+    if (s->fail_after && s->pos >= s->fail_after) {
+        return -1;
+    }
+    size_t n = want < s->chunk ? want : s->chunk;
+    if (n > s->len - s->pos) {
+        n = s->len - s->pos;
+    }
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = (uint8_t)((s->pos + i) * 7);
+    }
+    s->pos += n;
+    return (int)n;
+}
+
+static frame_rx_status_t receive(frame_rx_stats_t *stats, uint8_t *buf, size_t cap, fake_stream_t *s, size_t *received)
+{
+    frame_rx_t rx;
+    frame_rx_status_t status = frame_rx_begin(&rx, stats, buf, cap, s->len);
+    if (status != FRAME_RX_OK) {
+        return status;
+    }
+    while (!frame_rx_done(&rx)) {
+        uint8_t *dst;
+        size_t want = frame_rx_next(&rx, &dst, FRAME_RX_DEFAULT_CHUNK);
+        TEST_ASSERT(want > 0 && want <= FRAME_RX_DEFAULT_CHUNK);
+        TEST_ASSERT(dst + want <= buf + cap);
+        int n = fake_read(s, dst, want);
+        if (n <= 0) {
+            break;
+        }
+        frame_rx_commit(&rx, (size_t)n);
+    }
+    *received = rx.received;
+    return frame_rx_end(&rx);
+}
+
+static void test_full_frame_is_reassembled(void)
+{
+    static uint8_t buf[FRAME_BYTES];
+    frame_rx_stats_t stats = {0};
+    fake_stream_t s = {.len = FRAME_BYTES, .chunk = 1436};  // One TCP segment at a time
+    size_t received;
+
+    TEST_ASSERT_EQUAL(FRAME_RX_OK, receive(&stats, buf, sizeof(buf), &s, &received));
+    TEST_ASSERT_EQUAL(FRAME_BYTES, received);
+    for (size_t i = 0; i < FRAME_BYTES; i += 4099) {
+        TEST_ASSERT_EQUAL((uint8_t)(i * 7), buf[i]);
+    }
+    TEST_ASSERT_EQUAL((uint8_t)((FRAME_BYTES - 1) * 7), buf[FRAME_BYTES - 1]);
+    TEST_ASSERT_EQUAL(1, stats.complete);
+    TEST_ASSERT_EQUAL(FRAME_BYTES, stats.bytes);
+}
+
+static void test_oversize_is_rejected(void)
+{
+    static uint8_t buf[1024];
+    frame_rx_stats_t stats = {0};
+    fake_stream_t s = {.len = 1025, .chunk = 512};
+    size_t received = 0;
+
+    TEST_ASSERT_EQUAL(FRAME_RX_TOO_LARGE, receive(&stats, buf, sizeof(buf), &s, &received));
+    TEST_ASSERT_EQUAL(0, s.pos);
+    TEST_ASSERT_EQUAL(1, stats.too_large);
+    TEST_ASSERT_EQUAL(0, stats.complete);
+}
+
+static void test_aborted_transfer_is_counted(void)
+{
+    static uint8_t buf[FRAME_BYTES];
+    frame_rx_stats_t stats = {0};
+    fake_stream_t s = {.len = FRAME_BYTES, .chunk = 65536, .fail_after = 100000};
+    size_t received;
+
+    TEST_ASSERT_EQUAL(FRAME_RX_INCOMPLETE, receive(&stats, buf, sizeof(buf), &s, &received));
+    TEST_ASSERT(received >= 100000 && received < FRAME_BYTES);
+    TEST_ASSERT_EQUAL(1, stats.incomplete);
+    TEST_ASSERT_EQUAL(0, stats.complete);
+    TEST_ASSERT_EQUAL(received, stats.bytes);
+}
+
+static void test_commit_never_overruns(void)
+{
+    uint8_t buf[16];
+    frame_rx_t rx;
+    frame_rx_begin(&rx, NULL, buf, sizeof(buf), 10);
+
+    uint8_t *dst;
+    TEST_ASSERT_EQUAL(4, frame_rx_next(&rx, &dst, 4));
+    TEST_ASSERT(dst == buf);
+    frame_rx_commit(&rx, 4);
+    TEST_ASSERT_EQUAL(6, frame_rx_next(&rx, &dst, 0));
+    TEST_ASSERT(dst == buf + 4);
+    frame_rx_commit(&rx, 100);
+    TEST_ASSERT_TRUE(frame_rx_done(&rx));
+    TEST_ASSERT_EQUAL(10, rx.received);
+    TEST_ASSERT_EQUAL(0, frame_rx_next(&rx, &dst, 0));
+    TEST_ASSERT_EQUAL(FRAME_RX_OK, frame_rx_end(&rx));
+}
+
+static void test_size_check_against_config(void)
+{
+    uint8_t buf[64];
+    frame_rx_stats_t stats = {0};
+    frame_rx_t rx;
+    frame_rx_begin(&rx, &stats, buf, sizeof(buf), 32);
+    frame_rx_commit(&rx, 32);
+    frame_rx_end(&rx);
+
+    TEST_ASSERT_EQUAL(FRAME_RX_OK, frame_rx_check_size(&stats, rx.received, 0));
+    TEST_ASSERT_EQUAL(FRAME_RX_OK, frame_rx_check_size(&stats, rx.received, 32));
+    TEST_ASSERT_EQUAL(FRAME_RX_SIZE_MISMATCH, frame_rx_check_size(&stats, rx.received, 4 * 4 * 2 + 2));
+    TEST_ASSERT_EQUAL(1, stats.size_mismatch);
+    TEST_ASSERT_EQUAL(1, stats.complete);
+}
+
+static void test_empty_message(void)
+{
+    uint8_t buf[4];
+    frame_rx_stats_t stats = {0};
+    frame_rx_t rx;
+    TEST_ASSERT_EQUAL(FRAME_RX_OK, frame_rx_begin(&rx, &stats, buf, sizeof(buf), 0));
+    TEST_ASSERT_TRUE(frame_rx_done(&rx));
+    TEST_ASSERT_EQUAL(FRAME_RX_OK, frame_rx_end(&rx));
+    TEST_ASSERT_EQUAL(1, stats.complete);
+}
+
+int main(void)
+{
+    RUN_TEST(test_full_frame_is_reassembled);
+    RUN_TEST(test_oversize_is_rejected);
+    RUN_TEST(test_aborted_transfer_is_counted);
+    RUN_TEST(test_commit_never_overruns);
+    RUN_TEST(test_size_check_against_config);
+    RUN_TEST(test_empty_message);
+    return TEST_REPORT();
+}
@@ -0,0 +1,142 @@
+#include <pthread.h>
+#include <stdint.h>
+#include "frame_stats.h"
+#include "test_common.h"
+
+#define THREADS 4
+#define SAMPLES_PER_THREAD 100000
+
+static void test_samples_land_in_buckets(void)
+{
+    frame_stats_t *stats = frame_stats_create();
+    TEST_ASSERT_NOT_NULL(stats);
+
+    frame_stats_record(stats, FRAME_STAGE_RECV, 0);
+    frame_stats_record(stats, FRAME_STAGE_RECV, FRAME_STATS_FIRST_BOUND_US - 1);
+    frame_stats_record(stats, FRAME_STAGE_RECV, FRAME_STATS_FIRST_BOUND_US);
+    frame_stats_record(stats, FRAME_STAGE_RECV, 3 * FRAME_STATS_FIRST_BOUND_US);
+    frame_stats_record(stats, FRAME_STAGE_RECV, UINT32_MAX);
+    frame_stats_record(stats, FRAME_STAGE_COUNT, 1);   // Ignored
+
+    frame_stage_stats_t recv;
+    frame_stats_get(stats, FRAME_STAGE_RECV, &recv);
+    TEST_ASSERT_EQUAL(5, recv.count);
+    TEST_ASSERT_EQUAL(UINT32_MAX, recv.max_us);
+    TEST_ASSERT_EQUAL(2, recv.buckets[0]);
+    TEST_ASSERT_EQUAL(1, recv.buckets[1]);
+    TEST_ASSERT_EQUAL(1, recv.buckets[2]);
+    TEST_ASSERT_EQUAL(1, recv.buckets[FRAME_STATS_BUCKETS - 1]);
+    TEST_ASSERT_EQUAL((uint64_t)FRAME_STATS_FIRST_BOUND_US * 5 - 1 + UINT32_MAX, recv.sum_us);
+
+    frame_stage_stats_t decode;
+    frame_stats_get(stats, FRAME_STAGE_DECODE, &decode);
+    TEST_ASSERT_EQUAL(0, decode.count);
+
+    frame_stats_reset(stats);
+    frame_stats_get(stats, FRAME_STAGE_RECV, &recv);
+    TEST_ASSERT_EQUAL(0, recv.count);
+    TEST_ASSERT_EQUAL(0, recv.max_us);
+    TEST_ASSERT_EQUAL(0, recv.buckets[0]);
+
+    frame_stats_delete(stats);
+}
+
+static void test_percentiles(void)
+{
+    frame_stats_t *stats = frame_stats_create();
+    TEST_ASSERT_NOT_NULL(stats);
+
+    frame_stage_stats_t stage;
+    frame_stats_get(stats, FRAME_STAGE_RENDER, &stage);
+    TEST_ASSERT_EQUAL(0, frame_stage_percentile_us(&stage, 50));
+
+    // 90 fast samples, 9 around 5 ms, one slow outlier
+    for (int i = 0; i < 90; i++) {
+        frame_stats_record(stats, FRAME_STAGE_RENDER, 100);
+    }
+    for (int i = 0; i < 9; i++) {
+        frame_stats_record(stats, FRAME_STAGE_RENDER, 5000);
+    }
+    frame_stats_record(stats, FRAME_STAGE_RENDER, 40000);
+
+    frame_stats_get(stats, FRAME_STAGE_RENDER, &stage);
+    TEST_ASSERT_EQUAL(FRAME_STATS_FIRST_BOUND_US, frame_stage_percentile_us(&stage, 50));
+    TEST_ASSERT_EQUAL(FRAME_STATS_FIRST_BOUND_US, frame_stage_percentile_us(&stage, 90));
+    TEST_ASSERT_EQUAL(8192, frame_stage_percentile_us(&stage, 99));
+    // Never above the longest sample
+    TEST_ASSERT_EQUAL(40000, frame_stage_percentile_us(&stage, 100));
+
+    frame_stats_delete(stats);
+}
+
+static void test_json(void)
+{
+    frame_stats_t *stats = frame_stats_create();
+    TEST_ASSERT_NOT_NULL(stats);
+    frame_stats_record(stats, FRAME_STAGE_QUEUE, 1000);
+    frame_stats_record(stats, FRAME_STAGE_QUEUE, 3000);
+
+    char buf[2048];
+    size_t len = frame_stats_to_json(stats, buf, sizeof(buf));
+    TEST_ASSERT(len > 0);
+    TEST_ASSERT_EQUAL(strlen(buf), len);
+    TEST_ASSERT(buf[0] == '{' && buf[len - 1] == '}');
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"queue\":{\"count\":2,\"meanUs\":2000,\"maxUs\":3000,"
+                                     "\"p50Us\":1024,\"p90Us\":3000,\"p99Us\":3000,\"buckets\":[0,0,1,0,1,"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"recv\":{\"count\":0,"));
+    for (int s = 0; s < FRAME_STAGE_COUNT; s++) {
+        char key[32];
+        snprintf(key, sizeof(key), "\"%s\":{", frame_stage_name((frame_stage_t)s));
+        TEST_ASSERT_NOT_NULL(strstr(buf, key));
+    }
+
+    // Too small: nothing half written is reported as valid
+    TEST_ASSERT_EQUAL(0, frame_stats_to_json(stats, buf, len));
+    TEST_ASSERT_EQUAL(len, frame_stats_to_json(stats, buf, len + 1));
+
+    frame_stats_delete(stats);
+}
+
+static void *record_thread(void *arg)
+{
+    frame_stats_t *stats = arg;
+    for (uint32_t i = 0; i < SAMPLES_PER_THREAD; i++) {
+        frame_stats_record(stats, FRAME_STAGE_TOTAL, i % 20000);
+    }
+    return NULL;
+}
+
+static void test_concurrent_recording(void)
+{
+    frame_stats_t *stats = frame_stats_create();
+    TEST_ASSERT_NOT_NULL(stats);
+
+    pthread_t threads[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, record_thread, stats));
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    frame_stage_stats_t total;
+    frame_stats_get(stats, FRAME_STAGE_TOTAL, &total);
+    TEST_ASSERT_EQUAL(THREADS * SAMPLES_PER_THREAD, total.count);
+    TEST_ASSERT_EQUAL(19999, total.max_us);
+    uint64_t in_buckets = 0;
+    for (int i = 0; i < FRAME_STATS_BUCKETS; i++) {
+        in_buckets += total.buckets[i];
+    }
+    TEST_ASSERT_EQUAL(total.count, in_buckets);
+
+    frame_stats_delete(stats);
+}
+
+int main(void)
+{
+    RUN_TEST(test_samples_land_in_buckets);
+    RUN_TEST(test_percentiles);
+    RUN_TEST(test_json);
+    RUN_TEST(test_concurrent_recording);
+    return TEST_REPORT();
+}
@@ -0,0 +1,521 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "frame_delta.h"
+#include "frame_pool.h"
+#include "frame_tiles.h"
+#include "rle_encode.h"
+#include "test_common.h"
+
+#define FRAME_W     64
+#define FRAME_H     48
+#define TILE_W      16
+#define TILE_H      16
+#define TILES_X     (FRAME_W / TILE_W)
+#define TILE_COUNT  (TILES_X * (FRAME_H / TILE_H))
+#define STRIDE      (FRAME_W * 2)
+#define SLOT_SIZE   (FRAME_DELTA_HEADER_LEN + TILE_COUNT * FRAME_DELTA_RECT_LEN + FRAME_W * FRAME_H * 2)
+#define DATAGRAM    (FRAME_TILES_HEADER_LEN + TILE_W * TILE_H * 2 + 64)
+
+#define DEADLINE_US     200000
+#define NACK_DELAY_US   20000
+
+static uint16_t frame_pixel(uint32_t frame_id, int x, int y)
+{
+    return (uint16_t)(x * 7 + y * 13 + frame_id * 31);
+}
+
+static frame_rect_t tile_rect(uint16_t index)
+{
+    frame_rect_t r = {
+        .x = (uint16_t)(index % TILES_X * TILE_W),
+        .y = (uint16_t)(index / TILES_X * TILE_H),
+        .w = TILE_W,
+        .h = TILE_H,
+    };
+    return r;
+}
+
+/* Builds the datagram of one tile of a test frame the way the sender does. */
+static size_t make_tile(uint8_t *dst, uint32_t frame_id, uint16_t index, frame_format_t format)
+{
+    frame_tile_t tile = {
+        .frame_id = frame_id,
+        .format = format,
+        .index = index,
+        .count = TILE_COUNT,
+        .width = FRAME_W,
+        .height = FRAME_H,
+        .rect = tile_rect(index),
+    };
+    size_t len = frame_tile_write_header(&tile, dst, DATAGRAM);
+
+    uint8_t pixels[TILE_W * TILE_H * 2];
+    for (int y = 0; y < TILE_H; y++) {
+        for (int x = 0; x < TILE_W; x++) {
+            uint16_t c = frame_pixel(frame_id, tile.rect.x + x, tile.rect.y + y);
+            pixels[(y * TILE_W + x) * 2] = (uint8_t)c;
+            pixels[(y * TILE_W + x) * 2 + 1] = (uint8_t)(c >> 8);
+        }
+    }
+    if (format == FRAME_FORMAT_RGB565_RLE) {
+        return len + rle_encode(pixels, sizeof(pixels), dst + len, 2);
+    }
+    memcpy(dst + len, pixels, sizeof(pixels));
+    return len + sizeof(pixels);
+}
+
+static uint16_t pixel_at(const uint8_t *canvas, int x, int y)
+{
+    const uint8_t *p = canvas + y * STRIDE + x * 2;
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/* Patches a reassembled frame into `canvas` and checks which tiles it painted. */
+static void check_frame(frame_slot_t *slot, uint32_t frame_id, uint8_t *canvas, const bool *missing)
+{
+    frame_delta_t delta;
+    TEST_ASSERT_NOT_NULL(slot);
+    TEST_ASSERT_EQUAL(frame_id, slot->seq);
+    TEST_ASSERT_EQUAL(FRAME_W, slot->width);
+    TEST_ASSERT_EQUAL(FRAME_H, slot->height);
+    TEST_ASSERT_EQUAL(FRAME_DELTA_OK, frame_delta_parse(slot->data, slot->size, &delta));
+    TEST_ASSERT_EQUAL(frame_id, delta.seq);
+    frame_delta_apply(&delta, canvas, STRIDE);
+
+    for (uint16_t index = 0; index < TILE_COUNT; index++) {
+        frame_rect_t r = tile_rect(index);
+        uint16_t expected = frame_pixel(frame_id, r.x + 3, r.y + 5);
+        bool painted = pixel_at(canvas, r.x + 3, r.y + 5) == expected;
+        TEST_ASSERT_EQUAL(missing && missing[index] ? 0 : 1, painted);
+    }
+}
+
+static frame_pool_t *make_pool(size_t slots)
+{
+    const frame_pool_config_t cfg = {
+        .slot_count = slots,
+        .slot_size = SLOT_SIZE,
+    };
+    return frame_pool_create(&cfg);
+}
+
+static frame_tiles_t *make_tiles(frame_pool_t *pool)
+{
+    const frame_tiles_config_t cfg = {
+        .pool = pool,
+        .deadline_us = DEADLINE_US,
+        .nack_delay_us = NACK_DELAY_US,
+        .max_nacks = 2,
+    };
+    return frame_tiles_create(&cfg);
+}
+
+static void test_parse(void)
+{
+    static uint8_t d[DATAGRAM];
+    frame_tile_t tile;
+    size_t len = make_tile(d, 0x01020304, 5, FRAME_FORMAT_RGB565);
+
+    TEST_ASSERT_EQUAL(FRAME_TILES_OK, frame_tile_parse(d, len, &tile));
+    TEST_ASSERT_EQUAL(0x01020304, tile.frame_id);
+    TEST_ASSERT_EQUAL(5, tile.index);
+    TEST_ASSERT_EQUAL(TILE_COUNT, tile.count);
+    TEST_ASSERT_EQUAL(FRAME_W, tile.width);
+    TEST_ASSERT_EQUAL(16, tile.rect.x);
+    TEST_ASSERT_EQUAL(16, tile.rect.y);
+    TEST_ASSERT_EQUAL(TILE_W * TILE_H * 2, tile.payload_len);
+
+    TEST_ASSERT_EQUAL(FRAME_TILES_TRUNCATED, frame_tile_parse(d, FRAME_TILES_HEADER_LEN - 1, &tile));
+    TEST_ASSERT_EQUAL(FRAME_TILES_NOT_TILE, frame_tile_parse((const uint8_t *)FRAME_DELTA_MAGIC, 4, &tile));
+
+    d[4] = FRAME_TILES_VERSION + 1;
+    TEST_ASSERT_EQUAL(FRAME_TILES_BAD_VERSION, frame_tile_parse(d, len, &tile));
+    d[4] = FRAME_TILES_VERSION;
+    d[5] = 0x7f;
+    TEST_ASSERT_EQUAL(FRAME_TILES_BAD_FORMAT, frame_tile_parse(d, len, &tile));
+    d[5] = FRAME_FORMAT_RGB565;
+
+    // Index past the count, a rectangle hanging off the frame
+    d[6] = TILE_COUNT;
+    TEST_ASSERT_EQUAL(FRAME_TILES_BAD_TILE, frame_tile_parse(d, len, &tile));
+    d[6] = 5;
+    d[20] = FRAME_W - 8;
+    TEST_ASSERT_EQUAL(FRAME_TILES_BAD_TILE, frame_tile_parse(d, len, &tile));
+}
+
+static void test_complete_frame_is_key(void)
+{
+    static uint8_t d[DATAGRAM];
+    static uint8_t canvas[FRAME_H * STRIDE];
+    frame_pool_t *pool = make_pool(2);
+    frame_tiles_t *tiles = make_tiles(pool);
+    memset(canvas, 0, sizeof(canvas));
+
+    for (uint16_t i = 0; i < TILE_COUNT; i++) {
+        TEST_ASSERT_NULL(frame_tiles_poll(tiles, 0));
+        size_t len = make_tile(d, 1, i, i % 2 ? FRAME_FORMAT_RGB565_RLE : FRAME_FORMAT_RGB565);
+        TEST_ASSERT_EQUAL(FRAME_TILES_OK, frame_tiles_push(tiles, d, len, 1000 + i));
+    }
+    TEST_ASSERT_EQUAL(INT64_MAX, frame_tiles_next_event_us(tiles));
+    frame_slot_t *slot = frame_tiles_poll(tiles, 2000);
+    check_frame(slot, 1, canvas, NULL);
+    TEST_ASSERT_EQUAL(1000, slot->recv_start_us);
+    TEST_ASSERT_NULL(frame_tiles_poll(tiles, 2000));
+
+    frame_delta_t delta;
+    frame_delta_parse(slot->data, slot->size, &delta);
+    TEST_ASSERT_TRUE(frame_delta_is_key(&delta));
+    frame_pool_release(pool, slot);
+
+    // Sent again, the frame is over
+    size_t len = make_tile(d, 1, 0, FRAME_FORMAT_RGB565);
+    TEST_ASSERT_EQUAL(FRAME_TILES_LATE, frame_tiles_push(tiles, d, len, 3000));
+
+    frame_tiles_stats_t stats;
+    frame_tiles_get_stats(tiles, &stats);
+    TEST_ASSERT_EQUAL(TILE_COUNT, stats.tiles);
+    TEST_ASSERT_EQUAL(1, stats.frames_complete);
+    TEST_ASSERT_EQUAL(1, stats.tiles_late);
+
+    frame_tiles_delete(tiles);
+    frame_pool_delete(pool);
+}
+
+static void test_deadline_sends_partial_frame(void)
+{
+    static uint8_t d[DATAGRAM];
+    static uint8_t canvas[FRAME_H * STRIDE];
+    frame_pool_t *pool = make_pool(2);
+    frame_tiles_t *tiles = make_tiles(pool);
+    bool missing[TILE_COUNT] = {false};
+    missing[2] = true;
+    missing[7] = true;
+    memset(canvas, 0, sizeof(canvas));
+
+    for (uint16_t i = 0; i < TILE_COUNT; i++) {
+        if (!missing[i]) {
+            size_t len = make_tile(d, 9, i, FRAME_FORMAT_RGB565);
+            TEST_ASSERT_EQUAL(FRAME_TILES_OK, frame_tiles_push(tiles, d, len, 100));
+        }
+    }
+    TEST_ASSERT_NULL(frame_tiles_poll(tiles, 100 + DEADLINE_US - 1));
+    TEST_ASSERT(frame_tiles_next_event_us(tiles) <= 100 + DEADLINE_US);
+
+    frame_slot_t *slot = frame_tiles_poll(tiles, 100 + DEADLINE_US);
+    check_frame(slot, 9, canvas, missing);
+    frame_delta_t delta;
+    frame_delta_parse(slot->data, slot->size, &delta);
+    TEST_ASSERT_EQUAL(TILE_COUNT - 2, delta.rect_count);
+    TEST_ASSERT_FALSE(frame_delta_is_key(&delta));
+    frame_pool_release(pool, slot);
+
+    // A missing tile after the deadline is of no use anymore
+    size_t len = make_tile(d, 9, 2, FRAME_FORMAT_RGB565);
+    TEST_ASSERT_EQUAL(FRAME_TILES_LATE, frame_tiles_push(tiles, d, len, 100 + DEADLINE_US + 1));
+    TEST_ASSERT_NULL(frame_tiles_poll(tiles, 100 + DEADLINE_US + 1));
+
+    frame_tiles_stats_t stats;
+    frame_tiles_get_stats(tiles, &stats);
+    TEST_ASSERT_EQUAL(1, stats.frames_partial);
+    TEST_ASSERT_EQUAL(2, stats.tiles_missing);
+
+    frame_tiles_delete(tiles);
+    frame_pool_delete(pool);
+}
+
+static void test_newer_frame_sends_older_one(void)
+{
+    static uint8_t d[DATAGRAM];
+    static uint8_t canvas[FRAME_H * STRIDE];
+    frame_pool_t *pool = make_pool(3);
+    frame_tiles_t *tiles = make_tiles(pool);
+    bool missing[TILE_COUNT];
+    memset(canvas, 0, sizeof(canvas));
+
+    for (uint16_t i = 0; i < TILE_COUNT / 2; i++) {
+        size_t len = make_tile(d, 20, i, FRAME_FORMAT_RGB565);
+        TEST_ASSERT_EQUAL(FRAME_TILES_OK, frame_tiles_push(tiles, d, len, 0));
+    }
+    size_t len = make_tile(d, 21, 0, FRAME_FORMAT_RGB565);
+    TEST_ASSERT_EQUAL(FRAME_TILES_OK, frame_tiles_push(tiles, d, len, 10));
+    for (uint16_t i = 0; i < TILE_COUNT; i++) {
+        missing[i] = i >= TILE_COUNT / 2;
+    }
+    frame_slot_t *slot = frame_tiles_poll(tiles, 10);
+    check_frame(slot, 20, canvas, missing);
+    frame_pool_release(pool, slot);
+    TEST_ASSERT_NULL(frame_tiles_poll(tiles, 10));
+
+    // Stragglers of the frame that went out, then the rest of the new one
+    len = make_tile(d, 20, TILE_COUNT - 1, FRAME_FORMAT_RGB565);
+    TEST_ASSERT_EQUAL(FRAME_TILES_LATE, frame_tiles_push(tiles, d, len, 20));
+    for (uint16_t i = 1; i < TILE_COUNT; i++) {
+        len = make_tile(d, 21, i, FRAME_FORMAT_RGB565);
+        TEST_ASSERT_EQUAL(FRAME_TILES_OK, frame_tiles_push(tiles, d, len, 30));
+    }
+    slot = frame_tiles_poll(tiles, 30);
+    check_frame(slot, 21, canvas, NULL);
+    frame_pool_release(pool, slot);
+
+    frame_tiles_delete(tiles);
+    frame_pool_delete(pool);
+}
+
+static void test_nack_and_retransmit(void)
+{
+    static uint8_t d[DATAGRAM];
+    static uint8_t canvas[FRAME_H * STRIDE];
+    uint8_t nack_buf[64];
+    frame_tiles_nack_t nack;
+    frame_pool_t *pool = make_pool(2);
+    frame_tiles_t *tiles = make_tiles(pool);
+    memset(canvas, 0, sizeof(canvas));
+
+    for (uint16_t i = 0; i < TILE_COUNT; i++) {
+        if (i != 0 && i != 11) {
+            size_t len = make_tile(d, 5, i, FRAME_FORMAT_RGB565);
+            TEST_ASSERT_EQUAL(FRAME_TILES_OK, frame_tiles_push(tiles, d, len, 1000));
+        }
+    }
+
+    // Nothing before the sender had a chance to finish
+    TEST_ASSERT_EQUAL(0, frame_tiles_nack(tiles, 1000 + NACK_DELAY_US - 1, nack_buf, sizeof(nack_buf)));
+    TEST_ASSERT_EQUAL(1000 + NACK_DELAY_US, frame_tiles_next_event_us(tiles));
+    size_t len = frame_tiles_nack(tiles, 1000 + NACK_DELAY_US, nack_buf, sizeof(nack_buf));
+    TEST_ASSERT_EQUAL(FRAME_TILES_NACK_HEADER_LEN + 4, len);
+    TEST_ASSERT_EQUAL(FRAME_TILES_OK, frame_tiles_parse_nack(nack_buf, len, &nack));
+    TEST_ASSERT_EQUAL(5, nack.frame_id);
+    TEST_ASSERT_EQUAL(2, nack.count);
+    TEST_ASSERT_EQUAL(0, frame_tiles_nack_index(&nack, 0));
+    TEST_ASSERT_EQUAL(11, frame_tiles_nack_index(&nack, 1));
+    TEST_ASSERT_EQUAL(FRAME_TILES_TRUNCATED, frame_tiles_parse_nack(nack_buf, len - 1, &nack));
+
+    // The next one waits another delay, and there are only max_nacks
+    TEST_ASSERT_EQUAL(0, frame_tiles_nack(tiles, 1000 + NACK_DELAY_US + 1, nack_buf, sizeof(nack_buf)));
+    TEST_ASSERT(frame_tiles_nack(tiles, 1000 + 2 * NACK_DELAY_US, nack_buf, sizeof(nack_buf)) > 0);
+    TEST_ASSERT_EQUAL(0, frame_tiles_nack(tiles, 1000 + 4 * NACK_DELAY_US, nack_buf, sizeof(nack_buf)));
+
+    len = make_tile(d, 5, 11, FRAME_FORMAT_RGB565);
+    TEST_ASSERT_EQUAL(FRAME_TILES_OK, frame_tiles_push(tiles, d, len, 50000));
+    TEST_ASSERT_EQUAL(FRAME_TILES_DUPLICATE, frame_tiles_push(tiles, d, len, 50001));
+    len = make_tile(d, 5, 0, FRAME_FORMAT_RGB565);
+    TEST_ASSERT_EQUAL(FRAME_TILES_OK, frame_tiles_push(tiles, d, len, 50002));
+
+    frame_slot_t *slot = frame_tiles_poll(tiles, 50002);
+    check_frame(slot, 5, canvas, NULL);
+    frame_pool_release(pool, slot);
+
+    frame_tiles_stats_t stats;
+    frame_tiles_get_stats(tiles, &stats);
+    TEST_ASSERT_EQUAL(2, stats.nacks);
+    TEST_ASSERT_EQUAL(4, stats.tiles_requested);
+    TEST_ASSERT_EQUAL(1, stats.tiles_duplicate);
+    TEST_ASSERT_EQUAL(1, stats.frames_complete);
+
+    frame_tiles_delete(tiles);
+    frame_pool_delete(pool);
+}
+
+static void test_bad_tiles(void)
+{
+    static uint8_t d[DATAGRAM];
+    frame_pool_t *pool = make_pool(1);
+    frame_tiles_t *tiles = make_tiles(pool);
+
+    // Payload that does not match the rectangle, raw and compressed
+    size_t len = make_tile(d, 1, 0, FRAME_FORMAT_RGB565);
+    TEST_ASSERT_EQUAL(FRAME_TILES_CORRUPT, frame_tiles_push(tiles, d, len - 2, 0));
+    len = make_tile(d, 1, 1, FRAME_FORMAT_RGB565_RLE);
+    TEST_ASSERT_EQUAL(FRAME_TILES_CORRUPT, frame_tiles_push(tiles, d, len - 3, 0));
+
+    // Another size in the middle of a frame
+    len = make_tile(d, 1, 2, FRAME_FORMAT_RGB565);
+    d[8] = TILE_COUNT + 1;
+    TEST_ASSERT_EQUAL(FRAME_TILES_MISMATCH, frame_tiles_push(tiles, d, len, 0));
+
+    // The only slot is taken, the next frame has nowhere to go
+    TEST_ASSERT_NULL(frame_tiles_poll(tiles, DEADLINE_US));
+    frame_slot_t *held = frame_pool_acquire(pool);
+    TEST_ASSERT_NOT_NULL(held);
+    len = make_tile(d, 2, 0, FRAME_FORMAT_RGB565);
+    TEST_ASSERT_EQUAL(FRAME_TILES_NO_BUFFER, frame_tiles_push(tiles, d, len, DEADLINE_US));
+    frame_pool_release(pool, held);
+    TEST_ASSERT_EQUAL(FRAME_TILES_OK, frame_tiles_push(tiles, d, len, DEADLINE_US));
+
+    frame_tiles_stats_t stats;
+    frame_tiles_get_stats(tiles, &stats);
+    TEST_ASSERT_EQUAL(3, stats.tiles_bad);
+    TEST_ASSERT_EQUAL(1, stats.no_buffer);
+    TEST_ASSERT_EQUAL(1, stats.frames_partial);
+
+    // Deleting gives the frame being assembled back
+    frame_tiles_delete(tiles);
+    frame_pool_stats_t pool_stats;
+    frame_pool_get_stats(pool, &pool_stats);
+    TEST_ASSERT_EQUAL(0, pool_stats.in_use);
+    frame_pool_delete(pool);
+}
+
+/* Loopback sender: sends LOOP_FRAMES frames as UDP tiles, drops a few on the
+ * first try and sends them again when asked, except for the frames whose
+ * losses it leaves alone. */
+#define LOOP_FRAMES 12
+
+typedef struct {
+    int sock;
+    struct sockaddr_in device;
+} sender_t;
+
+static bool loop_dropped(uint32_t frame_id, uint16_t index)
+{
+    return frame_id % 3 == 1 && (index == frame_id % TILE_COUNT || index == TILE_COUNT - 1);
+}
+
+static bool loop_ignores_nacks(uint32_t frame_id)
+{
+    return frame_id == 7;
+}
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void *sender_main(void *arg)
+{
+    sender_t *sender = arg;
+    uint8_t d[DATAGRAM];
+    uint8_t buf[256];
+
+    for (uint32_t frame_id = 1; frame_id <= LOOP_FRAMES; frame_id++) {
+        bool dropped = false;
+        for (uint16_t i = 0; i < TILE_COUNT; i++) {
+            if (loop_dropped(frame_id, i)) {
+                dropped = true;
+                continue;
+            }
+            size_t len = make_tile(d, frame_id, i, frame_id % 2 ? FRAME_FORMAT_RGB565_RLE : FRAME_FORMAT_RGB565);
+            sendto(sender->sock, d, len, 0, (struct sockaddr *)&sender->device, sizeof(sender->device));
+        }
+        if (!dropped) {
+            continue;
+        }
+
+        // Answer the NACK before moving on to the next frame, NACKs of earlier frames
+        // may still be queued
+        frame_tiles_nack_t nack = {0};
+        struct pollfd pfd = { .fd = sender->sock, .events = POLLIN };
+        while (poll(&pfd, 1, 5 * NACK_DELAY_US / 1000) > 0) {
+            ssize_t n = recv(sender->sock, buf, sizeof(buf), 0);
+            if (n > 0 && frame_tiles_parse_nack(buf, (size_t)n, &nack) == FRAME_TILES_OK && nack.frame_id == frame_id) {
+                break;
+            }
+            nack.count = 0;
+        }
+        if (loop_ignores_nacks(frame_id)) {
+            continue;
+        }
+        for (size_t i = 0; i < nack.count; i++) {
+            size_t len = make_tile(d, frame_id, frame_tiles_nack_index(&nack, i), FRAME_FORMAT_RGB565);
+            sendto(sender->sock, d, len, 0, (struct sockaddr *)&sender->device, sizeof(sender->device));
+        }
+    }
+    return NULL;
+}
+
+static void test_loopback_sender(void)
+{
+    static uint8_t canvas[FRAME_H * STRIDE];
+    static uint8_t d[DATAGRAM];
+    uint8_t nack_buf[256];
+    frame_pool_t *pool = make_pool(4);
+    frame_tiles_t *tiles = make_tiles(pool);
+    memset(canvas, 0, sizeof(canvas));
+
+    // Device socket on an ephemeral loopback port, the sender connected to it
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t addr_len = sizeof(addr);
+    int device = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT(device >= 0);
+    TEST_ASSERT_EQUAL(0, bind(device, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(0, getsockname(device, (struct sockaddr *)&addr, &addr_len));
+
+    sender_t sender = { .device = addr };
+    sender.sock = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT(sender.sock >= 0);
+    pthread_t thread;
+    TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL, sender_main, &sender));
+
+    struct sockaddr_in peer;
+    socklen_t peer_len = 0;
+    uint32_t frames = 0;
+    uint32_t partial = 0;
+    int64_t give_up = now_us() + 5000000;
+    while (frames < LOOP_FRAMES && now_us() < give_up) {
+        int64_t now = now_us();
+        int64_t next = frame_tiles_next_event_us(tiles);
+        int timeout_ms = next == INT64_MAX ? 100 : (int)((next - now + 999) / 1000);
+        struct pollfd pfd = { .fd = device, .events = POLLIN };
+        if (poll(&pfd, 1, timeout_ms > 0 ? timeout_ms : 0) > 0) {
+            peer_len = sizeof(peer);
+            ssize_t n = recvfrom(device, d, sizeof(d), 0, (struct sockaddr *)&peer, &peer_len);
+            if (n > 0) {
+                frame_tiles_push(tiles, d, (size_t)n, now_us());
+            }
+        }
+
+        now = now_us();
+        size_t nack_len = frame_tiles_nack(tiles, now, nack_buf, sizeof(nack_buf));
+        if (nack_len && peer_len) {
+            sendto(device, nack_buf, nack_len, 0, (struct sockaddr *)&peer, peer_len);
+        }
+
+        frame_slot_t *slot;
+        while ((slot = frame_tiles_poll(tiles, now)) != NULL) {
+            bool missing[TILE_COUNT];
+            for (uint16_t i = 0; i < TILE_COUNT; i++) {
+                missing[i] = loop_ignores_nacks(slot->seq) && loop_dropped(slot->seq, i);
+            }
+            frames++;
+            TEST_ASSERT_EQUAL(frames, slot->seq);
+            check_frame(slot, slot->seq, canvas, missing);
+            partial += loop_ignores_nacks(slot->seq);
+            frame_pool_release(pool, slot);
+        }
+    }
+    pthread_join(thread, NULL);
+    close(sender.sock);
+    close(device);
+
+    TEST_ASSERT_EQUAL(LOOP_FRAMES, frames);
+    frame_tiles_stats_t stats;
+    frame_tiles_get_stats(tiles, &stats);
+    TEST_ASSERT_EQUAL(LOOP_FRAMES - 1, stats.frames_complete);
+    TEST_ASSERT_EQUAL(1, stats.frames_partial);
+    TEST_ASSERT_EQUAL(1, partial);
+    TEST_ASSERT(stats.nacks >= 4);
+
+    frame_tiles_delete(tiles);
+    frame_pool_delete(pool);
+}
+
+int main(void)
+{
+    RUN_TEST(test_parse);
+    RUN_TEST(test_complete_frame_is_key);
+    RUN_TEST(test_deadline_sends_partial_frame);
+    RUN_TEST(test_newer_frame_sends_older_one);
+    RUN_TEST(test_nack_and_retransmit);
+    RUN_TEST(test_bad_tiles);
+    RUN_TEST(test_loopback_sender);
+    return TEST_REPORT();
+}
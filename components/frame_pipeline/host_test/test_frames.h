@@ -0,0 +1,65 @@
+/* Synthetic RGB565 frames standing in for recorded JunctionRelay screenshots. */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+static void frame_put_pixel(uint8_t *frame, int w, int x, int y, uint16_t c)
+{
+    frame[(y * w + x) * 2] = (uint8_t)c;
+    frame[(y * w + x) * 2 + 1] = (uint8_t)(c >> 8);
+}
+
+static void frame_fill_rect(uint8_t *frame, int w, int x0, int y0, int rw, int rh, uint16_t c)
+{
+    for (int y = y0; y < y0 + rh; y++) {
+        for (int x = x0; x < x0 + rw; x++) {
+            frame_put_pixel(frame, w, x, y, c);
+        }
+    }
+}
+
+/* Dashboard-like screen: flat background, a grid of cards with a bar gauge
+ * and a few lines of "text" (short irregular pixel runs) each. */
+static void make_dashboard_frame(uint8_t *frame, int w, int h, uint32_t seed)
+{
+    frame_fill_rect(frame, w, 0, 0, w, h, 0x18e3);
+
+    int card_w = w / 4;
+    int card_h = h / 3;
+    for (int cy = 0; cy < 3; cy++) {
+        for (int cx = 0; cx < 4; cx++) {
+            int x0 = cx * card_w + 8;
+            int y0 = cy * card_h + 8;
+            frame_fill_rect(frame, w, x0, y0, card_w - 16, card_h - 16, 0x2945);
+
+            // Bar gauge with a vertical gradient
+            int fill = (int)((seed + cx * 37 + cy * 91) % (unsigned)(card_w - 48));
+            for (int y = 0; y < 12; y++) {
+                frame_fill_rect(frame, w, x0 + 16, y0 + card_h - 48 + y, fill, 1, (uint16_t)(0x07e0 + (y << 11)));
+            }
+
+            // Text lines
+            uint32_t r = seed * 1103515245u + (uint32_t)(cx * 7 + cy * 13);
+            for (int line = 0; line < 3; line++) {
+                int y = y0 + 16 + line * 20;
+                for (int x = x0 + 16; x < x0 + card_w - 48; x++) {
+                    r = r * 1103515245u + 12345u;
+                    if ((r >> 16) % 3 == 0) {
+                        frame_fill_rect(frame, w, x, y, 1, 12, 0xffff);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* Incompressible frame, the worst case for both codecs. */
+static void make_noise_frame(uint8_t *frame, int w, int h, uint32_t seed)
+{
+    uint32_t r = seed;
+    for (int i = 0; i < w * h * 2; i++) {
+        r = r * 1103515245u + 12345u;
+        frame[i] = (uint8_t)(r >> 16);
+    }
+}
@@ -0,0 +1,298 @@
+#include <stdint.h>
+#include "json_pull.h"
+#include "test_common.h"
+
+#define FUZZ_ROUNDS 200000
+#define FUZZ_MAX_LEN 160
+
+// Pulls every token of `json` into `tokens`, returns how many up to and including END or ERROR
+static size_t pull_all(const char *json, json_pull_token_t *tokens, size_t max)
+{
+    json_pull_t pull;
+    json_pull_init(&pull, json, strlen(json));
+    size_t n = 0;
+    while (n < max) {
+        json_pull_token_t token = json_pull_next(&pull);
+        tokens[n++] = token;
+        if (token == JSON_PULL_END || token == JSON_PULL_ERROR) {
+            break;
+        }
+    }
+    return n;
+}
+
+static json_pull_token_t last_token(const char *json)
+{
+    json_pull_token_t tokens[128];
+    size_t n = pull_all(json, tokens, 128);
+    return tokens[n - 1];
+}
+
+static void test_tokens(void)
+{
+    static const json_pull_token_t expected[] = {
+        JSON_PULL_OBJECT_START,
+        JSON_PULL_KEY, JSON_PULL_STRING,
+        JSON_PULL_KEY, JSON_PULL_ARRAY_START, JSON_PULL_NUMBER, JSON_PULL_TRUE, JSON_PULL_FALSE,
+        JSON_PULL_NULL, JSON_PULL_ARRAY_START, JSON_PULL_ARRAY_END, JSON_PULL_ARRAY_END,
+        JSON_PULL_KEY, JSON_PULL_OBJECT_START, JSON_PULL_OBJECT_END,
+        JSON_PULL_OBJECT_END,
+        JSON_PULL_END,
+    };
+    json_pull_token_t tokens[32];
+    size_t n = pull_all(" {\"a\" : \"x\", \"b\":[1,true,false,null,[]],\n\"c\":{}}\r\n", tokens, 32);
+    TEST_ASSERT_EQUAL(sizeof(expected) / sizeof(expected[0]), n);
+    TEST_ASSERT_EQUAL_MEMORY(expected, tokens, sizeof(expected));
+
+    // Scalars at the top level, END stays
+    json_pull_t pull;
+    json_pull_init(&pull, "42", 2);
+    TEST_ASSERT_EQUAL(JSON_PULL_NUMBER, json_pull_next(&pull));
+    TEST_ASSERT_EQUAL(JSON_PULL_END, json_pull_next(&pull));
+    TEST_ASSERT_EQUAL(JSON_PULL_END, json_pull_next(&pull));
+
+    // No NUL needed, the length is all that counts
+    json_pull_init(&pull, "\"ab\"garbage", 4);
+    TEST_ASSERT_EQUAL(JSON_PULL_STRING, json_pull_next(&pull));
+    TEST_ASSERT_EQUAL(2, pull.str_len);
+    TEST_ASSERT_EQUAL(JSON_PULL_END, json_pull_next(&pull));
+}
+
+static void test_strings_and_keys(void)
+{
+    json_pull_t pull;
+    const char *json = "{\"type\":\"sen\\\"sor\",\"t\\u0079pe\":1}";
+    json_pull_init(&pull, json, strlen(json));
+    TEST_ASSERT_EQUAL(JSON_PULL_OBJECT_START, json_pull_next(&pull));
+    TEST_ASSERT_EQUAL(JSON_PULL_KEY, json_pull_next(&pull));
+    TEST_ASSERT_TRUE(json_pull_key_is(&pull, "type"));
+    TEST_ASSERT_FALSE(json_pull_key_is(&pull, "typ"));
+    TEST_ASSERT_FALSE(pull.str_escaped);
+
+    TEST_ASSERT_EQUAL(JSON_PULL_STRING, json_pull_next(&pull));
+    TEST_ASSERT_FALSE(json_pull_key_is(&pull, "sen\\\"sor"));
+    TEST_ASSERT_TRUE(json_pull_str_is(&pull, "sen\\\"sor"));
+    TEST_ASSERT_TRUE(pull.str_escaped);
+    char buf[16];
+    TEST_ASSERT_EQUAL(7, json_pull_string_copy(&pull, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("sen\"sor", buf);
+
+    // Keys compare raw, escaped ones have to be copied out first
+    TEST_ASSERT_EQUAL(JSON_PULL_KEY, json_pull_next(&pull));
+    TEST_ASSERT_FALSE(json_pull_key_is(&pull, "type"));
+    json_pull_string_copy(&pull, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("type", buf);
+}
+
+static double number_of(const char *json)
+{
+    json_pull_t pull;
+    json_pull_init(&pull, json, strlen(json));
+    TEST_ASSERT_EQUAL(JSON_PULL_NUMBER, json_pull_next(&pull));
+    TEST_ASSERT_EQUAL(JSON_PULL_END, json_pull_next(&pull));
+    return pull.number;
+}
+
+static void test_numbers(void)
+{
+    TEST_ASSERT(number_of("0") == 0);
+    TEST_ASSERT(number_of("-0") == 0);
+    TEST_ASSERT(number_of("123456789012345") == 123456789012345.0);
+    TEST_ASSERT(number_of("-17") == -17);
+    TEST_ASSERT(number_of("42.5") == 42.5);
+    TEST_ASSERT(number_of("-1.5e3") == -1500);
+    TEST_ASSERT(number_of("25E-1") == 2.5);
+    TEST_ASSERT(number_of("1e+2") == 100);
+    TEST_ASSERT(number_of("12345678901234567890") == 12345678901234567890.0);
+
+    static const char *const bad[] = {
+        "01", "-", "+1", ".5", "1.", "1e", "1e+", "0x10", "--1", "1.2.3", "NaN", "Infinity",
+        "1234567890123456789012345678901234567890123456789012345678901234",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        TEST_ASSERT_EQUAL(JSON_PULL_ERROR, last_token(bad[i]));
+    }
+    // Exactly JSON_PULL_MAX_NUMBER characters still parse
+    TEST_ASSERT_EQUAL(JSON_PULL_END, last_token("123456789012345678901234567890123456789012345678901234567890123"));
+}
+
+static void test_malformed(void)
+{
+    static const char *const bad[] = {
+        "", "   ", "{", "}", "[", "]", "{]", "[}", "{\"a\"}", "{\"a\":}", "{\"a\" 1}", "{a:1}",
+        "{\"a\":1,}", "[1,]", "[1 2]", "{\"a\":1 \"b\":2}", ",1", "1 2", "{} {}", "tru", "nul",
+        "truex", "\"abc", "\"a\\\"", "\"\\x\"", "\"\\u12g4\"", "\"\\u123\"", "\"a\nb\"", "'a'",
+        "{\"a\":1}}", "[[]]]",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        if (last_token(bad[i]) != JSON_PULL_ERROR) {
+            fprintf(stderr, "accepted: %s\n", bad[i]);
+            TEST_FAIL_MESSAGE("malformed JSON accepted");
+        }
+    }
+
+    // ERROR is sticky
+    json_pull_t pull;
+    json_pull_init(&pull, "[1,,2]", 6);
+    TEST_ASSERT_EQUAL(JSON_PULL_ARRAY_START, json_pull_next(&pull));
+    TEST_ASSERT_EQUAL(JSON_PULL_NUMBER, json_pull_next(&pull));
+    TEST_ASSERT_EQUAL(JSON_PULL_ERROR, json_pull_next(&pull));
+    TEST_ASSERT_EQUAL(JSON_PULL_ERROR, json_pull_next(&pull));
+    TEST_ASSERT_FALSE(json_pull_skip(&pull));
+}
+
+static void test_depth_limit(void)
+{
+    char json[2 * (JSON_PULL_MAX_DEPTH + 1) + 1];
+    for (int depth = JSON_PULL_MAX_DEPTH; depth <= JSON_PULL_MAX_DEPTH + 1; depth++) {
+        memset(json, '[', depth);
+        memset(json + depth, ']', depth);
+        json[2 * depth] = '\0';
+        TEST_ASSERT_EQUAL(depth == JSON_PULL_MAX_DEPTH ? JSON_PULL_END : JSON_PULL_ERROR, last_token(json));
+    }
+}
+
+static void test_skip(void)
+{
+    json_pull_t pull;
+    const char *json = "{\"skip\":{\"a\":[1,{\"b\":\"]}\"}],\"c\":null},\"n\":2,\"arr\":[[3],4],\"last\":5}";
+    json_pull_init(&pull, json, strlen(json));
+    TEST_ASSERT_EQUAL(JSON_PULL_OBJECT_START, json_pull_next(&pull));
+
+    // A whole value after its key
+    TEST_ASSERT_EQUAL(JSON_PULL_KEY, json_pull_next(&pull));
+    TEST_ASSERT_TRUE(json_pull_skip(&pull));
+    TEST_ASSERT_EQUAL(JSON_PULL_OBJECT_END, pull.token);
+    TEST_ASSERT_EQUAL(1, pull.depth);
+
+    // A scalar after its key
+    TEST_ASSERT_EQUAL(JSON_PULL_KEY, json_pull_next(&pull));
+    TEST_ASSERT_TRUE(json_pull_skip(&pull));
+    TEST_ASSERT_EQUAL(JSON_PULL_NUMBER, pull.token);
+
+    // The rest of a container that was just opened
+    TEST_ASSERT_EQUAL(JSON_PULL_KEY, json_pull_next(&pull));
+    TEST_ASSERT_EQUAL(JSON_PULL_ARRAY_START, json_pull_next(&pull));
+    TEST_ASSERT_TRUE(json_pull_skip(&pull));
+    TEST_ASSERT_EQUAL(JSON_PULL_ARRAY_END, pull.token);
+    TEST_ASSERT_EQUAL(1, pull.depth);
+
+    TEST_ASSERT_EQUAL(JSON_PULL_KEY, json_pull_next(&pull));
+    TEST_ASSERT_TRUE(json_pull_key_is(&pull, "last"));
+    TEST_ASSERT_EQUAL(JSON_PULL_NUMBER, json_pull_next(&pull));
+    TEST_ASSERT(pull.number == 5);
+    TEST_ASSERT_EQUAL(JSON_PULL_OBJECT_END, json_pull_next(&pull));
+    TEST_ASSERT_EQUAL(JSON_PULL_END, json_pull_next(&pull));
+
+    // Skipping into malformed input fails
+    json_pull_init(&pull, "{\"a\":[1,2}", 10);
+    json_pull_next(&pull);
+    json_pull_next(&pull);
+    TEST_ASSERT_FALSE(json_pull_skip(&pull));
+}
+
+static void test_unescape(void)
+{
+    char buf[32];
+    const char *src = "a\\n\\t\\\\\\/\\b\\f\\r\\\"";
+    TEST_ASSERT_EQUAL(9, json_pull_unescape(src, strlen(src), buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("a\n\t\\/\b\f\r\"", buf);
+
+    // \u escapes to UTF-8, surrogate pairs combined, lone surrogates replaced
+    src = "\\u0041\\u00e9\\u20ac\\ud83d\\ude00\\udc00x";
+    TEST_ASSERT_EQUAL(1 + 2 + 3 + 4 + 3 + 1, json_pull_unescape(src, strlen(src), buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("A\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\xef\xbf\xbdx", buf);
+
+    // Cut off at a character boundary, escaped or raw
+    TEST_ASSERT_EQUAL(1, json_pull_unescape("\\u0041\\u20ac", 12, buf, 4));
+    TEST_ASSERT_EQUAL_STRING("A", buf);
+    TEST_ASSERT_EQUAL(1, json_pull_unescape("A\xe2\x82\xac", 4, buf, 4));
+    TEST_ASSERT_EQUAL_STRING("A", buf);
+    TEST_ASSERT_EQUAL(0, json_pull_unescape("abc", 3, buf, 1));
+    TEST_ASSERT_EQUAL_STRING("", buf);
+}
+
+// xorshift32, fixed seed so a failure reproduces
+static uint32_t fuzz_state = 0x9e3779b9;
+
+static uint32_t fuzz_next(void)
+{
+    fuzz_state ^= fuzz_state << 13;
+    fuzz_state ^= fuzz_state >> 17;
+    fuzz_state ^= fuzz_state << 5;
+    return fuzz_state;
+}
+
+// Random mutations of valid JSON. Inputs live in exactly sized heap buffers,
+// so building with -DFRAME_PIPELINE_SANITIZE=ON catches any read past the end.
+static void test_fuzz(void)
+{
+    static const char *const seeds[] = {
+        "{\"type\":\"sensor\",\"sensors\":{\"cpu\":{\"value\":42.5,\"displayValue\":\"42 \\u0025\"},\"fps\":60}}",
+        "[1,-2.5e-3,true,false,null,\"\\ud83d\\ude00\",[[{}]],{\"a\":{\"b\":[]}}]",
+        "{\"layout\":\"<view>\\n\\t<lv_label bind_text=\\\"cpu_text\\\"/>\\n</view>\",\"screenId\":null}",
+    };
+    const char alphabet[] = "{}[]\":,\\u0e.-+ tfn";
+
+    for (uint32_t round = 0; round < FUZZ_ROUNDS; round++) {
+        char input[FUZZ_MAX_LEN];
+        const char *seed = seeds[fuzz_next() % (sizeof(seeds) / sizeof(seeds[0]))];
+        size_t len = strlen(seed);
+        memcpy(input, seed, len);
+
+        for (uint32_t n = fuzz_next() % 4; n > 0 && len > 0; n--) {
+            size_t at = fuzz_next() % len;
+            switch (fuzz_next() % 4) {
+            case 0:
+                input[at] ^= (char)(1u << (fuzz_next() % 8));
+                break;
+            case 1:
+                input[at] = alphabet[fuzz_next() % (sizeof(alphabet) - 1)];
+                break;
+            case 2:
+                input[at] = (char)fuzz_next();
+                break;
+            default:
+                len = at;
+                break;
+            }
+        }
+
+        char *data = malloc(len ? len : 1);
+        TEST_ASSERT_NOT_NULL(data);
+        memcpy(data, input, len);
+
+        json_pull_t pull;
+        json_pull_init(&pull, data, len);
+        json_pull_token_t token;
+        size_t tokens = 0;
+        while ((token = json_pull_next(&pull)) != JSON_PULL_END && token != JSON_PULL_ERROR) {
+            TEST_ASSERT(pull.p >= data && pull.p <= data + len);
+            TEST_ASSERT(pull.depth <= JSON_PULL_MAX_DEPTH);
+            if (token == JSON_PULL_KEY || token == JSON_PULL_STRING) {
+                TEST_ASSERT(pull.str >= data && pull.str + pull.str_len <= data + len);
+                char out[FUZZ_MAX_LEN + 1];
+                size_t out_len = json_pull_string_copy(&pull, out, sizeof(out));
+                TEST_ASSERT(out_len <= pull.str_len && out[out_len] == '\0');
+            }
+            TEST_ASSERT(++tokens <= len);
+        }
+        if (token == JSON_PULL_END) {
+            TEST_ASSERT_EQUAL(0, pull.depth);
+        }
+        free(data);
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(test_tokens);
+    RUN_TEST(test_strings_and_keys);
+    RUN_TEST(test_numbers);
+    RUN_TEST(test_malformed);
+    RUN_TEST(test_depth_limit);
+    RUN_TEST(test_skip);
+    RUN_TEST(test_unescape);
+    RUN_TEST(test_fuzz);
+    return TEST_REPORT();
+}
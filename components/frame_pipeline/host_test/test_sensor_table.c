@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include "sensor_table.h"
+#include "test_common.h"
+
+#define MAX_CHANGED 64
+
+static const sensor_entry_t *changed_entries[MAX_CHANGED];
+static size_t changed_count;
+
+static void record_changed(const sensor_entry_t *entry, void *ctx)
+{
+    (void)ctx;
+    if (changed_count < MAX_CHANGED) {
+        changed_entries[changed_count] = entry;
+    }
+    changed_count++;
+}
+
+static bool apply(sensor_table_t *table, const char *json)
+{
+    changed_count = 0;
+    return sensor_table_apply_json(table, json, strlen(json), record_changed, NULL);
+}
+
+static void test_only_changes_fire(void)
+{
+    sensor_table_t *table = sensor_table_create(16);
+    TEST_ASSERT_NOT_NULL(table);
+
+    TEST_ASSERT_TRUE(apply(table, "{\"type\":\"sensor\",\"sensors\":{"
+                                  "\"cpu\":{\"value\":42.5,\"displayValue\":\"42 %\",\"unit\":\"%\"},"
+                                  "\"fps\":60,\"mode\":\"eco\"}}"));
+    TEST_ASSERT_EQUAL(3, changed_count);
+    TEST_ASSERT_EQUAL(3, sensor_table_count(table));
+    TEST_ASSERT_EQUAL_STRING("cpu", changed_entries[0]->key);
+    TEST_ASSERT(changed_entries[0]->value == 42.5);
+    TEST_ASSERT_EQUAL_STRING("42 %", changed_entries[0]->text);
+    TEST_ASSERT_EQUAL_STRING("fps", changed_entries[1]->key);
+    TEST_ASSERT(changed_entries[1]->value == 60);
+    TEST_ASSERT_EQUAL_STRING("", changed_entries[1]->text);
+    TEST_ASSERT_EQUAL_STRING("eco", changed_entries[2]->text);
+
+    // Same values again: nothing fires
+    TEST_ASSERT_TRUE(apply(table, "{\"sensors\":{\"fps\":60,\"cpu\":{\"displayValue\":\"42 %\",\"value\":42.5}},\"type\":\"sensor\"}"));
+    TEST_ASSERT_EQUAL(0, changed_count);
+
+    // Only the display string of cpu changed, a value alone keeps the string
+    TEST_ASSERT_TRUE(apply(table, "{\"sensors\":{\"cpu\":{\"value\":42.5,\"displayValue\":\"43 %\"},\"fps\":{\"value\":60}}}"));
+    TEST_ASSERT_EQUAL(1, changed_count);
+    TEST_ASSERT_EQUAL_STRING("cpu", changed_entries[0]->key);
+    TEST_ASSERT_EQUAL(2, changed_entries[0]->changes);
+    TEST_ASSERT_TRUE(apply(table, "{\"sensors\":{\"cpu\":{\"value\":50}}}"));
+    TEST_ASSERT_EQUAL(1, changed_count);
+    TEST_ASSERT_EQUAL_STRING("43 %", changed_entries[0]->text);
+
+    const sensor_entry_t *fps = sensor_table_find(table, "fps", 3);
+    TEST_ASSERT_NOT_NULL(fps);
+    TEST_ASSERT(fps->value == 60);
+    TEST_ASSERT_NULL(sensor_table_find(table, "fp", 2));
+    TEST_ASSERT_NULL(sensor_table_find(table, "gpu", 3));
+
+    sensor_table_stats_t stats;
+    sensor_table_get_stats(table, &stats);
+    TEST_ASSERT_EQUAL(4, stats.messages);
+    TEST_ASSERT_EQUAL(0, stats.malformed);
+    TEST_ASSERT_EQUAL(5, stats.changed);
+    TEST_ASSERT_EQUAL(3, stats.unchanged);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+    sensor_table_delete(table);
+}
+
+static void test_odd_members(void)
+{
+    sensor_table_t *table = sensor_table_create(16);
+
+    // Values of the wrong type and sensors without anything usable are skipped
+    TEST_ASSERT_TRUE(apply(table, "{\"sensors\":{\"a\":null,\"b\":[1,2],\"c\":{\"value\":\"7\",\"displayValue\":7},"
+                                  "\"d\":{\"value\":[1],\"displayValue\":{\"x\":1},\"other\":{}},\"e\":true}}"));
+    TEST_ASSERT_EQUAL(0, changed_count);
+    TEST_ASSERT_EQUAL(0, sensor_table_count(table));
+
+    // "sensors" that is not an object, nested "sensors" members
+    TEST_ASSERT_TRUE(apply(table, "{\"sensors\":[{\"a\":1}],\"x\":{\"sensors\":{\"a\":1}}}"));
+    TEST_ASSERT_EQUAL(0, changed_count);
+
+    // Escaped keys and strings are unescaped, strings cut off to fit
+    TEST_ASSERT_TRUE(apply(table, "{\"sensors\":{\"t\\u00e9mp\":\"21 \\u00b0C\","
+                                  "\"long\":\"0123456789012345678901234567890123456789\"}}"));
+    TEST_ASSERT_EQUAL(2, changed_count);
+    TEST_ASSERT_NOT_NULL(sensor_table_find(table, "t\xc3\xa9mp", 5));
+    TEST_ASSERT_EQUAL_STRING("21 \xc2\xb0" "C", changed_entries[0]->text);
+    TEST_ASSERT_EQUAL(SENSOR_TABLE_TEXT_LEN - 1, strlen(changed_entries[1]->text));
+    sensor_table_delete(table);
+}
+
+static void test_dropped(void)
+{
+    sensor_table_t *table = sensor_table_create(2);
+    TEST_ASSERT_TRUE(apply(table, "{\"sensors\":{\"a\":1,\"b\":2,\"c\":3,\"a\":4,"
+                                  "\"0123456789012345678901234567890123456789\":5,\"\":6}}"));
+    TEST_ASSERT_EQUAL(3, changed_count);
+    TEST_ASSERT_EQUAL(2, sensor_table_count(table));
+    TEST_ASSERT(sensor_table_find(table, "a", 1)->value == 4);
+    TEST_ASSERT_NULL(sensor_table_find(table, "c", 1));
+
+    sensor_table_stats_t stats;
+    sensor_table_get_stats(table, &stats);
+    TEST_ASSERT_EQUAL(3, stats.dropped);
+    sensor_table_delete(table);
+
+    TEST_ASSERT_NULL(sensor_table_create(0));
+    TEST_ASSERT_NULL(sensor_table_create(32769));
+}
+
+static void test_malformed_keeps_earlier_updates(void)
+{
+    sensor_table_t *table = sensor_table_create(16);
+    TEST_ASSERT_FALSE(apply(table, "{\"sensors\":{\"a\":1,\"b\":2 \"c\":{\"value\":3,}}}"));
+    TEST_ASSERT_EQUAL(2, changed_count);
+    TEST_ASSERT_NOT_NULL(sensor_table_find(table, "b", 1));
+    TEST_ASSERT_NULL(sensor_table_find(table, "c", 1));
+    TEST_ASSERT_FALSE(apply(table, "{\"sensors\":{\"c\":{\"value\":3,}}}"));
+    TEST_ASSERT_EQUAL(0, changed_count);
+    TEST_ASSERT_NULL(sensor_table_find(table, "c", 1));
+    TEST_ASSERT_FALSE(apply(table, "{\"sensors\":{\"x\":1}} trailing"));
+    TEST_ASSERT_FALSE(apply(table, "[1]"));
+    TEST_ASSERT_FALSE(apply(table, ""));
+
+    sensor_table_stats_t stats;
+    sensor_table_get_stats(table, &stats);
+    TEST_ASSERT_EQUAL(5, stats.malformed);
+    sensor_table_delete(table);
+}
+
+static void test_many_sensors(void)
+{
+    // Every entry in use, the slots half full
+    enum { COUNT = 300 };
+    sensor_table_t *table = sensor_table_create(COUNT);
+    static char json[COUNT * 48];
+    size_t len = (size_t)snprintf(json, sizeof(json), "{\"sensors\":{");
+    for (int i = 0; i < COUNT; i++) {
+        len += (size_t)snprintf(json + len, sizeof(json) - len, "%s\"sensor_%d\":{\"value\":%d}", i ? "," : "", i, i);
+    }
+    snprintf(json + len, sizeof(json) - len, "}}");
+
+    TEST_ASSERT_TRUE(apply(table, json));
+    TEST_ASSERT_EQUAL(COUNT, changed_count);
+    TEST_ASSERT_TRUE(apply(table, json));
+    TEST_ASSERT_EQUAL(0, changed_count);
+
+    for (int i = 0; i < COUNT; i++) {
+        char key[SENSOR_TABLE_KEY_LEN];
+        int key_len = snprintf(key, sizeof(key), "sensor_%d", i);
+        const sensor_entry_t *entry = sensor_table_find(table, key, (size_t)key_len);
+        TEST_ASSERT_NOT_NULL(entry);
+        TEST_ASSERT(entry->value == i);
+    }
+    sensor_table_delete(table);
+}
+
+int main(void)
+{
+    RUN_TEST(test_only_changes_fire);
+    RUN_TEST(test_odd_members);
+    RUN_TEST(test_dropped);
+    RUN_TEST(test_malformed_keeps_earlier_updates);
+    RUN_TEST(test_many_sensors);
+    return TEST_REPORT();
+}
@@ -0,0 +1,288 @@
+#include <stdint.h>
+#include "ws_assembler.h"
+#include "test_common.h"
+
+#define TEXT_CAP    256
+#define BINARY_CAP  (80 * 1024)
+#define MAX_MSGS    8
+
+/* Replays a recorded byte stream through the parser and the assembler, the
+ * same way the device handler drives the assembler from esp_http_server,
+ * handing the bytes over `chunk` at a time. */
+typedef struct {
+    ws_assembler_t as;
+    uint8_t text_buf[TEXT_CAP];
+    uint8_t binary_buf[BINARY_CAP];
+    ws_message_t msgs[MAX_MSGS];
+    int msg_count;
+    int errors;
+} replay_t;
+
+static void replay(replay_t *r, const uint8_t *stream, size_t len, size_t chunk)
+{
+    uint8_t hdr_buf[WS_FRAME_MAX_HEADER_LEN];
+    size_t hdr_len = 0;
+    ws_frame_hdr_t hdr;
+    size_t payload_left = 0;
+    size_t payload_pos = 0;
+    uint8_t *dst = NULL;
+    uint8_t control_buf[125];
+    bool in_frame = false;
+    size_t pos = 0;
+
+    while (pos < len && r->errors == 0) {
+        size_t avail = (len - pos) < chunk ? (len - pos) : chunk;
+        const uint8_t *data = stream + pos;
+        pos += avail;
+
+        while (avail > 0) {
+            if (!in_frame) {
+                hdr_buf[hdr_len++] = *data++;
+                avail--;
+                int n = ws_frame_parse_header(hdr_buf, hdr_len, &hdr);
+                if (n < 0) {
+                    r->errors++;
+                    return;
+                }
+                if (n == 0) {
+                    continue;
+                }
+                hdr_len = 0;
+                in_frame = true;
+                payload_left = (size_t)hdr.payload_len;
+                payload_pos = 0;
+
+                switch (ws_assembler_frame(&r->as, hdr.opcode, hdr.fin, payload_left)) {
+                case WS_ASM_START: {
+                    bool text = hdr.opcode == WS_OPCODE_TEXT;
+                    if (!ws_assembler_attach(&r->as, text ? r->text_buf : r->binary_buf,
+                                             text ? TEXT_CAP : BINARY_CAP)) {
+                        r->errors++;
+                        return;
+                    }
+                    dst = ws_assembler_payload(&r->as);
+                    break;
+                }
+                case WS_ASM_CONTINUE:
+                    dst = ws_assembler_payload(&r->as);
+                    break;
+                case WS_ASM_CONTROL:
+                    dst = control_buf;
+                    break;
+                default:
+                    ws_assembler_abort(&r->as);
+                    r->errors++;
+                    return;
+                }
+            }
+
+            size_t n = avail < payload_left ? avail : payload_left;
+            memcpy(dst + payload_pos, data, n);
+            if (hdr.masked) {
+                ws_frame_unmask(dst + payload_pos, n, hdr.mask_key, payload_pos);
+            }
+            data += n;
+            avail -= n;
+            payload_pos += n;
+            payload_left -= n;
+
+            if (payload_left == 0) {
+                in_frame = false;
+                ws_message_t msg;
+                if (ws_assembler_frame_done(&r->as, &msg) && r->msg_count < MAX_MSGS) {
+                    r->msgs[r->msg_count++] = msg;
+                }
+            }
+        }
+    }
+}
+
+static replay_t *replay_all_chunkings(const uint8_t *stream, size_t len, int expected_msgs)
+{
+    static replay_t r;
+    static const size_t chunks[] = {1, 2, 3, 7, 1436, SIZE_MAX};
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        ws_assembler_init(&r.as);
+        r.msg_count = 0;
+        r.errors = 0;
+        replay(&r, stream, len, chunks[i]);
+        TEST_ASSERT_EQUAL(0, r.errors);
+        TEST_ASSERT_EQUAL(expected_msgs, r.msg_count);
+    }
+    return &r;
+}
+
+/* RFC 6455, 5.7: "A single-frame unmasked text message" */
+static void test_rfc_unmasked_text(void)
+{
+    static const uint8_t stream[] = {0x81, 0x05, 0x48, 0x65, 0x6c, 0x6c, 0x6f};
+    replay_t *r = replay_all_chunkings(stream, sizeof(stream), 1);
+    TEST_ASSERT_EQUAL(WS_OPCODE_TEXT, r->msgs[0].opcode);
+    TEST_ASSERT_EQUAL(5, r->msgs[0].len);
+    TEST_ASSERT_EQUAL_MEMORY("Hello", r->msgs[0].data, 5);
+    TEST_ASSERT(r->msgs[0].data == r->text_buf);
+}
+
+/* RFC 6455, 5.7: "A single-frame masked text message" */
+static void test_rfc_masked_text(void)
+{
+    static const uint8_t stream[] = {0x81, 0x85, 0x37, 0xfa, 0x21, 0x3d, 0x7f, 0x9f, 0x4d, 0x51, 0x58};
+    replay_t *r = replay_all_chunkings(stream, sizeof(stream), 1);
+    TEST_ASSERT_EQUAL_MEMORY("Hello", r->msgs[0].data, 5);
+}
+
+/* RFC 6455, 5.7: "A fragmented unmasked text message", with the unmasked
+ * ping from the same section interleaved between the fragments */
+static void test_rfc_fragmented_text_with_ping(void)
+{
+    static const uint8_t stream[] = {
+        0x01, 0x03, 0x48, 0x65, 0x6c,
+        0x89, 0x05, 0x48, 0x65, 0x6c, 0x6c, 0x6f,
+        0x80, 0x02, 0x6c, 0x6f,
+    };
+    replay_t *r = replay_all_chunkings(stream, sizeof(stream), 1);
+    TEST_ASSERT_EQUAL(WS_OPCODE_TEXT, r->msgs[0].opcode);
+    TEST_ASSERT_EQUAL(5, r->msgs[0].len);
+    TEST_ASSERT_EQUAL(2, r->msgs[0].fragments);
+    TEST_ASSERT_EQUAL_MEMORY("Hello", r->msgs[0].data, 5);
+    TEST_ASSERT_EQUAL(1, r->as.stats.control);
+    TEST_ASSERT_EQUAL(1, r->as.stats.fragmented);
+}
+
+/* RFC 6455, 5.7: 256 and 64 KiB binary messages in a single unmasked frame */
+static void test_rfc_extended_lengths(void)
+{
+    static uint8_t stream[4 + 256 + 10 + 65536];
+    size_t n = 0;
+    stream[n++] = 0x82;
+    stream[n++] = 0x7E;
+    stream[n++] = 0x01;
+    stream[n++] = 0x00;
+    for (int i = 0; i < 256; i++) {
+        stream[n++] = (uint8_t)i;
+    }
+    const uint8_t hdr64[] = {0x82, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00};
+    memcpy(&stream[n], hdr64, sizeof(hdr64));
+    n += sizeof(hdr64);
+    for (int i = 0; i < 65536; i++) {
+        stream[n++] = (uint8_t)(i * 3);
+    }
+
+    replay_t *r = replay_all_chunkings(stream, n, 2);
+    TEST_ASSERT_EQUAL(256, r->msgs[0].len);
+    TEST_ASSERT_EQUAL(65536, r->msgs[1].len);
+    TEST_ASSERT_EQUAL(WS_OPCODE_BINARY, r->msgs[1].opcode);
+    TEST_ASSERT(r->msgs[1].data == r->binary_buf);
+    TEST_ASSERT_EQUAL((uint8_t)(65535 * 3), r->binary_buf[65535]);
+}
+
+/* Masked client traffic as sent by JunctionRelay: a blit_config text message
+ * followed by a 48x48 RGB565 frame split over three continuation frames */
+static void test_client_session(void)
+{
+    static const char config[] = "{\"type\":\"blit_config\",\"frameWidth\":48,\"frameHeight\":48}";
+    static const uint8_t key[4] = {0x12, 0x34, 0x56, 0x78};
+    static uint8_t stream[1024 + 48 * 48 * 2];
+    const size_t frame_len = 48 * 48 * 2;
+    const size_t parts[] = {1000, 1000, frame_len - 2000};
+    size_t n = 0;
+
+    stream[n++] = 0x81;
+    stream[n++] = 0x80 | (uint8_t)(sizeof(config) - 1);
+    memcpy(&stream[n], key, 4);
+    n += 4;
+    for (size_t i = 0; i < sizeof(config) - 1; i++) {
+        stream[n++] = (uint8_t)config[i] ^ key[i & 3];
+    }
+
+    size_t off = 0;
+    for (int p = 0; p < 3; p++) {
+        stream[n++] = (p == 0 ? 0x02 : 0x00) | (p == 2 ? 0x80 : 0x00);
+        stream[n++] = 0x80 | 0x7E;
+        stream[n++] = (uint8_t)(parts[p] >> 8);
+        stream[n++] = (uint8_t)parts[p];
+        memcpy(&stream[n], key, 4);
+        n += 4;
+        for (size_t i = 0; i < parts[p]; i++) {
+            stream[n++] = (uint8_t)(off + i) ^ key[i & 3];
+        }
+        off += parts[p];
+    }
+
+    replay_t *r = replay_all_chunkings(stream, n, 2);
+    TEST_ASSERT_EQUAL(WS_OPCODE_TEXT, r->msgs[0].opcode);
+    TEST_ASSERT_EQUAL(sizeof(config) - 1, r->msgs[0].len);
+    TEST_ASSERT_EQUAL_MEMORY(config, r->msgs[0].data, sizeof(config) - 1);
+    TEST_ASSERT_EQUAL(WS_OPCODE_BINARY, r->msgs[1].opcode);
+    TEST_ASSERT_EQUAL(frame_len, r->msgs[1].len);
+    TEST_ASSERT_EQUAL(3, r->msgs[1].fragments);
+    for (size_t i = 0; i < frame_len; i++) {
+        TEST_ASSERT_EQUAL((uint8_t)i, r->binary_buf[i]);
+    }
+}
+
+static void test_header_needs_more_bytes(void)
+{
+    static const uint8_t hdr[] = {0x82, 0xFF, 0, 0, 0, 0, 0, 0, 0x10, 0x00, 1, 2, 3, 4};
+    ws_frame_hdr_t h;
+    for (size_t i = 0; i < sizeof(hdr); i++) {
+        TEST_ASSERT_EQUAL(0, ws_frame_parse_header(hdr, i, &h));
+    }
+    TEST_ASSERT_EQUAL(14, ws_frame_parse_header(hdr, sizeof(hdr), &h));
+    TEST_ASSERT_EQUAL(4096, h.payload_len);
+    TEST_ASSERT_TRUE(h.masked);
+    TEST_ASSERT_EQUAL(4, h.mask_key[3]);
+}
+
+static void test_malformed_headers(void)
+{
+    ws_frame_hdr_t h;
+    static const uint8_t rsv[] = {0xC1, 0x00};
+    static const uint8_t len_msb[] = {0x82, 0x7F, 0x80, 0, 0, 0, 0, 0, 0, 0};
+    TEST_ASSERT_EQUAL(-1, ws_frame_parse_header(rsv, sizeof(rsv), &h));
+    TEST_ASSERT_EQUAL(-1, ws_frame_parse_header(len_msb, sizeof(len_msb), &h));
+}
+
+static void test_fragmentation_errors(void)
+{
+    ws_assembler_t as;
+    uint8_t buf[16];
+
+    ws_assembler_init(&as);
+    TEST_ASSERT_EQUAL(WS_ASM_PROTOCOL_ERROR, ws_assembler_frame(&as, WS_OPCODE_CONTINUATION, true, 1));
+
+    TEST_ASSERT_EQUAL(WS_ASM_START, ws_assembler_frame(&as, WS_OPCODE_TEXT, false, 4));
+    TEST_ASSERT_TRUE(ws_assembler_attach(&as, buf, sizeof(buf)));
+    ws_message_t msg;
+    TEST_ASSERT_FALSE(ws_assembler_frame_done(&as, &msg));
+    TEST_ASSERT_EQUAL(WS_ASM_PROTOCOL_ERROR, ws_assembler_frame(&as, WS_OPCODE_BINARY, true, 4));
+    TEST_ASSERT_EQUAL(WS_ASM_PROTOCOL_ERROR, ws_assembler_frame(&as, WS_OPCODE_PING, false, 0));
+    TEST_ASSERT_EQUAL(WS_ASM_PROTOCOL_ERROR, ws_assembler_frame(&as, WS_OPCODE_PING, true, 126));
+    TEST_ASSERT_EQUAL(WS_ASM_PROTOCOL_ERROR, ws_assembler_frame(&as, (ws_opcode_t)0x3, true, 0));
+    TEST_ASSERT_EQUAL(WS_ASM_TOO_LARGE, ws_assembler_frame(&as, WS_OPCODE_CONTINUATION, true, 13));
+    TEST_ASSERT(ws_assembler_abort(&as) == buf);
+    TEST_ASSERT_EQUAL(5, as.stats.protocol_errors);
+    TEST_ASSERT_EQUAL(1, as.stats.too_large);
+
+    // After the abort a new message starts cleanly
+    TEST_ASSERT_EQUAL(WS_ASM_START, ws_assembler_frame(&as, WS_OPCODE_BINARY, true, 17));
+    TEST_ASSERT_FALSE(ws_assembler_attach(&as, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(WS_ASM_START, ws_assembler_frame(&as, WS_OPCODE_BINARY, true, 16));
+    TEST_ASSERT_TRUE(ws_assembler_attach(&as, buf, sizeof(buf)));
+    TEST_ASSERT_TRUE(ws_assembler_frame_done(&as, &msg));
+    TEST_ASSERT_EQUAL(16, msg.len);
+    TEST_ASSERT_EQUAL(1, as.stats.messages);
+}
+
+int main(void)
+{
+    RUN_TEST(test_rfc_unmasked_text);
+    RUN_TEST(test_rfc_masked_text);
+    RUN_TEST(test_rfc_fragmented_text_with_ping);
+    RUN_TEST(test_rfc_extended_lengths);
+    RUN_TEST(test_client_session);
+    RUN_TEST(test_header_needs_more_bytes);
+    RUN_TEST(test_malformed_headers);
+    RUN_TEST(test_fragmentation_errors);
+    return TEST_REPORT();
+}
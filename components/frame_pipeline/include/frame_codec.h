@@ -0,0 +1,62 @@
+/**
+ * @file
+ * @brief Decoding of compressed frame payloads
+ *
+ * blit_config.frameFormat selects how full frames are encoded on the wire.
+ * Compressed frames are decoded straight into a frame_pool slot with the
+ * LZ4 and RLE decoders LVGL ships (src/libs/lz4, src/libs/rle), so
+ * LV_USE_LZ4 and LV_USE_RLE have to be enabled for the respective format.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Encoding of a full frame
+ */
+typedef enum {
+    FRAME_FORMAT_RGB565 = 0,    /*!< "rgb565": raw, 2 bytes per pixel */
+    FRAME_FORMAT_RGB565_LZ4,    /*!< "rgb565-lz4": one LZ4 block */
+    FRAME_FORMAT_RGB565_RLE,    /*!< "rgb565-rle": LVGL RLE with 2 byte blocks */
+} frame_format_t;
+
+/**
+ * @brief Look up a frameFormat name
+ *
+ * @return false for NULL or unknown names, `format` is left untouched then
+ */
+bool frame_format_parse(const char *name, frame_format_t *format);
+
+/**
+ * @brief frameFormat name of a format
+ */
+const char *frame_format_name(frame_format_t format);
+
+/**
+ * @brief True if frames of this format have to go through frame_codec_decode()
+ */
+bool frame_format_is_compressed(frame_format_t format);
+
+/**
+ * @brief True if the decoder for this format is compiled in
+ */
+bool frame_codec_supported(frame_format_t format);
+
+/**
+ * @brief Decode a compressed frame into `dst`
+ *
+ * @return Decoded bytes; 0 on corrupt input, an unsupported format or a frame
+ *         that does not fit into `capacity`
+ */
+size_t frame_codec_decode(frame_format_t format, const uint8_t *src, size_t len, uint8_t *dst, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
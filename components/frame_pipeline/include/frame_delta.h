@@ -0,0 +1,125 @@
+/**
+ * @file
+ * @brief Dirty-rectangle delta frames
+ *
+ * Instead of a whole RGB565 frame the sender ships only the rectangles that
+ * changed since the previous frame. The device keeps a persistent full-frame
+ * canvas, patches the rectangles into it and redraws only those areas.
+ *
+ * Wire format, all fields little-endian:
+ * @code
+ * offset  size  field
+ *      0     4  magic "JRDF"
+ *      4     1  version (FRAME_DELTA_VERSION)
+ *      5     1  format (frame_delta_format_t)
+ *      6     2  rect_count
+ *      8     4  seq, incremented by one per delta frame
+ *     12     2  width  of the full frame the rectangles belong to
+ *     14     2  height of the full frame
+ *     16   8*n  rect_count times { uint16 x, y, w, h }
+ *      .     .  pixels of every rectangle, row by row, in rect order
+ * @endcode
+ *
+ * A rectangle covering the whole frame is a key frame, and so are
+ * rectangles tiling it in bands from top to bottom, each band filled left to
+ * right with rectangles of its height. The sender starts with a key frame and
+ * sends another whenever the device may have missed a delta.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_DELTA_MAGIC       "JRDF"  /*!< First four bytes of every delta frame */
+#define FRAME_DELTA_VERSION     1       /*!< Header version this code understands */
+#define FRAME_DELTA_HEADER_LEN  16      /*!< Header length without the rect list */
+#define FRAME_DELTA_RECT_LEN    8       /*!< Length of one rect list entry */
+
+/**
+ * @brief Pixel encoding of the rectangle data
+ */
+typedef enum {
+    FRAME_DELTA_FORMAT_RGB565 = 0,      /*!< Raw RGB565, 2 bytes per pixel */
+} frame_delta_format_t;
+
+/**
+ * @brief Outcome of parsing a delta frame
+ */
+typedef enum {
+    FRAME_DELTA_OK = 0,                 /*!< Valid delta frame */
+    FRAME_DELTA_NOT_DELTA,              /*!< No delta magic, e.g. a plain full frame */
+    FRAME_DELTA_TRUNCATED,              /*!< Header or rect list cut short */
+    FRAME_DELTA_BAD_VERSION,            /*!< Unknown header version */
+    FRAME_DELTA_BAD_FORMAT,             /*!< Unknown pixel format */
+    FRAME_DELTA_BAD_RECT,               /*!< Empty rectangle or one outside the frame */
+    FRAME_DELTA_SIZE_MISMATCH,          /*!< Pixel data does not match the rectangles */
+} frame_delta_status_t;
+
+/**
+ * @brief One rectangle, in pixels of the full frame
+ */
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+} frame_rect_t;
+
+/**
+ * @brief A parsed delta frame, pointing into the received message
+ */
+typedef struct {
+    uint32_t seq;                       /*!< Sequence number */
+    frame_delta_format_t format;        /*!< Pixel format */
+    uint16_t width;                     /*!< Full frame width */
+    uint16_t height;                    /*!< Full frame height */
+    uint16_t rect_count;                /*!< Number of rectangles */
+    const uint8_t *rects;               /*!< Raw rect list, read it with frame_delta_rect() */
+    const uint8_t *pixels;              /*!< Pixel data of all rectangles */
+    size_t pixels_len;                  /*!< Bytes of pixel data */
+} frame_delta_t;
+
+/**
+ * @brief True if `data` starts with the delta frame magic
+ */
+bool frame_delta_is_delta(const uint8_t *data, size_t len);
+
+/**
+ * @brief Parse and validate a delta frame
+ *
+ * Every rectangle is checked against the frame size and the pixel data must
+ * match the rectangles exactly, so frame_delta_apply() never writes outside
+ * the canvas.
+ */
+frame_delta_status_t frame_delta_parse(const uint8_t *data, size_t len, frame_delta_t *delta);
+
+/**
+ * @brief Rectangle `index` of a parsed delta frame
+ */
+frame_rect_t frame_delta_rect(const frame_delta_t *delta, size_t index);
+
+/**
+ * @brief True if the delta repaints the whole frame
+ *
+ * Either with a single rectangle or with rectangles tiling it in bands, see
+ * the wire format above.
+ */
+bool frame_delta_is_key(const frame_delta_t *delta);
+
+/**
+ * @brief Copy the rectangles into a canvas of delta->width x delta->height pixels
+ *
+ * @param canvas Top left pixel of the canvas
+ * @param stride Bytes per canvas row
+ */
+void frame_delta_apply(const frame_delta_t *delta, uint8_t *canvas, size_t stride);
+
+#ifdef __cplusplus
+}
+#endif
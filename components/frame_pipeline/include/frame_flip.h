@@ -0,0 +1,117 @@
+/**
+ * @file
+ * @brief Page flipping between the frame buffers of a panel
+ *
+ * Full-screen frames in the panel's own format can skip LVGL and be written
+ * straight into a frame buffer the panel scans out from. frame_flip keeps
+ * track of which buffer is scanned out (front), which one was presented but
+ * is only picked up at the next vsync (pending), and hands out a third one to
+ * write into. With three buffers writing never waits; with two it waits for
+ * the pending buffer to become the front one; a single buffer is written
+ * while it is scanned out and may tear.
+ *
+ * The panel itself sits behind frame_panel_t so the flip logic builds and is
+ * tested on the host without ESP-IDF. Not thread safe, the buffers are meant
+ * to be written by one task.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_FLIP_MAX_BUFFERS 3    /*!< Upper bound of frame_flip_config_t::buffer_count */
+
+/**
+ * @brief Panel the buffers belong to
+ */
+typedef struct {
+    /**
+     * Scan `buffer` out from the next vsync on. Also responsible for making
+     * CPU writes to the buffer visible to the panel (cache write back).
+     */
+    void (*present)(void *ctx, uint8_t *buffer, size_t size);
+    /**
+     * Wait until the panel has refreshed at least once since the last
+     * present(). Returns false if that did not happen within timeout_ms,
+     * a timeout of 0 only polls.
+     */
+    bool (*wait_vsync)(void *ctx, uint32_t timeout_ms);
+    void *ctx;                                  /*!< Passed to the callbacks */
+} frame_panel_t;
+
+/**
+ * @brief Flip configuration
+ */
+typedef struct {
+    frame_panel_t panel;                        /*!< Panel callbacks */
+    uint8_t *buffers[FRAME_FLIP_MAX_BUFFERS];   /*!< Frame buffers owned by the panel */
+    size_t buffer_count;                        /*!< Number of buffers, 1..FRAME_FLIP_MAX_BUFFERS */
+    size_t buffer_size;                         /*!< Bytes per buffer */
+    size_t front;                               /*!< Index of the buffer scanned out at creation */
+    uint32_t vsync_timeout_ms;                  /*!< Longest wait for a vsync before giving up */
+} frame_flip_config_t;
+
+/**
+ * @brief Flip counters
+ */
+typedef struct {
+    uint32_t flips;                             /*!< Buffers presented */
+    uint32_t vsync_waits;                       /*!< Times writing or presenting had to wait for a vsync */
+    uint32_t vsync_timeouts;                    /*!< Vsync waits that timed out */
+    uint32_t dropped;                           /*!< frame_flip_begin() calls without a free buffer */
+} frame_flip_stats_t;
+
+typedef struct frame_flip_s frame_flip_t;
+
+/**
+ * @brief Create the flip state for the panel's buffers
+ *
+ * @return NULL on an invalid configuration or out of memory
+ */
+frame_flip_t *frame_flip_create(const frame_flip_config_t *cfg);
+
+/**
+ * @brief Free the flip state, the buffers stay with the panel
+ */
+void frame_flip_delete(frame_flip_t *flip);
+
+/**
+ * @brief Get a buffer that is neither scanned out nor waiting to be
+ *
+ * Waits for a vsync if every other buffer is busy. Each successful call must
+ * be followed by frame_flip_end().
+ *
+ * @return Buffer of frame_flip_config_t::buffer_size bytes, NULL if the vsync
+ *         wait timed out
+ */
+uint8_t *frame_flip_begin(frame_flip_t *flip);
+
+/**
+ * @brief Present the buffer from frame_flip_begin() at the next vsync
+ *
+ * Waits for the previously presented buffer to be scanned out first, so no
+ * frame is skipped.
+ */
+void frame_flip_end(frame_flip_t *flip);
+
+/**
+ * @brief Copy a complete frame into a free buffer and present it
+ *
+ * @return false if `len` is not the buffer size or no buffer became free
+ */
+bool frame_flip_show(frame_flip_t *flip, const uint8_t *frame, size_t len);
+
+/**
+ * @brief Read the counters
+ */
+void frame_flip_get_stats(frame_flip_t *flip, frame_flip_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
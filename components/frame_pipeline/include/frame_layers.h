@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @brief Z-ordered screen layers shared by several frame senders
+ *
+ * Every sender (a dashboard, an alert overlay, ...) draws into a layer of its
+ * own. A layer is identified by its z-order, higher layers are composited on
+ * top of lower ones, and covers a region of the screen or all of it. A
+ * sender claims a layer with its blit_config and owns it until it claims
+ * another one or disconnects; nobody else can draw into it meanwhile.
+ *
+ * The table is plain data: the receiving side claims and releases layers,
+ * the display side works from a copy of it (see frame_compositor). Not
+ * thread safe, no ESP-IDF dependencies.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_LAYERS_MAX        8   /*!< Layers, z-orders 0..FRAME_LAYERS_MAX - 1 */
+#define FRAME_LAYERS_NO_OWNER   0   /*!< Owner of a free layer, never a valid client id */
+
+/**
+ * @brief Rectangle on the screen, in pixels
+ *
+ * A width or height of 0 means the whole screen.
+ */
+typedef struct {
+    uint32_t x;                 /*!< Left edge */
+    uint32_t y;                 /*!< Top edge */
+    uint32_t width;             /*!< Width, 0 for the whole screen */
+    uint32_t height;            /*!< Height, 0 for the whole screen */
+} frame_region_t;
+
+/**
+ * @brief One layer
+ */
+typedef struct {
+    uint32_t owner;             /*!< Client id of the owner, FRAME_LAYERS_NO_OWNER if free */
+    frame_region_t region;      /*!< Where on the screen, clipped to it */
+    uint32_t generation;        /*!< Changes whenever the layer is claimed anew or moved */
+} frame_layer_t;
+
+/**
+ * @brief All layers of one screen
+ */
+typedef struct {
+    frame_layer_t layers[FRAME_LAYERS_MAX];     /*!< Indexed by z-order */
+    uint32_t screen_width;                      /*!< Screen size the regions are clipped to */
+    uint32_t screen_height;
+    uint32_t generation;                        /*!< Source of frame_layer_t::generation */
+} frame_layers_t;
+
+/**
+ * @brief Result of frame_layers_claim()
+ */
+typedef enum {
+    FRAME_LAYERS_OK = 0,
+    FRAME_LAYERS_BAD_LAYER,     /*!< z-order out of range */
+    FRAME_LAYERS_BUSY,          /*!< Layer owned by another client */
+    FRAME_LAYERS_OFF_SCREEN,    /*!< Region entirely off the screen */
+} frame_layers_status_t;
+
+/**
+ * @brief Start with every layer free
+ */
+void frame_layers_init(frame_layers_t *layers, uint32_t screen_width, uint32_t screen_height);
+
+/**
+ * @brief Claim layer `z` for client `owner`, or move it if the client already owns it
+ *
+ * A client owns one layer at a time, claiming another one gives up the one it
+ * had. The region is clipped to the screen; a whole-screen region is stored
+ * as the screen size.
+ *
+ * @param region NULL for the whole screen
+ */
+frame_layers_status_t frame_layers_claim(frame_layers_t *layers, uint8_t z, uint32_t owner,
+                                         const frame_region_t *region);
+
+/**
+ * @brief Give up every layer `owner` owns, e.g. when it disconnects
+ *
+ * @return Layers freed
+ */
+size_t frame_layers_release(frame_layers_t *layers, uint32_t owner);
+
+/**
+ * @brief Whether layer `z` is owned by anyone
+ */
+bool frame_layers_in_use(const frame_layers_t *layers, uint8_t z);
+
+/**
+ * @brief Layers owned by anyone
+ */
+size_t frame_layers_count(const frame_layers_t *layers);
+
+/**
+ * @brief Position of layer `z` in the stack, bottom first: the layers in use below it
+ */
+size_t frame_layers_stack_index(const frame_layers_t *layers, uint8_t z);
+
+/**
+ * @brief Name of a status, for logs and replies
+ */
+const char *frame_layers_status_name(frame_layers_status_t status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,200 @@
+/**
+ * @file
+ * @brief Message envelope and dispatch table
+ *
+ * Senders put every message in a small envelope that says what it is, so the
+ * device never has to guess from the payload bytes. Envelopes go in binary
+ * WebSocket messages or POST bodies. Wire format, all fields little-endian:
+ * @code
+ * offset  size  field
+ *      0     4  magic "JRMS"
+ *      4     1  version (FRAME_MSG_VERSION)
+ *      5     1  type (frame_msg_type_t)
+ *      6     2  reserved, 0
+ *      8     4  seq, echoed in the frame-ack of a frame
+ *     12     4  payload length, the rest of the message
+ *     16     .  payload
+ * @endcode
+ *
+ * Messages without an envelope still work: text messages are typed by
+ * frame_msg_from_text(), which reads the "type" member of a JSON object
+ * without parsing the rest, and binary ones are frames. Either way the
+ * result is a frame_msg_t that a frame_msg_dispatcher_t hands to the
+ * handler registered for its type.
+ *
+ * The JSON config messages are read with json_pull, straight out of the
+ * payload and without allocating; sensor messages go to a sensor_table.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "frame_layers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_MSG_MAGIC         "JRMS"  /*!< First four bytes of every envelope */
+#define FRAME_MSG_VERSION       1       /*!< Envelope version this code understands */
+#define FRAME_MSG_HEADER_LEN    16      /*!< Envelope header length */
+#define FRAME_MSG_NAME_LEN      32      /*!< Longest config string kept, plus the terminating NUL */
+
+/**
+ * @brief Message types, the values are part of the wire format
+ */
+typedef enum {
+    FRAME_MSG_NONE = 0,                 /*!< Not a valid type */
+    FRAME_MSG_FRAME = 1,                /*!< Full frame in the configured format, or a delta frame */
+    FRAME_MSG_BLIT_CONFIG = 2,          /*!< JSON "blit_config": frame format and size */
+    FRAME_MSG_SCREEN_CONFIG = 3,        /*!< JSON "config" or "rive_config" */
+    FRAME_MSG_SENSOR = 4,               /*!< JSON "sensor" or "rive_sensor" */
+    FRAME_MSG_PING = 5,                 /*!< Answered with "pong" */
+    FRAME_MSG_TEXT = 6,                 /*!< Any other text */
+    FRAME_MSG_TYPE_COUNT,
+} frame_msg_type_t;
+
+/**
+ * @brief Outcome of parsing an envelope
+ */
+typedef enum {
+    FRAME_MSG_OK = 0,                   /*!< Valid envelope */
+    FRAME_MSG_NOT_ENVELOPE,             /*!< No envelope magic, e.g. a bare frame */
+    FRAME_MSG_TRUNCATED,                /*!< Header cut short */
+    FRAME_MSG_BAD_VERSION,              /*!< Unknown envelope version */
+    FRAME_MSG_BAD_TYPE,                 /*!< Unknown message type or reserved bits set */
+    FRAME_MSG_SIZE_MISMATCH,            /*!< Payload length does not match the message */
+} frame_msg_status_t;
+
+/**
+ * @brief A typed message, pointing into the received data
+ */
+typedef struct {
+    frame_msg_type_t type;              /*!< What the payload is */
+    uint32_t seq;                       /*!< Sequence number, 0 if the sender gave none */
+    const uint8_t *payload;             /*!< Message without the envelope */
+    size_t len;                         /*!< Bytes of payload */
+} frame_msg_t;
+
+/**
+ * @brief Members of a "blit_config" message
+ */
+typedef struct {
+    char mode[FRAME_MSG_NAME_LEN];          /*!< "mode", empty if absent */
+    char format[FRAME_MSG_NAME_LEN];        /*!< "frameFormat", empty if absent */
+    char description[FRAME_MSG_NAME_LEN * 2];   /*!< "description", cut off if longer, empty if absent */
+    uint32_t width;                         /*!< "frameWidth", 0 if absent */
+    uint32_t height;                        /*!< "frameHeight", 0 if absent */
+    uint32_t size;                          /*!< "frameSize", 0 if absent */
+    bool has_layer;                         /*!< "layer" is present */
+    uint32_t layer;                         /*!< "layer": z-order of the sender's frames, higher on top; UINT32_MAX if not a number */
+    frame_region_t region;                  /*!< "region": {"x","y","width","height"}, all 0 for the whole screen */
+} frame_blit_config_t;
+
+/**
+ * @brief Members of a "config" message
+ */
+typedef struct {
+    char screen_id[FRAME_MSG_NAME_LEN * 2]; /*!< "screenId", cut off if longer, empty if absent */
+    bool has_layout;                        /*!< "layout" is present, as a string or null */
+    const char *layout;                     /*!< Raw bytes of the "layout" string in the payload, NULL for null */
+    size_t layout_len;                      /*!< Length of layout; json_pull_unescape() it into a buffer of layout_len + 1 */
+} frame_screen_config_t;
+
+/**
+ * @brief Handler of one message type
+ *
+ * @param ctx Passed through from frame_msg_dispatch()
+ */
+typedef void (*frame_msg_handler_t)(const frame_msg_t *msg, void *ctx);
+
+/**
+ * @brief Handlers indexed by message type
+ *
+ * Not thread safe, meant to be used by the task that receives the messages.
+ */
+typedef struct {
+    frame_msg_handler_t handlers[FRAME_MSG_TYPE_COUNT];     /*!< NULL: messages of the type are dropped */
+    uint32_t dispatched[FRAME_MSG_TYPE_COUNT];              /*!< Messages handed to each handler */
+    uint32_t unhandled;                                     /*!< Messages without a handler */
+} frame_msg_dispatcher_t;
+
+/**
+ * @brief True if `data` starts with the envelope magic
+ */
+bool frame_msg_is_envelope(const uint8_t *data, size_t len);
+
+/**
+ * @brief Parse and validate an envelope
+ */
+frame_msg_status_t frame_msg_parse(const uint8_t *data, size_t len, frame_msg_t *msg);
+
+/**
+ * @brief Write an envelope header for a payload of `payload_len` bytes
+ *
+ * @return FRAME_MSG_HEADER_LEN, or 0 if `size` is too small or the type invalid
+ */
+size_t frame_msg_write_header(uint8_t *buf, size_t size, frame_msg_type_t type, uint32_t seq,
+                              uint32_t payload_len);
+
+/**
+ * @brief Type a text message that came without an envelope
+ *
+ * "ping" is a ping, a JSON object is typed by its top-level "type" string,
+ * anything else including malformed JSON is FRAME_MSG_TEXT. Only the members
+ * before "type" are scanned, the rest is left to the handler.
+ */
+void frame_msg_from_text(const char *text, size_t len, frame_msg_t *msg);
+
+/**
+ * @brief Read a "blit_config" message
+ *
+ * Members of the wrong type are ignored like absent ones, numbers out of the
+ * uint32_t range as well.
+ *
+ * @return false if the payload is not a well-formed JSON object
+ */
+bool frame_msg_parse_blit_config(const frame_msg_t *msg, frame_blit_config_t *config);
+
+/**
+ * @brief Read a "config" message
+ *
+ * @return false if the payload is not a well-formed JSON object
+ */
+bool frame_msg_parse_screen_config(const frame_msg_t *msg, frame_screen_config_t *config);
+
+/**
+ * @brief Type of a JSON "type" name, FRAME_MSG_TEXT for unknown names
+ */
+frame_msg_type_t frame_msg_type_from_name(const char *name, size_t len);
+
+/**
+ * @brief Name of a type for logging
+ */
+const char *frame_msg_type_name(frame_msg_type_t type);
+
+/**
+ * @brief Clear all handlers and counters
+ */
+void frame_msg_dispatcher_init(frame_msg_dispatcher_t *dispatcher);
+
+/**
+ * @brief Register the handler of one type, replacing any previous one
+ *
+ * @return false for an invalid type
+ */
+bool frame_msg_dispatcher_set(frame_msg_dispatcher_t *dispatcher, frame_msg_type_t type,
+                              frame_msg_handler_t handler);
+
+/**
+ * @brief Call the handler registered for msg->type
+ *
+ * @return false if there is none
+ */
+bool frame_msg_dispatch(frame_msg_dispatcher_t *dispatcher, const frame_msg_t *msg, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
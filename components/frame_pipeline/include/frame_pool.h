@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @brief Fixed pool of preallocated frame buffers
+ *
+ * The pool owns a small number of equally sized, cache-line aligned slots.
+ * The receive path acquires a slot and writes the incoming payload straight
+ * into it, the display path releases the slot once the frame is no longer
+ * referenced. After creation no memory is allocated or freed.
+ *
+ * Acquire and release are lock-free and may be called from different tasks.
+ * The module has no ESP-IDF dependencies so it can be tested on the host.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_POOL_MAX_SLOTS        32  /*!< Upper bound of frame_pool_config_t::slot_count */
+#define FRAME_POOL_DEFAULT_ALIGN    64  /*!< Alignment used when frame_pool_config_t::alignment is 0 */
+
+/**
+ * @brief One preallocated frame buffer
+ */
+typedef struct {
+    uint8_t    *data;       /*!< Slot memory, aligned to the pool alignment until frame_slot_skip() */
+    size_t      capacity;   /*!< Usable bytes in data */
+    size_t      size;       /*!< Bytes of valid payload */
+    uint16_t    width;      /*!< Frame width in pixels */
+    uint16_t    height;     /*!< Frame height in pixels */
+    uint32_t    seq;        /*!< Sequence number assigned by the producer */
+    int64_t     recv_start_us;  /*!< When reception of the frame started, for frame_stats */
+    int64_t     queued_us;  /*!< When the frame was handed to the display, for frame_stats */
+    uint8_t     layer;      /*!< Screen layer the frame goes to, see frame_layers.h */
+    bool        self_contained; /*!< Full frame or key delta, needs no earlier frame of its layer */
+    uint8_t     index;      /*!< Position of the slot inside the pool */
+} frame_slot_t;
+
+/**
+ * @brief Pool configuration
+ */
+typedef struct {
+    size_t  slot_count;     /*!< Number of slots, 1..FRAME_POOL_MAX_SLOTS */
+    size_t  slot_size;      /*!< Bytes per slot, rounded up to the alignment */
+    size_t  alignment;      /*!< Power of two alignment of every slot (0: FRAME_POOL_DEFAULT_ALIGN) */
+    void *(*alloc)(size_t alignment, size_t size, void *user_ctx); /*!< Backing allocator (NULL: aligned_alloc) */
+    void (*free)(void *ptr, void *user_ctx);                        /*!< Backing deallocator (NULL: free) */
+    void   *user_ctx;       /*!< Passed to alloc and free */
+} frame_pool_config_t;
+
+/**
+ * @brief Pool counters
+ */
+typedef struct {
+    uint32_t acquired;      /*!< Successful acquires */
+    uint32_t released;      /*!< Releases */
+    uint32_t exhausted;     /*!< Acquires that failed because every slot was in use */
+    uint32_t in_use;        /*!< Slots currently held */
+    uint32_t peak_in_use;   /*!< Highest value of in_use seen so far */
+} frame_pool_stats_t;
+
+typedef struct frame_pool_s frame_pool_t;
+
+/**
+ * @brief Allocate the pool and all of its slots
+ *
+ * @param cfg Pool configuration
+ * @return Pool or NULL when the configuration is invalid or memory is short
+ */
+frame_pool_t *frame_pool_create(const frame_pool_config_t *cfg);
+
+/**
+ * @brief Free the pool and all of its slots
+ *
+ * @note No slot may be in use.
+ */
+void frame_pool_delete(frame_pool_t *pool);
+
+/**
+ * @brief Take a free slot
+ *
+ * The returned slot has size, width, height, seq and the timestamps cleared,
+ * and data and capacity cover the whole slot again.
+ *
+ * @return Slot or NULL when all slots are in use (counted as exhausted)
+ */
+frame_slot_t *frame_pool_acquire(frame_pool_t *pool);
+
+/**
+ * @brief Give a slot back to the pool
+ *
+ * @return false if the slot does not belong to the pool or was already free
+ */
+bool frame_pool_release(frame_pool_t *pool, frame_slot_t *slot);
+
+/**
+ * @brief Drop the first `len` bytes of the payload, e.g. a message header
+ *
+ * Moves data past them instead of copying the rest down, capacity and size
+ * shrink accordingly. Undone when the slot is acquired again.
+ *
+ * @return false if `len` is more than the slot holds
+ */
+bool frame_slot_skip(frame_slot_t *slot, size_t len);
+
+/**
+ * @brief Number of slots in the pool
+ */
+size_t frame_pool_slot_count(const frame_pool_t *pool);
+
+/**
+ * @brief Usable bytes of every slot
+ */
+size_t frame_pool_slot_size(const frame_pool_t *pool);
+
+/**
+ * @brief Snapshot of the pool counters
+ */
+void frame_pool_get_stats(frame_pool_t *pool, frame_pool_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,108 @@
+/**
+ * @file
+ * @brief Latest-frame-wins handoff of frame_pool slots from receiver to display
+ *
+ * A bounded ring of slot pointers between one producer (the receive path)
+ * and one consumer (the display task). Pushing into a full ring evicts the
+ * oldest frame instead of refusing the newest, so a live display never falls
+ * behind by more than the ring capacity. The evicted slot is handed back to
+ * the producer, which recycles it.
+ *
+ * frame_ring_pop() claims the oldest frame with a compare-and-swap, so besides
+ * the consumer the producer may call it too, e.g. to steal the oldest queued
+ * frame's buffer when the pool has run dry. Lock-free, no ESP-IDF
+ * dependencies.
+ *
+ * A delta frame is useless without the frames of its layer before it, so the
+ * producer can also ask for the oldest frame only if it is stale: a newer
+ * self-contained frame of its layer is queued, which the display would skip
+ * to anyway. See frame_ring_push_if_stale() and frame_ring_pop_stale().
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "frame_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_RING_MAX_CAPACITY 32  /*!< Upper bound of the ring capacity */
+
+/**
+ * @brief Ring counters
+ */
+typedef struct {
+    uint32_t pushed;        /*!< Frames queued */
+    uint32_t popped;        /*!< Frames taken out with frame_ring_pop() */
+    uint32_t evicted;       /*!< Frames pushed out of a full ring by a newer one */
+    uint32_t stale_taken;   /*!< Frames taken out with frame_ring_pop_stale() */
+    uint32_t refused;       /*!< Frames not queued by frame_ring_push_if_stale() */
+} frame_ring_stats_t;
+
+typedef struct frame_ring_s frame_ring_t;
+
+/**
+ * @brief Create an empty ring
+ *
+ * @param capacity Frames the ring holds, 1..FRAME_RING_MAX_CAPACITY
+ * @return NULL on a bad capacity or out of memory
+ */
+frame_ring_t *frame_ring_create(size_t capacity);
+
+/**
+ * @brief Free the ring, slots still queued are not released
+ */
+void frame_ring_delete(frame_ring_t *ring);
+
+/**
+ * @brief Queue a frame, producer only
+ *
+ * @return The oldest frame if the ring was full and it had to make room (now
+ *         owned by the caller), NULL otherwise
+ */
+frame_slot_t *frame_ring_push(frame_ring_t *ring, frame_slot_t *slot);
+
+/**
+ * @brief Queue a frame unless the ring is full of frames the display still needs, producer only
+ *
+ * Like frame_ring_push(), but a full ring evicts its oldest frame only if it
+ * is stale. Otherwise the new frame is refused.
+ *
+ * @param[out] evicted The stale frame that made room (now owned by the
+ *                     caller), NULL if there was room anyway
+ * @return false if slot was not queued and is still owned by the caller
+ */
+bool frame_ring_push_if_stale(frame_ring_t *ring, frame_slot_t *slot, frame_slot_t **evicted);
+
+/**
+ * @brief Take the oldest queued frame if it is stale, producer only
+ *
+ * @return Slot now owned by the caller, NULL if the oldest frame is still
+ *         needed or the ring is empty
+ */
+frame_slot_t *frame_ring_pop_stale(frame_ring_t *ring);
+
+/**
+ * @brief Take the oldest queued frame
+ *
+ * @return Slot now owned by the caller, NULL if the ring is empty
+ */
+frame_slot_t *frame_ring_pop(frame_ring_t *ring);
+
+/**
+ * @brief Frames queued at the moment
+ */
+size_t frame_ring_count(frame_ring_t *ring);
+
+/**
+ * @brief Snapshot of the ring counters
+ */
+void frame_ring_get_stats(frame_ring_t *ring, frame_ring_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @file
+ * @brief Chunked receive of one message into a fixed destination buffer
+ *
+ * The transport reads the body of a message in chunks straight into the
+ * destination (usually a frame_pool slot). frame_rx tracks how much is left,
+ * never hands out more room than the destination has, and keeps counters of
+ * complete, truncated and rejected messages.
+ *
+ * Typical use:
+ * @code
+ * frame_rx_t rx;
+ * if (frame_rx_begin(&rx, &stats, slot->data, slot->capacity, content_len) == FRAME_RX_OK) {
+ *     while (!frame_rx_done(&rx)) {
+ *         uint8_t *dst;
+ *         size_t want = frame_rx_next(&rx, &dst, FRAME_RX_DEFAULT_CHUNK);
+ *         int n = transport_read(dst, want);
+ *         if (n <= 0) break;
+ *         frame_rx_commit(&rx, n);
+ *     }
+ *     status = frame_rx_end(&rx);
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_RX_DEFAULT_CHUNK  (32 * 1024)  /*!< Suggested upper bound of a single read */
+
+/**
+ * @brief Outcome of a receive
+ */
+typedef enum {
+    FRAME_RX_OK = 0,            /*!< Message complete (or accepted, for frame_rx_begin) */
+    FRAME_RX_TOO_LARGE,         /*!< Message does not fit into the destination */
+    FRAME_RX_SIZE_MISMATCH,     /*!< Message size differs from the configured frame size */
+    FRAME_RX_INCOMPLETE,        /*!< Transport failed before the whole message arrived */
+} frame_rx_status_t;
+
+/**
+ * @brief Receive counters, shared by all receives of one transport
+ */
+typedef struct {
+    uint32_t complete;          /*!< Messages received completely */
+    uint32_t incomplete;        /*!< Messages aborted mid-way by the transport */
+    uint32_t too_large;         /*!< Messages rejected because they exceeded the destination */
+    uint32_t size_mismatch;     /*!< Frames whose size did not match the configured dimensions */
+    uint64_t bytes;             /*!< Payload bytes written into destinations */
+} frame_rx_stats_t;
+
+/**
+ * @brief State of one receive
+ */
+typedef struct {
+    frame_rx_stats_t *stats;    /*!< Counters to update, may be NULL */
+    uint8_t *dst;               /*!< Destination buffer */
+    size_t   capacity;          /*!< Bytes available in dst */
+    size_t   total;             /*!< Announced message length */
+    size_t   received;          /*!< Bytes written so far */
+} frame_rx_t;
+
+/**
+ * @brief Start receiving a message of `total` bytes into `dst`
+ *
+ * @return FRAME_RX_OK or FRAME_RX_TOO_LARGE (counted in stats)
+ */
+frame_rx_status_t frame_rx_begin(frame_rx_t *rx, frame_rx_stats_t *stats, uint8_t *dst, size_t capacity, size_t total);
+
+/**
+ * @brief Where and how much to read next
+ *
+ * @param[out] dst  Write position
+ * @param max_chunk Upper bound for the returned length (0: no bound)
+ * @return Bytes to read, 0 when the message is complete
+ */
+size_t frame_rx_next(frame_rx_t *rx, uint8_t **dst, size_t max_chunk);
+
+/**
+ * @brief Account for `len` bytes written at the position returned by frame_rx_next()
+ */
+void frame_rx_commit(frame_rx_t *rx, size_t len);
+
+/**
+ * @brief True once all announced bytes arrived
+ */
+bool frame_rx_done(const frame_rx_t *rx);
+
+/**
+ * @brief Finish the receive and update the counters
+ *
+ * @return FRAME_RX_OK or FRAME_RX_INCOMPLETE
+ */
+frame_rx_status_t frame_rx_end(frame_rx_t *rx);
+
+/**
+ * @brief Check the size of a complete frame against the configured dimensions
+ *
+ * @param stats Counters to update, may be NULL
+ * @param size Bytes received
+ * @param expected_size Bytes a frame of the configured dimensions has (0: nothing configured)
+ * @return FRAME_RX_OK or FRAME_RX_SIZE_MISMATCH (counted in stats)
+ */
+frame_rx_status_t frame_rx_check_size(frame_rx_stats_t *stats, size_t size, size_t expected_size);
+
+#ifdef __cplusplus
+}
+#endif
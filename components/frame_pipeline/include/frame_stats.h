@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief Per-stage latency histograms of the frame pipeline
+ *
+ * Every stage a frame passes through (receive, decode, queue, present, LVGL
+ * render and flush, end to end) records its duration into a histogram with
+ * fixed power-of-two buckets. Recording is a handful of atomic adds, cheap
+ * enough to do for every frame from any task, unlike a log line over UART.
+ * The histograms are read out as JSON for the /stats endpoint and the
+ * device-stats WebSocket message.
+ *
+ * No ESP-IDF dependencies; the caller supplies the timestamps.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_STATS_BUCKETS         14      /*!< Buckets per histogram */
+#define FRAME_STATS_FIRST_BOUND_US  256     /*!< Upper bound of the first bucket, each next one doubles */
+
+/**
+ * @brief Pipeline stages
+ */
+typedef enum {
+    FRAME_STAGE_RECV = 0,       /*!< First byte of a message to the last one */
+    FRAME_STAGE_DECODE,         /*!< Decompressing a frame */
+    FRAME_STAGE_QUEUE,          /*!< Waiting in the ring for the display task */
+    FRAME_STAGE_PRESENT,        /*!< Display task handing the frame to the presenter */
+    FRAME_STAGE_RENDER,         /*!< One LVGL refresh, including its flushes */
+    FRAME_STAGE_FLUSH,          /*!< Waiting for the panel to take flushed areas, summed over one LVGL refresh */
+    FRAME_STAGE_TOTAL,          /*!< First byte received to presented */
+    FRAME_STAGE_COUNT,
+} frame_stage_t;
+
+/**
+ * @brief Snapshot of one stage
+ */
+typedef struct {
+    uint32_t count;                             /*!< Samples */
+    uint64_t sum_us;                            /*!< Sum of all samples */
+    uint32_t max_us;                            /*!< Longest sample */
+    uint32_t buckets[FRAME_STATS_BUCKETS];      /*!< Bucket i counts samples below FRAME_STATS_FIRST_BOUND_US << i, the last one everything else */
+} frame_stage_stats_t;
+
+typedef struct frame_stats_s frame_stats_t;
+
+/**
+ * @brief Create zeroed histograms
+ *
+ * @return NULL if out of memory
+ */
+frame_stats_t *frame_stats_create(void);
+
+/**
+ * @brief Free the histograms
+ */
+void frame_stats_delete(frame_stats_t *stats);
+
+/**
+ * @brief Record one sample, safe from any task
+ */
+void frame_stats_record(frame_stats_t *stats, frame_stage_t stage, uint32_t duration_us);
+
+/**
+ * @brief Read one stage
+ */
+void frame_stats_get(frame_stats_t *stats, frame_stage_t stage, frame_stage_stats_t *out);
+
+/**
+ * @brief Clear all stages
+ */
+void frame_stats_reset(frame_stats_t *stats);
+
+/**
+ * @brief JSON name of a stage, e.g. "recv"
+ */
+const char *frame_stage_name(frame_stage_t stage);
+
+/**
+ * @brief Upper bound of the bucket the given percentile falls into
+ *
+ * @param percent 0..100
+ * @return Microseconds, never more than the longest sample; 0 without samples
+ */
+uint32_t frame_stage_percentile_us(const frame_stage_stats_t *stage, unsigned percent);
+
+/**
+ * @brief Write all stages as one JSON object keyed by stage name
+ *
+ * Each stage holds count, meanUs, maxUs, p50Us, p90Us, p99Us and the raw
+ * buckets array. The bucket bounds are FRAME_STATS_FIRST_BOUND_US doubling.
+ *
+ * @return Length written without the terminating NUL, or 0 if `size` is too small
+ */
+size_t frame_stats_to_json(frame_stats_t *stats, char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
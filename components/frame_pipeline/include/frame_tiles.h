@@ -0,0 +1,232 @@
+/**
+ * @file
+ * @brief Loss-tolerant reassembly of frames sent as UDP tiles
+ *
+ * Over UDP a frame is split into tiles, one per datagram, each of which can
+ * be decoded on its own: it says which frame it belongs to, where it goes and
+ * how it is encoded. The tiles of a frame are reassembled into a delta frame
+ * (frame_delta.h) in a frame_pool slot, one rectangle per tile, so a frame
+ * with tiles missing still patches whatever did arrive into the layer's
+ * canvas and the rest of the screen keeps the previous frame.
+ *
+ * Tile datagram, all fields little-endian:
+ * @code
+ * offset  size  field
+ *      0     4  magic "JRTL"
+ *      4     1  version (FRAME_TILES_VERSION)
+ *      5     1  format of the payload (frame_format_t)
+ *      6     2  tile index, 0..tile count - 1
+ *      8     2  tile count of the frame
+ *     10     2  width  of the full frame
+ *     12     2  height of the full frame
+ *     14     2  reserved, 0
+ *     16     4  frame id, incremented by one per frame
+ *     20     8  tile rectangle { uint16 x, y, w, h }
+ *     28     .  tile pixels, w * h RGB565 encoded in `format`
+ * @endcode
+ *
+ * One frame is assembled at a time. It goes out once all of its tiles are in,
+ * when the first tile of a newer frame arrives, or at the latest
+ * frame_tiles_config_t::deadline_us after its first tile, complete or not.
+ * Tiles of frames that went out already are too late and dropped. While a
+ * frame is being assembled and no tile came for nack_delay_us, the tiles
+ * still missing are requested again with a NACK datagram to the sender:
+ * @code
+ * offset  size  field
+ *      0     4  magic "JRTN"
+ *      4     1  version (FRAME_TILES_VERSION)
+ *      5     1  reserved, 0
+ *      6     2  count of tile indexes
+ *      8     4  frame id
+ *     12   2*n  tile indexes
+ * @endcode
+ *
+ * Senders tile the frame left to right in bands of equal height, top to
+ * bottom, and number the tiles in that order; a frame whose tiles all arrived
+ * in order is then a key frame (frame_delta_is_key()).
+ *
+ * Not thread-safe, one task receives and polls. No ESP-IDF dependencies.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "frame_codec.h"
+#include "frame_delta.h"
+#include "frame_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_TILES_MAGIC           "JRTL"  /*!< First four bytes of every tile datagram */
+#define FRAME_TILES_NACK_MAGIC      "JRTN"  /*!< First four bytes of every NACK datagram */
+#define FRAME_TILES_VERSION         1       /*!< Header version this code understands */
+#define FRAME_TILES_HEADER_LEN      28      /*!< Tile header length, the payload follows */
+#define FRAME_TILES_NACK_HEADER_LEN 12      /*!< NACK header length, the tile indexes follow */
+#define FRAME_TILES_MAX_TILES       2048    /*!< Most tiles per frame */
+
+/**
+ * @brief Outcome of parsing or reassembling a tile
+ */
+typedef enum {
+    FRAME_TILES_OK = 0,                 /*!< Tile taken */
+    FRAME_TILES_NOT_TILE,               /*!< No tile magic */
+    FRAME_TILES_TRUNCATED,              /*!< Header cut short */
+    FRAME_TILES_BAD_VERSION,            /*!< Unknown header version */
+    FRAME_TILES_BAD_FORMAT,             /*!< Unknown or unsupported payload format */
+    FRAME_TILES_BAD_TILE,               /*!< Bad index or count, or a rectangle outside the frame */
+    FRAME_TILES_MISMATCH,               /*!< Tile count or frame size differs from the frame's other tiles */
+    FRAME_TILES_CORRUPT,                /*!< Payload does not decode to the rectangle's pixels */
+    FRAME_TILES_TOO_LARGE,              /*!< Frame does not fit into a frame_pool slot */
+    FRAME_TILES_DUPLICATE,              /*!< Tile arrived already */
+    FRAME_TILES_LATE,                   /*!< Frame went out already */
+    FRAME_TILES_NO_BUFFER,              /*!< No free frame_pool slot to assemble a new frame in */
+} frame_tiles_status_t;
+
+/**
+ * @brief A parsed tile, pointing into the received datagram
+ */
+typedef struct {
+    uint32_t frame_id;                  /*!< Frame the tile belongs to */
+    frame_format_t format;              /*!< Encoding of the payload */
+    uint16_t index;                     /*!< Tile number inside the frame */
+    uint16_t count;                     /*!< Tiles of the frame */
+    uint16_t width;                     /*!< Full frame width */
+    uint16_t height;                    /*!< Full frame height */
+    frame_rect_t rect;                  /*!< Where the tile goes */
+    const uint8_t *payload;             /*!< Encoded pixels */
+    size_t payload_len;                 /*!< Bytes of payload */
+} frame_tile_t;
+
+/**
+ * @brief A parsed NACK, pointing into the received datagram
+ */
+typedef struct {
+    uint32_t frame_id;                  /*!< Frame the tiles are missing from */
+    uint16_t count;                     /*!< Number of tile indexes */
+    const uint8_t *indexes;             /*!< Raw index list, read it with frame_tiles_nack_index() */
+} frame_tiles_nack_t;
+
+/**
+ * @brief Reassembly configuration
+ */
+typedef struct {
+    frame_pool_t *pool;                 /*!< Frames are assembled in slots of this pool */
+    uint32_t deadline_us;               /*!< A frame goes out this long after its first tile at the latest */
+    uint32_t nack_delay_us;             /*!< Missing tiles are requested after this long without a tile */
+    uint8_t max_nacks;                  /*!< NACKs per frame at most, 0 never requests tiles */
+} frame_tiles_config_t;
+
+/**
+ * @brief Reassembly counters
+ */
+typedef struct {
+    uint32_t tiles;                     /*!< Tiles taken into a frame */
+    uint32_t tiles_bad;                 /*!< Datagrams that were no valid tile, or did not fit the frame */
+    uint32_t tiles_duplicate;           /*!< Tiles that arrived twice */
+    uint32_t tiles_late;                /*!< Tiles of frames that went out already */
+    uint32_t tiles_missing;             /*!< Tiles still missing when their frame went out */
+    uint32_t tiles_requested;           /*!< Tile indexes sent in NACKs */
+    uint32_t no_buffer;                 /*!< Tiles dropped for want of a free slot */
+    uint32_t nacks;                     /*!< NACK datagrams built */
+    uint32_t frames_complete;           /*!< Frames that went out with all tiles */
+    uint32_t frames_partial;            /*!< Frames that went out with tiles missing */
+} frame_tiles_stats_t;
+
+typedef struct frame_tiles_s frame_tiles_t;
+
+/**
+ * @brief Parse and validate a tile datagram
+ *
+ * Checks the header and that the rectangle lies inside the frame; whether
+ * the payload decodes is only known once it is reassembled.
+ */
+frame_tiles_status_t frame_tile_parse(const uint8_t *data, size_t len, frame_tile_t *tile);
+
+/**
+ * @brief Write the header of a tile datagram, for senders
+ *
+ * The payload goes right after it, tile->payload and payload_len are unused.
+ *
+ * @return FRAME_TILES_HEADER_LEN, 0 if `capacity` is too small
+ */
+size_t frame_tile_write_header(const frame_tile_t *tile, uint8_t *dst, size_t capacity);
+
+/**
+ * @brief Parse a NACK datagram, for senders
+ *
+ * @return FRAME_TILES_OK, or why it is no valid NACK
+ */
+frame_tiles_status_t frame_tiles_parse_nack(const uint8_t *data, size_t len, frame_tiles_nack_t *nack);
+
+/**
+ * @brief Tile index `i` of a parsed NACK
+ */
+uint16_t frame_tiles_nack_index(const frame_tiles_nack_t *nack, size_t i);
+
+/**
+ * @brief Short name of a status, e.g. for log lines
+ */
+const char *frame_tiles_status_name(frame_tiles_status_t status);
+
+/**
+ * @brief Create a reassembler
+ *
+ * @return NULL without a pool or out of memory
+ */
+frame_tiles_t *frame_tiles_create(const frame_tiles_config_t *cfg);
+
+/**
+ * @brief Free the reassembler and give the slots it holds back to the pool
+ */
+void frame_tiles_delete(frame_tiles_t *tiles);
+
+/**
+ * @brief Take a received datagram
+ *
+ * A tile of a newer frame sends the frame being assembled out first.
+ *
+ * @param now_us Current time, the clock of the deadlines
+ */
+frame_tiles_status_t frame_tiles_push(frame_tiles_t *tiles, const uint8_t *data, size_t len, int64_t now_us);
+
+/**
+ * @brief Take the next frame that is ready to be shown
+ *
+ * Call after every push and whenever frame_tiles_next_event_us() has passed,
+ * until it returns NULL. A frame past its deadline goes out with the tiles
+ * it has.
+ *
+ * @return Slot with a delta frame (size, width, height, seq set to the frame
+ *         id and recv_start_us to the first tile's arrival), now owned by
+ *         the caller; NULL if no frame is ready
+ */
+frame_slot_t *frame_tiles_poll(frame_tiles_t *tiles, int64_t now_us);
+
+/**
+ * @brief Build a NACK for the frame being assembled, if one is due
+ *
+ * Lists as many missing tiles as fit into `capacity`.
+ *
+ * @return Length of the NACK datagram in `dst`, 0 if none is due
+ */
+size_t frame_tiles_nack(frame_tiles_t *tiles, int64_t now_us, uint8_t *dst, size_t capacity);
+
+/**
+ * @brief When frame_tiles_poll() or frame_tiles_nack() next have something to do
+ *
+ * @return Time on the now_us clock, INT64_MAX while no frame is being assembled
+ */
+int64_t frame_tiles_next_event_us(const frame_tiles_t *tiles);
+
+/**
+ * @brief Snapshot of the counters
+ */
+void frame_tiles_get_stats(const frame_tiles_t *tiles, frame_tiles_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
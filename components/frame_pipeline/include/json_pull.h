@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @brief Zero-allocation pull parser for JSON messages
+ *
+ * Walks a JSON text token by token, straight out of the receive buffer: no
+ * tree is built and nothing is allocated, so a sensor burst with a hundred
+ * keys costs no heap at all. Strings are returned as spans of the input and
+ * only unescaped when the caller copies them out. The input needs no NUL
+ * terminator and every step is bounded by its length, whatever the bytes.
+ *
+ * The grammar is checked as the tokens are pulled; the first violation ends
+ * the walk with JSON_PULL_ERROR.
+ * @code
+ * json_pull_t pull;
+ * json_pull_init(&pull, text, len);
+ * if (json_pull_next(&pull) == JSON_PULL_OBJECT_START) {
+ *     while (json_pull_next(&pull) == JSON_PULL_KEY) {
+ *         if (json_pull_key_is(&pull, "frameWidth") && json_pull_next(&pull) == JSON_PULL_NUMBER) {
+ *             width = pull.number;
+ *         } else if (!json_pull_skip(&pull)) {
+ *             break;
+ *         }
+ *     }
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JSON_PULL_MAX_DEPTH     32  /*!< Deepest nesting of objects and arrays */
+#define JSON_PULL_MAX_NUMBER    63  /*!< Longest number literal, longer ones are an error */
+
+/**
+ * @brief Tokens
+ */
+typedef enum {
+    JSON_PULL_ERROR = 0,        /*!< Malformed, truncated or nested too deep; sticky */
+    JSON_PULL_END,              /*!< The top-level value is complete, only whitespace followed */
+    JSON_PULL_OBJECT_START,
+    JSON_PULL_OBJECT_END,
+    JSON_PULL_ARRAY_START,
+    JSON_PULL_ARRAY_END,
+    JSON_PULL_KEY,              /*!< Member name, in str/str_len */
+    JSON_PULL_STRING,           /*!< String value, in str/str_len */
+    JSON_PULL_NUMBER,           /*!< Number value, in number */
+    JSON_PULL_TRUE,
+    JSON_PULL_FALSE,
+    JSON_PULL_NULL,
+} json_pull_token_t;
+
+/**
+ * @brief Parser state; str, str_len, str_escaped and number describe the last token
+ */
+typedef struct {
+    const char *p;                  /*!< Next byte to look at */
+    const char *end;                /*!< One past the last byte of the input */
+    uint32_t arrays;                /*!< Bit n set if nesting level n is an array */
+    uint8_t depth;                  /*!< Open objects and arrays */
+    uint8_t expect;                 /*!< What the grammar allows next, internal */
+    json_pull_token_t token;        /*!< Last token returned */
+
+    const char *str;                /*!< KEY and STRING: the raw bytes between the quotes */
+    size_t str_len;                 /*!< KEY and STRING: length of str */
+    bool str_escaped;               /*!< KEY and STRING: str contains escapes, copy it out with json_pull_string_copy() */
+    double number;                  /*!< NUMBER: the value */
+} json_pull_t;
+
+/**
+ * @brief Start a walk over `len` bytes of JSON
+ */
+void json_pull_init(json_pull_t *pull, const char *json, size_t len);
+
+/**
+ * @brief Next token
+ *
+ * After JSON_PULL_END or JSON_PULL_ERROR every further call returns the same.
+ */
+json_pull_token_t json_pull_next(json_pull_t *pull);
+
+/**
+ * @brief Skip the value of the member whose key was just returned, or the rest of a container just opened
+ *
+ * After a KEY the whole value is skipped, after OBJECT_START or ARRAY_START
+ * everything up to and including the matching end; after any other token
+ * this does nothing.
+ *
+ * @return false on JSON_PULL_ERROR
+ */
+bool json_pull_skip(json_pull_t *pull);
+
+/**
+ * @brief True if the last token is the KEY or STRING `s`, compared as raw bytes
+ */
+bool json_pull_str_is(const json_pull_t *pull, const char *s);
+
+/**
+ * @brief True if the last token is the KEY `key`
+ */
+bool json_pull_key_is(const json_pull_t *pull, const char *key);
+
+/**
+ * @brief Unescape a JSON string body into a NUL terminated buffer
+ *
+ * \\uXXXX escapes, surrogate pairs included, become UTF-8. Output that does
+ * not fit is cut off at a character boundary.
+ *
+ * @param src Raw bytes between the quotes, already validated by json_pull_next()
+ * @param size Size of dst, at least 1
+ * @return Length written, without the NUL
+ */
+size_t json_pull_unescape(const char *src, size_t len, char *dst, size_t size);
+
+/**
+ * @brief json_pull_unescape() of the last KEY or STRING
+ */
+size_t json_pull_string_copy(const json_pull_t *pull, char *dst, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
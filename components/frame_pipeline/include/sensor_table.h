@@ -0,0 +1,109 @@
+/**
+ * @file
+ * @brief Hashed table of the latest sensor values
+ *
+ * Sensor messages come at 10-20 Hz with a hundred or more keys, most of
+ * which did not change since the last one. sensor_table_apply_json() reads
+ * such a message with json_pull straight into a table allocated once up
+ * front, and calls back only for the sensors whose value or display string
+ * changed. Nothing is allocated per message.
+ *
+ * Message schema, members other than these are skipped:
+ * @code
+ * {"type":"sensor","sensors":{"cpu":{"value":42.5,"displayValue":"42 %"}, "fps":60, "mode":"eco"}}
+ * @endcode
+ * A sensor is an object with "value" and/or "displayValue", or just a bare
+ * number (its value) or string (its display string).
+ *
+ * Not thread safe, meant to be used by the task that receives the messages.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSOR_TABLE_KEY_LEN    32  /*!< Longest sensor key plus the terminating NUL, longer keys are dropped */
+#define SENSOR_TABLE_TEXT_LEN   32  /*!< Longest display string plus the terminating NUL, longer ones are cut off */
+
+/**
+ * @brief One sensor
+ */
+typedef struct {
+    char key[SENSOR_TABLE_KEY_LEN];     /*!< Sensor key */
+    double value;                       /*!< Latest "value", 0 until one came */
+    char text[SENSOR_TABLE_TEXT_LEN];   /*!< Latest "displayValue", empty until one came */
+    uint32_t hash;                      /*!< Hash of key */
+    uint32_t changes;                   /*!< Messages that changed it, the first one included */
+} sensor_entry_t;
+
+/**
+ * @brief Table counters
+ */
+typedef struct {
+    uint32_t messages;          /*!< Messages applied */
+    uint32_t malformed;         /*!< Messages that turned out not to be well-formed JSON */
+    uint32_t changed;           /*!< Sensor updates that changed a sensor */
+    uint32_t unchanged;         /*!< Sensor updates equal to the value the sensor had */
+    uint32_t dropped;           /*!< Updates of new sensors once the table was full, or with too long keys */
+} sensor_table_stats_t;
+
+/**
+ * @brief Called for every sensor a message changed
+ *
+ * @param ctx Passed through from sensor_table_apply_json()
+ */
+typedef void (*sensor_table_changed_cb_t)(const sensor_entry_t *entry, void *ctx);
+
+typedef struct sensor_table_s sensor_table_t;
+
+/**
+ * @brief Allocate a table for up to `max_sensors` sensors
+ *
+ * @return NULL if out of memory or max_sensors is 0 or above 32768
+ */
+sensor_table_t *sensor_table_create(size_t max_sensors);
+
+/**
+ * @brief Free the table
+ */
+void sensor_table_delete(sensor_table_t *table);
+
+/**
+ * @brief Look a sensor up
+ *
+ * @return NULL if the table has no sensor `key`
+ */
+const sensor_entry_t *sensor_table_find(const sensor_table_t *table, const char *key, size_t key_len);
+
+/**
+ * @brief Sensors in the table
+ */
+size_t sensor_table_count(const sensor_table_t *table);
+
+/**
+ * @brief Apply one sensor message
+ *
+ * Sensors are updated, and `changed` called for each that changed, as the
+ * message is read. A message that turns out to be malformed halfway keeps
+ * the updates before the error.
+ *
+ * @param changed May be NULL
+ * @return false if the message is not well-formed JSON
+ */
+bool sensor_table_apply_json(sensor_table_t *table, const char *json, size_t len,
+                             sensor_table_changed_cb_t changed, void *ctx);
+
+/**
+ * @brief Read the counters
+ */
+void sensor_table_get_stats(const sensor_table_t *table, sensor_table_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
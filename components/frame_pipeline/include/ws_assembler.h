@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @brief WebSocket frame parsing and message reassembly
+ *
+ * A WebSocket message may arrive split over several frames (RFC 6455, 5.4).
+ * The assembler tracks the message in progress and tells the transport where
+ * the payload of every frame has to go, so fragments are written back to back
+ * into one destination buffer (text buffer or frame_pool slot) without copies.
+ *
+ * On the device esp_http_server decodes frame headers and unmasks payloads;
+ * ws_frame_parse_header() and ws_frame_unmask() do the same for raw byte
+ * streams, e.g. captured traffic replayed by the host tests.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WS_FRAME_MAX_HEADER_LEN 14  /*!< 2 bytes + 8 bytes extended length + 4 bytes mask key */
+
+/**
+ * @brief WebSocket opcodes
+ */
+typedef enum {
+    WS_OPCODE_CONTINUATION = 0x0,
+    WS_OPCODE_TEXT         = 0x1,
+    WS_OPCODE_BINARY       = 0x2,
+    WS_OPCODE_CLOSE        = 0x8,
+    WS_OPCODE_PING         = 0x9,
+    WS_OPCODE_PONG         = 0xA,
+} ws_opcode_t;
+
+/**
+ * @brief Decoded frame header
+ */
+typedef struct {
+    ws_opcode_t opcode;         /*!< Frame opcode */
+    bool        fin;            /*!< Last frame of the message */
+    bool        masked;         /*!< Payload is masked with mask_key */
+    uint8_t     mask_key[4];    /*!< Masking key */
+    uint64_t    payload_len;    /*!< Payload length */
+} ws_frame_hdr_t;
+
+/**
+ * @brief Result of feeding a frame header to the assembler
+ */
+typedef enum {
+    WS_ASM_START,               /*!< First frame of a data message, attach a buffer with ws_assembler_attach() */
+    WS_ASM_CONTINUE,            /*!< Next fragment of the message in progress */
+    WS_ASM_CONTROL,             /*!< Control frame (close/ping/pong), not part of any message */
+    WS_ASM_TOO_LARGE,           /*!< Message does not fit its buffer */
+    WS_ASM_PROTOCOL_ERROR,      /*!< Frame violates RFC 6455 framing or fragmentation rules */
+} ws_asm_event_t;
+
+/**
+ * @brief A complete message
+ */
+typedef struct {
+    ws_opcode_t opcode;         /*!< WS_OPCODE_TEXT or WS_OPCODE_BINARY */
+    uint8_t    *data;           /*!< The buffer passed to ws_assembler_attach() */
+    size_t      len;            /*!< Message length */
+    uint32_t    fragments;      /*!< Number of frames the message arrived in */
+} ws_message_t;
+
+/**
+ * @brief Assembler counters
+ */
+typedef struct {
+    uint32_t messages;          /*!< Complete data messages */
+    uint32_t fragmented;        /*!< Complete messages that arrived in more than one frame */
+    uint32_t control;           /*!< Control frames */
+    uint32_t too_large;         /*!< Messages dropped because they did not fit */
+    uint32_t protocol_errors;   /*!< Frames rejected as protocol violations */
+} ws_assembler_stats_t;
+
+/**
+ * @brief Reassembly state of one connection
+ */
+typedef struct {
+    ws_opcode_t opcode;         /*!< Opcode of the message in progress, WS_OPCODE_CONTINUATION when idle */
+    uint8_t    *buf;            /*!< Destination of the message in progress */
+    size_t      capacity;       /*!< Bytes available in buf */
+    size_t      len;            /*!< Bytes of completed fragments */
+    size_t      frame_len;      /*!< Payload length of the current frame */
+    bool        frame_fin;      /*!< Current frame ends the message */
+    bool        in_control;     /*!< Current frame is a control frame */
+    uint32_t    fragments;      /*!< Frames of the message in progress */
+    ws_assembler_stats_t stats; /*!< Counters */
+} ws_assembler_t;
+
+/**
+ * @brief Decode a frame header from the start of `data`
+ *
+ * @return Header length, 0 if more bytes are needed, -1 if the header is malformed
+ */
+int ws_frame_parse_header(const uint8_t *data, size_t len, ws_frame_hdr_t *hdr);
+
+/**
+ * @brief XOR `len` payload bytes with the mask key
+ *
+ * @param offset Position of payload[0] within the frame payload, for payloads unmasked in pieces
+ */
+void ws_frame_unmask(uint8_t *payload, size_t len, const uint8_t mask_key[4], size_t offset);
+
+/**
+ * @brief Reset the assembler, statistics included
+ */
+void ws_assembler_init(ws_assembler_t *as);
+
+/**
+ * @brief Feed the header of the next frame
+ *
+ * On WS_ASM_TOO_LARGE and WS_ASM_PROTOCOL_ERROR the caller drops the message
+ * in progress with ws_assembler_abort(), which hands back its buffer.
+ */
+ws_asm_event_t ws_assembler_frame(ws_assembler_t *as, ws_opcode_t opcode, bool fin, size_t payload_len);
+
+/**
+ * @brief Give the message started by WS_ASM_START its destination buffer
+ *
+ * @return false if even the first fragment does not fit (counted as too large);
+ *         the message is dropped and the buffer stays with the caller
+ */
+bool ws_assembler_attach(ws_assembler_t *as, uint8_t *buf, size_t capacity);
+
+/**
+ * @brief Where the payload of the current data frame has to be written
+ */
+uint8_t *ws_assembler_payload(const ws_assembler_t *as);
+
+/**
+ * @brief Mark the payload of the current frame as received
+ *
+ * @param[out] msg Filled when the frame completed a message
+ * @return true if a message is complete, ownership of msg->data goes back to the caller
+ */
+bool ws_assembler_frame_done(ws_assembler_t *as, ws_message_t *msg);
+
+/**
+ * @brief Drop the message in progress
+ *
+ * @return The buffer that was attached to it, or NULL
+ */
+uint8_t *ws_assembler_abort(ws_assembler_t *as);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,402 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json_pull.h"
+
+// What the grammar allows next
+enum {
+    EXPECT_VALUE = 0,       // Top level, after ':' or after ',' in an array
+    EXPECT_FIRST_VALUE,     // After '[': a value or ']'
+    EXPECT_KEY,             // After ',' in an object
+    EXPECT_FIRST_KEY,       // After '{': a key or '}'
+    EXPECT_NEXT,            // After a value in a container: ',' or its end
+    EXPECT_EOF,             // After the top-level value: only whitespace
+};
+
+// Integers with up to this many digits are exact in a double, no strtod() needed
+#define EXACT_DIGITS 15
+
+void json_pull_init(json_pull_t *pull, const char *json, size_t len)
+{
+    memset(pull, 0, sizeof(*pull));
+    pull->p = json;
+    pull->end = json + len;
+    pull->expect = EXPECT_VALUE;
+    pull->token = JSON_PULL_NULL;    // No token yet, anything but ERROR and END will do
+}
+
+static json_pull_token_t fail(json_pull_t *pull)
+{
+    pull->token = JSON_PULL_ERROR;
+    return JSON_PULL_ERROR;
+}
+
+static bool in_array(const json_pull_t *pull)
+{
+    return pull->depth && ((pull->arrays >> (pull->depth - 1)) & 1);
+}
+
+static json_pull_token_t value_done(json_pull_t *pull, json_pull_token_t token)
+{
+    pull->expect = pull->depth ? EXPECT_NEXT : EXPECT_EOF;
+    pull->token = token;
+    return token;
+}
+
+static const char *skip_ws(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        p++;
+    }
+    return p;
+}
+
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// p at the opening quote. Sets str/str_len/str_escaped and returns the
+// position after the closing quote, NULL if the string is malformed.
+static const char *scan_string(json_pull_t *pull, const char *p)
+{
+    const char *end = pull->end;
+    bool escaped = false;
+    const char *start = ++p;
+    while (p < end) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"') {
+            pull->str = start;
+            pull->str_len = (size_t)(p - start);
+            pull->str_escaped = escaped;
+            return p + 1;
+        }
+        if (c < 0x20) {
+            return NULL;
+        }
+        if (c == '\\') {
+            escaped = true;
+            if (++p == end) {
+                return NULL;
+            }
+            if (*p == 'u') {
+                if (end - p < 5) {
+                    return NULL;
+                }
+                for (int i = 1; i <= 4; i++) {
+                    if (hex_digit(p[i]) < 0) {
+                        return NULL;
+                    }
+                }
+                p += 4;
+            } else if (*p == '\0' || !strchr("\"\\/bfnrt", *p)) {
+                return NULL;
+            }
+        }
+        p++;
+    }
+    return NULL;
+}
+
+static const char *scan_digits(const char *p, const char *end)
+{
+    while (p < end && *p >= '0' && *p <= '9') {
+        p++;
+    }
+    return p;
+}
+
+// Validates one number literal and converts it unless skipping. Returns the
+// position after it, NULL if malformed.
+static const char *scan_number(json_pull_t *pull, const char *p, bool convert)
+{
+    const char *end = pull->end;
+    const char *start = p;
+    bool negative = p < end && *p == '-';
+    if (negative) {
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+        return NULL;
+    }
+    const char *int_start = p;
+    p = *p == '0' ? p + 1 : scan_digits(p, end);
+    size_t int_digits = (size_t)(p - int_start);
+    bool integer = true;
+
+    if (p < end && *p == '.') {
+        const char *frac = ++p;
+        p = scan_digits(p, end);
+        if (p == frac) {
+            return NULL;
+        }
+        integer = false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) {
+            p++;
+        }
+        const char *exp = p;
+        p = scan_digits(p, end);
+        if (p == exp) {
+            return NULL;
+        }
+        integer = false;
+    }
+    if ((size_t)(p - start) > JSON_PULL_MAX_NUMBER) {
+        return NULL;
+    }
+    if (!convert) {
+        return p;
+    }
+
+    // Sensor values are mostly small integers, those skip strtod()
+    if (integer && int_digits <= EXACT_DIGITS) {
+        uint64_t value = 0;
+        for (const char *d = int_start; d < p; d++) {
+            value = value * 10 + (uint64_t)(*d - '0');
+        }
+        pull->number = negative ? -(double)value : (double)value;
+    } else {
+        char buf[JSON_PULL_MAX_NUMBER + 1];
+        memcpy(buf, start, (size_t)(p - start));
+        buf[p - start] = '\0';
+        pull->number = strtod(buf, NULL);
+    }
+    return p;
+}
+
+static json_pull_token_t scan_literal(json_pull_t *pull, const char *word, json_pull_token_t token)
+{
+    size_t len = strlen(word);
+    if ((size_t)(pull->end - pull->p) < len || memcmp(pull->p, word, len) != 0) {
+        return fail(pull);
+    }
+    pull->p += len;
+    return value_done(pull, token);
+}
+
+static json_pull_token_t open_container(json_pull_t *pull, bool array)
+{
+    if (pull->depth == JSON_PULL_MAX_DEPTH) {
+        return fail(pull);
+    }
+    if (array) {
+        pull->arrays |= 1u << pull->depth;
+    } else {
+        pull->arrays &= ~(1u << pull->depth);
+    }
+    pull->depth++;
+    pull->p++;
+    pull->expect = array ? EXPECT_FIRST_VALUE : EXPECT_FIRST_KEY;
+    pull->token = array ? JSON_PULL_ARRAY_START : JSON_PULL_OBJECT_START;
+    return pull->token;
+}
+
+static json_pull_token_t close_container(json_pull_t *pull)
+{
+    json_pull_token_t token = in_array(pull) ? JSON_PULL_ARRAY_END : JSON_PULL_OBJECT_END;
+    pull->depth--;
+    pull->p++;
+    return value_done(pull, token);
+}
+
+static json_pull_token_t next_token(json_pull_t *pull, bool convert)
+{
+    if (pull->token == JSON_PULL_ERROR || pull->token == JSON_PULL_END) {
+        return pull->token;
+    }
+
+    const char *p = pull->p = skip_ws(pull->p, pull->end);
+    if (pull->expect == EXPECT_EOF) {
+        pull->token = p == pull->end ? JSON_PULL_END : JSON_PULL_ERROR;
+        return pull->token;
+    }
+    if (p == pull->end) {
+        return fail(pull);
+    }
+
+    if (pull->expect == EXPECT_NEXT) {
+        if (*p == (in_array(pull) ? ']' : '}')) {
+            return close_container(pull);
+        }
+        if (*p != ',') {
+            return fail(pull);
+        }
+        p = pull->p = skip_ws(p + 1, pull->end);
+        if (p == pull->end) {
+            return fail(pull);
+        }
+        pull->expect = in_array(pull) ? EXPECT_VALUE : EXPECT_KEY;
+    } else if ((pull->expect == EXPECT_FIRST_KEY && *p == '}') ||
+               (pull->expect == EXPECT_FIRST_VALUE && *p == ']')) {
+        return close_container(pull);
+    }
+
+    if (pull->expect == EXPECT_KEY || pull->expect == EXPECT_FIRST_KEY) {
+        if (*p != '"' || !(p = scan_string(pull, p))) {
+            return fail(pull);
+        }
+        p = skip_ws(p, pull->end);
+        if (p == pull->end || *p != ':') {
+            return fail(pull);
+        }
+        pull->p = p + 1;
+        pull->expect = EXPECT_VALUE;
+        pull->token = JSON_PULL_KEY;
+        return JSON_PULL_KEY;
+    }
+
+    switch (*p) {
+    case '{':
+        return open_container(pull, false);
+    case '[':
+        return open_container(pull, true);
+    case '"':
+        if (!(p = scan_string(pull, p))) {
+            return fail(pull);
+        }
+        pull->p = p;
+        return value_done(pull, JSON_PULL_STRING);
+    case 't':
+        return scan_literal(pull, "true", JSON_PULL_TRUE);
+    case 'f':
+        return scan_literal(pull, "false", JSON_PULL_FALSE);
+    case 'n':
+        return scan_literal(pull, "null", JSON_PULL_NULL);
+    default:
+        if (!(p = scan_number(pull, p, convert))) {
+            return fail(pull);
+        }
+        pull->p = p;
+        return value_done(pull, JSON_PULL_NUMBER);
+    }
+}
+
+json_pull_token_t json_pull_next(json_pull_t *pull)
+{
+    return next_token(pull, true);
+}
+
+bool json_pull_skip(json_pull_t *pull)
+{
+    json_pull_token_t token = pull->token;
+    if (token == JSON_PULL_KEY) {
+        token = next_token(pull, false);
+    }
+    if (token == JSON_PULL_OBJECT_START || token == JSON_PULL_ARRAY_START) {
+        uint8_t depth = pull->depth - 1;
+        while (pull->depth > depth) {
+            if (next_token(pull, false) == JSON_PULL_ERROR) {
+                return false;
+            }
+        }
+    }
+    return pull->token != JSON_PULL_ERROR;
+}
+
+bool json_pull_str_is(const json_pull_t *pull, const char *s)
+{
+    return (pull->token == JSON_PULL_KEY || pull->token == JSON_PULL_STRING) &&
+           strlen(s) == pull->str_len && memcmp(s, pull->str, pull->str_len) == 0;
+}
+
+bool json_pull_key_is(const json_pull_t *pull, const char *key)
+{
+    return pull->token == JSON_PULL_KEY && json_pull_str_is(pull, key);
+}
+
+static unsigned hex4(const char *p)
+{
+    return (unsigned)(hex_digit(p[0]) << 12 | hex_digit(p[1]) << 8 | hex_digit(p[2]) << 4 | hex_digit(p[3]));
+}
+
+static size_t utf8_encode(uint32_t cp, char *out)
+{
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xc0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3f));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xe0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3f));
+        out[2] = (char)(0x80 | (cp & 0x3f));
+        return 3;
+    }
+    out[0] = (char)(0xf0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3f));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3f));
+    out[3] = (char)(0x80 | (cp & 0x3f));
+    return 4;
+}
+
+// Bytes in the UTF-8 sequence starting with lead, 1 for anything that is not a lead byte
+static size_t utf8_sequence_len(unsigned char lead)
+{
+    return lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : lead >= 0xc0 ? 2 : 1;
+}
+
+size_t json_pull_unescape(const char *src, size_t len, char *dst, size_t size)
+{
+    const char *end = src + len;
+    size_t out = 0;
+    while (src < end) {
+        char seq[4];
+        size_t seq_len;
+        if (*src != '\\') {
+            seq_len = utf8_sequence_len((unsigned char)*src);
+            if (seq_len > (size_t)(end - src)) {
+                seq_len = (size_t)(end - src);
+            }
+            memcpy(seq, src, seq_len);
+            src += seq_len;
+        } else if (src[1] != 'u') {
+            static const char escapes[] = "\"\"\\\\//b\bf\fn\nr\rt\t";
+            const char *e = strchr(escapes, src[1]);
+            seq[0] = e ? e[1] : src[1];
+            seq_len = 1;
+            src += 2;
+        } else {
+            uint32_t cp = hex4(src + 2);
+            src += 6;
+            if (cp >= 0xd800 && cp < 0xdc00 && end - src >= 6 && src[0] == '\\' && src[1] == 'u') {
+                uint32_t low = hex4(src + 2);
+                if (low >= 0xdc00 && low < 0xe000) {
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                    src += 6;
+                }
+            }
+            if (cp >= 0xd800 && cp < 0xe000) {
+                cp = 0xfffd;    // Lone surrogate
+            }
+            seq_len = utf8_encode(cp, seq);
+        }
+
+        if (out + seq_len > size - 1) {
+            break;
+        }
+        memcpy(dst + out, seq, seq_len);
+        out += seq_len;
+    }
+    dst[out] = '\0';
+    return out;
+}
+
+size_t json_pull_string_copy(const json_pull_t *pull, char *dst, size_t size)
+{
+    return json_pull_unescape(pull->str, pull->str_len, dst, size);
+}
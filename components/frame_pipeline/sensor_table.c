@@ -0,0 +1,214 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json_pull.h"
+#include "sensor_table.h"
+
+#define MAX_SENSORS 32768   // Slot indexes are uint16_t
+
+struct sensor_table_s {
+    size_t max_sensors;
+    size_t count;
+    uint32_t slot_mask;             // Slot count - 1, a power of two of at least twice max_sensors
+    uint16_t *slots;                // Open addressing, entry index + 1, 0 for free
+    sensor_entry_t *entries;        // In the order the sensors first came
+    sensor_table_stats_t stats;
+};
+
+sensor_table_t *sensor_table_create(size_t max_sensors)
+{
+    if (max_sensors == 0 || max_sensors > MAX_SENSORS) {
+        return NULL;
+    }
+    size_t slot_count = 1;
+    while (slot_count < max_sensors * 2) {
+        slot_count <<= 1;
+    }
+
+    sensor_table_t *table = calloc(1, sizeof(sensor_table_t));
+    if (!table) {
+        return NULL;
+    }
+    table->slots = calloc(slot_count, sizeof(uint16_t));
+    table->entries = calloc(max_sensors, sizeof(sensor_entry_t));
+    if (!table->slots || !table->entries) {
+        sensor_table_delete(table);
+        return NULL;
+    }
+    table->max_sensors = max_sensors;
+    table->slot_mask = (uint32_t)(slot_count - 1);
+    return table;
+}
+
+void sensor_table_delete(sensor_table_t *table)
+{
+    if (!table) {
+        return;
+    }
+    free(table->slots);
+    free(table->entries);
+    free(table);
+}
+
+// FNV-1a
+static uint32_t key_hash(const char *key, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// The slot holding `key`, or the free slot where it would go
+static uint16_t *slot_of(const sensor_table_t *table, const char *key, size_t len, uint32_t hash)
+{
+    // Never more than half full, so the probe always ends at a free slot
+    for (uint32_t i = hash;; i++) {
+        uint16_t *slot = &table->slots[i & table->slot_mask];
+        if (*slot == 0) {
+            return slot;
+        }
+        const sensor_entry_t *entry = &table->entries[*slot - 1];
+        if (entry->hash == hash && memcmp(entry->key, key, len) == 0 && entry->key[len] == '\0') {
+            return slot;
+        }
+    }
+}
+
+const sensor_entry_t *sensor_table_find(const sensor_table_t *table, const char *key, size_t key_len)
+{
+    if (key_len >= SENSOR_TABLE_KEY_LEN) {
+        return NULL;
+    }
+    uint16_t *slot = slot_of(table, key, key_len, key_hash(key, key_len));
+    return *slot ? &table->entries[*slot - 1] : NULL;
+}
+
+size_t sensor_table_count(const sensor_table_t *table)
+{
+    return table->count;
+}
+
+// The sensor `key`, added if it is new; NULL if the table is full
+static sensor_entry_t *entry_get(sensor_table_t *table, const char *key, size_t len, bool *added)
+{
+    uint32_t hash = key_hash(key, len);
+    uint16_t *slot = slot_of(table, key, len, hash);
+    *added = *slot == 0;
+    if (*added) {
+        if (table->count == table->max_sensors) {
+            return NULL;
+        }
+        sensor_entry_t *entry = &table->entries[table->count++];
+        memcpy(entry->key, key, len);
+        entry->key[len] = '\0';
+        entry->hash = hash;
+        *slot = (uint16_t)table->count;
+    }
+    return &table->entries[*slot - 1];
+}
+
+// A sensor member: its key was just pulled, reads the value
+static void apply_sensor(sensor_table_t *table, json_pull_t *pull, sensor_table_changed_cb_t changed, void *ctx)
+{
+    // The unescaped key may be shorter than the raw one, one byte of room
+    // beyond the limit tells a key that is too long
+    char key_buf[SENSOR_TABLE_KEY_LEN + 1];
+    const char *key = pull->str;
+    size_t key_len = pull->str_len;
+    if (pull->str_escaped) {
+        key_len = json_pull_string_copy(pull, key_buf, sizeof(key_buf));
+        key = key_buf;
+    }
+
+    bool has_value = false;
+    bool has_text = false;
+    double value = 0;
+    char text[SENSOR_TABLE_TEXT_LEN];
+
+    json_pull_token_t token = json_pull_next(pull);
+    if (token == JSON_PULL_NUMBER) {
+        has_value = true;
+        value = pull->number;
+    } else if (token == JSON_PULL_STRING) {
+        has_text = true;
+        json_pull_string_copy(pull, text, sizeof(text));
+    } else if (token == JSON_PULL_OBJECT_START) {
+        while (json_pull_next(pull) == JSON_PULL_KEY) {
+            if (json_pull_key_is(pull, "value")) {
+                if (json_pull_next(pull) == JSON_PULL_NUMBER) {
+                    has_value = true;
+                    value = pull->number;
+                }
+            } else if (json_pull_key_is(pull, "displayValue")) {
+                if (json_pull_next(pull) == JSON_PULL_STRING) {
+                    has_text = true;
+                    json_pull_string_copy(pull, text, sizeof(text));
+                }
+            }
+            json_pull_skip(pull);
+        }
+    } else {
+        json_pull_skip(pull);
+    }
+    if (pull->token == JSON_PULL_ERROR || (!has_value && !has_text)) {
+        return;
+    }
+
+    bool added = false;
+    sensor_entry_t *entry = key_len > 0 && key_len < SENSOR_TABLE_KEY_LEN ? entry_get(table, key, key_len, &added) : NULL;
+    if (!entry) {
+        table->stats.dropped++;
+        return;
+    }
+
+    bool update = added;
+    if (has_value && value != entry->value) {
+        entry->value = value;
+        update = true;
+    }
+    if (has_text && strcmp(text, entry->text) != 0) {
+        strcpy(entry->text, text);
+        update = true;
+    }
+    if (!update) {
+        table->stats.unchanged++;
+        return;
+    }
+    entry->changes++;
+    table->stats.changed++;
+    if (changed) {
+        changed(entry, ctx);
+    }
+}
+
+bool sensor_table_apply_json(sensor_table_t *table, const char *json, size_t len,
+                             sensor_table_changed_cb_t changed, void *ctx)
+{
+    table->stats.messages++;
+
+    json_pull_t pull;
+    json_pull_init(&pull, json, len);
+    if (json_pull_next(&pull) == JSON_PULL_OBJECT_START) {
+        while (json_pull_next(&pull) == JSON_PULL_KEY) {
+            if (json_pull_key_is(&pull, "sensors") && json_pull_next(&pull) == JSON_PULL_OBJECT_START) {
+                while (json_pull_next(&pull) == JSON_PULL_KEY) {
+                    apply_sensor(table, &pull, changed, ctx);
+                }
+            } else {
+                json_pull_skip(&pull);
+            }
+        }
+    }
+    if (pull.token != JSON_PULL_OBJECT_END || json_pull_next(&pull) != JSON_PULL_END) {
+        table->stats.malformed++;
+        return false;
+    }
+    return true;
+}
+
+void sensor_table_get_stats(const sensor_table_t *table, sensor_table_stats_t *stats)
+{
+    *stats = table->stats;
+}
@@ -0,0 +1,182 @@
+#include <string.h>
+#include "ws_assembler.h"
+
+#define WS_FIN_BIT          0x80
+#define WS_RSV_BITS         0x70
+#define WS_OPCODE_BITS      0x0F
+#define WS_MASK_BIT         0x80
+#define WS_LEN_BITS         0x7F
+#define WS_LEN_16BIT        126
+#define WS_LEN_64BIT        127
+#define WS_CONTROL_MAX_LEN  125
+
+int ws_frame_parse_header(const uint8_t *data, size_t len, ws_frame_hdr_t *hdr)
+{
+    if (len < 2) {
+        return 0;
+    }
+
+    if (data[0] & WS_RSV_BITS) {
+        return -1;  // No extensions are negotiated
+    }
+
+    size_t pos = 2;
+    uint64_t payload_len = data[1] & WS_LEN_BITS;
+    if (payload_len == WS_LEN_16BIT) {
+        if (len < pos + 2) {
+            return 0;
+        }
+        payload_len = ((uint64_t)data[2] << 8) | data[3];
+        pos += 2;
+    } else if (payload_len == WS_LEN_64BIT) {
+        if (len < pos + 8) {
+            return 0;
+        }
+        if (data[2] & 0x80) {
+            return -1;  // Most significant bit must be 0
+        }
+        payload_len = 0;
+        for (int i = 0; i < 8; i++) {
+            payload_len = (payload_len << 8) | data[2 + i];
+        }
+        pos += 8;
+    }
+
+    bool masked = data[1] & WS_MASK_BIT;
+    if (masked) {
+        if (len < pos + 4) {
+            return 0;
+        }
+        memcpy(hdr->mask_key, &data[pos], 4);
+        pos += 4;
+    } else {
+        memset(hdr->mask_key, 0, sizeof(hdr->mask_key));
+    }
+
+    hdr->opcode = (ws_opcode_t)(data[0] & WS_OPCODE_BITS);
+    hdr->fin = data[0] & WS_FIN_BIT;
+    hdr->masked = masked;
+    hdr->payload_len = payload_len;
+    return (int)pos;
+}
+
+void ws_frame_unmask(uint8_t *payload, size_t len, const uint8_t mask_key[4], size_t offset)
+{
+    for (size_t i = 0; i < len; i++) {
+        payload[i] ^= mask_key[(offset + i) & 3];
+    }
+}
+
+void ws_assembler_init(ws_assembler_t *as)
+{
+    memset(as, 0, sizeof(*as));
+    as->opcode = WS_OPCODE_CONTINUATION;
+}
+
+static void reset_message(ws_assembler_t *as)
+{
+    as->opcode = WS_OPCODE_CONTINUATION;
+    as->buf = NULL;
+    as->capacity = 0;
+    as->len = 0;
+    as->fragments = 0;
+}
+
+ws_asm_event_t ws_assembler_frame(ws_assembler_t *as, ws_opcode_t opcode, bool fin, size_t payload_len)
+{
+    as->in_control = false;
+    as->frame_len = payload_len;
+    as->frame_fin = fin;
+
+    switch (opcode) {
+    case WS_OPCODE_CLOSE:
+    case WS_OPCODE_PING:
+    case WS_OPCODE_PONG:
+        // Control frames may be interleaved with fragments but are never fragmented themselves
+        if (!fin || payload_len > WS_CONTROL_MAX_LEN) {
+            as->stats.protocol_errors++;
+            return WS_ASM_PROTOCOL_ERROR;
+        }
+        as->in_control = true;
+        as->stats.control++;
+        return WS_ASM_CONTROL;
+
+    case WS_OPCODE_TEXT:
+    case WS_OPCODE_BINARY:
+        if (as->opcode != WS_OPCODE_CONTINUATION) {
+            as->stats.protocol_errors++;   // New message before the previous one finished
+            return WS_ASM_PROTOCOL_ERROR;
+        }
+        as->opcode = opcode;
+        as->len = 0;
+        as->fragments = 0;
+        return WS_ASM_START;
+
+    case WS_OPCODE_CONTINUATION:
+        if (as->opcode == WS_OPCODE_CONTINUATION) {
+            as->stats.protocol_errors++;   // Nothing to continue
+            return WS_ASM_PROTOCOL_ERROR;
+        }
+        if (payload_len > as->capacity - as->len) {
+            as->stats.too_large++;
+            return WS_ASM_TOO_LARGE;
+        }
+        return WS_ASM_CONTINUE;
+
+    default:
+        as->stats.protocol_errors++;   // Reserved opcode
+        return WS_ASM_PROTOCOL_ERROR;
+    }
+}
+
+bool ws_assembler_attach(ws_assembler_t *as, uint8_t *buf, size_t capacity)
+{
+    if (as->frame_len > capacity) {
+        as->stats.too_large++;
+        reset_message(as);
+        return false;
+    }
+    as->buf = buf;
+    as->capacity = capacity;
+    return true;
+}
+
+uint8_t *ws_assembler_payload(const ws_assembler_t *as)
+{
+    return as->buf + as->len;
+}
+
+bool ws_assembler_frame_done(ws_assembler_t *as, ws_message_t *msg)
+{
+    if (as->in_control) {
+        as->in_control = false;
+        return false;
+    }
+
+    as->len += as->frame_len;
+    as->fragments++;
+    as->frame_len = 0;
+    if (!as->frame_fin) {
+        return false;
+    }
+
+    msg->opcode = as->opcode;
+    msg->data = as->buf;
+    msg->len = as->len;
+    msg->fragments = as->fragments;
+    as->stats.messages++;
+    if (as->fragments > 1) {
+        as->stats.fragmented++;
+    }
+    reset_message(as);
+    return true;
+}
+
+uint8_t *ws_assembler_abort(ws_assembler_t *as)
+{
+    uint8_t *buf = as->buf;
+    reset_message(as);
+    as->in_control = false;
+    as->frame_len = 0;
+    return buf;
+}
@@ -0,0 +1,195 @@
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "frame_compositor.h"
+
+static const char *TAG = "frame_compositor";
+
+typedef struct {
+    lv_obj_t *container;            // Covers the layer's region, NULL until the layer is first used
+    frame_presenter_t *presenter;
+    uint32_t generation;            // Of the frame_layer_t the container was laid out for, 0 if unused
+} layer_t;
+
+struct frame_compositor_s {
+    frame_compositor_config_t cfg;
+    layer_t layers[FRAME_LAYERS_MAX];
+    frame_layers_t table;           // Copy as of the last sync
+    bool passthrough_allowed;       // Whether layer 0 currently may flip frames onto the panel
+    uint32_t unrouted;
+};
+
+frame_compositor_t *frame_compositor_create(const frame_compositor_config_t *cfg)
+{
+    frame_compositor_t *compositor = calloc(1, sizeof(frame_compositor_t));
+    if (!compositor) {
+        return NULL;
+    }
+    compositor->cfg = *cfg;
+    return compositor;
+}
+
+void frame_compositor_delete(frame_compositor_t *compositor)
+{
+    if (!compositor) {
+        return;
+    }
+    for (size_t z = 0; z < FRAME_LAYERS_MAX; z++) {
+        layer_t *layer = &compositor->layers[z];
+        if (!layer->container) {
+            continue;
+        }
+        frame_presenter_delete(layer->presenter);
+        compositor->cfg.lock(0);
+        lv_obj_delete(layer->container);
+        compositor->cfg.unlock();
+    }
+    free(compositor);
+}
+
+// A transparent, unclickable box the presenter centers its frames in
+static bool layer_create(frame_compositor_t *compositor, uint8_t z)
+{
+    layer_t *layer = &compositor->layers[z];
+
+    compositor->cfg.lock(0);
+    layer->container = lv_obj_create(compositor->cfg.parent);
+    lv_obj_remove_style_all(layer->container);
+    lv_obj_remove_flag(layer->container, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(layer->container, LV_OBJ_FLAG_HIDDEN);
+    compositor->cfg.unlock();
+
+    const frame_presenter_config_t presenter_cfg = {
+        .parent = layer->container,
+        .pool = compositor->cfg.pool,
+        .lock = compositor->cfg.lock,
+        .unlock = compositor->cfg.unlock,
+        // The panel has one set of frame buffers, only the bottom layer may flip them
+        .passthrough_display = z == 0 ? compositor->cfg.passthrough_display : NULL,
+        .passthrough_buffers = compositor->cfg.passthrough_buffers,
+    };
+    layer->presenter = frame_presenter_create(&presenter_cfg);
+    if (!layer->presenter) {
+        compositor->cfg.lock(0);
+        lv_obj_delete(layer->container);
+        compositor->cfg.unlock();
+        layer->container = NULL;
+        return false;
+    }
+    frame_presenter_set_passthrough(layer->presenter, compositor->passthrough_allowed);
+    return true;
+}
+
+void frame_compositor_sync(frame_compositor_t *compositor, const frame_layers_t *layers)
+{
+    bool restack = false;
+    for (uint8_t z = 0; z < FRAME_LAYERS_MAX; z++) {
+        layer_t *layer = &compositor->layers[z];
+        const frame_layer_t *wanted = &layers->layers[z];
+        uint32_t generation = frame_layers_in_use(layers, z) ? wanted->generation : 0;
+        if (generation == layer->generation) {
+            continue;
+        }
+        if (generation && !layer->container && !layer_create(compositor, z)) {
+            ESP_LOGE(TAG, "No memory for layer %u", z);
+            continue;
+        }
+        layer->generation = generation;
+        restack = true;
+
+        // Whatever the previous owner left behind goes, new or moved layers start empty
+        frame_presenter_reset(layer->presenter);
+        compositor->cfg.lock(0);
+        if (generation) {
+            lv_obj_set_pos(layer->container, (int32_t)wanted->region.x, (int32_t)wanted->region.y);
+            lv_obj_set_size(layer->container, (int32_t)wanted->region.width, (int32_t)wanted->region.height);
+            lv_obj_remove_flag(layer->container, LV_OBJ_FLAG_HIDDEN);
+            ESP_LOGI(TAG, "Layer %u: %ux%u at %u,%u", z, (unsigned) wanted->region.width,
+                     (unsigned) wanted->region.height, (unsigned) wanted->region.x, (unsigned) wanted->region.y);
+        } else {
+            lv_obj_add_flag(layer->container, LV_OBJ_FLAG_HIDDEN);
+            ESP_LOGI(TAG, "Layer %u released", z);
+        }
+        compositor->cfg.unlock();
+    }
+    compositor->table = *layers;
+    if (!restack) {
+        return;
+    }
+
+    // Bottom of the parent in z-order, below anything else on it
+    compositor->cfg.lock(0);
+    int32_t index = 0;
+    for (uint8_t z = 0; z < FRAME_LAYERS_MAX; z++) {
+        if (compositor->layers[z].container) {
+            lv_obj_move_to_index(compositor->layers[z].container, index++);
+        }
+    }
+    compositor->cfg.unlock();
+
+    // Flipping the panel's frame buffers would wipe out every other layer
+    const frame_region_t *base = &layers->layers[0].region;
+    bool allowed = frame_layers_count(layers) == 1 && frame_layers_in_use(layers, 0) &&
+                   base->width == layers->screen_width && base->height == layers->screen_height;
+    if (allowed != compositor->passthrough_allowed) {
+        compositor->passthrough_allowed = allowed;
+        if (compositor->layers[0].presenter) {
+            frame_presenter_set_passthrough(compositor->layers[0].presenter, allowed);
+        }
+    }
+}
+
+// The presenter of a layer somebody owns, NULL otherwise
+static frame_presenter_t *layer_presenter(frame_compositor_t *compositor, uint8_t z)
+{
+    if (z >= FRAME_LAYERS_MAX || !compositor->layers[z].generation) {
+        compositor->unrouted++;
+        return NULL;
+    }
+    return compositor->layers[z].presenter;
+}
+
+void frame_compositor_show(frame_compositor_t *compositor, frame_slot_t *slot)
+{
+    frame_presenter_t *presenter = layer_presenter(compositor, slot->layer);
+    if (!presenter) {
+        frame_pool_release(compositor->cfg.pool, slot);
+        return;
+    }
+    frame_presenter_show(presenter, slot);
+}
+
+bool frame_compositor_patch(frame_compositor_t *compositor, uint8_t layer, const frame_delta_t *delta)
+{
+    frame_presenter_t *presenter = layer_presenter(compositor, layer);
+    return presenter && frame_presenter_patch(presenter, delta);
+}
+
+void frame_compositor_hide(frame_compositor_t *compositor)
+{
+    for (size_t z = 0; z < FRAME_LAYERS_MAX; z++) {
+        if (compositor->layers[z].presenter) {
+            frame_presenter_hide(compositor->layers[z].presenter);
+        }
+    }
+}
+
+void frame_compositor_get_stats(frame_compositor_t *compositor, frame_compositor_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    for (size_t z = 0; z < FRAME_LAYERS_MAX; z++) {
+        if (!compositor->layers[z].presenter) {
+            continue;
+        }
+        frame_presenter_stats_t layer_stats;
+        frame_presenter_get_stats(compositor->layers[z].presenter, &layer_stats);
+        stats->presenter.frames += layer_stats.frames;
+        stats->presenter.deltas += layer_stats.deltas;
+        stats->presenter.deltas_dropped += layer_stats.deltas_dropped;
+        stats->presenter.delta_gaps += layer_stats.delta_gaps;
+        stats->presenter.passthrough_frames += layer_stats.passthrough_frames;
+        stats->presenter.passthrough_dropped += layer_stats.passthrough_dropped;
+    }
+    stats->layers = (uint32_t)frame_layers_count(&compositor->table);
+    stats->unrouted = compositor->unrouted;
+}
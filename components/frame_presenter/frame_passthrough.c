@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_lcd_mipi_dsi.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lvgl_port.h"
+#include "frame_passthrough.h"
+
+static const char *TAG = "frame_passthrough";
+
+#define RGB565_BYTES_PER_PIXEL 2
+#define VSYNC_TIMEOUT_MS 100    // Several refreshes even at low pixel clocks
+
+struct frame_passthrough_s {
+    lv_display_t *display;
+    esp_lcd_panel_handle_t panel;
+    uint16_t width;
+    uint16_t height;
+    SemaphoreHandle_t vsync;    // Given at the end of every refresh
+    frame_flip_t *flip;
+};
+
+static bool IRAM_ATTR on_vsync(lv_display_t *disp, void *user_ctx)
+{
+    frame_passthrough_t *passthrough = user_ctx;
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(passthrough->vsync, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+static void panel_present(void *ctx, uint8_t *buffer, size_t size)
+{
+    frame_passthrough_t *passthrough = ctx;
+    // Drawing a frame buffer onto itself only writes the cache back and makes
+    // it the one scanned out from the next refresh on
+    esp_lcd_panel_draw_bitmap(passthrough->panel, 0, 0, passthrough->width, passthrough->height, buffer);
+    // Cleared afterwards: a refresh in between is missed, which only costs a wait
+    xSemaphoreTake(passthrough->vsync, 0);
+}
+
+static bool panel_wait_vsync(void *ctx, uint32_t timeout_ms)
+{
+    frame_passthrough_t *passthrough = ctx;
+    if (xSemaphoreTake(passthrough->vsync, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return false;
+    }
+    // Still true for whoever asks next, until the next present
+    xSemaphoreGive(passthrough->vsync);
+    return true;
+}
+
+frame_passthrough_t *frame_passthrough_create(lv_display_t *display, size_t buffer_count)
+{
+    if (buffer_count == 0 || buffer_count > FRAME_FLIP_MAX_BUFFERS) {
+        return NULL;
+    }
+    if (lv_display_get_color_format(display) != LV_COLOR_FORMAT_RGB565) {
+        ESP_LOGW(TAG, "Display is not RGB565, no passthrough");
+        return NULL;
+    }
+
+    frame_passthrough_t *passthrough = calloc(1, sizeof(frame_passthrough_t));
+    if (!passthrough) {
+        return NULL;
+    }
+    passthrough->display = display;
+    passthrough->panel = lvgl_port_get_panel_handle(display);
+    passthrough->width = lv_display_get_original_horizontal_resolution(display);
+    passthrough->height = lv_display_get_original_vertical_resolution(display);
+
+    frame_flip_config_t cfg = {
+        .panel = {
+            .present = panel_present,
+            .wait_vsync = panel_wait_vsync,
+            .ctx = passthrough,
+        },
+        .buffer_count = buffer_count,
+        .buffer_size = (size_t)passthrough->width * passthrough->height * RGB565_BYTES_PER_PIXEL,
+        .front = 0,     // LVGL draws into the first buffer until somebody flips
+        .vsync_timeout_ms = VSYNC_TIMEOUT_MS,
+    };
+    void *fbs[FRAME_FLIP_MAX_BUFFERS] = { NULL };
+    esp_err_t err = esp_lcd_dpi_panel_get_frame_buffer(passthrough->panel, buffer_count, &fbs[0], &fbs[1], &fbs[2]);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to get %u frame buffers: %s", (unsigned) buffer_count, esp_err_to_name(err));
+        goto err;
+    }
+    for (size_t i = 0; i < buffer_count; i++) {
+        cfg.buffers[i] = fbs[i];
+    }
+
+    passthrough->vsync = xSemaphoreCreateBinary();
+    if (!passthrough->vsync) {
+        goto err;
+    }
+    passthrough->flip = frame_flip_create(&cfg);
+    if (!passthrough->flip) {
+        goto err;
+    }
+    err = lvgl_port_disp_register_vsync_cb(display, on_vsync, passthrough);
+    if (err != ESP_OK) {
+        goto err;
+    }
+
+    ESP_LOGI(TAG, "Passthrough for %dx%d frames with %u frame buffers",
+             passthrough->width, passthrough->height, (unsigned) buffer_count);
+    return passthrough;
+
+err:
+    frame_flip_delete(passthrough->flip);
+    if (passthrough->vsync) {
+        vSemaphoreDelete(passthrough->vsync);
+    }
+    free(passthrough);
+    return NULL;
+}
+
+void frame_passthrough_delete(frame_passthrough_t *passthrough)
+{
+    if (!passthrough) {
+        return;
+    }
+    lvgl_port_disp_register_vsync_cb(passthrough->display, NULL, NULL);
+    frame_flip_delete(passthrough->flip);
+    vSemaphoreDelete(passthrough->vsync);
+    free(passthrough);
+}
+
+bool frame_passthrough_fits(const frame_passthrough_t *passthrough, uint16_t width, uint16_t height)
+{
+    return passthrough && width == passthrough->width && height == passthrough->height;
+}
+
+bool frame_passthrough_show(frame_passthrough_t *passthrough, const uint8_t *data, size_t len)
+{
+    return frame_flip_show(passthrough->flip, data, len);
+}
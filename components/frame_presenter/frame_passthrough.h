@@ -0,0 +1,23 @@
+// Full-screen frames written straight into the frame buffers of a MIPI-DSI
+// (DPI) panel, flipped on vsync with frame_flip. Private to frame_presenter.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lvgl.h"
+#include "frame_flip.h"
+
+typedef struct frame_passthrough_s frame_passthrough_t;
+
+// NULL if the display is not an RGB565 DPI panel with buffer_count frame buffers
+frame_passthrough_t *frame_passthrough_create(lv_display_t *display, size_t buffer_count);
+
+void frame_passthrough_delete(frame_passthrough_t *passthrough);
+
+// True for frames in exactly the panel's resolution
+bool frame_passthrough_fits(const frame_passthrough_t *passthrough, uint16_t width, uint16_t height);
+
+// Copy the frame into a free frame buffer and flip to it at the next vsync
+bool frame_passthrough_show(frame_passthrough_t *passthrough, const uint8_t *data, size_t len);
@@ -0,0 +1,348 @@
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_lvgl_port.h"
+#include "frame_passthrough.h"
+#include "frame_presenter.h"
+
+static const char *TAG = "frame_presenter";
+
+#define RGB565_BYTES_PER_PIXEL 2
+
+struct frame_presenter_s {
+    frame_presenter_config_t cfg;
+    lv_obj_t *img;                  // The one image widget, created once
+    const lv_image_dsc_t *shown;    // Source set on img: &frame_dsc, &canvas_dsc or NULL
+    uint16_t shown_width;
+    uint16_t shown_height;
+    bool scaled;                    // Source is larger than the parent and scaled down to fit
+
+    frame_slot_t *front;            // Slot on screen, returned to the pool when replaced
+    lv_image_dsc_t frame_dsc;
+
+    uint8_t *canvas;                // Persistent canvas for delta frames
+    uint16_t canvas_width;
+    uint16_t canvas_height;
+    uint32_t canvas_seq;
+    lv_image_dsc_t canvas_dsc;
+
+    frame_passthrough_t *passthrough;   // NULL without passthrough
+    bool passthrough_allowed;           // Unset while other layers share the screen
+    bool passthrough_active;            // LVGL is stopped and frames go to the panel directly
+
+    frame_presenter_stats_t stats;
+};
+
+static void init_dsc(lv_image_dsc_t *dsc, const uint8_t *data, uint16_t width, uint16_t height)
+{
+    memset(dsc, 0, sizeof(*dsc));
+    dsc->header.magic = LV_IMAGE_HEADER_MAGIC;
+    dsc->header.cf = LV_COLOR_FORMAT_RGB565;
+    dsc->header.w = width;
+    dsc->header.h = height;
+    dsc->header.stride = width * RGB565_BYTES_PER_PIXEL;
+    dsc->data_size = (uint32_t)width * height * RGB565_BYTES_PER_PIXEL;
+    dsc->data = data;
+}
+
+// Point the widget at a new source. The layout only changes with the source size.
+static void set_source(frame_presenter_t *presenter, const lv_image_dsc_t *dsc)
+{
+    lv_obj_t *img = presenter->img;
+    lv_image_set_src(img, dsc);
+    presenter->shown = dsc;
+
+    if (dsc->header.w != presenter->shown_width || dsc->header.h != presenter->shown_height) {
+        presenter->shown_width = dsc->header.w;
+        presenter->shown_height = dsc->header.h;
+
+        int32_t parent_width = lv_obj_get_content_width(presenter->cfg.parent);
+        int32_t parent_height = lv_obj_get_content_height(presenter->cfg.parent);
+        presenter->scaled = dsc->header.w > parent_width || dsc->header.h > parent_height;
+        if (presenter->scaled) {
+            lv_obj_set_size(img, lv_pct(100), lv_pct(100));
+            lv_image_set_inner_align(img, LV_IMAGE_ALIGN_CONTAIN);
+        } else {
+            lv_obj_set_size(img, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+            lv_image_set_inner_align(img, LV_IMAGE_ALIGN_DEFAULT);
+        }
+        lv_obj_center(img);
+        lv_obj_update_layout(img);
+        ESP_LOGI(TAG, "Showing %dx%d frames%s", dsc->header.w, dsc->header.h, presenter->scaled ? " scaled to fit" : "");
+    }
+    lv_obj_remove_flag(img, LV_OBJ_FLAG_HIDDEN);
+}
+
+frame_presenter_t *frame_presenter_create(const frame_presenter_config_t *cfg)
+{
+    frame_presenter_t *presenter = calloc(1, sizeof(frame_presenter_t));
+    if (!presenter) {
+        return NULL;
+    }
+    presenter->cfg = *cfg;
+    presenter->passthrough_allowed = true;
+
+    if (cfg->passthrough_display) {
+        presenter->passthrough = frame_passthrough_create(cfg->passthrough_display, cfg->passthrough_buffers);
+        if (!presenter->passthrough) {
+            ESP_LOGW(TAG, "Passthrough unavailable, all frames go through LVGL");
+        }
+    }
+
+    cfg->lock(0);
+    presenter->img = lv_image_create(cfg->parent);
+    lv_obj_add_flag(presenter->img, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_remove_flag(presenter->img, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_move_background(presenter->img);
+    cfg->unlock();
+
+    return presenter;
+}
+
+void frame_presenter_delete(frame_presenter_t *presenter)
+{
+    if (!presenter) {
+        return;
+    }
+
+    presenter->cfg.lock(0);
+    if (presenter->passthrough_active) {
+        lvgl_port_resume();
+    }
+    lv_obj_delete(presenter->img);
+    lv_image_cache_drop(&presenter->frame_dsc);
+    lv_image_cache_drop(&presenter->canvas_dsc);
+    presenter->cfg.unlock();
+
+    frame_pool_release(presenter->cfg.pool, presenter->front);
+    frame_passthrough_delete(presenter->passthrough);
+    heap_caps_free(presenter->canvas);
+    free(presenter);
+}
+
+// Hide the widget and let it keep nothing, the next frame starts from scratch.
+// Called with the lock held; returns the slot that was on screen.
+static frame_slot_t *clear_source(frame_presenter_t *presenter)
+{
+    lv_obj_add_flag(presenter->img, LV_OBJ_FLAG_HIDDEN);
+    lv_image_set_src(presenter->img, NULL);
+    lv_image_cache_drop(&presenter->frame_dsc);
+    presenter->shown = NULL;
+    presenter->shown_width = 0;
+    presenter->shown_height = 0;
+
+    frame_slot_t *previous = presenter->front;
+    presenter->front = NULL;
+    return previous;
+}
+
+// Stop LVGL, so nothing draws into the frame buffers while they are flipped.
+// Called with the lock held; returns the slot that was on screen.
+static frame_slot_t *passthrough_enter(frame_presenter_t *presenter)
+{
+    lvgl_port_stop();
+    presenter->passthrough_active = true;
+    ESP_LOGI(TAG, "Passthrough on");
+    return clear_source(presenter);
+}
+
+// Called with the lock held
+static void passthrough_leave(frame_presenter_t *presenter)
+{
+    if (!presenter->passthrough_active) {
+        return;
+    }
+    presenter->passthrough_active = false;
+    lvgl_port_resume();
+    // The frame buffer holds the last passthrough frame, not what LVGL drew
+    lv_obj_invalidate(lv_obj_get_screen(presenter->cfg.parent));
+    ESP_LOGI(TAG, "Passthrough off");
+}
+
+static void passthrough_show(frame_presenter_t *presenter, frame_slot_t *slot)
+{
+    frame_slot_t *previous = NULL;
+    if (!presenter->passthrough_active) {
+        presenter->cfg.lock(0);
+        previous = passthrough_enter(presenter);
+        presenter->cfg.unlock();
+    }
+
+    // LVGL is stopped, the frame buffers are written without holding the lock
+    size_t size = (size_t)slot->width * slot->height * RGB565_BYTES_PER_PIXEL;
+    bool shown = frame_passthrough_show(presenter->passthrough, slot->data, size);
+
+    presenter->cfg.lock(0);
+    if (shown) {
+        presenter->stats.passthrough_frames++;
+    } else {
+        presenter->stats.passthrough_dropped++;
+    }
+    presenter->cfg.unlock();
+
+    frame_pool_release(presenter->cfg.pool, previous);
+    frame_pool_release(presenter->cfg.pool, slot);
+}
+
+void frame_presenter_show(frame_presenter_t *presenter, frame_slot_t *slot)
+{
+    if (presenter->passthrough_allowed && frame_passthrough_fits(presenter->passthrough, slot->width, slot->height)) {
+        passthrough_show(presenter, slot);
+        return;
+    }
+
+    presenter->cfg.lock(0);
+    passthrough_leave(presenter);
+
+    // The image cache may still hold an entry for the previous pixels
+    lv_image_cache_drop(&presenter->frame_dsc);
+    init_dsc(&presenter->frame_dsc, slot->data, slot->width, slot->height);
+    set_source(presenter, &presenter->frame_dsc);
+
+    frame_slot_t *previous = presenter->front;
+    presenter->front = slot;
+    presenter->stats.frames++;
+
+    presenter->cfg.unlock();
+
+    // Rendering happens under the display lock, so nothing reads the previous frame anymore
+    frame_pool_release(presenter->cfg.pool, previous);
+}
+
+void frame_presenter_hide(frame_presenter_t *presenter)
+{
+    presenter->cfg.lock(0);
+    passthrough_leave(presenter);
+    frame_slot_t *previous = clear_source(presenter);
+    presenter->cfg.unlock();
+
+    frame_pool_release(presenter->cfg.pool, previous);
+}
+
+// Called with the lock held
+static void canvas_free(frame_presenter_t *presenter)
+{
+    if (presenter->shown == &presenter->canvas_dsc) {
+        lv_image_set_src(presenter->img, NULL);
+        presenter->shown = NULL;
+    }
+    lv_image_cache_drop(&presenter->canvas_dsc);
+    heap_caps_free(presenter->canvas);
+    presenter->canvas = NULL;
+    presenter->canvas_width = 0;
+    presenter->canvas_height = 0;
+    presenter->canvas_seq = 0;
+}
+
+void frame_presenter_reset(frame_presenter_t *presenter)
+{
+    presenter->cfg.lock(0);
+    passthrough_leave(presenter);
+    frame_slot_t *previous = clear_source(presenter);
+    canvas_free(presenter);
+    presenter->cfg.unlock();
+
+    frame_pool_release(presenter->cfg.pool, previous);
+}
+
+void frame_presenter_set_passthrough(frame_presenter_t *presenter, bool allowed)
+{
+    presenter->cfg.lock(0);
+    presenter->passthrough_allowed = allowed;
+    if (!allowed) {
+        passthrough_leave(presenter);
+    }
+    presenter->cfg.unlock();
+}
+
+static bool canvas_prepare(frame_presenter_t *presenter, const frame_delta_t *delta)
+{
+    if (presenter->canvas && delta->width == presenter->canvas_width && delta->height == presenter->canvas_height) {
+        return true;
+    }
+
+    // A new canvas starts out undefined, only a key frame can fill it
+    if (!frame_delta_is_key(delta)) {
+        ESP_LOGW(TAG, "Delta seq %u for a %dx%d canvas without key frame, dropping",
+                 (unsigned) delta->seq, delta->width, delta->height);
+        return false;
+    }
+
+    if (presenter->canvas) {
+        canvas_free(presenter);
+    }
+
+    size_t canvas_size = (size_t)delta->width * delta->height * RGB565_BYTES_PER_PIXEL;
+    presenter->canvas = heap_caps_aligned_alloc(FRAME_POOL_DEFAULT_ALIGN, canvas_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!presenter->canvas) {
+        ESP_LOGE(TAG, "Failed to allocate %dx%d delta canvas", delta->width, delta->height);
+        presenter->canvas_width = 0;
+        presenter->canvas_height = 0;
+        return false;
+    }
+    presenter->canvas_width = delta->width;
+    presenter->canvas_height = delta->height;
+    init_dsc(&presenter->canvas_dsc, presenter->canvas, delta->width, delta->height);
+
+    ESP_LOGI(TAG, "Delta canvas %dx%d allocated", delta->width, delta->height);
+    return true;
+}
+
+bool frame_presenter_patch(frame_presenter_t *presenter, const frame_delta_t *delta)
+{
+    frame_slot_t *previous = NULL;
+
+    presenter->cfg.lock(0);
+    passthrough_leave(presenter);
+
+    if (!canvas_prepare(presenter, delta)) {
+        presenter->stats.deltas_dropped++;
+        presenter->cfg.unlock();
+        return false;
+    }
+    if (delta->seq != presenter->canvas_seq + 1 && !frame_delta_is_key(delta)) {
+        ESP_LOGW(TAG, "Delta seq %u after %u, canvas may be stale until the next key frame",
+                 (unsigned) delta->seq, (unsigned) presenter->canvas_seq);
+        presenter->stats.delta_gaps++;
+    }
+    presenter->canvas_seq = delta->seq;
+
+    // Rendering reads the canvas under the same lock, so no patch is ever half drawn
+    frame_delta_apply(delta, presenter->canvas, presenter->canvas_width * RGB565_BYTES_PER_PIXEL);
+
+    if (presenter->shown != &presenter->canvas_dsc) {
+        // Switching over from full frames redraws the whole widget anyway
+        set_source(presenter, &presenter->canvas_dsc);
+        previous = presenter->front;
+        presenter->front = NULL;
+    } else if (presenter->scaled) {
+        lv_obj_invalidate(presenter->img);
+    } else {
+        lv_area_t coords;
+        lv_obj_get_coords(presenter->img, &coords);
+        for (size_t i = 0; i < delta->rect_count; i++) {
+            frame_rect_t r = frame_delta_rect(delta, i);
+            lv_area_t area = {
+                .x1 = coords.x1 + r.x,
+                .y1 = coords.y1 + r.y,
+                .x2 = coords.x1 + r.x + r.w - 1,
+                .y2 = coords.y1 + r.y + r.h - 1,
+            };
+            lv_obj_invalidate_area(presenter->img, &area);
+        }
+    }
+    presenter->stats.deltas++;
+
+    presenter->cfg.unlock();
+
+    frame_pool_release(presenter->cfg.pool, previous);
+    return true;
+}
+
+void frame_presenter_get_stats(frame_presenter_t *presenter, frame_presenter_stats_t *stats)
+{
+    presenter->cfg.lock(0);
+    *stats = presenter->stats;
+    presenter->cfg.unlock();
+}
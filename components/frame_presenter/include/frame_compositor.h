@@ -0,0 +1,106 @@
+/**
+ * @file
+ * @brief Shows the frames of several senders in z-ordered screen layers
+ *
+ * Every layer of a frame_layers_t table gets a container widget covering its
+ * region with a frame_presenter inside. Containers are stacked in z-order at
+ * the bottom of the parent, so widgets created on the parent later (labels,
+ * the sensor dashboard) stay on top of all frames. Frames go to the layer
+ * named by frame_slot_t::layer; each layer keeps its own full frame, delta
+ * canvas and scaling.
+ *
+ * Layers are created the first time they are used and kept for later
+ * senders. Passthrough is only used by layer 0, and only while it is the one
+ * layer in use and covers the whole screen.
+ *
+ * Like frame_presenter, all functions take the display lock themselves. They
+ * must all be called from the same task, the one that displays frames.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+#include "frame_delta.h"
+#include "frame_layers.h"
+#include "frame_pool.h"
+#include "frame_presenter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Compositor configuration
+ */
+typedef struct {
+    lv_obj_t *parent;                   /*!< Screen the layers are stacked on */
+    frame_pool_t *pool;                 /*!< Pool the presented slots go back to */
+    bool (*lock)(uint32_t timeout_ms);  /*!< Display lock, e.g. bsp_display_lock */
+    void (*unlock)(void);               /*!< Display unlock, e.g. bsp_display_unlock */
+    lv_display_t *passthrough_display;  /*!< MIPI-DSI display for passthrough of layer 0, NULL for none */
+    size_t passthrough_buffers;         /*!< Frame buffers of the DPI panel (CONFIG_BSP_LCD_DPI_BUFFER_NUMS) */
+} frame_compositor_config_t;
+
+/**
+ * @brief Compositor counters
+ */
+typedef struct {
+    frame_presenter_stats_t presenter;  /*!< Sum over all layers */
+    uint32_t layers;                    /*!< Layers in use */
+    uint32_t unrouted;                  /*!< Frames for a layer nobody owned anymore when they got here */
+} frame_compositor_stats_t;
+
+typedef struct frame_compositor_s frame_compositor_t;
+
+/**
+ * @brief Create the compositor, without any layer yet
+ *
+ * @return NULL if out of memory
+ */
+frame_compositor_t *frame_compositor_create(const frame_compositor_config_t *cfg);
+
+/**
+ * @brief Delete all layers and give the slots on screen back to the pool
+ */
+void frame_compositor_delete(frame_compositor_t *compositor);
+
+/**
+ * @brief Bring the layers on screen in line with a copy of the layer table
+ *
+ * Layers that were released are hidden, layers claimed anew or moved start
+ * out empty in their new region, and the stacking order is fixed up. Cheap
+ * if nothing changed since the last call.
+ */
+void frame_compositor_sync(frame_compositor_t *compositor, const frame_layers_t *layers);
+
+/**
+ * @brief Show a full RGB565 frame in layer slot->layer
+ *
+ * Takes ownership of the slot, see frame_presenter_show().
+ */
+void frame_compositor_show(frame_compositor_t *compositor, frame_slot_t *slot);
+
+/**
+ * @brief Patch a delta frame into the canvas of layer `layer`
+ *
+ * @return false if the delta was dropped
+ */
+bool frame_compositor_patch(frame_compositor_t *compositor, uint8_t layer, const frame_delta_t *delta);
+
+/**
+ * @brief Hide the frames of every layer, e.g. while the dashboard takes over the display
+ *
+ * The next frame of a layer shows that layer again.
+ */
+void frame_compositor_hide(frame_compositor_t *compositor);
+
+/**
+ * @brief Read the counters
+ */
+void frame_compositor_get_stats(frame_compositor_t *compositor, frame_compositor_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
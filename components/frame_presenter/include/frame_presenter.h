@@ -0,0 +1,119 @@
+/**
+ * @file
+ * @brief Shows received frames with one long-lived LVGL image widget
+ *
+ * The presenter creates its image widget once and only swaps the pixel data
+ * behind it. A full frame stays in its frame_pool slot while it is on screen
+ * and goes back to the pool when the next frame replaces it, so with a pool
+ * of three or more slots the next frames are received while the current one
+ * is rendered. Delta frames are patched into a persistent canvas shown by
+ * the same widget.
+ *
+ * With passthrough enabled, full frames in exactly the panel's resolution
+ * skip LVGL: they are copied into a free frame buffer of the MIPI-DSI panel
+ * and flipped to on vsync while LVGL rendering is stopped. The first frame or
+ * delta that does not fit resumes LVGL and redraws the screen.
+ *
+ * All functions take the display lock themselves and must not be called
+ * with it held.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lvgl.h"
+#include "frame_delta.h"
+#include "frame_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Presenter configuration
+ */
+typedef struct {
+    lv_obj_t *parent;                   /*!< Screen (or container) the image widget is created on */
+    frame_pool_t *pool;                 /*!< Pool the presented slots go back to */
+    bool (*lock)(uint32_t timeout_ms);  /*!< Display lock, e.g. bsp_display_lock */
+    void (*unlock)(void);               /*!< Display unlock, e.g. bsp_display_unlock */
+    lv_display_t *passthrough_display;  /*!< MIPI-DSI display for passthrough, NULL to always render with LVGL */
+    size_t passthrough_buffers;         /*!< Frame buffers of the DPI panel (CONFIG_BSP_LCD_DPI_BUFFER_NUMS) */
+} frame_presenter_config_t;
+
+/**
+ * @brief Presenter counters
+ */
+typedef struct {
+    uint32_t frames;                    /*!< Full frames shown */
+    uint32_t deltas;                    /*!< Delta frames patched into the canvas */
+    uint32_t deltas_dropped;            /*!< Delta frames dropped for want of a key frame or canvas memory */
+    uint32_t delta_gaps;                /*!< Delta frames whose seq did not follow the previous one */
+    uint32_t passthrough_frames;        /*!< Full frames flipped onto the panel without LVGL */
+    uint32_t passthrough_dropped;       /*!< Passthrough frames dropped because no frame buffer became free */
+} frame_presenter_stats_t;
+
+typedef struct frame_presenter_s frame_presenter_t;
+
+/**
+ * @brief Create the presenter and its (hidden) image widget
+ *
+ * @return NULL if out of memory
+ */
+frame_presenter_t *frame_presenter_create(const frame_presenter_config_t *cfg);
+
+/**
+ * @brief Delete the widget and canvas and give the slot on screen back to the pool
+ */
+void frame_presenter_delete(frame_presenter_t *presenter);
+
+/**
+ * @brief Show a full RGB565 frame of slot->width x slot->height pixels
+ *
+ * Takes ownership of the slot. Frames larger than the parent are scaled down
+ * to fit, smaller ones are centered. Passthrough frames are copied and the
+ * slot goes back to the pool right away.
+ */
+void frame_presenter_show(frame_presenter_t *presenter, frame_slot_t *slot);
+
+/**
+ * @brief Hide the frame on screen, e.g. while other widgets take over the display
+ *
+ * Leaves passthrough and gives the slot on screen back to the pool. The next
+ * frame or delta shows the widget again; the delta canvas is kept.
+ */
+void frame_presenter_hide(frame_presenter_t *presenter);
+
+/**
+ * @brief Hide the frame on screen and free the delta canvas, e.g. when another sender takes over
+ */
+void frame_presenter_reset(frame_presenter_t *presenter);
+
+/**
+ * @brief Allow or forbid passthrough, e.g. while other widgets share the screen
+ *
+ * Forbidding it while frames are flipped resumes LVGL; the next full frame
+ * is rendered through the image widget. Allowed by default if configured.
+ */
+void frame_presenter_set_passthrough(frame_presenter_t *presenter, bool allowed);
+
+/**
+ * @brief Patch a delta frame into the canvas and redraw only its rectangles
+ *
+ * The delta must have been validated with frame_delta_parse(). A canvas of a
+ * new size is only set up by a key frame.
+ *
+ * @return false if the delta was dropped
+ */
+bool frame_presenter_patch(frame_presenter_t *presenter, const frame_delta_t *delta);
+
+/**
+ * @brief Read the counters
+ */
+void frame_presenter_get_stats(frame_presenter_t *presenter, frame_presenter_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @brief Sensor dashboard: LVGL widgets bound to sensor values
+ *
+ * Instead of streaming pixels, a sender can load a layout once and from then
+ * on only send sensor values. Each one is a few hundred bytes of JSON that
+ * redraws just the widgets bound to it.
+ *
+ * Every sensor key gets two lv_subject_t: "<key>" holds the value rounded to
+ * an integer, "<key>_text" its display string. Layouts are LVGL XML
+ * components that bind widgets to these subjects by name. LVGL has no XML
+ * binding for bars and charts, so the dashboard adds sensor_bar and
+ * sensor_chart, which take the same attributes as lv_bar and lv_chart plus
+ * bind_value. A chart appends every new value to its first series.
+ * @code
+ * <component>
+ *   <view extends="lv_obj" width="100%" height="100%" flex_flow="column">
+ *     <lv_label bind_text="cpu_text 'CPU %s'"/>
+ *     <lv_arc bind_value="cpu"/>
+ *     <sensor_bar bind_value="gpu" range="0 100"/>
+ *     <sensor_chart bind_value="fps" point_count="60">
+ *       <lv_chart-series color="0x00ff00"/>
+ *     </sensor_chart>
+ *   </view>
+ * </component>
+ * @endcode
+ *
+ * Sensors named in a bind_* attribute of a layout are created before the
+ * layout is, others on their first update. Their subjects are registered as
+ * XML globals, which cannot be removed again, so the dashboard is never
+ * deleted.
+ *
+ * All functions take the display lock themselves and must not be called
+ * with it held.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSOR_DASHBOARD_MAX_SENSORS    32  /*!< Sensors the dashboard keeps subjects for */
+#define SENSOR_DASHBOARD_KEY_LEN        32  /*!< Longest sensor key plus the terminating NUL */
+#define SENSOR_DASHBOARD_TEXT_LEN       32  /*!< Longest display string plus the terminating NUL */
+
+/**
+ * @brief Dashboard configuration
+ */
+typedef struct {
+    lv_obj_t *parent;                   /*!< Screen (or container) layouts are created on */
+    bool (*lock)(uint32_t timeout_ms);  /*!< Display lock, e.g. bsp_display_lock */
+    void (*unlock)(void);               /*!< Display unlock, e.g. bsp_display_unlock */
+} sensor_dashboard_config_t;
+
+/**
+ * @brief Dashboard counters
+ */
+typedef struct {
+    uint32_t layouts;                   /*!< Layouts loaded */
+    uint32_t layout_errors;             /*!< Layouts the XML engine rejected */
+    uint32_t updates;                   /*!< Sensor values that changed a subject */
+    uint32_t unchanged;                 /*!< Sensor values equal to the previous one, only charts redrawn */
+    uint32_t dropped;                   /*!< Updates of new sensors once the table was full */
+} sensor_dashboard_stats_t;
+
+typedef struct sensor_dashboard_s sensor_dashboard_t;
+
+/**
+ * @brief Create the dashboard and register sensor_bar and sensor_chart with the XML engine
+ *
+ * @return NULL if out of memory
+ */
+sensor_dashboard_t *sensor_dashboard_create(const sensor_dashboard_config_t *cfg);
+
+/**
+ * @brief Replace the layout on screen
+ *
+ * @param xml NUL terminated XML component, see the file description
+ * @return false if the XML engine rejected it; the dashboard is empty then
+ */
+bool sensor_dashboard_load(sensor_dashboard_t *dashboard, const char *xml);
+
+/**
+ * @brief Delete the layout on screen, if any
+ */
+void sensor_dashboard_clear(sensor_dashboard_t *dashboard);
+
+/**
+ * @brief True while a layout is on screen
+ */
+bool sensor_dashboard_is_active(sensor_dashboard_t *dashboard);
+
+/**
+ * @brief Set one sensor, bound widgets redraw if the value changed
+ *
+ * @param key Sensor key, `key_len` bytes, not NUL terminated
+ * @param text Display string, NULL to show the value itself
+ * @return false if the key is too long or the sensor table is full
+ */
+bool sensor_dashboard_set(sensor_dashboard_t *dashboard, const char *key, size_t key_len,
+                          double value, const char *text);
+
+/**
+ * @brief Read the counters
+ */
+void sensor_dashboard_get_stats(sensor_dashboard_t *dashboard, sensor_dashboard_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,254 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "others/xml/lv_xml_parser.h"
+#include "others/xml/lv_xml_utils.h"
+#include "others/xml/lv_xml_widget.h"
+#include "others/xml/parsers/lv_xml_bar_parser.h"
+#include "others/xml/parsers/lv_xml_chart_parser.h"
+#include "sensor_dashboard.h"
+
+#if !LV_USE_XML
+#error "sensor_dashboard loads its layouts with the LVGL XML engine, enable CONFIG_LV_USE_XML"
+#endif
+
+static const char *TAG = "sensor_dashboard";
+
+#define LAYOUT_COMPONENT    "sensor_dashboard_layout"
+#define TEXT_SUFFIX         "_text"
+
+typedef struct {
+    char key[SENSOR_DASHBOARD_KEY_LEN];
+    lv_subject_t value;                         // Rounded value, for arcs, bars and charts
+    lv_subject_t text;                          // Display string, for labels
+    char text_buf[SENSOR_DASHBOARD_TEXT_LEN];
+    char text_prev[SENSOR_DASHBOARD_TEXT_LEN];
+} sensor_t;
+
+struct sensor_dashboard_s {
+    sensor_dashboard_config_t cfg;
+    lv_obj_t *root;                 // Layout on screen, NULL without one
+    sensor_t sensors[SENSOR_DASHBOARD_MAX_SENSORS];
+    size_t sensor_count;
+    sensor_dashboard_stats_t stats;
+};
+
+// Called with the lock held
+static sensor_t *sensor_get(sensor_dashboard_t *dashboard, const char *key, size_t key_len, bool add)
+{
+    if (key_len == 0 || key_len >= SENSOR_DASHBOARD_KEY_LEN) {
+        return NULL;
+    }
+    for (size_t i = 0; i < dashboard->sensor_count; i++) {
+        sensor_t *sensor = &dashboard->sensors[i];
+        if (strncmp(sensor->key, key, key_len) == 0 && sensor->key[key_len] == '\0') {
+            return sensor;
+        }
+    }
+    if (!add || dashboard->sensor_count == SENSOR_DASHBOARD_MAX_SENSORS) {
+        return NULL;
+    }
+
+    sensor_t *sensor = &dashboard->sensors[dashboard->sensor_count++];
+    memcpy(sensor->key, key, key_len);
+    sensor->key[key_len] = '\0';
+    lv_subject_init_int(&sensor->value, 0);
+    lv_subject_init_string(&sensor->text, sensor->text_buf, sensor->text_prev, SENSOR_DASHBOARD_TEXT_LEN, "");
+
+    char text_name[SENSOR_DASHBOARD_KEY_LEN + sizeof(TEXT_SUFFIX)];
+    snprintf(text_name, sizeof(text_name), "%s" TEXT_SUFFIX, sensor->key);
+    lv_xml_register_subject(NULL, sensor->key, &sensor->value);
+    lv_xml_register_subject(NULL, text_name, &sensor->text);
+    return sensor;
+}
+
+// Subjects are looked up while the layout is created, so every sensor a
+// bind_* attribute names has to exist by then. The subject name is the
+// first word of the attribute value.
+static void declare_bound_sensors(sensor_dashboard_t *dashboard, const char *xml)
+{
+    for (const char *p = strstr(xml, "bind_"); p; p = strstr(p + 1, "bind_")) {
+        const char *q = p + 5;
+        while (*q == '_' || (*q >= 'a' && *q <= 'z')) {
+            q++;
+        }
+        while (*q == ' ') {
+            q++;
+        }
+        if (*q++ != '=') {
+            continue;
+        }
+        while (*q == ' ') {
+            q++;
+        }
+        if (*q != '"' && *q != '\'') {
+            continue;
+        }
+        char quote = *q++;
+        size_t len = 0;
+        while (q[len] && q[len] != quote && q[len] != ' ') {
+            len++;
+        }
+
+        const size_t suffix_len = sizeof(TEXT_SUFFIX) - 1;
+        if (len > suffix_len && memcmp(q + len - suffix_len, TEXT_SUFFIX, suffix_len) == 0) {
+            len -= suffix_len;
+        }
+        if (!sensor_get(dashboard, q, len, true)) {
+            ESP_LOGW(TAG, "No room for sensor %.*s", (int) len, q);
+        }
+    }
+}
+
+static void bar_observer_cb(lv_observer_t *observer, lv_subject_t *subject)
+{
+    lv_bar_set_value(lv_observer_get_target_obj(observer), lv_subject_get_int(subject), LV_ANIM_OFF);
+}
+
+static void chart_observer_cb(lv_observer_t *observer, lv_subject_t *subject)
+{
+    // The series are children in the XML and only exist after the first call
+    lv_obj_t *chart = lv_observer_get_target_obj(observer);
+    lv_chart_series_t *series = lv_chart_get_series_next(chart, NULL);
+    if (series) {
+        lv_chart_set_next_value(chart, series, lv_subject_get_int(subject));
+    }
+}
+
+static void bind_value(lv_xml_parser_state_t *state, const char **attrs, lv_observer_cb_t cb)
+{
+    const char *name = lv_xml_get_value_of(attrs, "bind_value");
+    if (!name) {
+        return;
+    }
+    lv_subject_t *subject = lv_xml_get_subject(&state->scope, name);
+    if (!subject) {
+        ESP_LOGW(TAG, "Layout binds to unknown subject %s", name);
+        return;
+    }
+    lv_subject_add_observer_obj(subject, cb, lv_xml_state_get_item(state), NULL);
+}
+
+static void sensor_bar_xml_apply(lv_xml_parser_state_t *state, const char **attrs)
+{
+    lv_xml_bar_apply(state, attrs);
+    bind_value(state, attrs, bar_observer_cb);
+}
+
+static void sensor_chart_xml_apply(lv_xml_parser_state_t *state, const char **attrs)
+{
+    lv_xml_chart_apply(state, attrs);
+    bind_value(state, attrs, chart_observer_cb);
+}
+
+sensor_dashboard_t *sensor_dashboard_create(const sensor_dashboard_config_t *cfg)
+{
+    sensor_dashboard_t *dashboard = calloc(1, sizeof(sensor_dashboard_t));
+    if (!dashboard) {
+        return NULL;
+    }
+    dashboard->cfg = *cfg;
+
+    cfg->lock(0);
+    lv_xml_widget_register("sensor_bar", lv_xml_bar_create, sensor_bar_xml_apply);
+    lv_xml_widget_register("sensor_chart", lv_xml_chart_create, sensor_chart_xml_apply);
+    cfg->unlock();
+    return dashboard;
+}
+
+// Called with the lock held. The widgets use the component's styles, so they go first.
+static void layout_delete(sensor_dashboard_t *dashboard)
+{
+    if (dashboard->root) {
+        lv_obj_delete(dashboard->root);
+        dashboard->root = NULL;
+    }
+    lv_xml_component_unregister(LAYOUT_COMPONENT);
+}
+
+bool sensor_dashboard_load(sensor_dashboard_t *dashboard, const char *xml)
+{
+    dashboard->cfg.lock(0);
+    layout_delete(dashboard);
+    declare_bound_sensors(dashboard, xml);
+
+    if (lv_xml_component_register_from_data(LAYOUT_COMPONENT, xml) == LV_RESULT_OK) {
+        dashboard->root = lv_xml_create(dashboard->cfg.parent, LAYOUT_COMPONENT, NULL);
+    }
+    bool loaded = dashboard->root != NULL;
+    if (loaded) {
+        lv_obj_move_foreground(dashboard->root);
+        dashboard->stats.layouts++;
+        ESP_LOGI(TAG, "Layout loaded, %u sensors", (unsigned) dashboard->sensor_count);
+    } else {
+        lv_xml_component_unregister(LAYOUT_COMPONENT);
+        dashboard->stats.layout_errors++;
+        ESP_LOGW(TAG, "Layout rejected by the XML engine");
+    }
+    dashboard->cfg.unlock();
+    return loaded;
+}
+
+void sensor_dashboard_clear(sensor_dashboard_t *dashboard)
+{
+    dashboard->cfg.lock(0);
+    layout_delete(dashboard);
+    dashboard->cfg.unlock();
+}
+
+bool sensor_dashboard_is_active(sensor_dashboard_t *dashboard)
+{
+    dashboard->cfg.lock(0);
+    bool active = dashboard->root != NULL;
+    dashboard->cfg.unlock();
+    return active;
+}
+
+bool sensor_dashboard_set(sensor_dashboard_t *dashboard, const char *key, size_t key_len,
+                          double value, const char *text)
+{
+    char formatted[SENSOR_DASHBOARD_TEXT_LEN];
+    if (!text) {
+        snprintf(formatted, sizeof(formatted), "%g", value);
+        text = formatted;
+    }
+    int32_t rounded = isfinite(value) ? (int32_t)lround(fmax(fmin(value, INT32_MAX), INT32_MIN)) : 0;
+
+    dashboard->cfg.lock(0);
+    sensor_t *sensor = sensor_get(dashboard, key, key_len, true);
+    if (!sensor) {
+        dashboard->stats.dropped++;
+        dashboard->cfg.unlock();
+        return false;
+    }
+
+    // The value always notifies, a chart appends even a repeated sample and
+    // arcs and bars ignore setting the value they have. Labels only redraw
+    // when the text changed.
+    bool changed = lv_subject_get_int(&sensor->value) != rounded;
+    if (changed) {
+        lv_subject_set_int(&sensor->value, rounded);
+    } else {
+        lv_subject_notify(&sensor->value);
+    }
+    if (strncmp(lv_subject_get_string(&sensor->text), text, SENSOR_DASHBOARD_TEXT_LEN - 1) != 0) {
+        lv_subject_copy_string(&sensor->text, text);
+        changed = true;
+    }
+    if (changed) {
+        dashboard->stats.updates++;
+    } else {
+        dashboard->stats.unchanged++;
+    }
+    dashboard->cfg.unlock();
+    return true;
+}
+
+void sensor_dashboard_get_stats(sensor_dashboard_t *dashboard, sensor_dashboard_stats_t *stats)
+{
+    dashboard->cfg.lock(0);
+    *stats = dashboard->stats;
+    dashboard->cfg.unlock();
+}
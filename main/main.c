@@ -1,24 +1,53 @@
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
-#include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_task_wdt.h"
 #include "esp_system.h"
+#include "esp_heap_caps.h"
 #include "esp_timer.h"
 #include "esp_eth.h"
 #include "esp_netif.h"
 #include "esp_event.h"
 #include "esp_http_server.h"
+#include "lwip/sockets.h"
 #include "cJSON.h"
 #include "bsp/esp32_p4_nano.h"
+#include "esp_lvgl_port.h"
 #include "lvgl.h"
+#if CONFIG_FRAME_LVGL_BENCHMARK
+#include "demos/lv_demos.h"
+#endif
+#include "frame_pool.h"
+#include "frame_compositor.h"
+#include "frame_ring.h"
+#include "frame_codec.h"
+#include "frame_delta.h"
+#include "frame_layers.h"
+#include "frame_msg.h"
+#include "frame_rx.h"
+#include "frame_stats.h"
+#include "frame_tiles.h"
+#include "json_pull.h"
+#include "sensor_dashboard.h"
+#include "sensor_table.h"
+#include "ws_assembler.h"
 
 static const char *TAG = "ESP32_P4_DSI";
 
+// Logging every message costs milliseconds over the UART, so it is opt-in
+#ifdef CONFIG_FRAME_LOG_VERBOSE
+#define FRAME_LOG_VERBOSE 1
+#else
+#define FRAME_LOG_VERBOSE 0
+#endif
+#define FRAME_LOGI(...) do { if (FRAME_LOG_VERBOSE) { ESP_LOGI(TAG, __VA_ARGS__); } } while (0)
+
 // Ethernet networking
 #define ETH_CONNECTED_BIT BIT0
 static EventGroupHandle_t s_network_event_group;
@@ -26,21 +55,53 @@ static httpd_handle_t server = NULL;
 static char device_ip[16] = {0};
 static char device_mac[18] = {0};
 
-// Image display structures
+// Frame handling
+#define TEXT_MESSAGE_MAX_LEN 4096   // Requests up to this size are received into text_buf
+#define RECV_TIMEOUT_RETRIES 5      // Consecutive socket timeouts tolerated inside one request body
+static frame_ring_t *frame_ring = NULL;          // Received frames waiting for the display task
+static TaskHandle_t frame_display_task_handle = NULL;
+static volatile int layer_ack_sockfd[FRAME_LAYERS_MAX];   // WebSocket that gets the messages of each layer, -1 for none
+static uint32_t frames_stale = 0;               // Frames replaced by a newer one before they were shown
+static uint32_t frames_dropped = 0;             // Frames dropped on arrival, every buffer held a needed frame
+static bool key_frame_requested[FRAME_LAYERS_MAX];  // No self-contained frame queued since the last request, httpd task
+static uint32_t key_frame_requests = 0;
+static frame_stats_t *frame_stats = NULL;       // Per-stage latency histograms
+static frame_pool_t *frame_pool = NULL;
+static frame_rx_stats_t frame_rx_stats;
+static uint32_t last_reported_exhausted = 0;
+static uint32_t last_reported_rx_errors = 0;
+static lv_display_t *display_handle = NULL;
+static frame_compositor_t *compositor = NULL;
+static sensor_dashboard_t *dashboard = NULL;   // Sensor widgets, on screen instead of frames while a layout is loaded
+static uint32_t frames_hidden = 0;              // Frames dropped because the dashboard was on screen
+static sensor_table_t *sensor_table = NULL;     // Latest sensor values, only changes reach the dashboard
+static lv_obj_t *ready_label = NULL;
+
+// Every sender has its own frame format, dimensions and screen layer, so a dashboard
+// and an alert overlay can send at the same time without changing each other's frames
 typedef struct {
-    uint8_t *data;
-    size_t size;
-    uint16_t width;
+    uint32_t id;                    // Owner id in frame_layers
+    uint8_t layer;                  // Layer its frames go to
+    frame_format_t format;          // Of its full frames
+    uint16_t width;                 // From its blit_config
     uint16_t height;
-    bool is_config;
-} frame_message_t;
+    bool config_received;
+    uint32_t messages;              // Messages received so far, numbers the log lines
+} frame_client_t;
 
-// Frame handling
-static QueueHandle_t frame_queue = NULL;
-static uint16_t current_frame_width = 0;
-static uint16_t current_frame_height = 0;
-static bool config_received = false;
-static lv_display_t *display_handle = NULL;
+// Claimed and released on the httpd task, copied by the display task under the lock
+static frame_layers_t frame_layers;
+static portMUX_TYPE frame_layers_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t next_client_id = 1;
+static frame_client_t http_client;  // HTTP POST senders have no connection to tell them apart
+
+// UDP senders share one client as well, their tiles are reassembled on the UDP task
+static frame_tiles_t *frame_tiles = NULL;
+#if CONFIG_FRAME_UDP_TRANSPORT
+#define FRAME_UDP_DATAGRAM_MAX 1472     // One Ethernet frame, IP fragments would be lost together
+#define FRAME_UDP_NACK_MAX 256
+static frame_client_t udp_client;
+#endif
 
 // Common frame dimension detection
 typedef struct {
@@ -67,7 +128,7 @@ static bool detect_frame_dimensions(uint32_t frame_size, uint16_t *width, uint16
         if (common_dimensions[i].bytes == frame_size) {
             *width = common_dimensions[i].width;
             *height = common_dimensions[i].height;
-            ESP_LOGI(TAG, "Detected common dimension: %dx%d (%d bytes)", *width, *height, frame_size);
+            FRAME_LOGI("Detected common dimension: %dx%d (%d bytes)", *width, *height, frame_size);
             return true;
         }
     }
@@ -84,7 +145,7 @@ static bool detect_frame_dimensions(uint32_t frame_size, uint16_t *width, uint16
             if (h <= 2048 && w <= 2048) {  // Reasonable limits
                 *width = (uint16_t)w;
                 *height = (uint16_t)h;
-                ESP_LOGI(TAG, "Auto-detected dimension: %dx%d (%d bytes)", *width, *height, frame_size);
+                FRAME_LOGI("Auto-detected dimension: %dx%d (%d bytes)", *width, *height, frame_size);
                 return true;
             }
         }
@@ -94,121 +155,199 @@ static bool detect_frame_dimensions(uint32_t frame_size, uint16_t *width, uint16
     return false;
 }
 
-static void rgb565_to_lvgl_display(const uint8_t *rgb565_data, uint32_t data_size, uint16_t width, uint16_t height)
+static void *frame_pool_psram_alloc(size_t alignment, size_t size, void *user_ctx)
 {
-    if (!display_handle) {
-        ESP_LOGE(TAG, "Display handle not initialized");
-        return;
-    }
-
-    uint32_t expected_bytes = (uint32_t)width * (uint32_t)height * 2U;
-    if (data_size != expected_bytes) {
-        ESP_LOGW(TAG, "Frame size mismatch: got %u bytes, expected %u for %dx%d",
-                 (unsigned) data_size, (unsigned) expected_bytes, width, height);
-    }
+    return heap_caps_aligned_alloc(alignment, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+}
 
-    int32_t disp_width = lv_display_get_horizontal_resolution(display_handle);
-    int32_t disp_height = lv_display_get_vertical_resolution(display_handle);
+static void frame_pool_psram_free(void *ptr, void *user_ctx)
+{
+    heap_caps_free(ptr);
+}
 
-    ESP_LOGI(TAG, "Updating display with %dx%d frame (display is %dx%d)",
-             width, height, disp_width, disp_height);
+#define LAYER_MESSAGE_MAX_LEN 48
 
-    lv_obj_t *screen = lv_screen_active();
-    lv_obj_clean(screen);
+typedef struct {
+    int sockfd;
+    char text[LAYER_MESSAGE_MAX_LEN];
+} layer_message_t;
 
-    lv_obj_t *img_obj = lv_img_create(screen);
+static void layer_message_send(void *arg)
+{
+    layer_message_t *msg = arg;
+    httpd_ws_frame_t pkt = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *)msg->text,
+        .len = strlen(msg->text),
+    };
+    httpd_ws_send_frame_async(server, msg->sockfd, &pkt);
+    free(msg);
+}
 
-    float scale_x = (float)disp_width / (float)width;
-    float scale_y = (float)disp_height / (float)height;
-    float scale = (scale_x < scale_y) ? scale_x : scale_y;
-    if (scale > 1.0f) scale = 1.0f;
+// Send a text message to the WebSocket sender of a layer, if it has one. Sent from the httpd task.
+static void layer_message_queue(uint8_t layer, const char *text)
+{
+    int sockfd = layer_ack_sockfd[layer];
+    if (!server || sockfd < 0) {
+        return;
+    }
+    layer_message_t *msg = malloc(sizeof(layer_message_t));
+    if (!msg) {
+        return;
+    }
+    msg->sockfd = sockfd;
+    snprintf(msg->text, sizeof(msg->text), "%s", text);
+    if (httpd_queue_work(server, layer_message_send, msg) != ESP_OK) {
+        free(msg);
+    }
+}
 
-    int32_t scaled_width = (int32_t)(width * scale);
-    int32_t scaled_height = (int32_t)(height * scale);
-    int32_t pos_x = (disp_width - scaled_width) / 2;
-    int32_t pos_y = (disp_height - scaled_height) / 2;
+// Tell the sender which frame made it onto the screen, so it can pace itself to the
+// display instead of the network.
+static void frame_ack_queue(uint8_t layer, uint32_t seq)
+{
+    char text[LAYER_MESSAGE_MAX_LEN];
+    if (seq == 0) {
+        return;
+    }
+    snprintf(text, sizeof(text), "{\"type\":\"frame-ack\",\"seq\":%u}", (unsigned) seq);
+    layer_message_queue(layer, text);
+}
 
-    /* Build an lv_img_dsc_t dynamically and set header fields according to
-       the LVGL version: modern LVGLs provide LV_COLOR_FORMAT_RGB565 (or similar).
-       If that symbol isn't available in your LVGL, try LV_IMG_CF_TRUE_COLOR (older API). */
+// A frame of the layer was dropped before it was shown: ask the sender for a key frame,
+// which repairs a canvas that missed a delta and tells the sender the display is behind.
+// Asks once until the next self-contained frame of the layer is queued. Runs on the httpd task.
+static void key_frame_request(uint8_t layer)
+{
+    if (key_frame_requested[layer]) {
+        return;
+    }
+    key_frame_requested[layer] = true;
+    key_frame_requests++;
+    layer_message_queue(layer, "{\"type\":\"key-frame-request\"}");
+}
 
-    static lv_img_dsc_t img_dsc;
+// The ready message goes away with the first frame or dashboard layout
+static void ready_label_remove(void)
+{
+    if (ready_label) {
+        bsp_display_lock(0);
+        lv_obj_delete(ready_label);
+        ready_label = NULL;
+        bsp_display_unlock();
+    }
+}
 
-    // Zero the structure first
-    memset(&img_dsc, 0, sizeof(img_dsc));
+// Display one frame in its layer and give its buffer back unless the compositor keeps it
+static void frame_display(frame_slot_t *slot)
+{
+    FRAME_LOGI("Processing frame: %u bytes", (unsigned) slot->size);
 
-    // Set header fields — set only the fields that exist in most LVGLs:
-    img_dsc.header.w = width;
-    img_dsc.header.h = height;
+    ready_label_remove();
 
-    // Try to set a RGB565-specific constant if available.
-    // Preferred modern constant:
-    #ifdef LV_COLOR_FORMAT_RGB565
-        img_dsc.header.cf = LV_COLOR_FORMAT_RGB565;
-    #elif defined(LV_COLOR_FORMAT_NATIVE) && defined(LV_COLOR_DEPTH) && (LV_COLOR_DEPTH == 16)
-        // If LV_COLOR_FORMAT_NATIVE exists and color depth is 16, native usually maps to RGB565
-        img_dsc.header.cf = LV_COLOR_FORMAT_NATIVE;
-    #elif defined(LV_IMG_CF_TRUE_COLOR)
-        // Backwards-compatible fallback for older LVGL versions (v7/v8)
-        img_dsc.header.cf = LV_IMG_CF_TRUE_COLOR;
-    #else
-        // As an ultimate fallback, try a numeric value that works with many LVGL configs:
-        //  -> In some LVGL builds the numeric value for RGB565 is 2 (but this is not portable).
-        // So we leave it zero and hope LVGL is built for RGB565; otherwise adjust per your LVGL.
-        img_dsc.header.cf = 0;
-    #endif
+    // Each layer keeps a full frame's buffer until the next frame replaces it;
+    // delta frames are copied into the layer's canvas.
+    if (frame_delta_is_delta(slot->data, slot->size)) {
+        frame_delta_t delta;
+        if (frame_delta_parse(slot->data, slot->size, &delta) == FRAME_DELTA_OK) {
+            frame_compositor_patch(compositor, slot->layer, &delta);
+        }
+    } else if (slot->size >= (size_t)slot->width * slot->height * 2) {
+        frame_compositor_show(compositor, slot);
+        return;
+    } else {
+        ESP_LOGW(TAG, "Frame too short: got %u bytes for %dx%d",
+                 (unsigned) slot->size, slot->width, slot->height);
+    }
+    frame_pool_release(frame_pool, slot);
+}
 
-    img_dsc.data_size = data_size;
-    img_dsc.data = (const uint8_t *)rgb565_data;
+static void frame_display_task(void *pvParameters)
+{
+    frame_slot_t *batch[CONFIG_FRAME_POOL_SLOTS];
+    bool compositor_hidden = false;
+    frame_layers_t layers;
 
-    // Use variable image source
-    lv_img_set_src(img_obj, &img_dsc);
+    ESP_LOGI(TAG, "Frame display task started");
 
-    // Position and scale the image
-    lv_obj_set_pos(img_obj, pos_x, pos_y);
-    lv_obj_set_size(img_obj, scaled_width, scaled_height);
+    while (1) {
+        // Woken by every queued frame, layer change and dashboard layout, the timeout only
+        // keeps the watchdog fed
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
 
-    // Force refresh
-    lv_refr_now(display_handle);
+        // Layers claimed or given up since the last round, before any of their frames
+        taskENTER_CRITICAL(&frame_layers_lock);
+        layers = frame_layers;
+        taskEXIT_CRITICAL(&frame_layers_lock);
+        frame_compositor_sync(compositor, &layers);
 
-    ESP_LOGI(TAG, "Frame displayed: %dx%d scaled to %dx%d at (%d,%d)",
-             width, height, scaled_width, scaled_height, pos_x, pos_y);
-}
+        // Latest frame wins: take everything queued and skip what a newer
+        // self-contained frame of the same layer makes stale. Deltas after it
+        // are applied in order.
+        size_t count = 0;
+        while (count < CONFIG_FRAME_POOL_SLOTS && (batch[count] = frame_ring_pop(frame_ring)) != NULL) {
+            count++;
+        }
 
+        // The compositor is only ever driven from this task, so hiding it cannot
+        // race a frame that is being shown or flipped.
+        if (dashboard && sensor_dashboard_is_active(dashboard)) {
+            if (!compositor_hidden) {
+                ready_label_remove();
+                frame_compositor_hide(compositor);
+                compositor_hidden = true;
+            }
+            for (size_t i = 0; i < count; i++) {
+                frame_pool_release(frame_pool, batch[i]);
+            }
+            frames_hidden += count;
+            esp_task_wdt_reset();
+            continue;
+        }
+        compositor_hidden = false;
 
-static void frame_display_task(void *pvParameters)
-{
-    frame_message_t frame_msg;
-    
-    ESP_LOGI(TAG, "Frame display task started");
-    
-    while (1) {
-        // Wait for frame data
-        if (xQueueReceive(frame_queue, &frame_msg, portMAX_DELAY) == pdTRUE) {
-            if (frame_msg.is_config) {
-                // Handle configuration message
-                ESP_LOGI(TAG, "Config updated: %dx%d", frame_msg.width, frame_msg.height);
-                current_frame_width = frame_msg.width;
-                current_frame_height = frame_msg.height;
-                config_received = true;
-            } else if (frame_msg.data && frame_msg.size > 0) {
-                // Handle frame data
-                uint16_t display_width = frame_msg.width;
-                uint16_t display_height = frame_msg.height;
-                
-                // Show frame info
-                ESP_LOGI(TAG, "Processing frame: %d bytes", frame_msg.size);
-                
-                // Display frame
-                rgb565_to_lvgl_display(frame_msg.data, frame_msg.size, display_width, display_height);
+        size_t newest_self_contained[FRAME_LAYERS_MAX] = {0};
+        for (size_t i = 1; i < count; i++) {
+            if (batch[i]->self_contained) {
+                newest_self_contained[batch[i]->layer] = i;
             }
-            
-            // Free the frame data
-            if (frame_msg.data) {
-                free(frame_msg.data);
+        }
+        size_t stale = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (i < newest_self_contained[batch[i]->layer]) {
+                frame_pool_release(frame_pool, batch[i]);
+                batch[i] = NULL;
+                stale++;
             }
         }
-        
+        if (stale) {
+            frames_stale += stale;
+            ESP_LOGW(TAG, "Skipped %u stale frames (%u total)", (unsigned) stale, (unsigned) frames_stale);
+        }
+
+        uint32_t shown_seq[FRAME_LAYERS_MAX] = {0};
+        for (size_t i = 0; i < count; i++) {
+            if (!batch[i]) {
+                continue;
+            }
+            // Read before the compositor takes the slot over
+            uint8_t layer = batch[i]->layer;
+            shown_seq[layer] = batch[i]->seq;
+            int64_t recv_start_us = batch[i]->recv_start_us;
+            int64_t present_start_us = esp_timer_get_time();
+            frame_stats_record(frame_stats, FRAME_STAGE_QUEUE, (uint32_t)(present_start_us - batch[i]->queued_us));
+
+            frame_display(batch[i]);
+
+            int64_t now = esp_timer_get_time();
+            frame_stats_record(frame_stats, FRAME_STAGE_PRESENT, (uint32_t)(now - present_start_us));
+            frame_stats_record(frame_stats, FRAME_STAGE_TOTAL, (uint32_t)(now - recv_start_us));
+        }
+        for (uint8_t layer = 0; layer < FRAME_LAYERS_MAX; layer++) {
+            frame_ack_queue(layer, shown_seq[layer]);
+        }
+
         // Reset watchdog
         esp_task_wdt_reset();
     }
@@ -241,207 +380,971 @@ static void got_ip_event_handler(void *arg, esp_event_base_t event_base, int32_t
     xEventGroupSetBits(s_network_event_group, ETH_CONNECTED_BIT);
 }
 
-static esp_err_t ws_handler(httpd_req_t *req)
+// Read the whole request body into dst, chunk by chunk. rx keeps the receive state so the
+// caller can still check the frame size against the blit_config dimensions.
+static frame_rx_status_t recv_request_body(httpd_req_t *req, uint8_t *dst, size_t capacity, frame_rx_t *rx)
 {
-    static uint32_t message_count = 1;
-    
-    if (req->method == HTTP_GET) {
-        ESP_LOGI(TAG, "WebSocket client connected");
-        
-        // Send device-connected message (like the Python script)
-        cJSON *device_info = cJSON_CreateObject();
-        cJSON_AddStringToObject(device_info, "type", "device-connected");
-        cJSON_AddNumberToObject(device_info, "timestamp", esp_timer_get_time() / 1000);
-        cJSON_AddStringToObject(device_info, "mac", device_mac);
-        cJSON_AddStringToObject(device_info, "ip", device_ip);
-        cJSON_AddNumberToObject(device_info, "port", 81);
-        cJSON_AddStringToObject(device_info, "protocol", "WebSocket");
-        cJSON_AddNumberToObject(device_info, "clientId", 1);
-        cJSON_AddStringToObject(device_info, "note", "ESP32-P4-Nano Ready for blit frames (dynamic dimensions)");
-        
-        char *json_string = cJSON_Print(device_info);
-        if (json_string) {
-            httpd_resp_set_type(req, "application/json");
-            httpd_resp_send(req, json_string, strlen(json_string));
-            free(json_string);
+    frame_rx_status_t status = frame_rx_begin(rx, &frame_rx_stats, dst, capacity, req->content_len);
+    if (status != FRAME_RX_OK) {
+        return status;
+    }
+
+    int timeouts = 0;
+    while (!frame_rx_done(rx)) {
+        uint8_t *chunk;
+        size_t want = frame_rx_next(rx, &chunk, FRAME_RX_DEFAULT_CHUNK);
+        int ret = httpd_req_recv(req, (char *)chunk, want);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts <= RECV_TIMEOUT_RETRIES) {
+            continue;
         }
-        cJSON_Delete(device_info);
-        return ESP_OK;
+        if (ret <= 0) {
+            break;
+        }
+        timeouts = 0;
+        frame_rx_commit(rx, ret);
     }
-    
-    // Handle incoming data
-    char *buf = malloc(64 * 1024);  // 64KB buffer for larger frames
-    if (!buf) {
-        ESP_LOGE(TAG, "Failed to allocate receive buffer");
-        return ESP_ERR_NO_MEM;
+
+    return frame_rx_end(rx);
+}
+
+// Work out the dimensions of a full RGB565 frame from the blit_config or its size.
+// Returns false if the frame has to be dropped.
+static bool full_frame_dimensions(const frame_client_t *client, size_t len,
+                                  uint16_t *display_width, uint16_t *display_height)
+{
+    *display_width = client->width;
+    *display_height = client->height;
+
+    if (client->config_received && client->width && client->height) {
+        // Use config dimensions
+        uint32_t expected_size = client->width * client->height * 2;
+        if (frame_rx_check_size(&frame_rx_stats, len, expected_size) == FRAME_RX_OK) {
+            FRAME_LOGI("RGB565 Frame (from config): %dx%d pixels (%u bytes)",
+                       client->width, client->height, (unsigned) len);
+            return true;
+        }
+        ESP_LOGW(TAG, "Frame size mismatch with config: got %u bytes, expected %u for %dx%d",
+                 (unsigned) len, (unsigned) expected_size, client->width, client->height);
+        // The frame is complete, so its size is exact; try to detect actual dimensions
+        if (!detect_frame_dimensions(len, display_width, display_height)) {
+            ESP_LOGW(TAG, "Could not detect dimensions, dropping frame");
+            return false;
+        }
+        return true;
     }
-    
-    int recv_len = httpd_req_recv(req, buf, 64 * 1024 - 1);
-    if (recv_len > 0) {
-        // Check if it's text or binary
-        bool is_binary = false;
-        
-        // Simple heuristic: if first few bytes look like binary data, treat as binary
-        for (int i = 0; i < MIN(recv_len, 16); i++) {
-            if (buf[i] < 32 && buf[i] != '\n' && buf[i] != '\r' && buf[i] != '\t') {
-                is_binary = true;
-                break;
-            }
+
+    // Try to auto-detect dimensions
+    if (detect_frame_dimensions(len, display_width, display_height)) {
+        FRAME_LOGI("Auto-detected RGB565 Frame: %dx%d pixels (%u bytes)",
+                   *display_width, *display_height, (unsigned) len);
+    } else {
+        ESP_LOGW(TAG, "Unknown frame format: %u bytes (could not detect dimensions)", (unsigned) len);
+        // Use a reasonable fallback
+        *display_width = 640;
+        *display_height = 480;
+    }
+    return true;
+}
+
+// A free frame buffer for a frame of the layer, or failing that the buffer of the oldest
+// frame waiting for display if a newer self-contained frame of its layer is queued too.
+// The display would skip that one anyway; a delta can't be skipped, so without such a
+// frame the one coming in now is dropped and its sender asked for a key frame.
+static frame_slot_t *frame_slot_acquire(uint8_t layer)
+{
+    frame_slot_t *slot = frame_pool_acquire(frame_pool);
+    if (!slot && (slot = frame_ring_pop_stale(frame_ring)) != NULL) {
+        ESP_LOGW(TAG, "No free frame buffer, dropping oldest queued frame of layer %u", slot->layer);
+        key_frame_request(slot->layer);
+        slot->size = 0;
+        slot->width = 0;
+        slot->height = 0;
+        slot->seq = 0;
+        slot->recv_start_us = 0;
+        slot->queued_us = 0;
+        slot->layer = 0;
+        slot->self_contained = false;
+    } else if (!slot) {
+        frames_dropped++;
+        key_frame_request(layer);
+    }
+    return slot;
+}
+
+// Claim a screen layer for the client and wake the display task to set it up. The HTTP
+// client never disconnects, so others may take a layer over from it. Runs on the httpd task.
+static frame_layers_status_t client_claim_layer(frame_client_t *client, uint8_t layer, const frame_region_t *region)
+{
+    taskENTER_CRITICAL(&frame_layers_lock);
+    frame_layers_status_t status = frame_layers_claim(&frame_layers, layer, client->id, region);
+    if (status == FRAME_LAYERS_BUSY && client != &http_client && frame_layers.layers[layer].owner == http_client.id) {
+        frame_layers_release(&frame_layers, http_client.id);
+        status = frame_layers_claim(&frame_layers, layer, client->id, region);
+    }
+    taskEXIT_CRITICAL(&frame_layers_lock);
+
+    if (status != FRAME_LAYERS_OK) {
+        return status;
+    }
+    client->layer = layer;
+    if (frame_display_task_handle) {
+        xTaskNotifyGive(frame_display_task_handle);
+    }
+    return status;
+}
+
+// Give up the client's layer, its frames disappear from the screen. Runs on the httpd task.
+static void client_release_layer(frame_client_t *client)
+{
+    taskENTER_CRITICAL(&frame_layers_lock);
+    size_t released = frame_layers_release(&frame_layers, client->id);
+    taskEXIT_CRITICAL(&frame_layers_lock);
+
+    if (released && frame_display_task_handle) {
+        xTaskNotifyGive(frame_display_task_handle);
+    }
+}
+
+// Queue a complete binary message (full RGB565 frame or delta frame) of the client for
+// display in its layer. Takes ownership of slot; a frame that was received into a text
+// buffer (slot is NULL) is copied into a fresh frame buffer. seq is echoed back in the
+// frame-ack once the frame is shown, 0 for none; recv_start_us is when its first byte came in.
+static void handle_frame_message(frame_client_t *client, frame_slot_t *slot, const uint8_t *data, size_t len,
+                                 uint32_t seq, int64_t recv_start_us)
+{
+    // Senders without a blit_config get the whole screen in their layer, 0 unless they said otherwise.
+    // Only the httpd task writes the table, so it reads it without the lock.
+    if (frame_layers.layers[client->layer].owner != client->id) {
+        frame_layers_status_t status = client_claim_layer(client, client->layer, NULL);
+        if (status != FRAME_LAYERS_OK) {
+            ESP_LOGW(TAG, "#%u: layer %u: %s, dropping frame", (unsigned) client->messages,
+                     client->layer, frame_layers_status_name(status));
+            frame_pool_release(frame_pool, slot);
+            return;
         }
-        
-        if (is_binary) {
-            // Binary frame data
-            ESP_LOGI(TAG, "#%d: FRAME - %d bytes", message_count, recv_len);
-            
-            // Show first few bytes as hex
-            ESP_LOGI(TAG, "First 8 bytes: %02x %02x %02x %02x %02x %02x %02x %02x", 
-                     (uint8_t)buf[0], (uint8_t)buf[1], (uint8_t)buf[2], (uint8_t)buf[3],
-                     (uint8_t)buf[4], (uint8_t)buf[5], (uint8_t)buf[6], (uint8_t)buf[7]);
-            
-            // Determine frame dimensions
-            uint16_t display_width = current_frame_width;
-            uint16_t display_height = current_frame_height;
-            
-            if (config_received && current_frame_width && current_frame_height) {
-                // Use config dimensions
-                uint32_t expected_size = current_frame_width * current_frame_height * 2;
-                if (recv_len == expected_size) {
-                    ESP_LOGI(TAG, "RGB565 Frame (from config): %dx%d pixels (%d bytes)", 
-                             current_frame_width, current_frame_height, recv_len);
-                } else {
-                    ESP_LOGW(TAG, "Frame size mismatch with config: got %d bytes, expected %d for %dx%d", 
-                             recv_len, expected_size, current_frame_width, current_frame_height);
-                    // Try to detect actual dimensions
-                    if (!detect_frame_dimensions(recv_len, &display_width, &display_height)) {
-                        ESP_LOGW(TAG, "Could not detect dimensions, using config anyway");
-                    }
-                }
-            } else {
-                // Try to auto-detect dimensions
-                if (detect_frame_dimensions(recv_len, &display_width, &display_height)) {
-                    ESP_LOGI(TAG, "Auto-detected RGB565 Frame: %dx%d pixels (%d bytes)", 
-                             display_width, display_height, recv_len);
-                } else {
-                    ESP_LOGW(TAG, "Unknown frame format: %d bytes (could not detect dimensions)", recv_len);
-                    // Use a reasonable fallback
-                    display_width = 640;
-                    display_height = 480;
-                }
+    }
+
+    uint16_t display_width = 0;
+    uint16_t display_height = 0;
+    bool delta = frame_delta_is_delta(data, len);
+    bool self_contained = !delta;
+
+    if (delta) {
+        // Validated here so the display task can apply it without further checks
+        frame_delta_t parsed;
+        frame_delta_status_t status = frame_delta_parse(data, len, &parsed);
+        if (status != FRAME_DELTA_OK) {
+            ESP_LOGW(TAG, "#%u: dropping malformed delta frame (%d)", (unsigned) client->messages, status);
+            frame_pool_release(frame_pool, slot);
+            return;
+        }
+        FRAME_LOGI("#%u: DELTA seq %u - %u rects, %u bytes", (unsigned) client->messages,
+                   (unsigned) parsed.seq, parsed.rect_count, (unsigned) len);
+        display_width = parsed.width;
+        display_height = parsed.height;
+        self_contained = frame_delta_is_key(&parsed);
+    } else {
+        FRAME_LOGI("#%u: FRAME - %u bytes", (unsigned) client->messages, (unsigned) len);
+
+        // Compressed frames are decoded straight into the frame buffer that gets displayed
+        if (frame_format_is_compressed(client->format)) {
+            frame_slot_t *decoded = frame_slot_acquire(client->layer);
+            if (!decoded) {
+                ESP_LOGW(TAG, "No free frame buffer to decode into, dropping frame");
+                frame_pool_release(frame_pool, slot);
+                return;
             }
-            
-            // Queue frame for display
-            if (frame_queue && display_width && display_height) {
-                frame_message_t frame_msg = {0};
-                frame_msg.data = malloc(recv_len);
-                if (frame_msg.data) {
-                    memcpy(frame_msg.data, buf, recv_len);
-                    frame_msg.size = recv_len;
-                    frame_msg.width = display_width;
-                    frame_msg.height = display_height;
-                    frame_msg.is_config = false;
-                    
-                    if (xQueueSend(frame_queue, &frame_msg, 0) != pdTRUE) {
-                        ESP_LOGW(TAG, "Frame queue full, dropping frame");
-                        free(frame_msg.data);
-                    }
-                } else {
-                    ESP_LOGE(TAG, "Failed to allocate frame data");
-                }
+            int64_t decode_start_us = esp_timer_get_time();
+            size_t decoded_len = frame_codec_decode(client->format, data, len, decoded->data, decoded->capacity);
+            frame_stats_record(frame_stats, FRAME_STAGE_DECODE, (uint32_t)(esp_timer_get_time() - decode_start_us));
+            frame_pool_release(frame_pool, slot);
+            if (!decoded_len) {
+                ESP_LOGW(TAG, "Corrupt %s frame, dropping", frame_format_name(client->format));
+                frame_pool_release(frame_pool, decoded);
+                return;
             }
-            
+            FRAME_LOGI("Decoded %s frame: %u -> %u bytes", frame_format_name(client->format),
+                       (unsigned) len, (unsigned) decoded_len);
+            slot = decoded;
+            data = decoded->data;
+            len = decoded_len;
+        }
+
+        // Show first few bytes as hex
+        if (len >= 8) {
+            FRAME_LOGI("First 8 bytes: %02x %02x %02x %02x %02x %02x %02x %02x",
+                       data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]);
+        }
+
+        if (!full_frame_dimensions(client, len, &display_width, &display_height)) {
+            frame_pool_release(frame_pool, slot);
+            return;
+        }
+    }
+
+    // Small frames arrive in a text buffer and still need a frame buffer
+    if (!slot && (slot = frame_slot_acquire(client->layer)) != NULL) {
+        memcpy(slot->data, data, len);
+    }
+
+    if (!slot) {
+        ESP_LOGW(TAG, "No free frame buffer, dropping frame");
+        return;
+    }
+
+    // Queue frame for display, the display task returns the buffer to the pool. A full
+    // ring pushes out its oldest frame if that one is stale, and refuses this one otherwise.
+    slot->size = len;
+    slot->width = display_width;
+    slot->height = display_height;
+    slot->seq = seq;
+    slot->recv_start_us = recv_start_us;
+    slot->queued_us = esp_timer_get_time();
+    slot->layer = client->layer;
+    slot->self_contained = self_contained;
+    frame_slot_t *evicted;
+    if (!frame_ring_push_if_stale(frame_ring, slot, &evicted)) {
+        ESP_LOGW(TAG, "Display behind, dropping frame");
+        frame_pool_release(frame_pool, slot);
+        frames_dropped++;
+        key_frame_request(client->layer);
+        return;
+    }
+    if (self_contained) {
+        key_frame_requested[client->layer] = false;
+    }
+    if (evicted) {
+        ESP_LOGW(TAG, "Display behind, dropping oldest queued frame of layer %u", evicted->layer);
+        key_frame_request(evicted->layer);
+        frame_pool_release(frame_pool, evicted);
+    }
+    if (frame_display_task_handle) {
+        xTaskNotifyGive(frame_display_task_handle);
+    }
+}
+
+static esp_err_t ws_send_text(httpd_req_t *req, const char *text)
+{
+    httpd_ws_frame_t pkt = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *)text,
+        .len = strlen(text),
+    };
+    return httpd_ws_send_frame(req, &pkt);
+}
+
+// Where a message came from, for the message handlers
+typedef struct {
+    httpd_req_t *req;
+    bool websocket;
+    frame_client_t *client;     // Sender, its session state
+    frame_slot_t *slot;         // Frame buffer holding the message, the frame handler takes it over
+    int64_t recv_start_us;      // First byte of the message came in
+} msg_source_t;
+
+static frame_msg_dispatcher_t msg_dispatcher;
+
+static void reply_text(const msg_source_t *src, const char *text)
+{
+    if (src->websocket) {
+        ws_send_text(src->req, text);
+    } else {
+        httpd_resp_sendstr(src->req, text);
+    }
+}
+
+static void log_malformed(const msg_source_t *src, const frame_msg_t *msg)
+{
+    ESP_LOGW(TAG, "#%u: malformed %s message", (unsigned) src->client->messages, frame_msg_type_name(msg->type));
+}
+
+static void on_frame_message(const frame_msg_t *msg, void *ctx)
+{
+    msg_source_t *src = ctx;
+    frame_stats_record(frame_stats, FRAME_STAGE_RECV, (uint32_t)(esp_timer_get_time() - src->recv_start_us));
+
+    // The frame has to start at slot->data, move it past the envelope instead of copying
+    if (src->slot && msg->payload != src->slot->data) {
+        frame_slot_skip(src->slot, (size_t)(msg->payload - src->slot->data));
+    }
+    handle_frame_message(src->client, src->slot, msg->payload, msg->len, msg->seq, src->recv_start_us);
+    src->slot = NULL;
+}
+
+static void on_ping_message(const frame_msg_t *msg, void *ctx)
+{
+    reply_text(ctx, "pong");
+    FRAME_LOGI("Ping/Pong");
+}
+
+static void on_blit_config_message(const frame_msg_t *msg, void *ctx)
+{
+    frame_client_t *client = ((msg_source_t *)ctx)->client;
+    frame_blit_config_t config;
+    if (!frame_msg_parse_blit_config(msg, &config)) {
+        log_malformed(ctx, msg);
+        return;
+    }
+    ESP_LOGI(TAG, "BLIT CONFIG received:");
+    if (config.mode[0]) ESP_LOGI(TAG, "- Mode: %s", config.mode);
+    if (config.format[0]) ESP_LOGI(TAG, "- Format: %s", config.format);
+    if (config.width && config.height) {
+        ESP_LOGI(TAG, "- Dimensions: %ux%u", (unsigned) config.width, (unsigned) config.height);
+    }
+    if (config.size) ESP_LOGI(TAG, "- Frame Size: %u bytes", (unsigned) config.size);
+    if (config.description[0]) ESP_LOGI(TAG, "- Description: %s", config.description);
+    if (config.has_layer || config.region.width) {
+        ESP_LOGI(TAG, "- Layer %u: %ux%u at %u,%u", (unsigned) (config.has_layer ? config.layer : client->layer),
+                 (unsigned) config.region.width, (unsigned) config.region.height,
+                 (unsigned) config.region.x, (unsigned) config.region.y);
+    }
+
+    // Frames that follow are raw RGB565 unless the config says otherwise
+    frame_format_t frame_format = FRAME_FORMAT_RGB565;
+    if (config.format[0] && (!frame_format_parse(config.format, &frame_format) ||
+                             !frame_codec_supported(frame_format))) {
+        ESP_LOGW(TAG, "Unsupported frame format %s, expecting rgb565", config.format);
+        frame_format = FRAME_FORMAT_RGB565;
+    }
+    client->format = frame_format;
+
+    // Update frame dimensions from config. Only the httpd task reads them, so
+    // they take effect for the very next frame.
+    if (config.width && config.height) {
+        client->width = (uint16_t)config.width;
+        client->height = (uint16_t)config.height;
+        client->config_received = true;
+        ESP_LOGI(TAG, "Config updated: %dx%d", client->width, client->height);
+    }
+
+    // A layer or region moves the sender's frames; without either they stay where they were
+    if (config.has_layer || config.region.width) {
+        uint32_t layer = config.has_layer ? config.layer : client->layer;
+        frame_layers_status_t status = layer < FRAME_LAYERS_MAX ?
+                                       client_claim_layer(client, (uint8_t)layer, &config.region) :
+                                       FRAME_LAYERS_BAD_LAYER;
+        if (status != FRAME_LAYERS_OK) {
+            ESP_LOGW(TAG, "Layer %u: %s", (unsigned) layer, frame_layers_status_name(status));
+            reply_text(ctx, frame_layers_status_name(status));
+        }
+    }
+}
+
+static void on_screen_config_message(const frame_msg_t *msg, void *ctx)
+{
+    frame_screen_config_t config;
+    if (!frame_msg_parse_screen_config(msg, &config)) {
+        log_malformed(ctx, msg);
+        return;
+    }
+    ESP_LOGI(TAG, "CONFIG received");
+    if (config.screen_id[0]) {
+        ESP_LOGI(TAG, "- Screen ID: %s", config.screen_id);
+    }
+
+    // "layout" is an LVGL XML component for the dashboard, empty or null goes back to frames
+    if (config.has_layout && dashboard) {
+        bool loaded = false;
+        bool cleared = !config.layout || config.layout_len == 0;
+        if (cleared) {
+            sensor_dashboard_clear(dashboard);
         } else {
-            // Text message (likely config or JSON)
-            buf[recv_len] = '\0';
-            ESP_LOGI(TAG, "#%d: TEXT - %d chars", message_count, recv_len);
-            
-            // Handle ping/pong
-            if (strncmp(buf, "ping", 4) == 0) {
-                httpd_resp_send(req, "pong", 4);
-                ESP_LOGI(TAG, "Ping/Pong");
-                free(buf);
-                return ESP_OK;
+            // Unescaped it is never longer than in the payload
+            char *xml = malloc(config.layout_len + 1);
+            if (xml) {
+                json_pull_unescape(config.layout, config.layout_len, xml, config.layout_len + 1);
+                loaded = sensor_dashboard_load(dashboard, xml);
+                free(xml);
             }
-            
-            // Try to parse as JSON
-            cJSON *json = cJSON_Parse(buf);
-            if (json) {
-                cJSON *type_item = cJSON_GetObjectItem(json, "type");
-                const char *msg_type = type_item ? cJSON_GetStringValue(type_item) : "unknown";
-                
-                if (strcmp(msg_type, "blit_config") == 0) {
-                    ESP_LOGI(TAG, "BLIT CONFIG received:");
-                    
-                    cJSON *mode = cJSON_GetObjectItem(json, "mode");
-                    cJSON *format = cJSON_GetObjectItem(json, "frameFormat");
-                    cJSON *width = cJSON_GetObjectItem(json, "frameWidth");
-                    cJSON *height = cJSON_GetObjectItem(json, "frameHeight");
-                    cJSON *size = cJSON_GetObjectItem(json, "frameSize");
-                    cJSON *desc = cJSON_GetObjectItem(json, "description");
-                    
-                    if (mode) ESP_LOGI(TAG, "- Mode: %s", cJSON_GetStringValue(mode));
-                    if (format) ESP_LOGI(TAG, "- Format: %s", cJSON_GetStringValue(format));
-                    if (width && height) {
-                        ESP_LOGI(TAG, "- Dimensions: %dx%d", cJSON_GetNumberValue(width), cJSON_GetNumberValue(height));
-                    }
-                    if (size) ESP_LOGI(TAG, "- Frame Size: %d bytes", (int)cJSON_GetNumberValue(size));
-                    if (desc) ESP_LOGI(TAG, "- Description: %s", cJSON_GetStringValue(desc));
-                    
-                    // Update frame dimensions from config
-                    if (width && height) {
-                        frame_message_t config_msg = {0};
-                        config_msg.width = (uint16_t)cJSON_GetNumberValue(width);
-                        config_msg.height = (uint16_t)cJSON_GetNumberValue(height);
-                        config_msg.is_config = true;
-                        
-                        if (frame_queue) {
-                            xQueueSend(frame_queue, &config_msg, 0);
-                        }
-                    }
-                    
-                } else if (strcmp(msg_type, "rive_config") == 0 || strcmp(msg_type, "config") == 0) {
-                    ESP_LOGI(TAG, "CONFIG: %s", msg_type);
-                    cJSON *screen_id = cJSON_GetObjectItem(json, "screenId");
-                    if (screen_id) {
-                        ESP_LOGI(TAG, "- Screen ID: %s", cJSON_GetStringValue(screen_id));
-                    }
-                    
-                } else if (strcmp(msg_type, "rive_sensor") == 0 || strcmp(msg_type, "sensor") == 0) {
-                    ESP_LOGI(TAG, "SENSOR DATA: %s", msg_type);
-                    cJSON *sensors = cJSON_GetObjectItem(json, "sensors");
-                    if (sensors) {
-                        cJSON *sensor = NULL;
-                        cJSON_ArrayForEach(sensor, sensors) {
-                            const char *sensor_name = sensor->string;
-                            cJSON *display_value = cJSON_GetObjectItem(sensor, "displayValue");
-                            cJSON *value = cJSON_GetObjectItem(sensor, "value");
-                            
-                            if (display_value) {
-                                ESP_LOGI(TAG, "- %s = %s", sensor_name, cJSON_GetStringValue(display_value));
-                            } else if (value) {
-                                ESP_LOGI(TAG, "- %s = %.2f", sensor_name, cJSON_GetNumberValue(value));
-                            }
-                        }
-                    }
-                    
-                } else {
-                    ESP_LOGI(TAG, "JSON: %s", msg_type);
-                    ESP_LOGI(TAG, "- Content: %.100s...", buf);
-                }
-                
-                cJSON_Delete(json);
-            } else {
-                // Not JSON, show as plain text
-                ESP_LOGI(TAG, "PLAIN TEXT: %.100s...", buf);
+        }
+        reply_text(ctx, loaded ? "layout-loaded" : (cleared ? "layout-cleared" : "layout-error"));
+        // The display task hides the frames, or shows them again with the next one
+        if (frame_display_task_handle) {
+            xTaskNotifyGive(frame_display_task_handle);
+        }
+    }
+}
+
+// Called by sensor_table_apply_json() for each sensor that changed
+static void on_sensor_changed(const sensor_entry_t *entry, void *ctx)
+{
+    if (entry->text[0]) {
+        FRAME_LOGI("- %s = %s", entry->key, entry->text);
+    } else {
+        FRAME_LOGI("- %s = %.2f", entry->key, entry->value);
+    }
+    if (dashboard) {
+        sensor_dashboard_set(dashboard, entry->key, strlen(entry->key), entry->value,
+                             entry->text[0] ? entry->text : NULL);
+    }
+}
+
+static void on_sensor_message(const frame_msg_t *msg, void *ctx)
+{
+    FRAME_LOGI("SENSOR DATA");
+    // Only the sensors that changed since the last message get through
+    if (!sensor_table_apply_json(sensor_table, (const char *)msg->payload, msg->len, on_sensor_changed, NULL)) {
+        log_malformed(ctx, msg);
+    }
+}
+
+static void on_text_message(const frame_msg_t *msg, void *ctx)
+{
+    ESP_LOGI(TAG, "TEXT: %.*s%s", (int) MIN(msg->len, 100), (const char *)msg->payload, msg->len > 100 ? "..." : "");
+}
+
+static void msg_dispatcher_init(void)
+{
+    frame_msg_dispatcher_init(&msg_dispatcher);
+    frame_msg_dispatcher_set(&msg_dispatcher, FRAME_MSG_FRAME, on_frame_message);
+    frame_msg_dispatcher_set(&msg_dispatcher, FRAME_MSG_PING, on_ping_message);
+    frame_msg_dispatcher_set(&msg_dispatcher, FRAME_MSG_BLIT_CONFIG, on_blit_config_message);
+    frame_msg_dispatcher_set(&msg_dispatcher, FRAME_MSG_SCREEN_CONFIG, on_screen_config_message);
+    frame_msg_dispatcher_set(&msg_dispatcher, FRAME_MSG_SENSOR, on_sensor_message);
+    frame_msg_dispatcher_set(&msg_dispatcher, FRAME_MSG_TEXT, on_text_message);
+}
+
+// Type a complete message and hand it to its handler. Binary messages are either an
+// envelope or a bare frame, text messages are typed by their JSON "type". Whatever
+// src->slot still holds afterwards is given back to the pool.
+static void dispatch_message(msg_source_t *src, bool binary, const uint8_t *data, size_t len, uint32_t seq)
+{
+    frame_client_t *client = src->client;
+    client->messages++;
+    frame_msg_t msg;
+    if (!binary) {
+        frame_msg_from_text((const char *)data, len, &msg);
+    } else {
+        frame_msg_status_t status = frame_msg_parse(data, len, &msg);
+        if (status == FRAME_MSG_NOT_ENVELOPE) {
+            msg = (frame_msg_t) {
+                .type = FRAME_MSG_FRAME,
+                .payload = data,
+                .len = len,
+            };
+        } else if (status != FRAME_MSG_OK) {
+            ESP_LOGW(TAG, "#%u: dropping malformed message envelope (%d)", (unsigned) client->messages, status);
+            frame_pool_release(frame_pool, src->slot);
+            src->slot = NULL;
+            return;
+        }
+    }
+    if (msg.seq == 0) {
+        msg.seq = seq;
+    }
+    FRAME_LOGI("#%u: %s - %u bytes", (unsigned) client->messages, frame_msg_type_name(msg.type), (unsigned) msg.len);
+
+    frame_msg_dispatch(&msg_dispatcher, &msg, src);
+    frame_pool_release(frame_pool, src->slot);
+    src->slot = NULL;
+}
+
+// A POST body is binary if it is a message envelope or says so in its Content-Type. Old
+// senders set no Content-Type; for them bodies too large for the text buffer are frames.
+static bool post_is_binary(httpd_req_t *req, const uint8_t *body, size_t len, bool large)
+{
+    if (frame_msg_is_envelope(body, len)) {
+        return true;
+    }
+    char content_type[64];
+    if (httpd_req_get_hdr_value_str(req, "Content-Type", content_type, sizeof(content_type)) != ESP_OK) {
+        return large;
+    }
+    return strncasecmp(content_type, "application/octet-stream", 24) == 0;
+}
+
+// Legacy transport: one message per HTTP POST body. Kept for senders that do not speak
+// WebSocket yet; see post_is_binary() for how frames and text are told apart.
+static esp_err_t http_post_handler(httpd_req_t *req)
+{
+    int64_t recv_start_us = esp_timer_get_time();
+    // Small requests (config, sensor JSON, ping) go into a static buffer, so they are never
+    // lost when every frame buffer is in use. Everything else is received straight into a
+    // pooled frame buffer. Handlers run on the single httpd task, so text_buf needs no locking.
+    static char text_buf[TEXT_MESSAGE_MAX_LEN + 1];
+    frame_slot_t *slot = NULL;
+    char *buf = text_buf;
+    size_t buf_len = TEXT_MESSAGE_MAX_LEN;
+
+    if (req->content_len > TEXT_MESSAGE_MAX_LEN) {
+        slot = frame_slot_acquire(http_client.layer);
+        if (!slot) {
+            ESP_LOGW(TAG, "No free frame buffer, dropping %d byte message", req->content_len);
+            return ESP_OK;
+        }
+        buf = (char *)slot->data;
+        buf_len = slot->capacity - 1;
+    }
+
+    frame_rx_t rx;
+    frame_rx_status_t rx_status = recv_request_body(req, (uint8_t *)buf, buf_len, &rx);
+    if (rx_status != FRAME_RX_OK) {
+        ESP_LOGW(TAG, "#%u: dropping %s message (%u of %d bytes)", (unsigned) http_client.messages + 1,
+                 rx_status == FRAME_RX_TOO_LARGE ? "oversized" : "incomplete",
+                 (unsigned) rx.received, req->content_len);
+        frame_pool_release(frame_pool, slot);
+        // A short body means the socket failed, let httpd close it
+        return rx_status == FRAME_RX_INCOMPLETE ? ESP_FAIL : ESP_OK;
+    }
+
+    size_t recv_len = rx.received;
+    if (recv_len == 0) {
+        frame_pool_release(frame_pool, slot);
+        return ESP_OK;
+    }
+
+    msg_source_t src = {
+        .req = req,
+        .client = &http_client,
+        .slot = slot,
+        .recv_start_us = recv_start_us,
+    };
+    dispatch_message(&src, post_is_binary(req, (const uint8_t *)buf, recv_len, slot != NULL),
+                     (const uint8_t *)buf, recv_len, 0);
+    return ESP_OK;
+}
+
+// WebSocket connection state, attached to the socket as its session context
+typedef struct {
+    frame_client_t client;                      // Frame format, dimensions and layer of this sender
+    ws_assembler_t assembler;
+    frame_slot_t *slot;                         // Frame buffer of the binary message in progress
+    bool skipping;                              // Dropping the remaining fragments of a message
+    int sockfd;                                 // Socket the session belongs to
+    uint32_t frames;                            // Binary messages received, the seq in frame-ack
+    int64_t recv_start_us;                      // First frame of the message in progress came in
+    char text_buf[TEXT_MESSAGE_MAX_LEN + 1];    // Text messages are reassembled here
+} ws_session_t;
+
+static void ws_session_free(void *ctx)
+{
+    ws_session_t *session = ctx;
+    if (session->slot) {
+        frame_pool_release(frame_pool, session->slot);
+    }
+    for (size_t i = 0; i < FRAME_LAYERS_MAX; i++) {
+        if (layer_ack_sockfd[i] == session->sockfd) {
+            layer_ack_sockfd[i] = -1;
+        }
+    }
+    // Its layer goes away with it and is free for the next sender
+    client_release_layer(&session->client);
+    free(session);
+}
+
+// Read and throw away the payload of a frame nobody has room for, so the stream stays in sync
+static esp_err_t ws_discard_payload(httpd_req_t *req, size_t len)
+{
+    uint8_t scratch[256];
+    int sockfd = httpd_req_to_sockfd(req);
+    int timeouts = 0;
+
+    while (len > 0) {
+        int ret = httpd_socket_recv(req->handle, sockfd, (char *)scratch, MIN(len, sizeof(scratch)), 0);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts <= RECV_TIMEOUT_RETRIES) {
+            continue;
+        }
+        if (ret <= 0) {
+            return ESP_FAIL;
+        }
+        timeouts = 0;
+        len -= ret;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t ws_send_device_connected(httpd_req_t *req)
+{
+    // Send device-connected message (like the Python script)
+    cJSON *device_info = cJSON_CreateObject();
+    cJSON_AddStringToObject(device_info, "type", "device-connected");
+    cJSON_AddNumberToObject(device_info, "timestamp", esp_timer_get_time() / 1000);
+    cJSON_AddStringToObject(device_info, "mac", device_mac);
+    cJSON_AddStringToObject(device_info, "ip", device_ip);
+    cJSON_AddNumberToObject(device_info, "port", 81);
+    cJSON_AddStringToObject(device_info, "protocol", "WebSocket");
+    cJSON_AddNumberToObject(device_info, "clientId", httpd_req_to_sockfd(req));
+    cJSON_AddStringToObject(device_info, "note", "ESP32-P4-Nano Ready for blit frames (dynamic dimensions)");
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    char *json_string = cJSON_PrintUnformatted(device_info);
+    if (json_string) {
+        ret = ws_send_text(req, json_string);
+        free(json_string);
+    }
+    cJSON_Delete(device_info);
+    return ret;
+}
+
+// WebSocket transport. httpd calls this once for the handshake and then once per data
+// frame; ping/pong/close are answered by httpd itself. Binary messages are message
+// envelopes or bare frames and are received straight into a pooled frame buffer, text
+// messages are JSON. Fragmented messages are reassembled by the session's ws_assembler.
+static esp_err_t ws_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET) {
+        ws_session_t *session = calloc(1, sizeof(ws_session_t));
+        if (!session) {
+            ESP_LOGE(TAG, "No memory for WebSocket session");
+            return ESP_FAIL;
+        }
+        ws_assembler_init(&session->assembler);
+        session->sockfd = httpd_req_to_sockfd(req);
+        session->client.id = next_client_id++;
+        req->sess_ctx = session;
+        req->free_ctx = ws_session_free;
+
+        ESP_LOGI(TAG, "WebSocket client connected (socket %d)", httpd_req_to_sockfd(req));
+        return ws_send_device_connected(req);
+    }
+
+    ws_session_t *session = req->sess_ctx;
+    if (!session) {
+        return ESP_FAIL;
+    }
+    ws_assembler_t *as = &session->assembler;
+
+    // Read the frame header only, then decide where the payload goes
+    httpd_ws_frame_t pkt = {0};
+    esp_err_t ret = httpd_ws_recv_frame(req, &pkt, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to read WebSocket frame header: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (session->skipping && pkt.type == HTTPD_WS_TYPE_CONTINUE) {
+        session->skipping = !pkt.final;
+        return ws_discard_payload(req, pkt.len);
+    }
+    session->skipping = false;
+
+    switch (ws_assembler_frame(as, (ws_opcode_t)pkt.type, pkt.final, pkt.len)) {
+    case WS_ASM_START:
+        session->recv_start_us = esp_timer_get_time();
+        if (pkt.type == HTTPD_WS_TYPE_TEXT) {
+            ws_assembler_attach(as, (uint8_t *)session->text_buf, TEXT_MESSAGE_MAX_LEN);
+        } else if ((session->slot = frame_slot_acquire(session->client.layer)) != NULL) {
+            if (!ws_assembler_attach(as, session->slot->data, session->slot->capacity)) {
+                frame_pool_release(frame_pool, session->slot);
+                session->slot = NULL;
             }
+        } else {
+            ESP_LOGW(TAG, "No free frame buffer, dropping frame");
+            ws_assembler_abort(as);
         }
-        
-        message_count++;
+        break;
+    case WS_ASM_CONTINUE:
+        break;
+    case WS_ASM_CONTROL:
+        return ws_discard_payload(req, pkt.len);
+    case WS_ASM_TOO_LARGE:
+        ws_assembler_abort(as);
+        frame_pool_release(frame_pool, session->slot);
+        session->slot = NULL;
+        break;
+    case WS_ASM_PROTOCOL_ERROR:
+    default:
+        ESP_LOGW(TAG, "WebSocket protocol error (opcode %d, fin %d), closing", pkt.type, pkt.final);
+        return ESP_FAIL;
+    }
+
+    if (as->opcode == WS_OPCODE_CONTINUATION) {
+        // Nowhere to put it: skip this frame and the rest of its message
+        ESP_LOGW(TAG, "#%u: dropping %u byte fragment", (unsigned) session->client.messages + 1, (unsigned) pkt.len);
+        session->skipping = !pkt.final;
+        return ws_discard_payload(req, pkt.len);
+    }
+
+    // A max_len of 0 would mean "header only" again, so empty frames skip the read
+    if (pkt.len > 0) {
+        pkt.payload = ws_assembler_payload(as);
+        ret = httpd_ws_recv_frame(req, &pkt, pkt.len);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to read WebSocket payload: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    frame_rx_stats.bytes += pkt.len;
+
+    ws_message_t msg;
+    if (!ws_assembler_frame_done(as, &msg)) {
+        return ESP_OK;
+    }
+
+    frame_rx_stats.complete++;
+    bool binary = msg.opcode == WS_OPCODE_BINARY;
+    msg_source_t src = {
+        .req = req,
+        .websocket = true,
+        .client = &session->client,
+        .slot = session->slot,
+        .recv_start_us = session->recv_start_us,
+    };
+    session->slot = NULL;
+    dispatch_message(&src, binary, msg.data, msg.len, binary ? ++session->frames : 0);
+    if (binary && frame_layers.layers[session->client.layer].owner == session->client.id) {
+        // The acks of a layer go to whoever draws into it
+        layer_ack_sockfd[session->client.layer] = session->sockfd;
     }
-    
-    free(buf);
     return ESP_OK;
 }
 
+// Runs on the LVGL task: time each refresh and the part of it spent waiting for the panel
+static void lvgl_refr_event_cb(lv_event_t *e)
+{
+    static int64_t refr_start_us;
+    static int64_t flush_wait_start_us;
+    static uint32_t flush_wait_us;
+    static bool flushed;
+    int64_t now = esp_timer_get_time();
+
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_REFR_START:
+        refr_start_us = now;
+        flush_wait_us = 0;
+        flushed = false;
+        break;
+    case LV_EVENT_FLUSH_START:
+        flushed = true;
+        break;
+    case LV_EVENT_FLUSH_WAIT_START:
+        flush_wait_start_us = now;
+        break;
+    case LV_EVENT_FLUSH_WAIT_FINISH:
+        flush_wait_us += (uint32_t)(now - flush_wait_start_us);
+        break;
+    case LV_EVENT_REFR_READY:
+        // Refreshes with nothing invalidated would only flood the histogram with zeros
+        if (flushed) {
+            frame_stats_record(frame_stats, FRAME_STAGE_RENDER, (uint32_t)(now - refr_start_us));
+            frame_stats_record(frame_stats, FRAME_STAGE_FLUSH, flush_wait_us);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+#define DEVICE_STATS_JSON_MAX 3072
+
+// Counters and latency histograms of the whole pipeline, for /stats and device-stats
+static char *device_stats_json(void)
+{
+    char *json = malloc(DEVICE_STATS_JSON_MAX);
+    if (!json) {
+        return NULL;
+    }
+
+    frame_pool_stats_t pool_stats;
+    frame_pool_get_stats(frame_pool, &pool_stats);
+    frame_ring_stats_t ring_stats;
+    frame_ring_get_stats(frame_ring, &ring_stats);
+    frame_compositor_stats_t compositor_stats = {0};
+    if (compositor) {
+        frame_compositor_get_stats(compositor, &compositor_stats);
+    }
+    const frame_presenter_stats_t *presenter_stats = &compositor_stats.presenter;
+    sensor_dashboard_stats_t dashboard_stats = {0};
+    if (dashboard) {
+        sensor_dashboard_get_stats(dashboard, &dashboard_stats);
+    }
+    sensor_table_stats_t sensor_stats;
+    sensor_table_get_stats(sensor_table, &sensor_stats);
+    frame_tiles_stats_t tiles_stats = {0};
+    if (frame_tiles) {
+        frame_tiles_get_stats(frame_tiles, &tiles_stats);
+    }
+    lvgl_port_task_stats_t lvgl_stats = {0};
+    lvgl_port_get_task_stats(&lvgl_stats);
+    unsigned lvgl_idle_pct = lvgl_stats.elapsed_us > lvgl_stats.busy_us ?
+                             (unsigned)(100 - lvgl_stats.busy_us * 100 / lvgl_stats.elapsed_us) : 0;
+    // Redrawn pixels per invalidated pixel (overlaps counted once), 100% at best,
+    // above it the joined or overlapping redrawn areas covered more than needed
+    lv_display_inv_stats_t inv_stats = {0};
+    if (display_handle) {
+        bsp_display_lock(0);
+        lv_display_get_inv_stats(display_handle, &inv_stats);
+        bsp_display_unlock();
+    }
+    unsigned overdraw_pct = inv_stats.inv_px ? (unsigned)(inv_stats.refr_px * 100 / inv_stats.inv_px) : 0;
+
+    int len = snprintf(json, DEVICE_STATS_JSON_MAX,
+                       "{\"type\":\"device-stats\",\"uptimeMs\":%lld,"
+                       "\"rx\":{\"complete\":%u,\"incomplete\":%u,\"tooLarge\":%u,\"sizeMismatch\":%u,\"bytes\":%llu},"
+                       "\"pool\":{\"slots\":%u,\"inUse\":%u,\"peakInUse\":%u,\"exhausted\":%u},"
+                       "\"queue\":{\"queued\":%u,\"evicted\":%u,\"stale\":%u,\"dropped\":%u,\"keyFrameRequests\":%u},"
+                       "\"presenter\":{\"frames\":%u,\"deltas\":%u,\"deltasDropped\":%u,\"passthroughFrames\":%u,"
+                       "\"layers\":%u,\"unrouted\":%u},"
+                       "\"dashboard\":{\"layouts\":%u,\"layoutErrors\":%u,\"updates\":%u,\"unchanged\":%u,"
+                       "\"dropped\":%u,\"framesHidden\":%u},"
+                       "\"sensors\":{\"count\":%u,\"messages\":%u,\"malformed\":%u,\"changed\":%u,"
+                       "\"unchanged\":%u,\"dropped\":%u},"
+                       "\"udp\":{\"complete\":%u,\"partial\":%u,\"tiles\":%u,\"tilesMissing\":%u,"
+                       "\"tilesLate\":%u,\"tilesBad\":%u,\"nacks\":%u,\"noBuffer\":%u},"
+                       "\"lvgl\":{\"runs\":%u,\"idlePercent\":%u,\"wakeDisplay\":%u,\"wakeTouch\":%u,"
+                       "\"wakeFlush\":%u,\"wakeTimer\":%u,\"wakeUser\":%u,\"wakeTimeout\":%u,"
+                       "\"invAreas\":%u,\"refrAreas\":%u,\"invBufFull\":%u,\"overdrawPercent\":%u},"
+                       "\"stages\":",
+                       (long long)(esp_timer_get_time() / 1000),
+                       (unsigned) frame_rx_stats.complete, (unsigned) frame_rx_stats.incomplete,
+                       (unsigned) frame_rx_stats.too_large, (unsigned) frame_rx_stats.size_mismatch,
+                       (unsigned long long) frame_rx_stats.bytes,
+                       (unsigned) frame_pool_slot_count(frame_pool), (unsigned) pool_stats.in_use,
+                       (unsigned) pool_stats.peak_in_use, (unsigned) pool_stats.exhausted,
+                       (unsigned) ring_stats.pushed, (unsigned)(ring_stats.evicted + ring_stats.stale_taken),
+                       (unsigned) frames_stale, (unsigned) frames_dropped, (unsigned) key_frame_requests,
+                       (unsigned) presenter_stats->frames, (unsigned) presenter_stats->deltas,
+                       (unsigned) presenter_stats->deltas_dropped, (unsigned) presenter_stats->passthrough_frames,
+                       (unsigned) compositor_stats.layers, (unsigned) compositor_stats.unrouted,
+                       (unsigned) dashboard_stats.layouts, (unsigned) dashboard_stats.layout_errors,
+                       (unsigned) dashboard_stats.updates, (unsigned) dashboard_stats.unchanged,
+                       (unsigned) dashboard_stats.dropped, (unsigned) frames_hidden,
+                       (unsigned) sensor_table_count(sensor_table), (unsigned) sensor_stats.messages,
+                       (unsigned) sensor_stats.malformed, (unsigned) sensor_stats.changed,
+                       (unsigned) sensor_stats.unchanged, (unsigned) sensor_stats.dropped,
+                       (unsigned) tiles_stats.frames_complete, (unsigned) tiles_stats.frames_partial,
+                       (unsigned) tiles_stats.tiles, (unsigned) tiles_stats.tiles_missing,
+                       (unsigned) tiles_stats.tiles_late, (unsigned) tiles_stats.tiles_bad,
+                       (unsigned) tiles_stats.nacks, (unsigned) tiles_stats.no_buffer,
+                       (unsigned) lvgl_stats.handler_runs, lvgl_idle_pct,
+                       (unsigned) lvgl_stats.wakes_display, (unsigned) lvgl_stats.wakes_touch,
+                       (unsigned) lvgl_stats.wakes_flush, (unsigned) lvgl_stats.wakes_timer,
+                       (unsigned) lvgl_stats.wakes_user, (unsigned) lvgl_stats.wakes_timeout,
+                       (unsigned) inv_stats.inv_area_cnt, (unsigned) inv_stats.refr_area_cnt,
+                       (unsigned) inv_stats.inv_buf_full_cnt, overdraw_pct);
+    size_t stages_len = 0;
+    if (len > 0 && len < DEVICE_STATS_JSON_MAX) {
+        stages_len = frame_stats_to_json(frame_stats, json + len, DEVICE_STATS_JSON_MAX - len - 1);
+    }
+    if (!stages_len) {
+        free(json);
+        return NULL;
+    }
+    strcpy(json + len + stages_len, "}");
+    return json;
+}
+
+// GET /stats
+static esp_err_t stats_get_handler(httpd_req_t *req)
+{
+    char *json = device_stats_json();
+    if (!json) {
+        return httpd_resp_send_500(req);
+    }
+    httpd_resp_set_type(req, "application/json");
+    esp_err_t ret = httpd_resp_sendstr(req, json);
+    free(json);
+    return ret;
+}
+
+// Runs on the httpd task: push device-stats to every WebSocket client
+static void device_stats_broadcast(void *arg)
+{
+    int fds[CONFIG_LWIP_MAX_SOCKETS];
+    size_t count = sizeof(fds) / sizeof(fds[0]);
+    if (httpd_get_client_list(server, &count, fds) != ESP_OK) {
+        return;
+    }
+
+    char *json = NULL;
+    for (size_t i = 0; i < count; i++) {
+        if (httpd_ws_get_fd_info(server, fds[i]) != HTTPD_WS_CLIENT_WEBSOCKET) {
+            continue;
+        }
+        if (!json && !(json = device_stats_json())) {
+            return;
+        }
+        httpd_ws_frame_t pkt = {
+            .final = true,
+            .type = HTTPD_WS_TYPE_TEXT,
+            .payload = (uint8_t *)json,
+            .len = strlen(json),
+        };
+        httpd_ws_send_frame_async(server, fds[i], &pkt);
+    }
+    free(json);
+}
+
+#if CONFIG_FRAME_UDP_TRANSPORT
+// A reassembled UDP frame takes the same way as a WebSocket frame. Runs on the httpd task,
+// which is the only one that queues frames and claims layers.
+static void frame_udp_handle(void *arg)
+{
+    frame_slot_t *slot = arg;
+    udp_client.messages++;
+    handle_frame_message(&udp_client, slot, slot->data, slot->size, 0, slot->recv_start_us);
+}
+
+// Receives frames as UDP tiles, see frame_tiles.h. A lost datagram costs one tile, which
+// is asked for again or left out when the frame is due, instead of stalling the stream
+// the way a TCP retransmission does.
+static void frame_udp_task(void *pvParameters)
+{
+    static uint8_t datagram[FRAME_UDP_DATAGRAM_MAX];
+    static uint8_t nack[FRAME_UDP_NACK_MAX];
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_FRAME_UDP_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (sock < 0 || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        ESP_LOGE(TAG, "Failed to open UDP port %d", CONFIG_FRAME_UDP_PORT);
+        if (sock >= 0) {
+            close(sock);
+        }
+        vTaskDelete(NULL);
+        return;
+    }
+    ESP_LOGI(TAG, "UDP tiles on udp://%s:%d/", device_ip, CONFIG_FRAME_UDP_PORT);
+
+    struct sockaddr_storage peer;
+    socklen_t peer_len = 0;
+    while (1) {
+        // Sleep until the next datagram, or until a frame is due or its missing tiles are
+        int64_t next = frame_tiles_next_event_us(frame_tiles);
+        int64_t wait_us = next == INT64_MAX ? 1000000 : next - esp_timer_get_time();
+        if (wait_us < 0) {
+            wait_us = 0;
+        }
+        struct timeval timeout = {
+            .tv_sec = wait_us / 1000000,
+            .tv_usec = wait_us % 1000000,
+        };
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(sock, &readable);
+        if (select(sock + 1, &readable, NULL, NULL, &timeout) > 0) {
+            socklen_t len = sizeof(peer);
+            int received = recvfrom(sock, datagram, sizeof(datagram), 0, (struct sockaddr *)&peer, &len);
+            if (received > 0) {
+                peer_len = len;
+                frame_tiles_status_t status = frame_tiles_push(frame_tiles, datagram, received, esp_timer_get_time());
+                if (status != FRAME_TILES_OK) {
+                    FRAME_LOGI("UDP tile: %s", frame_tiles_status_name(status));
+                }
+            }
+        }
+
+        int64_t now = esp_timer_get_time();
+        size_t nack_len = frame_tiles_nack(frame_tiles, now, nack, sizeof(nack));
+        if (nack_len && peer_len) {
+            sendto(sock, nack, nack_len, 0, (struct sockaddr *)&peer, peer_len);
+        }
+
+        frame_slot_t *slot;
+        while ((slot = frame_tiles_poll(frame_tiles, now)) != NULL) {
+            if (httpd_queue_work(server, frame_udp_handle, slot) != ESP_OK) {
+                ESP_LOGW(TAG, "httpd queue full, dropping UDP frame");
+                frame_pool_release(frame_pool, slot);
+            }
+        }
+    }
+}
+#endif
+
 static void start_ethernet_and_webserver(void *pvParameters)
 {
     // Initialize networking (unchanged from original)
@@ -494,19 +1397,35 @@ static void start_ethernet_and_webserver(void *pvParameters)
                 .uri = "/",
                 .method = HTTP_GET,
                 .handler = ws_handler,
-                .user_ctx = NULL
+                .user_ctx = NULL,
+                .is_websocket = true
             };
             httpd_register_uri_handler(server, &ws);
             
-            httpd_uri_t ws_post = {
+            httpd_uri_t http_post = {
                 .uri = "/",
                 .method = HTTP_POST,
-                .handler = ws_handler,
+                .handler = http_post_handler,
                 .user_ctx = NULL
             };
-            httpd_register_uri_handler(server, &ws_post);
+            httpd_register_uri_handler(server, &http_post);
+
+            httpd_uri_t stats = {
+                .uri = "/stats",
+                .method = HTTP_GET,
+                .handler = stats_get_handler,
+                .user_ctx = NULL
+            };
+            httpd_register_uri_handler(server, &stats);
             
             ESP_LOGI(TAG, "WebSocket server ready for blit frames!");
+
+#if CONFIG_FRAME_UDP_TRANSPORT
+            // Next to the WebSocket, reassembled frames are handed to the server's task
+            if (frame_tiles) {
+                xTaskCreate(frame_udp_task, "frame_udp", 4096, NULL, 5, NULL);
+            }
+#endif
         }
     } else {
         ESP_LOGW(TAG, "No Ethernet connection, continuing without WebSocket");
@@ -514,26 +1433,146 @@ static void start_ethernet_and_webserver(void *pvParameters)
     
     // Keep task alive
     while (1) {
-        vTaskDelay(pdMS_TO_TICKS(5000));
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_FRAME_STATS_INTERVAL_MS ? CONFIG_FRAME_STATS_INTERVAL_MS : 5000));
         if (server != NULL) {
             ESP_LOGD(TAG, "WebSocket server running on %s:81", device_ip);
+            if (CONFIG_FRAME_STATS_INTERVAL_MS) {
+                httpd_queue_work(server, device_stats_broadcast, NULL);
+            }
+        }
+
+        frame_pool_stats_t pool_stats;
+        frame_pool_get_stats(frame_pool, &pool_stats);
+        if (pool_stats.exhausted != last_reported_exhausted) {
+            ESP_LOGW(TAG, "Frame pool exhausted %u times (%u/%u in use, peak %u)",
+                     (unsigned) pool_stats.exhausted, (unsigned) pool_stats.in_use,
+                     (unsigned) frame_pool_slot_count(frame_pool), (unsigned) pool_stats.peak_in_use);
+            last_reported_exhausted = pool_stats.exhausted;
+        }
+
+        uint32_t rx_errors = frame_rx_stats.incomplete + frame_rx_stats.too_large + frame_rx_stats.size_mismatch;
+        if (rx_errors != last_reported_rx_errors) {
+            ESP_LOGW(TAG, "Receive: %u complete, %u incomplete, %u oversized, %u size mismatch",
+                     (unsigned) frame_rx_stats.complete, (unsigned) frame_rx_stats.incomplete,
+                     (unsigned) frame_rx_stats.too_large, (unsigned) frame_rx_stats.size_mismatch);
+            last_reported_rx_errors = rx_errors;
         }
     }
     
     vTaskDelete(NULL);
 }
 
+#if CONFIG_FRAME_LVGL_BENCHMARK
+// One line per scene, so runs with a different number of draw units can be compared.
+// Runs on the LVGL task.
+static void lvgl_benchmark_end_cb(const lv_demo_benchmark_summary_t *summary)
+{
+    ESP_LOGI(TAG, "LVGL benchmark, %d SW draw unit(s)%s", LV_DRAW_SW_DRAW_UNIT_CNT,
+             LV_DRAW_THREAD_PIN_CORES ? " pinned to cores" : "");
+    ESP_LOGI(TAG, "%-26s %5s %5s %9s %9s", "scene", "fps", "cpu", "render", "flush");
+    for (const lv_demo_benchmark_scene_dsc_t *scene = summary->scenes; scene->create_cb; scene++) {
+        uint32_t cnt = scene->measurement_cnt ? scene->measurement_cnt : 1;
+        ESP_LOGI(TAG, "%-26s %5u %4u%% %6u ms %6u ms", scene->name,
+                 (unsigned)(scene->fps_avg / cnt), (unsigned)(scene->cpu_avg_usage / cnt),
+                 (unsigned)(scene->render_avg_time / cnt), (unsigned)(scene->flush_avg_time / cnt));
+    }
+    if (summary->valid_scene_cnt > 0) {
+        ESP_LOGI(TAG, "%-26s %5u %4u%% %6u ms %6u ms", "average",
+                 (unsigned)(summary->total_avg_fps / summary->valid_scene_cnt),
+                 (unsigned)(summary->total_avg_cpu / summary->valid_scene_cnt),
+                 (unsigned)(summary->total_avg_render_time / summary->valid_scene_cnt),
+                 (unsigned)(summary->total_avg_flush_time / summary->valid_scene_cnt));
+    }
+    lv_demo_benchmark_summary_display(summary);
+}
+
+static void run_lvgl_benchmark(void)
+{
+    display_handle = bsp_display_start();
+    if (display_handle == NULL) {
+        ESP_LOGE(TAG, "Display initialization failed");
+        return;
+    }
+    if (bsp_display_brightness_init() == ESP_OK) {
+        bsp_display_backlight_on();
+        bsp_display_brightness_set(80);
+    }
+
+    bsp_display_lock(0);
+    lv_display_set_tile_size(display_handle, CONFIG_FRAME_LVGL_TILE_SIZE, CONFIG_FRAME_LVGL_TILE_SIZE);
+    lv_demo_benchmark_set_end_cb(lvgl_benchmark_end_cb);
+    lv_demo_benchmark();
+    bsp_display_unlock();
+}
+#endif
+
 void app_main(void)
 {
     ESP_LOGI(TAG, "ESP32-P4-Nano WebSocket Image Display Ready");
 
-    // Create frame queue for passing data between WebSocket and display tasks
-    frame_queue = xQueueCreate(5, sizeof(frame_message_t));
-    if (!frame_queue) {
-        ESP_LOGE(TAG, "Failed to create frame queue");
+#if CONFIG_FRAME_LVGL_BENCHMARK
+    run_lvgl_benchmark();
+    return;
+#endif
+
+    // Preallocate the frame buffers, nothing is allocated per frame after this
+    const frame_pool_config_t pool_config = {
+        .slot_count = CONFIG_FRAME_POOL_SLOTS,
+        .slot_size = CONFIG_FRAME_POOL_SLOT_SIZE,
+        .alignment = FRAME_POOL_DEFAULT_ALIGN,
+        .alloc = frame_pool_psram_alloc,
+        .free = frame_pool_psram_free,
+    };
+    frame_pool = frame_pool_create(&pool_config);
+    if (!frame_pool) {
+        ESP_LOGE(TAG, "Failed to allocate %d frame buffers of %d bytes",
+                 CONFIG_FRAME_POOL_SLOTS, CONFIG_FRAME_POOL_SLOT_SIZE);
+        return;
+    }
+
+    frame_stats = frame_stats_create();
+    if (!frame_stats) {
+        ESP_LOGE(TAG, "Failed to create frame stats");
         return;
     }
 
+    // Hands received frames to the display task, the newest frame always gets in
+    frame_ring = frame_ring_create(CONFIG_FRAME_POOL_SLOTS);
+    if (!frame_ring) {
+        ESP_LOGE(TAG, "Failed to create frame ring");
+        return;
+    }
+
+    sensor_table = sensor_table_create(CONFIG_SENSOR_TABLE_SIZE);
+    if (!sensor_table) {
+        ESP_LOGE(TAG, "Failed to create sensor table");
+        return;
+    }
+
+    // Senders claim screen layers; POST senders all share one client
+    frame_layers_init(&frame_layers, BSP_LCD_H_RES, BSP_LCD_V_RES);
+    for (size_t i = 0; i < FRAME_LAYERS_MAX; i++) {
+        layer_ack_sockfd[i] = -1;
+    }
+    http_client.id = next_client_id++;
+
+#if CONFIG_FRAME_UDP_TRANSPORT
+    const frame_tiles_config_t tiles_config = {
+        .pool = frame_pool,
+        .deadline_us = CONFIG_FRAME_UDP_DEADLINE_MS * 1000,
+        .nack_delay_us = CONFIG_FRAME_UDP_NACK_DELAY_MS * 1000,
+        .max_nacks = CONFIG_FRAME_UDP_NACKS,
+    };
+    frame_tiles = frame_tiles_create(&tiles_config);
+    if (!frame_tiles) {
+        ESP_LOGW(TAG, "Failed to create UDP tile reassembly, UDP frames are off");
+    }
+    udp_client.id = next_client_id++;
+    udp_client.layer = CONFIG_FRAME_UDP_LAYER;
+#endif
+
+    msg_dispatcher_init();
+
     // Initialize networking first (non-blocking)
     s_network_event_group = xEventGroupCreate();
     xTaskCreate(start_ethernet_and_webserver, "network_task", 8192, NULL, 5, NULL);
@@ -554,24 +1593,56 @@ void app_main(void)
         ESP_LOGI(TAG, "Backlight on at 80%%");
     }
 
+    // Show ready message on display, it goes away with the first frame. LVGL runs in its
+    // own task, so every LVGL call outside of it needs the display lock.
+    bsp_display_lock(0);
+    lv_obj_t *screen = lv_screen_active();
+    lv_obj_set_style_bg_color(screen, lv_color_make(0, 0, 0), 0);  // Black background
+    
+    ready_label = lv_label_create(screen);
+    lv_label_set_text(ready_label, "ESP32-P4-Nano\nReady for WebSocket\nBlit Frames\n\nWaiting for connection...");
+    lv_obj_set_style_text_color(ready_label, lv_color_make(255, 255, 255), 0);  // White text
+    lv_obj_set_style_text_align(ready_label, LV_TEXT_ALIGN_CENTER, 0);
+    lv_obj_center(ready_label);
+    lv_display_add_event_cb(display_handle, lvgl_refr_event_cb, LV_EVENT_ALL, NULL);
+    lv_display_set_tile_size(display_handle, CONFIG_FRAME_LVGL_TILE_SIZE, CONFIG_FRAME_LVGL_TILE_SIZE);
+    bsp_display_unlock();
+
+    // Every sender's frames in a layer of their own, full-screen ones of a lone sender go to
+    // the panel directly
+    const frame_compositor_config_t compositor_config = {
+        .parent = screen,
+        .pool = frame_pool,
+        .lock = bsp_display_lock,
+        .unlock = bsp_display_unlock,
+#if CONFIG_FRAME_PASSTHROUGH
+        .passthrough_display = display_handle,
+        .passthrough_buffers = CONFIG_BSP_LCD_DPI_BUFFER_NUMS,
+#endif
+    };
+    compositor = frame_compositor_create(&compositor_config);
+    if (!compositor) {
+        ESP_LOGE(TAG, "Failed to create frame compositor");
+        return;
+    }
+
+    // Sensor widgets bound to values, loaded as an XML layout through the config message
+    const sensor_dashboard_config_t dashboard_config = {
+        .parent = screen,
+        .lock = bsp_display_lock,
+        .unlock = bsp_display_unlock,
+    };
+    dashboard = sensor_dashboard_create(&dashboard_config);
+    if (!dashboard) {
+        ESP_LOGW(TAG, "Failed to create sensor dashboard, layouts are ignored");
+    }
+
     // Create frame display task
-    xTaskCreate(frame_display_task, "frame_display", 8192, NULL, 4, NULL);
+    xTaskCreate(frame_display_task, "frame_display", 8192, NULL, 4, &frame_display_task_handle);
 
     // Register main task with watchdog
     esp_task_wdt_add(xTaskGetCurrentTaskHandle());
 
-    // Show ready message on display
-    lv_obj_t *screen = lv_screen_active();
-    lv_obj_set_style_bg_color(screen, lv_color_make(0, 0, 0), 0);  // Black background
-    
-    lv_obj_t *label = lv_label_create(screen);
-    lv_label_set_text(label, "ESP32-P4-Nano\nReady for WebSocket\nBlit Frames\n\nWaiting for connection...");
-    lv_obj_set_style_text_color(label, lv_color_make(255, 255, 255), 0);  // White text
-    lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_CENTER, 0);
-    lv_obj_center(label);
-    
-    lv_refr_now(display_handle);
-
     ESP_LOGI(TAG, "Ready to receive and display RGB565 frames via WebSocket");
     ESP_LOGI(TAG, "Connect JunctionRelay to ws://%s:81/", device_ip[0] ? device_ip : "[waiting for IP]");
 
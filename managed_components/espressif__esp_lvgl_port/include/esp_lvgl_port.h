@@ -33,6 +33,8 @@ extern "C" {
 typedef enum {
     LVGL_PORT_EVENT_DISPLAY = 0x01,
     LVGL_PORT_EVENT_TOUCH   = 0x02,
+    LVGL_PORT_EVENT_FLUSH   = 0x04,
+    LVGL_PORT_EVENT_TIMER   = 0x08,
     LVGL_PORT_EVENT_USER    = 0x80,
 } lvgl_port_event_type_t;
 
@@ -55,6 +57,21 @@ typedef struct {
     int timer_period_ms;    /*!< LVGL timer tick period in ms */
 } lvgl_port_cfg_t;
 
+/**
+ * @brief LVGL task counters, see lvgl_port_get_task_stats()
+ */
+typedef struct {
+    uint32_t wakes_display;     /*!< Wakeups by an invalidated area or a refresh request */
+    uint32_t wakes_touch;       /*!< Wakeups by an input device */
+    uint32_t wakes_flush;       /*!< Wakeups by a finished flush */
+    uint32_t wakes_timer;       /*!< Wakeups because an LVGL timer was due */
+    uint32_t wakes_user;        /*!< Wakeups by LVGL_PORT_EVENT_USER */
+    uint32_t wakes_timeout;     /*!< Wakeups without any event */
+    uint32_t handler_runs;      /*!< lv_timer_handler() calls */
+    uint64_t busy_us;           /*!< Time spent reading input devices and in lv_timer_handler() */
+    uint64_t elapsed_us;        /*!< Time since the LVGL task started */
+} lvgl_port_task_stats_t;
+
 /**
  * @brief LVGL port configuration structure
  *
@@ -96,6 +113,9 @@ esp_err_t lvgl_port_deinit(void);
 /**
  * @brief Take LVGL mutex
  *
+ * With LV_USE_OS, LVGL's own lock (lv_lock()) is taken too. The timeout covers both locks;
+ * it applies to LVGL's lock only with LV_OS_FREERTOS, other OS backends wait for it indefinitely.
+ *
  * @param timeout_ms Timeout in [ms]. 0 will block indefinitely.
  * @return
  *      - true  Mutex was taken
@@ -152,6 +172,19 @@ esp_err_t lvgl_port_resume(void);
  */
 esp_err_t lvgl_port_task_wake(lvgl_port_event_type_t event, void *param);
 
+/**
+ * @brief Get the LVGL task counters
+ *
+ * @note The task is idle for (elapsed_us - busy_us) of elapsed_us
+ *
+ * @param stats     counters since the task started
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if stats is NULL
+ *      - ESP_ERR_INVALID_STATE if the LVGL task is not running
+ */
+esp_err_t lvgl_port_get_task_stats(lvgl_port_task_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
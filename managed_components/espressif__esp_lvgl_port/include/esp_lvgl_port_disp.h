@@ -127,6 +127,41 @@ lv_display_t *lvgl_port_add_disp_rgb(const lvgl_port_display_cfg_t *disp_cfg, co
  */
 esp_err_t lvgl_port_remove_disp(lv_display_t *disp);
 
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Callback for the end of a panel refresh (vsync)
+ *
+ * @note Called from ISR context.
+ *
+ * @return true if a higher priority task was woken
+ */
+typedef bool (*lvgl_port_vsync_cb_t)(lv_display_t *disp, void *user_ctx);
+
+/**
+ * @brief Get the LCD panel handle of a display added to LVGL
+ *
+ * @param disp LVGL display
+ * @return LCD panel handle the display was added with
+ */
+esp_lcd_panel_handle_t lvgl_port_get_panel_handle(lv_display_t *disp);
+
+/**
+ * @brief Register a callback for the end of every panel refresh of a MIPI-DSI display
+ *
+ * The DPI panel supports one set of event callbacks only, which is owned by
+ * the port. Use this to be notified about vsync, e.g. to flip own frame
+ * buffers while LVGL is stopped.
+ *
+ * @param disp LVGL display added with lvgl_port_add_disp_dsi
+ * @param cb Callback, NULL to unregister
+ * @param user_ctx Passed to the callback
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_NOT_SUPPORTED     if the display is not a MIPI-DSI display
+ */
+esp_err_t lvgl_port_disp_register_vsync_cb(lv_display_t *disp, lvgl_port_vsync_cb_t cb, void *user_ctx);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -18,6 +18,20 @@ extern "C" {
 #warning "esp_lvgl_port_lv_blend.h included, but CONFIG_LV_DRAW_SW_ASM_CUSTOM not set. Assembly rendering not used"
 #else
 
+/* The hard copy of the LVGL 9.1 blend API in the SIMD test app comes without lv_version.h */
+#if defined(__has_include)
+#if __has_include("lv_version.h")
+#include "lv_version.h"
+#endif
+#endif
+
+#if defined(LVGL_VERSION_MAJOR) && ((LVGL_VERSION_MAJOR > 9) || (LVGL_VERSION_MAJOR == 9 && LVGL_VERSION_MINOR >= 2))
+
+/* The assembly below is written for the LVGL 9.1 blend descriptors, newer versions use the vector kernels */
+#include "esp_lvgl_port_lv_blend_vec.h"
+
+#else
+
 /*********************
  *      DEFINES
  *********************/
@@ -151,6 +165,8 @@ static inline lv_result_t _lv_rgb888_blend_normal_to_rgb888_esp(_lv_draw_sw_blen
     return lv_rgb888_blend_normal_to_rgb888_esp(&asm_dsc);
 }
 
+#endif // LVGL_VERSION
+
 #endif // CONFIG_LV_DRAW_SW_ASM_CUSTOM
 
 #ifdef __cplusplus
@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Portable RGB565 blend kernels written with GCC/Clang vector extensions.
+ *
+ * The compiler maps the vectors to the SIMD unit of the target (SSE2/AVX2 on x86,
+ * NEON on Arm) or splits them to scalar operations where there is none.
+ * The results are bit exact with LVGL's C implementation.
+ *
+ * Used by LVGL >= 9.2 when this header (or esp_lvgl_port_lv_blend.h, which includes it)
+ * is set as LV_DRAW_SW_ASM_CUSTOM_INCLUDE with LV_USE_DRAW_SW_ASM = LV_DRAW_SW_ASM_CUSTOM.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__) && !defined(__ASSEMBLER__)
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#ifndef LV_DRAW_SW_COLOR_BLEND_TO_RGB565
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc) \
+    lv_color_blend_to_rgb565_vec(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_OPA
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_OPA(dsc) \
+    lv_color_blend_to_rgb565_with_opa_vec(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_MASK
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_MASK(dsc) \
+    lv_color_blend_to_rgb565_with_mask_vec(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_COLOR_BLEND_TO_RGB565_MIX_MASK_OPA
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_MIX_MASK_OPA(dsc) \
+    lv_color_blend_to_rgb565_mix_mask_opa_vec(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565(dsc) \
+    lv_rgb565_blend_normal_to_rgb565_vec(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_OPA
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_OPA(dsc) \
+    lv_rgb565_blend_normal_to_rgb565_with_opa_vec(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_MASK
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_MASK(dsc) \
+    lv_rgb565_blend_normal_to_rgb565_with_mask_vec(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_MIX_MASK_OPA
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_MIX_MASK_OPA(dsc) \
+    lv_rgb565_blend_normal_to_rgb565_mix_mask_opa_vec(dsc)
+#endif
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+lv_result_t lv_color_blend_to_rgb565_vec(lv_draw_sw_blend_fill_dsc_t *dsc);
+lv_result_t lv_color_blend_to_rgb565_with_opa_vec(lv_draw_sw_blend_fill_dsc_t *dsc);
+lv_result_t lv_color_blend_to_rgb565_with_mask_vec(lv_draw_sw_blend_fill_dsc_t *dsc);
+lv_result_t lv_color_blend_to_rgb565_mix_mask_opa_vec(lv_draw_sw_blend_fill_dsc_t *dsc);
+
+lv_result_t lv_rgb565_blend_normal_to_rgb565_vec(lv_draw_sw_blend_image_dsc_t *dsc);
+lv_result_t lv_rgb565_blend_normal_to_rgb565_with_opa_vec(lv_draw_sw_blend_image_dsc_t *dsc);
+lv_result_t lv_rgb565_blend_normal_to_rgb565_with_mask_vec(lv_draw_sw_blend_image_dsc_t *dsc);
+lv_result_t lv_rgb565_blend_normal_to_rgb565_mix_mask_opa_vec(lv_draw_sw_blend_image_dsc_t *dsc);
+
+#endif /* __GNUC__ */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
@@ -23,6 +23,12 @@ static const char *TAG = "LVGL";
 
 #define ESP_LVGL_PORT_TASK_MUX_DELAY_MS    10000
 
+#ifdef CONFIG_LVGL_PORT_TASK_EVENT_DRIVEN
+#define LVGL_PORT_TASK_EVENT_DRIVEN 1
+#else
+#define LVGL_PORT_TASK_EVENT_DRIVEN 0
+#endif
+
 /*******************************************************************************
 * Types definitions
 *******************************************************************************/
@@ -34,9 +40,14 @@ typedef struct lvgl_port_ctx_s {
     EventGroupHandle_t  lvgl_events;
     SemaphoreHandle_t   task_init_mux;
     esp_timer_handle_t  tick_timer;
+    esp_timer_handle_t  wake_timer;     /* One-shot, wakes the task when the next LVGL timer is due */
     bool                running;
+    bool                timers_stopped; /* lvgl_port_stop() was called, no LVGL timer will be due */
     int                 task_max_sleep_ms;
     int                 timer_period_ms;
+    portMUX_TYPE        stats_lock;
+    lvgl_port_task_stats_t stats;
+    int64_t             task_start_us;
 } lvgl_port_ctx_t;
 
 /*******************************************************************************
@@ -49,6 +60,9 @@ static lvgl_port_ctx_t lvgl_port_ctx;
 *******************************************************************************/
 static void lvgl_port_task(void *arg);
 static esp_err_t lvgl_port_tick_init(void);
+#if LVGL_PORT_TASK_EVENT_DRIVEN
+static esp_err_t lvgl_port_wake_timer_init(void);
+#endif
 static void lvgl_port_task_deinit(void);
 
 /*******************************************************************************
@@ -62,6 +76,7 @@ esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg)
     ESP_GOTO_ON_FALSE(cfg->task_affinity < (configNUM_CORES), ESP_ERR_INVALID_ARG, err, TAG, "Bad core number for task! Maximum core number is %d", (configNUM_CORES - 1));
 
     memset(&lvgl_port_ctx, 0, sizeof(lvgl_port_ctx));
+    portMUX_INITIALIZE(&lvgl_port_ctx.stats_lock);
 
     /* Tick init */
     lvgl_port_ctx.timer_period_ms = cfg->timer_period_ms;
@@ -109,6 +124,7 @@ esp_err_t lvgl_port_resume(void)
     esp_err_t ret = ESP_ERR_INVALID_STATE;
 
     if (lvgl_port_ctx.tick_timer != NULL) {
+        lvgl_port_ctx.timers_stopped = false;
         lv_timer_enable(true);
         ret = esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_ctx.timer_period_ms * 1000);
     }
@@ -121,6 +137,7 @@ esp_err_t lvgl_port_stop(void)
     esp_err_t ret = ESP_ERR_INVALID_STATE;
 
     if (lvgl_port_ctx.tick_timer != NULL) {
+        lvgl_port_ctx.timers_stopped = true;
         lv_timer_enable(false);
         ret = esp_timer_stop(lvgl_port_ctx.tick_timer);
     }
@@ -140,6 +157,8 @@ esp_err_t lvgl_port_deinit(void)
     /* Stop running task */
     if (lvgl_port_ctx.running) {
         lvgl_port_ctx.running = false;
+        /* Do not wait for it to wake up on its own */
+        lvgl_port_task_wake(LVGL_PORT_EVENT_USER, NULL);
     }
 
     /* Wait for stop task */
@@ -149,6 +168,12 @@ esp_err_t lvgl_port_deinit(void)
     }
     ESP_LOGI(TAG, "Stopped LVGL task");
 
+    if (lvgl_port_ctx.wake_timer != NULL) {
+        esp_timer_stop(lvgl_port_ctx.wake_timer);
+        esp_timer_delete(lvgl_port_ctx.wake_timer);
+        lvgl_port_ctx.wake_timer = NULL;
+    }
+
     lvgl_port_task_deinit();
 
     return ESP_OK;
@@ -158,13 +183,35 @@ bool lvgl_port_lock(uint32_t timeout_ms)
 {
     assert(lvgl_port_ctx.lvgl_mux && "lvgl_port_init must be called first");
 
+    const TickType_t start_ticks = xTaskGetTickCount();
     const TickType_t timeout_ticks = (timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
-    return xSemaphoreTakeRecursive(lvgl_port_ctx.lvgl_mux, timeout_ticks) == pdTRUE;
+    if (xSemaphoreTakeRecursive(lvgl_port_ctx.lvgl_mux, timeout_ticks) != pdTRUE) {
+        return false;
+    }
+
+    /* With LV_USE_OS, LVGL's own lock, also taken by lv_timer_handler(). Always taken after lvgl_mux,
+     * so both are taken in the same order everywhere. The timeout covers both locks together. */
+#if LV_USE_OS == LV_OS_FREERTOS
+    if (timeout_ms != 0) {
+        const uint32_t elapsed_ms = pdTICKS_TO_MS(xTaskGetTickCount() - start_ticks);
+        const uint32_t left_ms = elapsed_ms < timeout_ms ? timeout_ms - elapsed_ms : 0;
+        if (lv_freertos_lock_timeout(left_ms) != LV_RESULT_OK) {
+            xSemaphoreGiveRecursive(lvgl_port_ctx.lvgl_mux);
+            return false;
+        }
+        return true;
+    }
+#else
+    (void)start_ticks;
+#endif
+    lv_lock();
+    return true;
 }
 
 void lvgl_port_unlock(void)
 {
     assert(lvgl_port_ctx.lvgl_mux && "lvgl_port_init must be called first");
+    lv_unlock();
     xSemaphoreGiveRecursive(lvgl_port_ctx.lvgl_mux);
 }
 
@@ -213,10 +260,87 @@ IRAM_ATTR bool lvgl_port_task_notify(uint32_t value)
     return (need_yield == pdTRUE);
 }
 
+esp_err_t lvgl_port_get_task_stats(lvgl_port_task_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.running, ESP_ERR_INVALID_STATE, TAG, "LVGL task not running");
+
+    portENTER_CRITICAL(&lvgl_port_ctx.stats_lock);
+    *stats = lvgl_port_ctx.stats;
+    portEXIT_CRITICAL(&lvgl_port_ctx.stats_lock);
+    stats->elapsed_us = esp_timer_get_time() - lvgl_port_ctx.task_start_us;
+
+    return ESP_OK;
+}
+
 /*******************************************************************************
 * Private functions
 *******************************************************************************/
 
+static void lvgl_port_count_wakes(EventBits_t events)
+{
+    portENTER_CRITICAL(&lvgl_port_ctx.stats_lock);
+    if (events & LVGL_PORT_EVENT_DISPLAY) {
+        lvgl_port_ctx.stats.wakes_display++;
+    }
+    if (events & LVGL_PORT_EVENT_TOUCH) {
+        lvgl_port_ctx.stats.wakes_touch++;
+    }
+    if (events & LVGL_PORT_EVENT_FLUSH) {
+        lvgl_port_ctx.stats.wakes_flush++;
+    }
+    if (events & LVGL_PORT_EVENT_TIMER) {
+        lvgl_port_ctx.stats.wakes_timer++;
+    }
+    if (events & LVGL_PORT_EVENT_USER) {
+        lvgl_port_ctx.stats.wakes_user++;
+    }
+    if (!events) {
+        lvgl_port_ctx.stats.wakes_timeout++;
+    }
+    portEXIT_CRITICAL(&lvgl_port_ctx.stats_lock);
+}
+
+#if LVGL_PORT_TASK_EVENT_DRIVEN
+/* LVGL calls this when a timer is created, resumed or reset, e.g. when an invalidated area resumes the refresh timer */
+static void lvgl_port_timer_resume_callback(void *data)
+{
+    /* The LVGL task picks up timers changed from inside lv_timer_handler() itself */
+    if (xTaskGetCurrentTaskHandle() != lvgl_port_ctx.lvgl_task) {
+        lvgl_port_task_wake(LVGL_PORT_EVENT_TIMER, NULL);
+    }
+}
+
+static void lvgl_port_wake_timer_callback(void *arg)
+{
+    lvgl_port_task_wake(LVGL_PORT_EVENT_TIMER, NULL);
+}
+
+/* Block until an event comes in or the next LVGL timer is due. The wake timer is an
+ * esp_timer, so a timer due in less than a FreeRTOS tick does not wait for the next tick. */
+static EventBits_t lvgl_port_task_wait(uint32_t delay_ms)
+{
+    if (delay_ms == 0) {
+        /* Due already, but let lower priority tasks run the way vTaskDelay(1) did */
+        delay_ms = 1;
+    }
+    bool armed = false;
+    if (delay_ms < (uint32_t)lvgl_port_ctx.task_max_sleep_ms && !lvgl_port_ctx.timers_stopped) {
+        esp_timer_stop(lvgl_port_ctx.wake_timer);
+        armed = (esp_timer_start_once(lvgl_port_ctx.wake_timer, (uint64_t)delay_ms * 1000) == ESP_OK);
+    }
+
+    EventBits_t events = xEventGroupWaitBits(lvgl_port_ctx.lvgl_events, 0xFF, pdTRUE, pdFALSE,
+                         pdMS_TO_TICKS(lvgl_port_ctx.task_max_sleep_ms));
+
+    /* Woken by something else first, lv_timer_handler() works out the next due time anew */
+    if (armed && !(events & LVGL_PORT_EVENT_TIMER)) {
+        esp_timer_stop(lvgl_port_ctx.wake_timer);
+    }
+    return events;
+}
+#endif
+
 static void lvgl_port_task(void *arg)
 {
     TaskHandle_t task_to_notify = (TaskHandle_t)arg;
@@ -237,15 +361,26 @@ static void lvgl_port_task(void *arg)
     xTaskNotifyGive(task_to_notify);
     /* Tick init */
     lvgl_port_tick_init();
+#if LVGL_PORT_TASK_EVENT_DRIVEN
+    lvgl_port_wake_timer_init();
+    lv_timer_handler_set_resume_cb(lvgl_port_timer_resume_callback, NULL);
+#endif
 
-    ESP_LOGI(TAG, "Starting LVGL task");
+    ESP_LOGI(TAG, "Starting LVGL task%s", LVGL_PORT_TASK_EVENT_DRIVEN ? " (event driven)" : "");
+    lvgl_port_ctx.task_start_us = esp_timer_get_time();
     lvgl_port_ctx.running = true;
     while (lvgl_port_ctx.running) {
+#if LVGL_PORT_TASK_EVENT_DRIVEN
+        events = lvgl_port_task_wait(task_delay_ms);
+#else
         /* Wait for queue or timeout (sleep task) */
         TickType_t wait = (pdMS_TO_TICKS(task_delay_ms) >= 1 ? pdMS_TO_TICKS(task_delay_ms) : 1);
         events = xEventGroupWaitBits(lvgl_port_ctx.lvgl_events, 0xFF, pdTRUE, pdFALSE, wait);
+#endif
+        lvgl_port_count_wakes(events);
 
         if (lv_display_get_default() && lvgl_port_lock(0)) {
+            int64_t busy_start_us = esp_timer_get_time();
 
             /* Call read input devices */
             if (events & LVGL_PORT_EVENT_TOUCH) {
@@ -261,6 +396,12 @@ static void lvgl_port_task(void *arg)
             /* Handle LVGL */
             task_delay_ms = lv_timer_handler();
             lvgl_port_unlock();
+
+            int64_t busy_us = esp_timer_get_time() - busy_start_us;
+            portENTER_CRITICAL(&lvgl_port_ctx.stats_lock);
+            lvgl_port_ctx.stats.handler_runs++;
+            lvgl_port_ctx.stats.busy_us += busy_us;
+            portEXIT_CRITICAL(&lvgl_port_ctx.stats_lock);
         } else {
             task_delay_ms = 1; /*Keep trying*/
         }
@@ -269,8 +410,10 @@ static void lvgl_port_task(void *arg)
             task_delay_ms = lvgl_port_ctx.task_max_sleep_ms;
         }
 
+#if !LVGL_PORT_TASK_EVENT_DRIVEN
         /* Minimal dealy for the task. When there is too much events, it takes time for other tasks and interrupts. */
         vTaskDelay(1);
+#endif
     }
 
     /* Give semaphore back */
@@ -319,3 +462,15 @@ static esp_err_t lvgl_port_tick_init(void)
     ESP_RETURN_ON_ERROR(esp_timer_create(&lvgl_tick_timer_args, &lvgl_port_ctx.tick_timer), TAG, "Creating LVGL timer filed!");
     return esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_ctx.timer_period_ms * 1000);
 }
+
+#if LVGL_PORT_TASK_EVENT_DRIVEN
+static esp_err_t lvgl_port_wake_timer_init(void)
+{
+    const esp_timer_create_args_t lvgl_wake_timer_args = {
+        .callback = &lvgl_port_wake_timer_callback,
+        .name = "LVGL wake",
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&lvgl_wake_timer_args, &lvgl_port_ctx.wake_timer), TAG, "Creating LVGL wake timer failed!");
+    return ESP_OK;
+}
+#endif
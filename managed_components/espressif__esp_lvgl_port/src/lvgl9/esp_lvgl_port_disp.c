@@ -60,6 +60,8 @@ typedef struct {
     lv_display_t              *disp_drv;      /* LVGL display driver */
     lv_display_rotation_t     current_rotation;
     SemaphoreHandle_t         trans_sem;      /* Idle transfer mutex */
+    lvgl_port_vsync_cb_t      vsync_cb;       /* User callback for the end of a panel refresh */
+    void                      *vsync_cb_ctx;
 #if LVGL_PORT_PPA
     lvgl_port_ppa_handle_t    ppa_handle;
 #endif //LVGL_PORT_PPA
@@ -139,9 +141,9 @@ lv_display_t *lvgl_port_add_disp_dsi(const lvgl_port_display_cfg_t *disp_cfg, co
 
 #if (CONFIG_IDF_TARGET_ESP32P4 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0))
         esp_lcd_dpi_panel_event_callbacks_t cbs = {0};
-        if (dsi_cfg->flags.avoid_tearing) {
-            cbs.on_refresh_done = lvgl_port_flush_dpi_vsync_ready_callback;
-        } else {
+        /* Refresh done is always registered, for lvgl_port_disp_register_vsync_cb */
+        cbs.on_refresh_done = lvgl_port_flush_dpi_vsync_ready_callback;
+        if (!dsi_cfg->flags.avoid_tearing) {
             cbs.on_color_trans_done = lvgl_port_flush_dpi_panel_ready_callback;
         }
         /* Register done callback */
@@ -247,6 +249,27 @@ void lvgl_port_flush_ready(lv_display_t *disp)
     lv_disp_flush_ready(disp);
 }
 
+esp_lcd_panel_handle_t lvgl_port_get_panel_handle(lv_display_t *disp)
+{
+    assert(disp);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_driver_data(disp);
+    assert(disp_ctx != NULL);
+    return disp_ctx->panel_handle;
+}
+
+esp_err_t lvgl_port_disp_register_vsync_cb(lv_display_t *disp, lvgl_port_vsync_cb_t cb, void *user_ctx)
+{
+    assert(disp);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_driver_data(disp);
+    assert(disp_ctx != NULL);
+    ESP_RETURN_ON_FALSE(disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_DSI, ESP_ERR_NOT_SUPPORTED, TAG, "Vsync callback is supported only for MIPI-DSI displays");
+
+    disp_ctx->vsync_cb = NULL;
+    disp_ctx->vsync_cb_ctx = user_ctx;
+    disp_ctx->vsync_cb = cb;
+    return ESP_OK;
+}
+
 /*******************************************************************************
 * Private functions
 *******************************************************************************/
@@ -450,6 +473,10 @@ static bool lvgl_port_flush_io_ready_callback(esp_lcd_panel_io_handle_t panel_io
     lv_display_t *disp_drv = (lv_display_t *)user_ctx;
     assert(disp_drv != NULL);
     lv_disp_flush_ready(disp_drv);
+#if CONFIG_LVGL_PORT_TASK_EVENT_DRIVEN
+    /* The last flush of a frame is not waited for, a refresh queued meanwhile can start now */
+    lvgl_port_task_wake(LVGL_PORT_EVENT_FLUSH, disp_drv);
+#endif
     return false;
 }
 
@@ -459,6 +486,10 @@ static bool lvgl_port_flush_dpi_panel_ready_callback(esp_lcd_panel_handle_t pane
     lv_display_t *disp_drv = (lv_display_t *)user_ctx;
     assert(disp_drv != NULL);
     lv_disp_flush_ready(disp_drv);
+#if CONFIG_LVGL_PORT_TASK_EVENT_DRIVEN
+    /* The last flush of a frame is not waited for, a refresh queued meanwhile can start now */
+    lvgl_port_task_wake(LVGL_PORT_EVENT_FLUSH, disp_drv);
+#endif
     return false;
 }
 
@@ -475,6 +506,11 @@ static bool lvgl_port_flush_dpi_vsync_ready_callback(esp_lcd_panel_handle_t pane
         xSemaphoreGiveFromISR(disp_ctx->trans_sem, &need_yield);
     }
 
+    lvgl_port_vsync_cb_t vsync_cb = disp_ctx->vsync_cb;
+    if (vsync_cb && vsync_cb(disp_drv, disp_ctx->vsync_cb_ctx)) {
+        need_yield = pdTRUE;
+    }
+
     return (need_yield == pdTRUE);
 }
 #endif
@@ -0,0 +1,326 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * RGB565 blend kernels with GCC/Clang vector extensions, see esp_lvgl_port_lv_blend_vec.h
+ *
+ * Every kernel processes VEC_PX pixels at once and the remaining pixels of the row one by one.
+ * Mixing uses the same formula as lv_color_16_16_mix(), so the results are the same bit by bit:
+ * the green channel is moved to the upper half word and all channels are mixed in one 32-bit lane.
+ */
+
+#include <string.h>
+#include "lvgl.h"
+#include "lvgl_private.h"
+#include "esp_lvgl_port_lv_blend_vec.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* Pixels per vector. The pixels are mixed in 32-bit lanes, 4 of them fill a 128-bit register
+ * of SSE2, NEON or PIE */
+#define VEC_PX          4
+
+/* The RGB565 channels spread to 32 bits: 0b00000111111000001111100000011111 */
+#define RGB565_SPREAD   0x7E0F81F
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef uint32_t vec_u32_t __attribute__((vector_size(VEC_PX * 4)));
+typedef uint16_t vec_u16_t __attribute__((vector_size(VEC_PX * 2)));
+typedef uint8_t vec_u8_t __attribute__((vector_size(VEC_PX)));
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static inline vec_u16_t load_u16(const uint16_t *p);
+static inline void store_u16(uint16_t *p, vec_u16_t v);
+static inline uint32_t load_mask_bits(const lv_opa_t *p);
+static inline vec_u32_t load_mask(const lv_opa_t *p);
+static inline vec_u32_t spread(vec_u16_t c);
+static inline vec_u16_t mix_vec(vec_u32_t fg, vec_u32_t bg, vec_u32_t mix);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+lv_result_t lv_color_blend_to_rgb565_vec(lv_draw_sw_blend_fill_dsc_t *dsc)
+{
+    const int32_t w = dsc->dest_w;
+    const uint16_t color16 = lv_color_to_u16(dsc->color);
+    const vec_u16_t color_v = (vec_u16_t){0} + color16;
+    uint8_t *dest_row = dsc->dest_buf;
+
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        uint16_t *dest = (uint16_t *)dest_row;
+        int32_t x = 0;
+        for (; x <= w - VEC_PX; x += VEC_PX) {
+            store_u16(&dest[x], color_v);
+        }
+        for (; x < w; x++) {
+            dest[x] = color16;
+        }
+        dest_row += dsc->dest_stride;
+    }
+
+    return LV_RESULT_OK;
+}
+
+lv_result_t lv_color_blend_to_rgb565_with_opa_vec(lv_draw_sw_blend_fill_dsc_t *dsc)
+{
+    const int32_t w = dsc->dest_w;
+    const lv_opa_t opa = dsc->opa;
+    const uint16_t color16 = lv_color_to_u16(dsc->color);
+    const vec_u32_t fg = spread((vec_u16_t){0} + color16);
+    const vec_u32_t opa_v = (vec_u32_t){0} + opa;
+    uint8_t *dest_row = dsc->dest_buf;
+
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        uint16_t *dest = (uint16_t *)dest_row;
+        int32_t x = 0;
+        for (; x <= w - VEC_PX; x += VEC_PX) {
+            store_u16(&dest[x], mix_vec(fg, spread(load_u16(&dest[x])), opa_v));
+        }
+        for (; x < w; x++) {
+            dest[x] = lv_color_16_16_mix(color16, dest[x], opa);
+        }
+        dest_row += dsc->dest_stride;
+    }
+
+    return LV_RESULT_OK;
+}
+
+lv_result_t lv_color_blend_to_rgb565_with_mask_vec(lv_draw_sw_blend_fill_dsc_t *dsc)
+{
+    const int32_t w = dsc->dest_w;
+    const uint16_t color16 = lv_color_to_u16(dsc->color);
+    const vec_u16_t color_v = (vec_u16_t){0} + color16;
+    const vec_u32_t fg = spread(color_v);
+    const lv_opa_t *mask = dsc->mask_buf;
+    uint8_t *dest_row = dsc->dest_buf;
+
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        uint16_t *dest = (uint16_t *)dest_row;
+        int32_t x = 0;
+        for (; x <= w - VEC_PX; x += VEC_PX) {
+            /* Anti-aliased edges: most of the mask is fully transparent or fully covered */
+            uint32_t mask_bits = load_mask_bits(&mask[x]);
+            if (mask_bits == 0) {
+                continue;
+            } else if (mask_bits == UINT32_MAX) {
+                store_u16(&dest[x], color_v);
+            } else {
+                store_u16(&dest[x], mix_vec(fg, spread(load_u16(&dest[x])), load_mask(&mask[x])));
+            }
+        }
+        for (; x < w; x++) {
+            dest[x] = lv_color_16_16_mix(color16, dest[x], mask[x]);
+        }
+        dest_row += dsc->dest_stride;
+        mask += dsc->mask_stride;
+    }
+
+    return LV_RESULT_OK;
+}
+
+lv_result_t lv_color_blend_to_rgb565_mix_mask_opa_vec(lv_draw_sw_blend_fill_dsc_t *dsc)
+{
+    const int32_t w = dsc->dest_w;
+    const lv_opa_t opa = dsc->opa;
+    const uint16_t color16 = lv_color_to_u16(dsc->color);
+    const vec_u32_t fg = spread((vec_u16_t){0} + color16);
+    const lv_opa_t *mask = dsc->mask_buf;
+    uint8_t *dest_row = dsc->dest_buf;
+
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        uint16_t *dest = (uint16_t *)dest_row;
+        int32_t x = 0;
+        for (; x <= w - VEC_PX; x += VEC_PX) {
+            vec_u32_t mix_v = (load_mask(&mask[x]) * opa) >> 8;     /* LV_OPA_MIX2 */
+            store_u16(&dest[x], mix_vec(fg, spread(load_u16(&dest[x])), mix_v));
+        }
+        for (; x < w; x++) {
+            dest[x] = lv_color_16_16_mix(color16, dest[x], LV_OPA_MIX2(mask[x], opa));
+        }
+        dest_row += dsc->dest_stride;
+        mask += dsc->mask_stride;
+    }
+
+    return LV_RESULT_OK;
+}
+
+lv_result_t lv_rgb565_blend_normal_to_rgb565_vec(lv_draw_sw_blend_image_dsc_t *dsc)
+{
+    /* LVGL calls the same hooks for RGB565_SWAPPED sources too, leave those to the C code */
+    if (dsc->src_color_format != LV_COLOR_FORMAT_RGB565) {
+        return LV_RESULT_INVALID;
+    }
+
+    const int32_t w = dsc->dest_w;
+    uint8_t *dest_row = dsc->dest_buf;
+    const uint8_t *src_row = dsc->src_buf;
+
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        uint16_t *dest = (uint16_t *)dest_row;
+        const uint16_t *src = (const uint16_t *)src_row;
+        int32_t x = 0;
+        for (; x <= w - VEC_PX; x += VEC_PX) {
+            store_u16(&dest[x], load_u16(&src[x]));
+        }
+        for (; x < w; x++) {
+            dest[x] = src[x];
+        }
+        dest_row += dsc->dest_stride;
+        src_row += dsc->src_stride;
+    }
+
+    return LV_RESULT_OK;
+}
+
+lv_result_t lv_rgb565_blend_normal_to_rgb565_with_opa_vec(lv_draw_sw_blend_image_dsc_t *dsc)
+{
+    if (dsc->src_color_format != LV_COLOR_FORMAT_RGB565) {
+        return LV_RESULT_INVALID;
+    }
+
+    const int32_t w = dsc->dest_w;
+    const lv_opa_t opa = dsc->opa;
+    const vec_u32_t opa_v = (vec_u32_t){0} + opa;
+    uint8_t *dest_row = dsc->dest_buf;
+    const uint8_t *src_row = dsc->src_buf;
+
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        uint16_t *dest = (uint16_t *)dest_row;
+        const uint16_t *src = (const uint16_t *)src_row;
+        int32_t x = 0;
+        for (; x <= w - VEC_PX; x += VEC_PX) {
+            store_u16(&dest[x], mix_vec(spread(load_u16(&src[x])), spread(load_u16(&dest[x])), opa_v));
+        }
+        for (; x < w; x++) {
+            dest[x] = lv_color_16_16_mix(src[x], dest[x], opa);
+        }
+        dest_row += dsc->dest_stride;
+        src_row += dsc->src_stride;
+    }
+
+    return LV_RESULT_OK;
+}
+
+lv_result_t lv_rgb565_blend_normal_to_rgb565_with_mask_vec(lv_draw_sw_blend_image_dsc_t *dsc)
+{
+    if (dsc->src_color_format != LV_COLOR_FORMAT_RGB565) {
+        return LV_RESULT_INVALID;
+    }
+
+    const int32_t w = dsc->dest_w;
+    const lv_opa_t *mask = dsc->mask_buf;
+    uint8_t *dest_row = dsc->dest_buf;
+    const uint8_t *src_row = dsc->src_buf;
+
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        uint16_t *dest = (uint16_t *)dest_row;
+        const uint16_t *src = (const uint16_t *)src_row;
+        int32_t x = 0;
+        for (; x <= w - VEC_PX; x += VEC_PX) {
+            uint32_t mask_bits = load_mask_bits(&mask[x]);
+            if (mask_bits == 0) {
+                continue;
+            } else if (mask_bits == UINT32_MAX) {
+                store_u16(&dest[x], load_u16(&src[x]));
+            } else {
+                store_u16(&dest[x], mix_vec(spread(load_u16(&src[x])), spread(load_u16(&dest[x])), load_mask(&mask[x])));
+            }
+        }
+        for (; x < w; x++) {
+            dest[x] = lv_color_16_16_mix(src[x], dest[x], mask[x]);
+        }
+        dest_row += dsc->dest_stride;
+        src_row += dsc->src_stride;
+        mask += dsc->mask_stride;
+    }
+
+    return LV_RESULT_OK;
+}
+
+lv_result_t lv_rgb565_blend_normal_to_rgb565_mix_mask_opa_vec(lv_draw_sw_blend_image_dsc_t *dsc)
+{
+    if (dsc->src_color_format != LV_COLOR_FORMAT_RGB565) {
+        return LV_RESULT_INVALID;
+    }
+
+    const int32_t w = dsc->dest_w;
+    const lv_opa_t opa = dsc->opa;
+    const lv_opa_t *mask = dsc->mask_buf;
+    uint8_t *dest_row = dsc->dest_buf;
+    const uint8_t *src_row = dsc->src_buf;
+
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        uint16_t *dest = (uint16_t *)dest_row;
+        const uint16_t *src = (const uint16_t *)src_row;
+        int32_t x = 0;
+        for (; x <= w - VEC_PX; x += VEC_PX) {
+            vec_u32_t mix_v = (load_mask(&mask[x]) * opa) >> 8;     /* LV_OPA_MIX2 */
+            store_u16(&dest[x], mix_vec(spread(load_u16(&src[x])), spread(load_u16(&dest[x])), mix_v));
+        }
+        for (; x < w; x++) {
+            dest[x] = lv_color_16_16_mix(src[x], dest[x], LV_OPA_MIX2(mask[x], opa));
+        }
+        dest_row += dsc->dest_stride;
+        src_row += dsc->src_stride;
+        mask += dsc->mask_stride;
+    }
+
+    return LV_RESULT_OK;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/* The buffers don't need to be aligned, memcpy() compiles to unaligned vector loads and stores */
+static inline vec_u16_t load_u16(const uint16_t *p)
+{
+    vec_u16_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store_u16(uint16_t *p, vec_u16_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static inline uint32_t load_mask_bits(const lv_opa_t *p)
+{
+    uint32_t bits;
+    memcpy(&bits, p, sizeof(bits));
+    return bits;
+}
+
+static inline vec_u32_t load_mask(const lv_opa_t *p)
+{
+    vec_u8_t v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_convertvector(v, vec_u32_t);
+}
+
+static inline vec_u32_t spread(vec_u16_t c)
+{
+    vec_u32_t c32 = __builtin_convertvector(c, vec_u32_t);
+    return (c32 | (c32 << 16)) & RGB565_SPREAD;
+}
+
+/* lv_color_16_16_mix() on VEC_PX pixels. Its early returns for mix 0 and 255 give the same as the formula. */
+static inline vec_u16_t mix_vec(vec_u32_t fg, vec_u32_t bg, vec_u32_t mix)
+{
+    mix = (mix + 4) >> 3;
+    vec_u32_t res = ((((fg - bg) * mix) >> 5) + bg) & RGB565_SPREAD;
+    return __builtin_convertvector(res | (res >> 16), vec_u16_t);
+}
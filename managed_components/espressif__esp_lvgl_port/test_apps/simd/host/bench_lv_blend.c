@@ -0,0 +1,449 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+Benchmark of the blend kernels, host counterpart of ../main/test_lv_fill_benchmark.c and ../main/test_lv_image_benchmark.c
+
+Purpose:
+    - Measure LVGL's own src/draw/sw/blend/ files, not the hard copy of ../main/lv_blend, so every LVGL update is measured
+    - Measure the hooks of esp_lvgl_port_lv_blend_vec.h against them
+    - Give machine readable results, to track the Mpx/s of every kernel across commits
+
+Procedure:
+    - For every destination color format, fill and image blend from the source formats the port has kernels for
+    - For every variant (normal, opa, mask, mask+opa), stride alignment (16-byte aligned or not) and area width (1..1280 px)
+    - Repeat the blending until it takes at least the minimum time, keep the fastest of a few such runs
+    - Print one record per combination, CSV or JSON, to stdout or to a file
+
+Usage:
+    bench_lv_blend [--json] [--quick] [--height N] [--min-time-ms N] [--filter TEXT] [-o FILE]
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lvgl.h"
+#include "lvgl_private.h"
+#include "src/draw/sw/blend/lv_draw_sw_blend_to_al88.h"
+#include "src/draw/sw/blend/lv_draw_sw_blend_to_argb8888.h"
+#include "src/draw/sw/blend/lv_draw_sw_blend_to_l8.h"
+#include "src/draw/sw/blend/lv_draw_sw_blend_to_rgb565.h"
+#include "src/draw/sw/blend/lv_draw_sw_blend_to_rgb565_swapped.h"
+#include "src/draw/sw/blend/lv_draw_sw_blend_to_rgb888.h"
+
+// ------------------------------------------------- Defines -----------------------------------------------------------
+
+#define MAX_WIDTH       1280
+#define MAX_HEIGHT      64
+#define MAX_PX_SIZE     4
+#define BUF_ALIGN       64          // Cache line, the aligned buffers are aligned for every vector length
+#define BEST_OF_RUNS    3
+
+// ------------------------------------------------- Macros and Types --------------------------------------------------
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+/**
+ * @brief Opacity and mask combinations, each one is a different kernel
+ */
+typedef enum {
+    BLEND_NORMAL,
+    BLEND_OPA,
+    BLEND_MASK,
+    BLEND_MASK_OPA,
+} blend_variant_t;
+
+/**
+ * @brief Blend functions of one destination color format, of one implementation
+ */
+typedef struct {
+    const char *impl;                                       // "lvgl" for LVGL's C code, or the hooks' name
+    lv_color_format_t dest_cf;
+    void (*fill)(lv_draw_sw_blend_fill_dsc_t *dsc);
+    void (*image)(lv_draw_sw_blend_image_dsc_t *dsc);
+    const lv_color_format_t *src_cfs;                       // Source formats of the image blend
+    size_t src_cf_cnt;
+} bench_dest_t;
+
+/**
+ * @brief Benchmark options, from the command line
+ */
+typedef struct {
+    bool json;
+    bool quick;
+    int height;
+    double min_time;                                        // Minimum time of one measured run, in seconds
+    const char *filter;                                     // Only the kernels with this text in the name
+    FILE *out;
+} bench_options_t;
+
+/**
+ * @brief One measured combination
+ */
+typedef struct {
+    const bench_dest_t *dest;
+    bool image;
+    lv_color_format_t src_cf;
+    blend_variant_t variant;
+    bool aligned;
+    int width;
+    int height;
+} bench_case_t;
+
+void lv_draw_sw_blend_color_to_rgb565_custom(lv_draw_sw_blend_fill_dsc_t *dsc);
+void lv_draw_sw_blend_image_to_rgb565_custom(lv_draw_sw_blend_image_dsc_t *dsc);
+
+static const char *const variant_names[] = {"normal", "opa", "mask", "mask+opa"};
+static const int bench_widths[] = {1, 2, 3, 7, 8, 15, 16, 31, 33, 64, 127, 128, 255, 256, 480, 800, 1024, 1280};
+static const int quick_widths[] = {1, 15, 128, 1280};
+static const lv_color_t bench_color = {
+    .blue = 0x56,
+    .green = 0x34,
+    .red = 0x12,
+};
+
+// Source formats of the port's kernels
+static const lv_color_format_t all_src_cfs[] = {
+    LV_COLOR_FORMAT_RGB565,
+    LV_COLOR_FORMAT_RGB888,
+    LV_COLOR_FORMAT_XRGB8888,
+    LV_COLOR_FORMAT_ARGB8888,
+};
+static const lv_color_format_t rgb565_src_cfs[] = {
+    LV_COLOR_FORMAT_RGB565,
+};
+
+// ------------------------------------------------ Blend functions ----------------------------------------------------
+
+// The RGB888 functions serve XRGB8888 too, with the pixel size as a parameter
+
+static void fill_to_rgb888(lv_draw_sw_blend_fill_dsc_t *dsc)
+{
+    lv_draw_sw_blend_color_to_rgb888(dsc, 3);
+}
+
+static void image_to_rgb888(lv_draw_sw_blend_image_dsc_t *dsc)
+{
+    lv_draw_sw_blend_image_to_rgb888(dsc, 3);
+}
+
+static void fill_to_xrgb8888(lv_draw_sw_blend_fill_dsc_t *dsc)
+{
+    lv_draw_sw_blend_color_to_rgb888(dsc, 4);
+}
+
+static void image_to_xrgb8888(lv_draw_sw_blend_image_dsc_t *dsc)
+{
+    lv_draw_sw_blend_image_to_rgb888(dsc, 4);
+}
+
+static const bench_dest_t bench_dests[] = {
+    {"lvgl", LV_COLOR_FORMAT_RGB565, lv_draw_sw_blend_color_to_rgb565, lv_draw_sw_blend_image_to_rgb565, all_src_cfs, ARRAY_SIZE(all_src_cfs)},
+    {"vec", LV_COLOR_FORMAT_RGB565, lv_draw_sw_blend_color_to_rgb565_custom, lv_draw_sw_blend_image_to_rgb565_custom, rgb565_src_cfs, ARRAY_SIZE(rgb565_src_cfs)},
+    {"lvgl", LV_COLOR_FORMAT_RGB565_SWAPPED, lv_draw_sw_blend_color_to_rgb565_swapped, lv_draw_sw_blend_image_to_rgb565_swapped, all_src_cfs, ARRAY_SIZE(all_src_cfs)},
+    {"lvgl", LV_COLOR_FORMAT_RGB888, fill_to_rgb888, image_to_rgb888, all_src_cfs, ARRAY_SIZE(all_src_cfs)},
+    {"lvgl", LV_COLOR_FORMAT_XRGB8888, fill_to_xrgb8888, image_to_xrgb8888, all_src_cfs, ARRAY_SIZE(all_src_cfs)},
+    {"lvgl", LV_COLOR_FORMAT_ARGB8888, lv_draw_sw_blend_color_to_argb8888, lv_draw_sw_blend_image_to_argb8888, all_src_cfs, ARRAY_SIZE(all_src_cfs)},
+    {"lvgl", LV_COLOR_FORMAT_L8, lv_draw_sw_blend_color_to_l8, lv_draw_sw_blend_image_to_l8, all_src_cfs, ARRAY_SIZE(all_src_cfs)},
+    {"lvgl", LV_COLOR_FORMAT_AL88, lv_draw_sw_blend_color_to_al88, lv_draw_sw_blend_image_to_al88, all_src_cfs, ARRAY_SIZE(all_src_cfs)},
+};
+
+// ------------------------------------------------ Static functions ---------------------------------------------------
+
+static const char *cf_name(lv_color_format_t cf)
+{
+    switch (cf) {
+    case LV_COLOR_FORMAT_RGB565:
+        return "RGB565";
+    case LV_COLOR_FORMAT_RGB565_SWAPPED:
+        return "RGB565_SWAPPED";
+    case LV_COLOR_FORMAT_RGB888:
+        return "RGB888";
+    case LV_COLOR_FORMAT_XRGB8888:
+        return "XRGB8888";
+    case LV_COLOR_FORMAT_ARGB8888:
+        return "ARGB8888";
+    case LV_COLOR_FORMAT_L8:
+        return "L8";
+    case LV_COLOR_FORMAT_AL88:
+        return "AL88";
+    default:
+        return "?";
+    }
+}
+
+static uint32_t rand_next(uint32_t *state)
+{
+    // xorshift32, the same sequence on every run
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void fill_bytes(uint8_t *buf, size_t len, uint32_t seed)
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)rand_next(&seed);
+    }
+}
+
+// Runs of fully transparent and fully covered pixels, like anti-aliased edges, mixed with random coverage
+static void fill_mask(lv_opa_t *buf, size_t len, uint32_t seed)
+{
+    for (size_t i = 0; i < len; i++) {
+        uint32_t r = rand_next(&seed);
+        switch ((i / 8) % 4) {
+        case 0:
+            buf[i] = LV_OPA_TRANSP;
+            break;
+        case 1:
+            buf[i] = LV_OPA_COVER;
+            break;
+        default:
+            buf[i] = (lv_opa_t)r;
+            break;
+        }
+    }
+}
+
+static double time_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Stride of a row of width px: aligned rows start 16-byte aligned, the others shift by one pixel every row
+static int32_t row_stride(int width, uint32_t px_size, bool aligned)
+{
+    int32_t stride = (int32_t)((width * px_size + BUF_ALIGN - 1) / BUF_ALIGN * BUF_ALIGN);
+    return aligned ? stride : stride + (int32_t)px_size;
+}
+
+static bool case_matches(const bench_options_t *opt, const char *kernel)
+{
+    return opt->filter == NULL || strstr(kernel, opt->filter) != NULL;
+}
+
+static void kernel_name(const bench_case_t *bc, char *buf, size_t len)
+{
+    if (bc->image) {
+        snprintf(buf, len, "image_%s_to_%s", cf_name(bc->src_cf), cf_name(bc->dest->dest_cf));
+    } else {
+        snprintf(buf, len, "fill_to_%s", cf_name(bc->dest->dest_cf));
+    }
+}
+
+/**
+ * @brief Measure one combination
+ *
+ * @return Millions of destination pixels blended per second
+ */
+static double bench_run(const bench_options_t *opt, const bench_case_t *bc, uint8_t *dest_mem, const uint8_t *src_mem, const lv_opa_t *mask_mem)
+{
+    const uint32_t dest_px_size = lv_color_format_get_size(bc->dest->dest_cf);
+    const uint32_t src_px_size = lv_color_format_get_size(bc->src_cf);
+    const bool use_mask = bc->variant == BLEND_MASK || bc->variant == BLEND_MASK_OPA;
+    const lv_opa_t opa = (bc->variant == BLEND_OPA || bc->variant == BLEND_MASK_OPA) ? LV_OPA_50 : LV_OPA_COVER;
+
+    // The unaligned buffers start one pixel after a cache line
+    uint8_t *dest = dest_mem + (bc->aligned ? 0 : dest_px_size);
+    const uint8_t *src = src_mem + (bc->aligned ? 0 : src_px_size);
+    const lv_opa_t *mask = mask_mem + (bc->aligned ? 0 : 1);
+
+    lv_draw_sw_blend_fill_dsc_t fill_dsc = {
+        .dest_buf = dest,
+        .dest_w = bc->width,
+        .dest_h = bc->height,
+        .dest_stride = row_stride(bc->width, dest_px_size, bc->aligned),
+        .mask_buf = use_mask ? mask : NULL,
+        .mask_stride = row_stride(bc->width, 1, bc->aligned),
+        .color = bench_color,
+        .opa = opa,
+    };
+    lv_draw_sw_blend_image_dsc_t image_dsc = {
+        .dest_buf = dest,
+        .dest_w = bc->width,
+        .dest_h = bc->height,
+        .dest_stride = fill_dsc.dest_stride,
+        .mask_buf = fill_dsc.mask_buf,
+        .mask_stride = fill_dsc.mask_stride,
+        .src_buf = src,
+        .src_stride = row_stride(bc->width, src_px_size, bc->aligned),
+        .src_color_format = bc->src_cf,
+        .opa = opa,
+        .blend_mode = LV_BLEND_MODE_NORMAL,
+    };
+
+    // Double the repetitions until a run takes the minimum time, then keep the fastest of a few such runs
+    uint32_t reps = 1;
+    double best = 0;
+    for (int run = 0; run < BEST_OF_RUNS;) {
+        const double start = time_now();
+        for (uint32_t i = 0; i < reps; i++) {
+            if (bc->image) {
+                bc->dest->image(&image_dsc);
+            } else {
+                bc->dest->fill(&fill_dsc);
+            }
+        }
+        const double elapsed = time_now() - start;
+        if (elapsed < opt->min_time) {
+            reps *= 2;
+            continue;
+        }
+        const double mpx_s = (double)bc->width * bc->height * reps / elapsed / 1e6;
+        if (mpx_s > best) {
+            best = mpx_s;
+        }
+        run++;
+    }
+    return best;
+}
+
+static void print_header(const bench_options_t *opt)
+{
+    if (opt->json) {
+        fprintf(opt->out, "{\n  \"lvgl\": \"%d.%d.%d\",\n  \"unit\": \"Mpx/s\",\n  \"results\": [",
+                LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH);
+    } else {
+        fprintf(opt->out, "impl,kernel,dest_cf,src_cf,variant,stride,width,height,mpx_s\n");
+    }
+}
+
+static void print_record(const bench_options_t *opt, const bench_case_t *bc, const char *kernel, double mpx_s, bool first)
+{
+    const char *src = bc->image ? cf_name(bc->src_cf) : "";
+    const char *stride = bc->aligned ? "aligned" : "unaligned";
+    if (opt->json) {
+        fprintf(opt->out, "%s\n    {\"impl\": \"%s\", \"kernel\": \"%s\", \"dest_cf\": \"%s\", \"src_cf\": \"%s\", "
+                "\"variant\": \"%s\", \"stride\": \"%s\", \"width\": %d, \"height\": %d, \"mpx_s\": %.3f}",
+                first ? "" : ",", bc->dest->impl, kernel, cf_name(bc->dest->dest_cf), src,
+                variant_names[bc->variant], stride, bc->width, bc->height, mpx_s);
+    } else {
+        fprintf(opt->out, "%s,%s,%s,%s,%s,%s,%d,%d,%.3f\n",
+                bc->dest->impl, kernel, cf_name(bc->dest->dest_cf), src,
+                variant_names[bc->variant], stride, bc->width, bc->height, mpx_s);
+    }
+}
+
+static void print_footer(const bench_options_t *opt)
+{
+    if (opt->json) {
+        fprintf(opt->out, "\n  ]\n}\n");
+    }
+}
+
+static int usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [--json] [--quick] [--height N] [--min-time-ms N] [--filter TEXT] [-o FILE]\n"
+            "  --json            JSON instead of CSV\n"
+            "  --quick           a few widths and short runs, to check the benchmark works\n"
+            "  --height N        rows of every area, 1..%d (default 16)\n"
+            "  --min-time-ms N   minimum duration of one measured run (default 2)\n"
+            "  --filter TEXT     only the kernels with TEXT in the name, e.g. to_RGB565 or image_ARGB8888\n"
+            "  -o FILE           write the results to FILE instead of stdout\n", prog, MAX_HEIGHT);
+    return EXIT_FAILURE;
+}
+
+int main(int argc, char **argv)
+{
+    bench_options_t opt = {
+        .height = 16,
+        .min_time = 2e-3,
+        .out = stdout,
+    };
+    bool min_time_set = false;
+
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--json") == 0) {
+            opt.json = true;
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            opt.quick = true;
+        } else if (strcmp(argv[i], "--height") == 0 && has_value) {
+            opt.height = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--min-time-ms") == 0 && has_value) {
+            opt.min_time = atof(argv[++i]) * 1e-3;
+            min_time_set = true;
+        } else if (strcmp(argv[i], "--filter") == 0 && has_value) {
+            opt.filter = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && has_value) {
+            opt.out = fopen(argv[++i], "w");
+            if (opt.out == NULL) {
+                perror(argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (opt.height < 1 || opt.height > MAX_HEIGHT || opt.min_time <= 0) {
+        return usage(argv[0]);
+    }
+    if (opt.quick && !min_time_set) {
+        opt.min_time = 2e-4;
+    }
+
+    // One set of buffers for all the combinations, big enough for the widest unaligned one
+    const size_t row_len = (size_t)row_stride(MAX_WIDTH, MAX_PX_SIZE, false);
+    const size_t buf_len = (row_len * MAX_HEIGHT + BUF_ALIGN) / BUF_ALIGN * BUF_ALIGN;
+    uint8_t *dest_mem = aligned_alloc(BUF_ALIGN, buf_len);
+    uint8_t *src_mem = aligned_alloc(BUF_ALIGN, buf_len);
+    lv_opa_t *mask_mem = aligned_alloc(BUF_ALIGN, buf_len);
+    if (dest_mem == NULL || src_mem == NULL || mask_mem == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    fill_bytes(dest_mem, buf_len, 0x12345678);
+    fill_bytes(src_mem, buf_len, 0x9abcdef0);
+    fill_mask(mask_mem, buf_len, 0x0badcafe);
+
+    const int *widths = opt.quick ? quick_widths : bench_widths;
+    const size_t width_cnt = opt.quick ? ARRAY_SIZE(quick_widths) : ARRAY_SIZE(bench_widths);
+    bool first = true;
+    char kernel[64];
+
+    print_header(&opt);
+    for (size_t d = 0; d < ARRAY_SIZE(bench_dests); d++) {
+        // The fill first, then the image blend from every source format
+        for (size_t s = 0; s <= bench_dests[d].src_cf_cnt; s++) {
+            bench_case_t bc = {
+                .dest = &bench_dests[d],
+                .image = s > 0,
+                .src_cf = s > 0 ? bench_dests[d].src_cfs[s - 1] : LV_COLOR_FORMAT_UNKNOWN,
+                .height = opt.height,
+            };
+            kernel_name(&bc, kernel, sizeof(kernel));
+            if (!case_matches(&opt, kernel)) {
+                continue;
+            }
+            for (bc.variant = BLEND_NORMAL; bc.variant <= BLEND_MASK_OPA; bc.variant++) {
+                for (int aligned = 1; aligned >= 0; aligned--) {
+                    bc.aligned = aligned;
+                    for (size_t w = 0; w < width_cnt; w++) {
+                        bc.width = widths[w];
+                        const double mpx_s = bench_run(&opt, &bc, dest_mem, src_mem, mask_mem);
+                        print_record(&opt, &bc, kernel, mpx_s, first);
+                        first = false;
+                    }
+                }
+            }
+        }
+    }
+    print_footer(&opt);
+
+    if (opt.out != stdout) {
+        fclose(opt.out);
+    }
+    free(dest_mem);
+    free(src_mem);
+    free(mask_mem);
+    return EXIT_SUCCESS;
+}
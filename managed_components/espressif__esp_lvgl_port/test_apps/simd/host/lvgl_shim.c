@@ -0,0 +1,20 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* The few LVGL runtime functions the blend code calls,
+ * so the host tests do not need to build the whole library. */
+#include <string.h>
+#include "lvgl.h"
+
+void *lv_memcpy(void *dst, const void *src, size_t len)
+{
+    return memcpy(dst, src, len);
+}
+
+void lv_memset(void *dst, uint8_t v, size_t len)
+{
+    memset(dst, v, len);
+}
@@ -0,0 +1,411 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+Functionality tests of the vector blend kernels, host port of ../main/test_lv_fill_functionality.c
+and ../main/test_lv_image_functionality.c
+
+Purpose:
+    - Test that LVGL blending with the hooks of esp_lvgl_port_lv_blend_vec.h achieves the same results as the ANSI version
+
+Procedure:
+    - LVGL's lv_draw_sw_blend_to_rgb565.c is built twice, plain and with the hooks (entry points renamed to *_custom)
+    - Prepare testing matrix, to cover the combinations of destination array widths, heights, strides, memory alignment...
+      for every opa/mask variant of the blending
+    - Run both versions of the LVGL blending API on the same data
+    - Compare the results bit by bit, including the canary pixels around the destination
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lvgl.h"
+#include "lvgl_private.h"
+#include "src/draw/sw/blend/lv_draw_sw_blend_to_rgb565.h"
+#include "esp_lvgl_port_lv_blend_vec.h"
+#include "unity/unity.h"
+
+// ------------------------------------------------- Defines -----------------------------------------------------------
+
+#define CANARY_PIXELS 4
+
+// ------------------------------------------------- Macros and Types --------------------------------------------------
+
+/**
+ * @brief Opacity and mask combinations, each one is a different hook
+ */
+typedef enum {
+    BLEND_NORMAL,
+    BLEND_OPA,
+    BLEND_MASK,
+    BLEND_MASK_OPA,
+} blend_variant_t;
+
+/**
+ * @brief Functionality test combinations
+ */
+typedef struct {
+    int min_w;                  // Minimum width of the test array
+    int max_w;                  // Maximum width of the test array
+    int min_h;                  // Minimum height of the test array
+    int max_h;                  // Maximum height of the test array
+    int max_unalign_byte;       // Maximum amount of unaligned bytes of the test arrays
+    int unalign_step;           // Increment step in bytes unalignment, 2 as LVGL accesses RGB565 arrays as uint16_t
+    int stride_step;            // Increment step of the destination and source strides
+} test_matrix_params_t;
+
+/**
+ * @brief Functionality test case parameters
+ */
+typedef struct {
+    bool image;                         // Image blending, or fill with test_color
+    lv_color_format_t src_cf;           // Source color format of the image
+    blend_variant_t variant;
+    lv_opa_t opa;
+    int dest_w;
+    int dest_h;
+    int dest_stride;                    // Destination stride in pixels
+    int src_stride;                     // Source stride in pixels
+    int unalign_byte;                   // Memory unalignment of all the arrays
+    int combinations;                   // Count of tested combinations
+} test_case_params_t;
+
+void lv_draw_sw_blend_color_to_rgb565_custom(lv_draw_sw_blend_fill_dsc_t *dsc);
+void lv_draw_sw_blend_image_to_rgb565_custom(lv_draw_sw_blend_image_dsc_t *dsc);
+
+static const lv_opa_t test_opas[] = {0, 1, 127, 128, 200, LV_OPA_MAX - 1};
+static const char *const variant_names[] = {"normal", "opa", "mask", "mask+opa"};
+static const lv_color_t test_color = {
+    .blue = 0x56,
+    .green = 0x34,
+    .red = 0x12,
+};
+static char test_msg_buf[160];
+
+// ------------------------------------------------ Static test functions ----------------------------------------------
+
+static uint32_t rand_next(uint32_t *state)
+{
+    // xorshift32, the same sequence on every run
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void fill_px(uint16_t *buf, size_t len, uint32_t seed)
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint16_t)rand_next(&seed);
+    }
+}
+
+// Runs of fully transparent and fully covered pixels, like anti-aliased edges, mixed with random coverage
+static void fill_mask(lv_opa_t *buf, size_t len, uint32_t seed)
+{
+    for (size_t i = 0; i < len; i++) {
+        uint32_t r = rand_next(&seed);
+        switch ((i / 8) % 4) {
+        case 0:
+            buf[i] = LV_OPA_TRANSP;
+            break;
+        case 1:
+            buf[i] = LV_OPA_COVER;
+            break;
+        default:
+            buf[i] = (lv_opa_t)r;
+            break;
+        }
+    }
+}
+
+static void lv_blend_functionality(const test_case_params_t *tc)
+{
+    const int unalign = tc->unalign_byte;
+    const size_t active_len = (size_t)tc->dest_h * tc->dest_stride;
+    const size_t total_len = active_len + CANARY_PIXELS * 2;
+    const int mask_stride = tc->dest_w + 3;
+    const bool use_mask = tc->variant == BLEND_MASK || tc->variant == BLEND_MASK_OPA;
+
+    uint8_t *mem_ansi = malloc(total_len * sizeof(uint16_t) + unalign);
+    uint8_t *mem_vec = malloc(total_len * sizeof(uint16_t) + unalign);
+    uint8_t *mem_src = malloc((size_t)tc->dest_h * tc->src_stride * sizeof(uint16_t) + unalign);
+    uint8_t *mem_mask = malloc((size_t)tc->dest_h * mask_stride + unalign);
+    TEST_ASSERT_NOT_NULL(mem_ansi);
+    TEST_ASSERT_NOT_NULL(mem_vec);
+    TEST_ASSERT_NOT_NULL(mem_src);
+    TEST_ASSERT_NOT_NULL(mem_mask);
+
+    // Zero canary pixels around the same destination data
+    uint16_t *dest_ansi = (uint16_t *)(mem_ansi + unalign);
+    uint16_t *dest_vec = (uint16_t *)(mem_vec + unalign);
+    memset(dest_ansi, 0, total_len * sizeof(uint16_t));
+    fill_px(dest_ansi + CANARY_PIXELS, active_len, 0x12345678);
+    memcpy(dest_vec, dest_ansi, total_len * sizeof(uint16_t));
+
+    uint16_t *src = (uint16_t *)(mem_src + unalign);
+    fill_px(src, (size_t)tc->dest_h * tc->src_stride, 0x9abcdef0);
+    lv_opa_t *mask = mem_mask + unalign;
+    fill_mask(mask, (size_t)tc->dest_h * mask_stride, 0x0badcafe);
+
+    const lv_opa_t opa = (tc->variant == BLEND_OPA || tc->variant == BLEND_MASK_OPA) ? tc->opa : LV_OPA_COVER;
+
+    if (tc->image) {
+        lv_draw_sw_blend_image_dsc_t dsc = {
+            .dest_buf = dest_ansi + CANARY_PIXELS,
+            .dest_w = tc->dest_w,
+            .dest_h = tc->dest_h,
+            .dest_stride = tc->dest_stride * sizeof(uint16_t),
+            .mask_buf = use_mask ? mask : NULL,
+            .mask_stride = mask_stride,
+            .src_buf = src,
+            .src_stride = tc->src_stride * sizeof(uint16_t),
+            .src_color_format = tc->src_cf,
+            .opa = opa,
+            .blend_mode = LV_BLEND_MODE_NORMAL,
+        };
+        lv_draw_sw_blend_image_to_rgb565(&dsc);
+        dsc.dest_buf = dest_vec + CANARY_PIXELS;
+        lv_draw_sw_blend_image_to_rgb565_custom(&dsc);
+    } else {
+        lv_draw_sw_blend_fill_dsc_t dsc = {
+            .dest_buf = dest_ansi + CANARY_PIXELS,
+            .dest_w = tc->dest_w,
+            .dest_h = tc->dest_h,
+            .dest_stride = tc->dest_stride * sizeof(uint16_t),
+            .mask_buf = use_mask ? mask : NULL,
+            .mask_stride = mask_stride,
+            .color = test_color,
+            .opa = opa,
+        };
+        lv_draw_sw_blend_color_to_rgb565(&dsc);
+        dsc.dest_buf = dest_vec + CANARY_PIXELS;
+        lv_draw_sw_blend_color_to_rgb565_custom(&dsc);
+    }
+
+    snprintf(test_msg_buf, sizeof(test_msg_buf),
+             "%s %s, opa = %d, dest_w = %d, dest_h = %d, dest_stride = %d, src_stride = %d, unalign_byte = %d",
+             tc->image ? "image" : "fill", variant_names[tc->variant], opa,
+             tc->dest_w, tc->dest_h, tc->dest_stride, tc->src_stride, unalign);
+
+    // Canary pixels must stay 0
+    for (int i = 0; i < CANARY_PIXELS; i++) {
+        TEST_ASSERT_MESSAGE(dest_vec[i] == 0 && dest_vec[total_len - 1 - i] == 0, test_msg_buf);
+    }
+
+    // dest_vec and dest_ansi must be equal
+    TEST_ASSERT_MESSAGE(memcmp(dest_vec, dest_ansi, total_len * sizeof(uint16_t)) == 0, test_msg_buf);
+
+    free(mem_ansi);
+    free(mem_vec);
+    free(mem_src);
+    free(mem_mask);
+}
+
+static void functionality_test_matrix(const test_matrix_params_t *test_matrix, test_case_params_t *test_case)
+{
+    // Step destination array width
+    for (int dest_w = test_matrix->min_w; dest_w <= test_matrix->max_w; dest_w++) {
+
+        // Step destination array height
+        for (int dest_h = test_matrix->min_h; dest_h <= test_matrix->max_h; dest_h++) {
+
+            // Step destination array stride
+            for (int dest_stride = dest_w; dest_stride <= dest_w * 2; dest_stride += test_matrix->stride_step) {
+
+                // Step source array stride, fills don't have one
+                int max_src_stride = test_case->image ? dest_w * 2 : dest_w;
+                for (int src_stride = dest_w; src_stride <= max_src_stride; src_stride += test_matrix->stride_step) {
+
+                    // Step the arrays' unalignment
+                    for (int unalign_byte = 0; unalign_byte <= test_matrix->max_unalign_byte; unalign_byte += test_matrix->unalign_step) {
+                        test_case->dest_w = dest_w;
+                        test_case->dest_h = dest_h;
+                        test_case->dest_stride = dest_stride;
+                        test_case->src_stride = src_stride;
+                        test_case->unalign_byte = unalign_byte;
+                        lv_blend_functionality(test_case);
+                        test_case->combinations++;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Every variant, with a set of opacities where it is used
+static void functionality_test_variants(const test_matrix_params_t *test_matrix, test_case_params_t *test_case)
+{
+    for (blend_variant_t variant = BLEND_NORMAL; variant <= BLEND_MASK_OPA; variant++) {
+        const bool use_opa = variant == BLEND_OPA || variant == BLEND_MASK_OPA;
+        const size_t opa_cnt = use_opa ? sizeof(test_opas) / sizeof(test_opas[0]) : 1;
+        for (size_t i = 0; i < opa_cnt; i++) {
+            test_case->variant = variant;
+            test_case->opa = test_opas[i];
+            functionality_test_matrix(test_matrix, test_case);
+        }
+    }
+    printf("test combinations: %d\n", test_case->combinations);
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+static void test_fill_functionality_rgb565(void)
+{
+    const test_matrix_params_t test_matrix = {
+        .min_w = 1,             // Widths below, at and above the vector length, with tails of every length
+        .max_w = 40,
+        .min_h = 1,
+        .max_h = 3,
+        .max_unalign_byte = 16,
+        .unalign_step = 2,
+        .stride_step = 1,
+    };
+    test_case_params_t test_case = {
+        .image = false,
+    };
+    functionality_test_variants(&test_matrix, &test_case);
+}
+
+static void test_image_functionality_rgb565(void)
+{
+    const test_matrix_params_t test_matrix = {
+        .min_w = 1,
+        .max_w = 40,
+        .min_h = 1,
+        .max_h = 3,
+        .max_unalign_byte = 16,
+        .unalign_step = 2,
+        .stride_step = 3,
+    };
+    test_case_params_t test_case = {
+        .image = true,
+        .src_cf = LV_COLOR_FORMAT_RGB565,
+    };
+    functionality_test_variants(&test_matrix, &test_case);
+}
+
+// LVGL runs the RGB565 hooks for byte swapped sources too, they must be left to the C code
+static void test_image_functionality_rgb565_swapped(void)
+{
+    const test_matrix_params_t test_matrix = {
+        .min_w = 1,
+        .max_w = 20,
+        .min_h = 1,
+        .max_h = 2,
+        .max_unalign_byte = 4,
+        .unalign_step = 2,
+        .stride_step = 5,
+    };
+    test_case_params_t test_case = {
+        .image = true,
+        .src_cf = LV_COLOR_FORMAT_RGB565_SWAPPED,
+    };
+    functionality_test_variants(&test_matrix, &test_case);
+}
+
+// Every mix value, with the ones lv_color_16_16_mix() returns early for, inside and outside full vectors
+static void test_mix_all_values(void)
+{
+    uint16_t dest_ansi[256];
+    uint16_t dest_vec[256];
+    uint16_t src[256];
+    lv_opa_t mask[256];
+
+    for (uint32_t seed = 1; seed <= 64; seed++) {
+        fill_px(dest_ansi, 256, seed);
+        fill_px(src, 256, ~seed);
+        memcpy(dest_vec, dest_ansi, sizeof(dest_ansi));
+        for (int i = 0; i < 256; i++) {
+            mask[i] = (lv_opa_t)(i + seed);
+        }
+
+        lv_draw_sw_blend_image_dsc_t dsc = {
+            .dest_buf = dest_ansi,
+            .dest_w = 256 - (seed % 8),
+            .dest_h = 1,
+            .dest_stride = sizeof(dest_ansi),
+            .mask_buf = mask,
+            .mask_stride = sizeof(mask),
+            .src_buf = src,
+            .src_stride = sizeof(src),
+            .src_color_format = LV_COLOR_FORMAT_RGB565,
+            .opa = LV_OPA_COVER,
+            .blend_mode = LV_BLEND_MODE_NORMAL,
+        };
+        lv_draw_sw_blend_image_to_rgb565(&dsc);
+        dsc.dest_buf = dest_vec;
+        lv_draw_sw_blend_image_to_rgb565_custom(&dsc);
+        TEST_ASSERT_EQUAL_MEMORY(dest_ansi, dest_vec, sizeof(dest_ansi));
+    }
+}
+
+// The kernels must not fall back to the C code for the formats they are made for
+static void test_kernels_handle_rgb565(void)
+{
+    uint16_t dest[2 * 16] = {0};
+    uint16_t src[2 * 16] = {0};
+    lv_opa_t mask[2 * 16] = {0};
+
+    lv_draw_sw_blend_fill_dsc_t fill_dsc = {
+        .dest_buf = dest,
+        .dest_w = 16,
+        .dest_h = 2,
+        .dest_stride = 16 * sizeof(uint16_t),
+        .mask_buf = mask,
+        .mask_stride = 16,
+        .color = test_color,
+        .opa = LV_OPA_50,
+    };
+    TEST_ASSERT_EQUAL(LV_RESULT_OK, lv_color_blend_to_rgb565_vec(&fill_dsc));
+    TEST_ASSERT_EQUAL(LV_RESULT_OK, lv_color_blend_to_rgb565_with_opa_vec(&fill_dsc));
+    TEST_ASSERT_EQUAL(LV_RESULT_OK, lv_color_blend_to_rgb565_with_mask_vec(&fill_dsc));
+    TEST_ASSERT_EQUAL(LV_RESULT_OK, lv_color_blend_to_rgb565_mix_mask_opa_vec(&fill_dsc));
+
+    lv_draw_sw_blend_image_dsc_t image_dsc = {
+        .dest_buf = dest,
+        .dest_w = 16,
+        .dest_h = 2,
+        .dest_stride = 16 * sizeof(uint16_t),
+        .mask_buf = mask,
+        .mask_stride = 16,
+        .src_buf = src,
+        .src_stride = 16 * sizeof(uint16_t),
+        .src_color_format = LV_COLOR_FORMAT_RGB565,
+        .opa = LV_OPA_50,
+        .blend_mode = LV_BLEND_MODE_NORMAL,
+    };
+    TEST_ASSERT_EQUAL(LV_RESULT_OK, lv_rgb565_blend_normal_to_rgb565_vec(&image_dsc));
+    TEST_ASSERT_EQUAL(LV_RESULT_OK, lv_rgb565_blend_normal_to_rgb565_with_opa_vec(&image_dsc));
+    TEST_ASSERT_EQUAL(LV_RESULT_OK, lv_rgb565_blend_normal_to_rgb565_with_mask_vec(&image_dsc));
+    TEST_ASSERT_EQUAL(LV_RESULT_OK, lv_rgb565_blend_normal_to_rgb565_mix_mask_opa_vec(&image_dsc));
+
+    image_dsc.src_color_format = LV_COLOR_FORMAT_RGB565_SWAPPED;
+    TEST_ASSERT_EQUAL(LV_RESULT_INVALID, lv_rgb565_blend_normal_to_rgb565_vec(&image_dsc));
+    TEST_ASSERT_EQUAL(LV_RESULT_INVALID, lv_rgb565_blend_normal_to_rgb565_with_opa_vec(&image_dsc));
+    TEST_ASSERT_EQUAL(LV_RESULT_INVALID, lv_rgb565_blend_normal_to_rgb565_with_mask_vec(&image_dsc));
+    TEST_ASSERT_EQUAL(LV_RESULT_INVALID, lv_rgb565_blend_normal_to_rgb565_mix_mask_opa_vec(&image_dsc));
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_kernels_handle_rgb565);
+    RUN_TEST(test_mix_all_values);
+    RUN_TEST(test_fill_functionality_rgb565);
+    RUN_TEST(test_image_functionality_rgb565);
+    RUN_TEST(test_image_functionality_rgb565_swapped);
+    return UNITY_END();
+}
@@ -165,6 +165,11 @@
  *  rendering performance but might cause other tasks to starve. */
 #define LV_DRAW_THREAD_PRIO LV_THREAD_PRIO_HIGH
 
+/** Pin the drawing threads to the CPU cores in turn: thread `i` runs on core `i % core count`.
+ *  With `LV_DRAW_SW_DRAW_UNIT_CNT` set to the core count every core renders.
+ *  Only supported with `LV_OS_FREERTOS` on SMP targets (ESP-IDF), ignored otherwise. */
+#define LV_DRAW_THREAD_PIN_CORES 0
+
 #define LV_USE_DRAW_SW 1
 #if LV_USE_DRAW_SW == 1
     /*
@@ -214,6 +219,8 @@
         /** Set number of maximally-cached circle data.
          *  The circumference of 1/4 circle are saved for anti-aliasing.
          *  `radius * 4` bytes are used per circle (the most often used radiuses are saved).
+         *  Up to radius 64 the corners are saved too, `(2 * radius)^2` bytes per circle,
+         *  to fill rounded rectangles without line masks.
          *  - 0: disables caching */
         #define LV_DRAW_SW_CIRCLE_CACHE_SIZE 4
     #endif
@@ -132,7 +132,8 @@ typedef struct _lv_global_t {
     lv_draw_sw_shadow_cache_t sw_shadow_cache;
 #endif
 #if LV_DRAW_SW_COMPLEX
-    lv_draw_sw_mask_radius_circle_dsc_arr_t sw_circle_cache;
+    lv_cache_t * sw_circle_cache;
+    lv_draw_sw_mask_circle_hot_arr_t sw_circle_hot;
 #endif
 
 #if LV_USE_LOG
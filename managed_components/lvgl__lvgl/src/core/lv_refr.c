@@ -36,13 +36,26 @@
  *      TYPEDEFS
  **********************/
 
+/*A tile of the tiled refresh rendered into a slice of the draw buffer*/
+typedef struct {
+    lv_layer_t layer;
+    lv_draw_buf_t draw_buf;
+    lv_area_t area;
+} refr_tile_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 static void lv_refr_join_area(void);
+static void inv_area_join_cheapest(lv_display_t * disp, const lv_area_t * area_p);
+static int64_t get_join_saving(const lv_area_t * a1, const lv_area_t * a2, lv_area_t * joined_area);
+static uint64_t inv_area_union_size(const lv_area_t * areas, uint32_t cnt);
 static void refr_invalid_areas(void);
 static void refr_sync_areas(void);
 static void refr_area(const lv_area_t * area_p, int32_t y_offset);
+static bool refr_area_tiled(const lv_area_t * area_p);
+static void get_tile_area(const lv_area_t * area_p, uint32_t tile_idx, uint32_t col_cnt, lv_area_t * tile_area);
+static void remove_layer(lv_layer_t * layer);
 static void refr_configured_layer(lv_layer_t * layer);
 static lv_obj_t * lv_refr_get_top_obj(const lv_area_t * area_p, lv_obj_t * obj);
 static void refr_obj_and_children(lv_layer_t * layer, lv_obj_t * top_obj);
@@ -50,6 +63,7 @@ static void refr_obj(lv_layer_t * layer, lv_obj_t * obj);
 static uint32_t get_max_row(lv_display_t * disp, int32_t area_w, int32_t area_h);
 static void draw_buf_flush(lv_display_t * disp);
 static void call_flush_cb(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map);
+static void swap_buffers(lv_display_t * disp);
 static void wait_for_flushing(lv_display_t * disp);
 
 /**********************
@@ -303,6 +317,7 @@ void lv_inv_area(lv_display_t * disp, const lv_area_t * area_p)
 
     /*If there were at least 1 invalid area in full refresh mode, redraw the whole screen*/
     if(disp->render_mode == LV_DISPLAY_RENDER_MODE_FULL) {
+        disp->inv_stats.inv_area_cnt++;
         disp->inv_areas[0] = scr_area;
         disp->inv_p = 1;
         lv_display_send_event(disp, LV_EVENT_REFR_REQUEST, NULL);
@@ -318,14 +333,17 @@ void lv_inv_area(lv_display_t * disp, const lv_area_t * area_p)
         if(lv_area_is_in(&com_area, &disp->inv_areas[i], 0) != false) return;
     }
 
-    /*Save the area*/
-    lv_area_t * tmp_area_p = &com_area;
-    if(disp->inv_p >= LV_INV_BUF_SIZE) { /*If no place for the area add the screen*/
-        disp->inv_p = 0;
-        tmp_area_p = &scr_area;
+    disp->inv_stats.inv_area_cnt++;
+
+    /*Save the area. If there is no place for it join the areas which cost the least to join*/
+    if(disp->inv_p >= LV_INV_BUF_SIZE) {
+        inv_area_join_cheapest(disp, &com_area);
+        disp->inv_stats.inv_buf_full_cnt++;
+    }
+    else {
+        lv_area_copy(&disp->inv_areas[disp->inv_p], &com_area);
+        disp->inv_p++;
     }
-    lv_area_copy(&disp->inv_areas[disp->inv_p], tmp_area_p);
-    disp->inv_p++;
 
     lv_display_send_event(disp, LV_EVENT_REFR_REQUEST, NULL);
 }
@@ -398,15 +416,26 @@ void lv_display_refr_timer(lv_timer_t * tmr)
         goto refr_finish;
     }
 
+    /*The pixels to redraw before the areas are joined. Overlapping areas are counted once.*/
+    disp_refr->inv_stats.inv_px += inv_area_union_size(disp_refr->inv_areas, disp_refr->inv_p);
+
     lv_refr_join_area();
     refr_sync_areas();
     refr_invalid_areas();
 
     if(disp_refr->inv_p == 0) goto refr_finish;
+
+    uint32_t i;
+    disp_refr->inv_stats.refr_cnt++;
+    for(i = 0; i < disp_refr->inv_p; i++) {
+        if(disp_refr->inv_area_joined[i]) continue;
+        disp_refr->inv_stats.refr_area_cnt++;
+        disp_refr->inv_stats.refr_px += lv_area_get_size(&disp_refr->inv_areas[i]);
+    }
+
     /*In double buffered direct mode save the updated areas.
      *They will be used on the next call to synchronize the buffers.*/
     if(lv_display_is_double_buffered(disp_refr) && disp_refr->render_mode == LV_DISPLAY_RENDER_MODE_DIRECT) {
-        uint32_t i;
         for(i = 0; i < disp_refr->inv_p; i++) {
             if(disp_refr->inv_area_joined[i])
                 continue;
@@ -437,42 +466,149 @@ refr_finish:
  **********************/
 
 /**
- * Join the areas which has got common parts
+ * Join the invalidated areas if redrawing their bounding box is cheaper than redrawing them one by one.
+ * Always the pair which saves the most is joined first, and the joined area can be joined again.
  */
 static void lv_refr_join_area(void)
 {
     LV_PROFILER_REFR_BEGIN;
-    uint32_t join_from;
+    while(1) {
+        int64_t best_saving = 0;
+        uint32_t best_in = 0;
+        uint32_t best_from = 0;
+        lv_area_t best_area;
+
+        uint32_t join_from;
+        uint32_t join_in;
+        lv_area_t joined_area;
+        for(join_in = 0; join_in < disp_refr->inv_p; join_in++) {
+            if(disp_refr->inv_area_joined[join_in] != 0) continue;
+
+            for(join_from = join_in + 1; join_from < disp_refr->inv_p; join_from++) {
+                if(disp_refr->inv_area_joined[join_from] != 0) continue;
+
+                int64_t saving = get_join_saving(&disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from],
+                                                 &joined_area);
+                if(saving > best_saving) {
+                    best_saving = saving;
+                    best_in = join_in;
+                    best_from = join_from;
+                    best_area = joined_area;
+                }
+            }
+        }
+
+        if(best_saving == 0) break;
+
+        /*Mark 'best_from' as joined into 'best_in'*/
+        lv_area_copy(&disp_refr->inv_areas[best_in], &best_area);
+        disp_refr->inv_area_joined[best_from] = 1;
+    }
+    LV_PROFILER_REFR_END;
+}
+
+/**
+ * Make room for a new invalidated area when the buffer is full.
+ * Join the two areas (including the new one) whose bounding box adds the least extra pixels.
+ * @param disp      pointer to display whose invalidated areas are full
+ * @param area_p    the new area to save
+ */
+static void inv_area_join_cheapest(lv_display_t * disp, const lv_area_t * area_p)
+{
+    /*Index `inv_p` means the new area*/
+    int64_t best_saving = INT64_MIN;
+    uint32_t best_in = 0;
+    uint32_t best_from = 0;
+    lv_area_t best_area;
+
     uint32_t join_in;
+    uint32_t join_from;
     lv_area_t joined_area;
-    for(join_in = 0; join_in < disp_refr->inv_p; join_in++) {
-        if(disp_refr->inv_area_joined[join_in] != 0) continue;
-
-        /*Check all areas to join them in 'join_in'*/
-        for(join_from = 0; join_from < disp_refr->inv_p; join_from++) {
-            /*Handle only unjoined areas and ignore itself*/
-            if(disp_refr->inv_area_joined[join_from] != 0 || join_in == join_from) {
-                continue;
+    for(join_in = 0; join_in < disp->inv_p; join_in++) {
+        for(join_from = join_in + 1; join_from <= disp->inv_p; join_from++) {
+            const lv_area_t * from_p = join_from == disp->inv_p ? area_p : &disp->inv_areas[join_from];
+            int64_t saving = get_join_saving(&disp->inv_areas[join_in], from_p, &joined_area);
+            if(saving > best_saving) {
+                best_saving = saving;
+                best_in = join_in;
+                best_from = join_from;
+                best_area = joined_area;
             }
+        }
+    }
 
-            /*Check if the areas are on each other*/
-            if(lv_area_is_on(&disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from]) == false) {
-                continue;
-            }
+    lv_area_copy(&disp->inv_areas[best_in], &best_area);
+    if(best_from != disp->inv_p) lv_area_copy(&disp->inv_areas[best_from], area_p);
+}
 
-            lv_area_join(&joined_area, &disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from]);
+/**
+ * Tell how much cheaper it is to redraw the bounding box of two areas than to redraw them separately.
+ * Redrawing an area costs its size plus `LV_INV_AREA_COST` for traversing the widgets, setting up and flushing.
+ * @param a1            pointer to an area
+ * @param a2            pointer to an other area
+ * @param joined_area   store the bounding box of the two areas here
+ * @return              the saved cost in pixels, negative if joining costs more
+ */
+static int64_t get_join_saving(const lv_area_t * a1, const lv_area_t * a2, lv_area_t * joined_area)
+{
+    lv_area_join(joined_area, a1, a2);
+    return (int64_t)lv_area_get_size(a1) + lv_area_get_size(a2) + LV_INV_AREA_COST - lv_area_get_size(joined_area);
+}
 
-            /*Join two area only if the joined area size is smaller*/
-            if(lv_area_get_size(&joined_area) < (lv_area_get_size(&disp_refr->inv_areas[join_in]) +
-                                                 lv_area_get_size(&disp_refr->inv_areas[join_from]))) {
-                lv_area_copy(&disp_refr->inv_areas[join_in], &joined_area);
+/**
+ * Get the number of pixels covered by some areas. The pixels covered by more areas are counted once.
+ * @param areas     array of areas
+ * @param cnt       number of areas, at most `LV_INV_BUF_SIZE`
+ * @return          the size of the union of the areas
+ */
+static uint64_t inv_area_union_size(const lv_area_t * areas, uint32_t cnt)
+{
+    /*Sort the left and right edges of the areas. Between two neighboring edges
+     *the areas are vertical stripes, merge their Y ranges there.*/
+    int32_t edges[LV_INV_BUF_SIZE * 2];
+    uint32_t edge_cnt = 0;
+    uint32_t i, j;
+    for(i = 0; i < cnt; i++) {
+        edges[edge_cnt++] = areas[i].x1;
+        edges[edge_cnt++] = areas[i].x2 + 1;
+    }
+    for(i = 1; i < edge_cnt; i++) {
+        int32_t e = edges[i];
+        for(j = i; j > 0 && edges[j - 1] > e; j--) edges[j] = edges[j - 1];
+        edges[j] = e;
+    }
+
+    uint64_t size = 0;
+    for(i = 0; i + 1 < edge_cnt; i++) {
+        int32_t x1 = edges[i];
+        int32_t x2 = edges[i + 1] - 1;
+        if(x1 > x2) continue;
+
+        /*The areas of the stripe sorted by their top*/
+        const lv_area_t * stripe[LV_INV_BUF_SIZE];
+        uint32_t stripe_cnt = 0;
+        for(j = 0; j < cnt; j++) {
+            if(areas[j].x1 > x1 || areas[j].x2 < x2) continue;
+            uint32_t k;
+            for(k = stripe_cnt; k > 0 && stripe[k - 1]->y1 > areas[j].y1; k--) stripe[k] = stripe[k - 1];
+            stripe[k] = &areas[j];
+            stripe_cnt++;
+        }
 
-                /*Mark 'join_form' is joined into 'join_in'*/
-                disp_refr->inv_area_joined[join_from] = 1;
+        int32_t covered_h = 0;
+        int32_t y_next = LV_COORD_MIN;
+        for(j = 0; j < stripe_cnt; j++) {
+            int32_t y1 = LV_MAX(stripe[j]->y1, y_next);
+            if(stripe[j]->y2 >= y1) {
+                covered_h += stripe[j]->y2 - y1 + 1;
+                y_next = stripe[j]->y2 + 1;
             }
         }
+
+        size += (uint64_t)covered_h * (x2 - x1 + 1);
     }
-    LV_PROFILER_REFR_END;
+
+    return size;
 }
 
 /**
@@ -611,6 +747,8 @@ static void refr_invalid_areas(void)
 
         lv_area_t inv_a = disp_refr->inv_areas[i];
         if(disp_refr->render_mode == LV_DISPLAY_RENDER_MODE_PARTIAL) {
+            if(refr_area_tiled(&inv_a)) continue;
+
             /*Calculate the max row num*/
             int32_t w = lv_area_get_width(&inv_a);
             int32_t h = lv_area_get_height(&inv_a);
@@ -726,6 +864,12 @@ static void refr_area(const lv_area_t * area_p, int32_t y_offset)
         tile_h = lv_area_get_height(area_p) / tile_cnt;
     }
 
+    /* In single buffered mode wait here until the buffer is freed.
+     * Else we would draw into the buffer while it's still being transferred to the display*/
+    if(!lv_display_is_double_buffered(disp_refr)) {
+        wait_for_flushing(disp_refr);
+    }
+
     if(tile_cnt == 1) {
         refr_configured_layer(layer);
     }
@@ -766,16 +910,7 @@ static void refr_area(const lv_area_t * area_p, int32_t y_offset)
                 lv_draw_dispatch();
             }
 
-            lv_layer_t * layer_i = disp_refr->layer_head;
-            while(layer_i) {
-                if(layer_i->next == tile_layer) {
-                    layer_i->next = tile_layer->next;
-                    break;
-                }
-                layer_i = layer_i->next;
-            }
-
-            if(disp_refr->layer_deinit) disp_refr->layer_deinit(disp_refr, tile_layer);
+            remove_layer(tile_layer);
         }
         lv_free(tile_layers);
     }
@@ -784,6 +919,140 @@ static void refr_area(const lv_area_t * area_p, int32_t y_offset)
     LV_PROFILER_REFR_END;
 }
 
+/**
+ * Refresh an area in fixed size tiles if it's enabled on the display.
+ * The tiles are rendered in parallel into separate slices of the draw buffer
+ * and each is flushed as soon as it and all the tiles before it are ready.
+ * @param area_p    pointer to an area to refresh
+ * @return          false: tiled refresh is disabled or not possible, the area wasn't refreshed
+ */
+static bool refr_area_tiled(const lv_area_t * area_p)
+{
+    lv_display_t * disp = disp_refr;
+    lv_color_format_t cf = disp->color_format;
+    if(disp->tile_w <= 0 || disp->tile_h <= 0) return false;
+    if(LV_COLOR_FORMAT_IS_INDEXED(cf) || lv_display_get_matrix_rotation(disp)) return false;
+
+    int32_t tile_w = LV_MIN(disp->tile_w, lv_area_get_width(area_p));
+    int32_t tile_h = LV_MIN(disp->tile_h, lv_area_get_height(area_p));
+    uint32_t col_cnt = (lv_area_get_width(area_p) + tile_w - 1) / tile_w;
+    uint32_t row_cnt = (lv_area_get_height(area_p) + tile_h - 1) / tile_h;
+    uint32_t tile_cnt = col_cnt * row_cnt;
+    if(tile_cnt < 2) return false;
+
+    /*Each tile in the buffer needs an aligned slice. Use at least 2 to render while flushing*/
+    uint32_t slice_size = LV_ROUND_UP(lv_draw_buf_width_to_stride(tile_w, cf) * tile_h, LV_DRAW_BUF_ALIGN);
+    uint8_t * buf_data = lv_draw_buf_align(disp->buf_act->data, cf);
+    uint32_t buf_size = disp->buf_act->data_size - (buf_data - disp->buf_act->data);
+    uint32_t slice_cnt = LV_MIN(buf_size / slice_size, tile_cnt);
+    if(slice_cnt < 2) return false;
+
+    /*The tiles need to be on the boundaries required by the display*/
+    uint32_t i;
+    for(i = 0; i < tile_cnt; i++) {
+        lv_area_t tile_area;
+        get_tile_area(area_p, i, col_cnt, &tile_area);
+        lv_area_t rounded_area = tile_area;
+        lv_display_send_event(disp, LV_EVENT_INVALIDATE_AREA, &rounded_area);
+        if(!lv_area_is_equal(&tile_area, &rounded_area)) return false;
+    }
+
+    refr_tile_t * tiles = lv_malloc_zeroed(slice_cnt * sizeof(refr_tile_t));
+    LV_ASSERT_MALLOC(tiles);
+    if(tiles == NULL) return false;
+
+    LV_PROFILER_REFR_BEGIN;
+
+    /*The whole buffer is used by the tiles, so the last flush needs to be finished*/
+    wait_for_flushing(disp);
+
+    uint32_t next_render = 0;
+    uint32_t next_flush = 0;
+    while(next_flush < tile_cnt) {
+        /*Add the draw tasks of the tiles for which there is a free slice*/
+        while(next_render < tile_cnt && next_render - next_flush < slice_cnt) {
+            uint32_t slice = next_render % slice_cnt;
+            refr_tile_t * tile = &tiles[slice];
+
+            /*The previous tile of this slice might be still being flushed*/
+            if(next_render >= slice_cnt && next_render - slice_cnt == next_flush - 1) {
+                wait_for_flushing(disp);
+            }
+
+            /*The tiles at the right edge can be narrower, keep their lines continuous for `flush_cb`*/
+            get_tile_area(area_p, next_render, col_cnt, &tile->area);
+            int32_t w = lv_area_get_width(&tile->area);
+            lv_draw_buf_init(&tile->draw_buf, w, lv_area_get_height(&tile->area), cf,
+                             lv_draw_buf_width_to_stride(w, cf), buf_data + slice * slice_size, slice_size);
+            lv_draw_layer_init(&tile->layer, NULL, cf, &tile->area);
+            tile->layer.draw_buf = &tile->draw_buf;
+            refr_configured_layer(&tile->layer);
+            next_render++;
+        }
+
+        /*Flush the tiles in order. Only one flush can be in progress*/
+        refr_tile_t * tile = &tiles[next_flush % slice_cnt];
+        while(tile->layer.draw_task_head) {
+            lv_draw_dispatch_wait_for_request();
+            lv_draw_dispatch();
+        }
+        remove_layer(&tile->layer);
+
+        wait_for_flushing(disp);
+        disp->last_part = next_flush == tile_cnt - 1;
+        disp->flushing = 1;
+        disp->flushing_last = disp->last_area && disp->last_part;
+        disp->refreshed_area = tile->area;
+        if(disp->flush_cb) {
+            call_flush_cb(disp, &tile->area, tile->draw_buf.data);
+        }
+        next_flush++;
+    }
+
+    /*The last tile might be still being flushed, continue in the other buffer*/
+    if(lv_display_is_double_buffered(disp)) swap_buffers(disp);
+
+    lv_free(tiles);
+    LV_PROFILER_REFR_END;
+    return true;
+}
+
+/**
+ * Get the area of a tile of the tiled refresh
+ * @param area_p        the area which is divided into tiles
+ * @param tile_idx      index of the tile, row by row from the top left corner
+ * @param col_cnt       number of tiles in a row
+ * @param tile_area     store the area of the tile here
+ */
+static void get_tile_area(const lv_area_t * area_p, uint32_t tile_idx, uint32_t col_cnt, lv_area_t * tile_area)
+{
+    int32_t tile_w = LV_MIN(disp_refr->tile_w, lv_area_get_width(area_p));
+    int32_t tile_h = LV_MIN(disp_refr->tile_h, lv_area_get_height(area_p));
+
+    tile_area->x1 = area_p->x1 + (int32_t)(tile_idx % col_cnt) * tile_w;
+    tile_area->y1 = area_p->y1 + (int32_t)(tile_idx / col_cnt) * tile_h;
+    tile_area->x2 = LV_MIN(tile_area->x1 + tile_w - 1, area_p->x2);
+    tile_area->y2 = LV_MIN(tile_area->y1 + tile_h - 1, area_p->y2);
+}
+
+/**
+ * Remove a finished tile layer from the display
+ * @param layer     pointer to a layer created by `lv_draw_layer_init`
+ */
+static void remove_layer(lv_layer_t * layer)
+{
+    lv_layer_t * layer_i = disp_refr->layer_head;
+    while(layer_i) {
+        if(layer_i->next == layer) {
+            layer_i->next = layer->next;
+            break;
+        }
+        layer_i = layer_i->next;
+    }
+
+    if(disp_refr->layer_deinit) disp_refr->layer_deinit(disp_refr, layer);
+}
+
 static void refr_configured_layer(lv_layer_t * layer)
 {
     LV_PROFILER_REFR_BEGIN;
@@ -848,11 +1117,6 @@ static void refr_configured_layer(lv_layer_t * layer)
     }
 #endif /* LV_DRAW_TRANSFORM_USE_MATRIX */
 
-    /* In single buffered mode wait here until the buffer is freed.
-     * Else we would draw into the buffer while it's still being transferred to the display*/
-    if(!lv_display_is_double_buffered(disp_refr)) {
-        wait_for_flushing(disp_refr);
-    }
     /*If the screen is transparent initialize it when the flushing is ready*/
     if(lv_color_format_has_alpha(disp_refr->color_format)) {
         lv_area_t clear_area = layer->_clip_area;
@@ -1374,15 +1638,20 @@ static void draw_buf_flush(lv_display_t * disp)
     }
     /*If there are 2 buffers swap them. With direct mode swap only on the last area*/
     if(lv_display_is_double_buffered(disp) && (disp->render_mode != LV_DISPLAY_RENDER_MODE_DIRECT || flushing_last)) {
-        if(disp->buf_act == disp->buf_1) {
-            disp->buf_act = disp->buf_2;
-        }
-        else if(disp->buf_act == disp->buf_2) {
-            disp->buf_act = disp->buf_3 ? disp->buf_3 : disp->buf_1;
-        }
-        else {
-            disp->buf_act = disp->buf_1;
-        }
+        swap_buffers(disp);
+    }
+}
+
+static void swap_buffers(lv_display_t * disp)
+{
+    if(disp->buf_act == disp->buf_1) {
+        disp->buf_act = disp->buf_2;
+    }
+    else if(disp->buf_act == disp->buf_2) {
+        disp->buf_act = disp->buf_3 ? disp->buf_3 : disp->buf_1;
+    }
+    else {
+        disp->buf_act = disp->buf_1;
     }
 }
 
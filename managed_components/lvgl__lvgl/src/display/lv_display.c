@@ -590,6 +590,36 @@ uint32_t lv_display_get_tile_cnt(lv_display_t * disp)
     return disp->tile_cnt;
 }
 
+void lv_display_set_tile_size(lv_display_t * disp, int32_t w, int32_t h)
+{
+    if(disp == NULL) disp = lv_display_get_default();
+    if(disp == NULL) return;
+
+    if(w <= 0 || h <= 0) {
+        w = 0;
+        h = 0;
+    }
+
+    disp->tile_w = w;
+    disp->tile_h = h;
+}
+
+int32_t lv_display_get_tile_width(lv_display_t * disp)
+{
+    if(disp == NULL) disp = lv_display_get_default();
+    if(disp == NULL) return 0;
+
+    return disp->tile_w;
+}
+
+int32_t lv_display_get_tile_height(lv_display_t * disp)
+{
+    if(disp == NULL) disp = lv_display_get_default();
+    if(disp == NULL) return 0;
+
+    return disp->tile_h;
+}
+
 void lv_display_set_antialiasing(lv_display_t * disp, bool en)
 {
     if(disp == NULL) disp = lv_display_get_default();
@@ -1024,6 +1054,29 @@ bool lv_display_is_invalidation_enabled(lv_display_t * disp)
     return (disp->inv_en_cnt > 0);
 }
 
+void lv_display_get_inv_stats(lv_display_t * disp, lv_display_inv_stats_t * stats)
+{
+    if(!disp) disp = lv_display_get_default();
+    if(!disp) {
+        LV_LOG_WARN("no display registered");
+        lv_memzero(stats, sizeof(lv_display_inv_stats_t));
+        return;
+    }
+
+    *stats = disp->inv_stats;
+}
+
+void lv_display_reset_inv_stats(lv_display_t * disp)
+{
+    if(!disp) disp = lv_display_get_default();
+    if(!disp) {
+        LV_LOG_WARN("no display registered");
+        return;
+    }
+
+    lv_memzero(&disp->inv_stats, sizeof(lv_display_inv_stats_t));
+}
+
 lv_timer_t * lv_display_get_refr_timer(lv_display_t * disp)
 {
     if(!disp) disp = lv_display_get_default();
@@ -78,6 +78,18 @@ typedef enum {
     LV_SCR_LOAD_ANIM_OUT_BOTTOM,
 } lv_screen_load_anim_t;
 
+/** Counters of the invalidated and redrawn areas.
+ * `refr_px / inv_px` is the overdraw ratio: 1 when exactly the invalidated pixels were redrawn,
+ * more when the joined areas or overlapping redrawn areas covered other pixels too */
+typedef struct {
+    uint32_t refr_cnt;          /**< Number of refreshes which redrew something */
+    uint32_t inv_area_cnt;      /**< Number of the invalidated areas */
+    uint32_t refr_area_cnt;     /**< Number of the redrawn areas after joining the invalidated ones */
+    uint32_t inv_buf_full_cnt;  /**< Number of times two areas were joined to make room for a new one */
+    uint64_t inv_px;            /**< Pixels of the invalidated areas as stored before joining them, overlaps counted once */
+    uint64_t refr_px;           /**< Sum of the sizes of the redrawn areas, overlaps counted each time */
+} lv_display_inv_stats_t;
+
 typedef void (*lv_display_flush_cb_t)(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map);
 typedef void (*lv_display_flush_wait_cb_t)(lv_display_t * disp);
 
@@ -357,6 +369,31 @@ void lv_display_set_tile_cnt(lv_display_t * disp, uint32_t tile_cnt);
  */
 uint32_t lv_display_get_tile_cnt(lv_display_t * disp);
 
+/**
+ * Render the invalidated areas in fixed size tiles instead of horizontal stripes.
+ * The tiles are rendered in parallel into separate slices of the draw buffer
+ * and each tile is flushed as soon as it and the tiles before it are ready.
+ * Works only in `LV_DISPLAY_RENDER_MODE_PARTIAL`, the draw buffer needs to hold at least two tiles.
+ * @param disp              pointer to a display
+ * @param w                 width of the tiles, 0: disable tiled refresh
+ * @param h                 height of the tiles, 0: disable tiled refresh
+ */
+void lv_display_set_tile_size(lv_display_t * disp, int32_t w, int32_t h);
+
+/**
+ * Get the width of the tiles used in tiled refresh
+ * @param disp              pointer to a display
+ * @return                  width of the tiles, 0 if tiled refresh is disabled
+ */
+int32_t lv_display_get_tile_width(lv_display_t * disp);
+
+/**
+ * Get the height of the tiles used in tiled refresh
+ * @param disp              pointer to a display
+ * @return                  height of the tiles, 0 if tiled refresh is disabled
+ */
+int32_t lv_display_get_tile_height(lv_display_t * disp);
+
 /**
  * Enable anti-aliasing for the render engine
  * @param disp      pointer to a display
@@ -573,6 +610,20 @@ void lv_display_enable_invalidation(lv_display_t * disp, bool en);
  */
 bool lv_display_is_invalidation_enabled(lv_display_t * disp);
 
+/**
+ * Get how many areas and pixels were invalidated and how many were redrawn
+ * since the display was created or the counters were reset.
+ * @param disp      pointer to a display (NULL to use the default display)
+ * @param stats     store the counters here
+ */
+void lv_display_get_inv_stats(lv_display_t * disp, lv_display_inv_stats_t * stats);
+
+/**
+ * Reset the counters of the invalidated and redrawn areas
+ * @param disp      pointer to a display (NULL to use the default display)
+ */
+void lv_display_reset_inv_stats(lv_display_t * disp);
+
 /**
  * Get a pointer to the screen refresher timer to
  * modify its parameters with `lv_timer_...` functions.
@@ -29,6 +29,10 @@ extern "C" {
 #define LV_INV_BUF_SIZE 32 /**< Buffer size for invalid areas */
 #endif
 
+#ifndef LV_INV_AREA_COST
+#define LV_INV_AREA_COST 4096 /**< Overhead of redrawing one more area in pixels. Used to decide which areas to join */
+#endif
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -93,6 +97,8 @@ struct _lv_display_t {
     lv_display_render_mode_t render_mode;
     uint32_t antialiasing : 1;       /**< 1: anti-aliasing is enabled on this display.*/
     uint32_t tile_cnt     : 8;       /**< Divide the display buffer into these number of tiles */
+    int32_t tile_w;                  /**< Width of the tiles in tiled refresh, 0: disabled */
+    int32_t tile_h;                  /**< Height of the tiles in tiled refresh, 0: disabled */
     uint32_t stride_is_auto : 1;     /**< 1: The stride of the buffers was not set explicitly. */
 
 
@@ -106,6 +112,7 @@ struct _lv_display_t {
     uint8_t inv_area_joined[LV_INV_BUF_SIZE];
     uint32_t inv_p;
     int32_t inv_en_cnt;
+    lv_display_inv_stats_t inv_stats;
 
     /** Double buffer sync areas (redrawn during last refresh) */
     lv_ll_t sync_areas;
@@ -27,14 +27,61 @@
  *********************/
 #define _draw_info LV_GLOBAL_DEFAULT()->draw_info
 
+/*Size of the cells of the task index in pixels*/
+#define TASK_INDEX_CELL_SIZE        64
+
+/*Draw tasks touching more cells are listed only once, among the large tasks of the index*/
+#define TASK_INDEX_LARGE_CELL_CNT   16
+
+/*Link only this many draw tasks ahead of the removed ones. The cells of the index hold only the
+ *linked tasks, so this limits how many older tasks a new one is compared with.*/
+#define TASK_LINK_AHEAD             128
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+/*Draw tasks listed in a cell of the task index from the oldest to the newest*/
+typedef struct {
+    lv_draw_task_t ** tasks;
+    uint32_t start;             /*The oldest tasks are removed here without moving the others*/
+    uint32_t end;
+    uint32_t size;
+} task_bucket_t;
+
+/*Uniform grid over the buffer of a layer. A cell lists the linked, not yet removed draw tasks
+ *touching it, so a new draw task needs to be compared only with the draw tasks around it.*/
+typedef struct _lv_draw_task_index_t {
+    int32_t x_ofs;
+    int32_t y_ofs;
+    int32_t col_cnt;
+    int32_t row_cnt;
+    uint32_t seq;               /*`index_seq` of the next linked draw task*/
+    task_bucket_t large;
+    task_bucket_t * cells;
+} task_index_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 static bool is_independent(lv_layer_t * layer, lv_draw_task_t * t_check);
+static inline bool track_dependencies(void);
+static void link_new_tasks(lv_layer_t * layer);
+static void link_task(lv_layer_t * layer, lv_draw_task_t * t);
+static void link_bucket(task_bucket_t * bucket, lv_draw_task_t * t, uint32_t * min_seq);
+static bool add_dependency(lv_draw_task_t * t_old, lv_draw_task_t * t);
+static void task_index_create(lv_layer_t * layer);
+static void task_index_delete(lv_layer_t * layer);
+static void task_index_get_cells(const task_index_t * index, const lv_area_t * area, lv_area_t * cells);
+static inline bool task_index_is_large(const lv_area_t * cells);
+static bool task_index_add(task_index_t * index, lv_draw_task_t * t);
+static void task_index_remove(task_index_t * index, lv_draw_task_t * t);
+static bool task_bucket_add(task_bucket_t * bucket, lv_draw_task_t * t);
+static void task_bucket_remove(task_bucket_t * bucket, lv_draw_task_t * t);
+static void release_task(lv_draw_task_t * t);
+static void ready_queue_add(lv_layer_t * layer, lv_draw_task_t * t);
+static void ready_queue_remove(lv_layer_t * layer, lv_draw_task_t * t);
+static lv_draw_task_t * ready_queue_take(lv_layer_t * layer, uint8_t draw_unit_id);
 static void cleanup_task(lv_draw_task_t * t, lv_display_t * disp);
 static inline size_t get_draw_dsc_size(lv_draw_task_type_t type);
 static lv_draw_task_t * get_first_available_task(lv_layer_t * layer);
@@ -63,6 +110,7 @@ void lv_draw_init(void)
 #if LV_USE_OS
     lv_thread_sync_init(&_draw_info.sync);
 #endif
+    lv_mutex_init(&_draw_info.task_lock);
 }
 
 void lv_draw_deinit(void)
@@ -70,6 +118,7 @@ void lv_draw_deinit(void)
 #if LV_USE_OS
     lv_thread_sync_delete(&_draw_info.sync);
 #endif
+    lv_mutex_delete(&_draw_info.task_lock);
 
     lv_draw_unit_t * u = _draw_info.unit_head;
     while(u) {
@@ -114,16 +163,14 @@ lv_draw_task_t * lv_draw_add_task(lv_layer_t * layer, const lv_area_t * coords,
     new_task->draw_dsc = (uint8_t *)new_task + LV_ALIGN_UP(sizeof(lv_draw_task_t), 8);
     new_task->state = LV_DRAW_TASK_STATE_QUEUED;
 
-    /*Find the tail*/
-    if(layer->draw_task_head == NULL) {
+    /*Append to the end*/
+    if(layer->draw_task_tail == NULL) {
         layer->draw_task_head = new_task;
     }
     else {
-        lv_draw_task_t * tail = layer->draw_task_head;
-        while(tail->next) tail = tail->next;
-
-        tail->next = new_task;
+        layer->draw_task_tail->next = new_task;
     }
+    layer->draw_task_tail = new_task;
 
     LV_PROFILER_DRAW_END;
     return new_task;
@@ -238,9 +285,24 @@ bool lv_draw_dispatch_layer(lv_display_t * disp, lv_layer_t * layer)
     lv_draw_task_t * t = layer->draw_task_head;
     lv_draw_task_t * t_next;
     bool remove_task = false;
+    bool locked = false;
     while(t) {
         t_next = t->next;
         if(t->state == LV_DRAW_TASK_STATE_READY) {
+            if(t->linked) {
+                /*Take the lock only once for all the finished tasks*/
+                if(!locked) {
+                    lv_mutex_lock(&_draw_info.task_lock);
+                    locked = true;
+                }
+                /*Draw units which don't call `lv_draw_task_finish` only set the state*/
+                release_task(t);
+                if(t->in_ready_queue) ready_queue_remove(layer, t);
+                if(layer->task_index) task_index_remove(layer->task_index, t);
+            }
+            if(t->linked) layer->linked_cnt--;
+            if(layer->last_linked == t) layer->last_linked = t_prev;
+            if(layer->draw_task_tail == t) layer->draw_task_tail = t_prev;
             cleanup_task(t, disp);
             remove_task = true;
             if(t_prev != NULL)
@@ -254,6 +316,21 @@ bool lv_draw_dispatch_layer(lv_display_t * disp, lv_layer_t * layer)
         t = t_next;
     }
 
+    /*All the older tasks are finished, so the dependencies which couldn't be registered are met too*/
+    t = layer->draw_task_head;
+    if(t && t->wait_for_older) {
+        if(!locked) {
+            lv_mutex_lock(&_draw_info.task_lock);
+            locked = true;
+        }
+        t->wait_for_older = false;
+        if(t->dep_cnt == 0 && t->state == LV_DRAW_TASK_STATE_QUEUED) ready_queue_add(layer, t);
+    }
+
+    if(locked) lv_mutex_unlock(&_draw_info.task_lock);
+
+    if(layer->draw_task_head == NULL && layer->task_index) task_index_delete(layer);
+
     bool task_dispatched = false;
 
     /*This layer is ready, enable blending its buffer*/
@@ -264,7 +341,12 @@ bool lv_draw_dispatch_layer(lv_display_t * disp, lv_layer_t * layer)
             if(t_src->type == LV_DRAW_TASK_TYPE_LAYER && t_src->state == LV_DRAW_TASK_STATE_WAITING) {
                 lv_draw_image_dsc_t * draw_dsc = t_src->draw_dsc;
                 if(draw_dsc->src == layer) {
+                    lv_mutex_lock(&_draw_info.task_lock);
                     t_src->state = LV_DRAW_TASK_STATE_QUEUED;
+                    if(t_src->linked && t_src->dep_cnt == 0 && !t_src->wait_for_older) {
+                        ready_queue_add(layer->parent, t_src);
+                    }
+                    lv_mutex_unlock(&_draw_info.task_lock);
                     lv_draw_dispatch_request();
                     break;
                 }
@@ -274,6 +356,8 @@ bool lv_draw_dispatch_layer(lv_display_t * disp, lv_layer_t * layer)
     }
     /*Assign draw tasks to the draw_units*/
     else if(remove_task || layer->draw_task_head) {
+        if(track_dependencies()) link_new_tasks(layer);
+
         /*Find a draw unit which is not busy and can take at least one task*/
         /*Let all draw units to pick draw tasks*/
         lv_draw_unit_t * u = _draw_info.unit_head;
@@ -352,7 +436,7 @@ lv_draw_task_t * lv_draw_get_next_available_task(lv_layer_t * layer, lv_draw_tas
         /*Find a queued and independent task*/
         if(t->state == LV_DRAW_TASK_STATE_QUEUED &&
            (t->preferred_draw_unit_id == LV_DRAW_UNIT_NONE || t->preferred_draw_unit_id == draw_unit_id) &&
-           is_independent(layer, t)) {
+           (t->linked && !t->wait_for_older ? t->dep_cnt == 0 : is_independent(layer, t))) {
             LV_PROFILER_DRAW_END;
             return t;
         }
@@ -363,6 +447,42 @@ lv_draw_task_t * lv_draw_get_next_available_task(lv_layer_t * layer, lv_draw_tas
     return NULL;
 }
 
+void lv_draw_lock_tasks(void)
+{
+    lv_mutex_lock(&_draw_info.task_lock);
+}
+
+void lv_draw_unlock_tasks(void)
+{
+    lv_mutex_unlock(&_draw_info.task_lock);
+}
+
+lv_draw_task_t * lv_draw_take_ready_task(lv_layer_t * layer, uint8_t draw_unit_id)
+{
+    return ready_queue_take(layer, draw_unit_id);
+}
+
+uint32_t lv_draw_task_finish(lv_draw_task_t * t, uint8_t draw_unit_id, lv_draw_task_t ** taken, uint32_t take_max)
+{
+    LV_PROFILER_DRAW_BEGIN;
+    /*The layer can be freed as soon as `t` is ready, so use it only before that*/
+    lv_layer_t * layer = t->target_layer;
+    uint32_t taken_cnt = 0;
+
+    release_task(t);
+    while(taken_cnt < take_max) {
+        lv_draw_task_t * t_ready = ready_queue_take(layer, draw_unit_id);
+        if(t_ready == NULL) break;
+        taken[taken_cnt] = t_ready;
+        taken_cnt++;
+    }
+
+    t->state = LV_DRAW_TASK_STATE_READY;
+
+    LV_PROFILER_DRAW_END;
+    return taken_cnt;
+}
+
 uint32_t lv_draw_get_dependent_count(lv_draw_task_t * t_check)
 {
     if(t_check == NULL) return 0;
@@ -371,6 +491,15 @@ uint32_t lv_draw_get_dependent_count(lv_draw_task_t * t_check)
     LV_PROFILER_DRAW_BEGIN;
     uint32_t cnt = 0;
 
+    /*The dependents are already collected while dispatching*/
+    if(t_check->linked) {
+        lv_mutex_lock(&_draw_info.task_lock);
+        cnt = t_check->released ? 0 : t_check->dependent_cnt;
+        lv_mutex_unlock(&_draw_info.task_lock);
+        LV_PROFILER_DRAW_END;
+        return cnt;
+    }
+
     lv_draw_task_t * t = t_check->next;
     while(t) {
         if((t->state == LV_DRAW_TASK_STATE_QUEUED || t->state == LV_DRAW_TASK_STATE_WAITING) &&
@@ -543,6 +672,368 @@ static bool is_independent(lv_layer_t * layer, lv_draw_task_t * t_check)
     return true;
 }
 
+/**
+ * Tell if the dependencies of the draw tasks need to be collected.
+ * A single draw unit without OS consumes the tasks in order and never looks at them.
+ * @return      true: collect the dependencies in `lv_draw_dispatch_layer`
+ */
+static inline bool track_dependencies(void)
+{
+    return LV_USE_OS || _draw_info.unit_cnt > 1;
+}
+
+/**
+ * Collect the dependencies of the draw tasks added since the last dispatch,
+ * but keep at most `TASK_LINK_AHEAD` linked tasks which are not removed yet.
+ * The rest is linked in the next dispatches as the older tasks are removed.
+ * @param layer     the layer whose new draw tasks should be linked
+ */
+static void link_new_tasks(lv_layer_t * layer)
+{
+    lv_draw_task_t * t = layer->last_linked ? layer->last_linked->next : layer->draw_task_head;
+    if(t == NULL || layer->linked_cnt >= TASK_LINK_AHEAD) return;
+
+    LV_PROFILER_DRAW_BEGIN;
+    lv_mutex_lock(&_draw_info.task_lock);
+    /*The index can be (re)built only when no linked tasks are left*/
+    if(layer->task_index == NULL && layer->last_linked == NULL) task_index_create(layer);
+    while(t && layer->linked_cnt < TASK_LINK_AHEAD) {
+        link_task(layer, t);
+        layer->linked_cnt++;
+        layer->last_linked = t;
+        t = t->next;
+    }
+    lv_mutex_unlock(&_draw_info.task_lock);
+    LV_PROFILER_DRAW_END;
+}
+
+/**
+ * Register `t` as a dependent of each older, not finished task overlapping it.
+ * If there is no such task `t` goes to the ready queue right away.
+ * Needs `task_lock`.
+ * @param layer     the layer of `t`
+ * @param t         the draw task to link
+ */
+static void link_task(lv_layer_t * layer, lv_draw_task_t * t)
+{
+    task_index_t * index = layer->task_index;
+    if(index) {
+        /*Check only the tasks listed in the cells touched by `t`*/
+        lv_area_t cells;
+        task_index_get_cells(index, &t->_real_area, &cells);
+
+        uint32_t min_seq = 0;
+        link_bucket(&index->large, t, &min_seq);
+
+        int32_t row;
+        int32_t col;
+        for(row = cells.y1; row <= cells.y2; row++) {
+            task_bucket_t * bucket = &index->cells[row * index->col_cnt];
+            for(col = cells.x1; col <= cells.x2; col++) {
+                link_bucket(&bucket[col], t, &min_seq);
+            }
+        }
+
+        /*Without the index the newer tasks would miss `t`, so compare all tasks from now on*/
+        if(!task_index_add(index, t)) task_index_delete(layer);
+    }
+    else {
+        lv_draw_task_t * t_old = layer->draw_task_head;
+        while(t_old != t) {
+            if(!t_old->released && t_old->state != LV_DRAW_TASK_STATE_READY &&
+               lv_area_is_on(&t_old->_real_area, &t->_real_area)) {
+                add_dependency(t_old, t);
+            }
+            t_old = t_old->next;
+        }
+    }
+
+    t->linked = true;
+    if(t->dep_cnt == 0 && !t->wait_for_older && t->state == LV_DRAW_TASK_STATE_QUEUED) ready_queue_add(layer, t);
+}
+
+/**
+ * Register `t` as a dependent of the not finished tasks of a bucket which overlap it.
+ * Needs `task_lock`.
+ * @param bucket    a bucket of the task index
+ * @param t         the draw task to link
+ * @param min_seq   the tasks older than this can be skipped. Updated if a task covering `t` is found.
+ */
+static void link_bucket(task_bucket_t * bucket, lv_draw_task_t * t, uint32_t * min_seq)
+{
+    uint32_t i = bucket->end;
+    while(i > bucket->start) {
+        i--;
+        lv_draw_task_t * t_old = bucket->tasks[i];
+        if(t_old->index_seq < *min_seq) break;
+        if(t_old->released || t_old->state == LV_DRAW_TASK_STATE_READY) continue;
+        if(!lv_area_is_on(&t_old->_real_area, &t->_real_area)) continue;
+
+        /*Listed in other cells too, but it's enough to wait for it once*/
+        if(t_old->dependent_cnt && t_old->dependents[t_old->dependent_cnt - 1] == t) continue;
+
+        if(!add_dependency(t_old, t)) continue;
+
+        /*Each older task overlapping `t` overlaps `t_old` too and `t_old` already waits for them*/
+        if(lv_area_is_in(&t->_real_area, &t_old->_real_area, 0)) {
+            *min_seq = LV_MAX(*min_seq, t_old->index_seq);
+        }
+    }
+}
+
+/**
+ * Make `t` wait for `t_old`. Needs `task_lock`.
+ * If there is not enough memory `t` waits for all the older tasks instead.
+ * @param t_old     an older, not finished draw task
+ * @param t         the newer draw task overlapping `t_old`
+ * @return          false: out of memory, the dependency is not registered
+ */
+static bool add_dependency(lv_draw_task_t * t_old, lv_draw_task_t * t)
+{
+    if(t_old->dependent_cnt == t_old->dependent_size) {
+        uint32_t new_size = t_old->dependent_size ? t_old->dependent_size * 2 : 4;
+        lv_draw_task_t ** new_dependents = lv_realloc(t_old->dependents, new_size * sizeof(lv_draw_task_t *));
+        LV_ASSERT_MALLOC(new_dependents);
+        if(new_dependents == NULL) {
+            /*Unblocked when it becomes the first task of the layer, see `lv_draw_dispatch_layer`*/
+            t->wait_for_older = true;
+            return false;
+        }
+        t_old->dependents = new_dependents;
+        t_old->dependent_size = new_size;
+    }
+    t_old->dependents[t_old->dependent_cnt] = t;
+    t_old->dependent_cnt++;
+    t->dep_cnt++;
+    return true;
+}
+
+/**
+ * Create an empty task index covering the buffer of a layer.
+ * If there is not enough memory the layer remains without index.
+ * @param layer     pointer to a layer without linked draw tasks
+ */
+static void task_index_create(lv_layer_t * layer)
+{
+    int32_t col_cnt = (lv_area_get_width(&layer->buf_area) + TASK_INDEX_CELL_SIZE - 1) / TASK_INDEX_CELL_SIZE;
+    int32_t row_cnt = (lv_area_get_height(&layer->buf_area) + TASK_INDEX_CELL_SIZE - 1) / TASK_INDEX_CELL_SIZE;
+    col_cnt = LV_MAX(col_cnt, 1);
+    row_cnt = LV_MAX(row_cnt, 1);
+
+    task_index_t * index = lv_malloc_zeroed(sizeof(task_index_t) + col_cnt * row_cnt * sizeof(task_bucket_t));
+    LV_ASSERT_MALLOC(index);
+    if(index == NULL) return;
+
+    index->x_ofs = layer->buf_area.x1;
+    index->y_ofs = layer->buf_area.y1;
+    index->col_cnt = col_cnt;
+    index->row_cnt = row_cnt;
+    index->cells = (task_bucket_t *)(index + 1);
+    layer->task_index = index;
+}
+
+/**
+ * Free the task index of a layer
+ * @param layer     pointer to a layer with task index
+ */
+static void task_index_delete(lv_layer_t * layer)
+{
+    task_index_t * index = layer->task_index;
+    int32_t i;
+    for(i = 0; i < index->col_cnt * index->row_cnt; i++) {
+        lv_free(index->cells[i].tasks);
+    }
+    lv_free(index->large.tasks);
+    lv_free(index);
+    layer->task_index = NULL;
+}
+
+/**
+ * Get the range of cells touched by an area. Areas out of the layer's buffer are clamped to the border cells.
+ * @param index     pointer to a task index
+ * @param area      the area to check
+ * @param cells     store the first and last column in `x1`/`x2` and the first and last row in `y1`/`y2`
+ */
+static void task_index_get_cells(const task_index_t * index, const lv_area_t * area, lv_area_t * cells)
+{
+    cells->x1 = LV_CLAMP(0, (area->x1 - index->x_ofs) / TASK_INDEX_CELL_SIZE, index->col_cnt - 1);
+    cells->x2 = LV_CLAMP(0, (area->x2 - index->x_ofs) / TASK_INDEX_CELL_SIZE, index->col_cnt - 1);
+    cells->y1 = LV_CLAMP(0, (area->y1 - index->y_ofs) / TASK_INDEX_CELL_SIZE, index->row_cnt - 1);
+    cells->y2 = LV_CLAMP(0, (area->y2 - index->y_ofs) / TASK_INDEX_CELL_SIZE, index->row_cnt - 1);
+}
+
+static inline bool task_index_is_large(const lv_area_t * cells)
+{
+    return lv_area_get_size(cells) > TASK_INDEX_LARGE_CELL_CNT;
+}
+
+/**
+ * List a newly linked draw task in the cells it touches. Needs `task_lock`.
+ * @param index     pointer to a task index
+ * @param t         the draw task to add
+ * @return          false: out of memory, `t` is not listed in every cell
+ */
+static bool task_index_add(task_index_t * index, lv_draw_task_t * t)
+{
+    task_index_get_cells(index, &t->_real_area, &t->index_cells);
+    t->index_seq = index->seq;
+    index->seq++;
+
+    if(task_index_is_large(&t->index_cells)) return task_bucket_add(&index->large, t);
+
+    int32_t row;
+    int32_t col;
+    for(row = t->index_cells.y1; row <= t->index_cells.y2; row++) {
+        task_bucket_t * bucket = &index->cells[row * index->col_cnt];
+        for(col = t->index_cells.x1; col <= t->index_cells.x2; col++) {
+            if(!task_bucket_add(&bucket[col], t)) return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Remove a draw task from the cells it's listed in. Needs `task_lock`.
+ * @param index     pointer to a task index
+ * @param t         the draw task to remove
+ */
+static void task_index_remove(task_index_t * index, lv_draw_task_t * t)
+{
+    if(task_index_is_large(&t->index_cells)) {
+        task_bucket_remove(&index->large, t);
+        return;
+    }
+
+    int32_t row;
+    int32_t col;
+    for(row = t->index_cells.y1; row <= t->index_cells.y2; row++) {
+        task_bucket_t * bucket = &index->cells[row * index->col_cnt];
+        for(col = t->index_cells.x1; col <= t->index_cells.x2; col++) {
+            task_bucket_remove(&bucket[col], t);
+        }
+    }
+}
+
+static bool task_bucket_add(task_bucket_t * bucket, lv_draw_task_t * t)
+{
+    if(bucket->end == bucket->size) {
+        if(bucket->start > 0) {
+            uint32_t cnt = bucket->end - bucket->start;
+            lv_memmove(bucket->tasks, &bucket->tasks[bucket->start], cnt * sizeof(lv_draw_task_t *));
+            bucket->start = 0;
+            bucket->end = cnt;
+        }
+        else {
+            uint32_t new_size = bucket->size ? bucket->size * 2 : 8;
+            lv_draw_task_t ** new_tasks = lv_realloc(bucket->tasks, new_size * sizeof(lv_draw_task_t *));
+            LV_ASSERT_MALLOC(new_tasks);
+            if(new_tasks == NULL) return false;
+            bucket->tasks = new_tasks;
+            bucket->size = new_size;
+        }
+    }
+    bucket->tasks[bucket->end] = t;
+    bucket->end++;
+    return true;
+}
+
+static void task_bucket_remove(task_bucket_t * bucket, lv_draw_task_t * t)
+{
+    /*Mostly the oldest tasks finish first, so search from the beginning and keep the order*/
+    uint32_t i;
+    for(i = bucket->start; i < bucket->end; i++) {
+        if(bucket->tasks[i] == t) break;
+    }
+    if(i == bucket->end) return;
+
+    if(i == bucket->start) {
+        bucket->start++;
+    }
+    else {
+        lv_memmove(&bucket->tasks[i], &bucket->tasks[i + 1], (bucket->end - i - 1) * sizeof(lv_draw_task_t *));
+        bucket->end--;
+    }
+
+    if(bucket->start == bucket->end) {
+        bucket->start = 0;
+        bucket->end = 0;
+    }
+}
+
+/**
+ * Notify the dependents of a finished draw task and queue the ones which became ready.
+ * Needs `task_lock`.
+ * @param t     the finished draw task
+ */
+static void release_task(lv_draw_task_t * t)
+{
+    if(t->released) return;
+    t->released = true;
+
+    uint32_t i;
+    for(i = 0; i < t->dependent_cnt; i++) {
+        lv_draw_task_t * t_dep = t->dependents[i];
+        t_dep->dep_cnt--;
+        if(t_dep->dep_cnt == 0 && !t_dep->wait_for_older && t_dep->state == LV_DRAW_TASK_STATE_QUEUED) {
+            ready_queue_add(t_dep->target_layer, t_dep);
+        }
+    }
+}
+
+/**
+ * Append a draw task to the ready queue of a layer. Needs `task_lock`.
+ * @param layer     the layer of `t`
+ * @param t         a draw task without unfinished dependencies
+ */
+static void ready_queue_add(lv_layer_t * layer, lv_draw_task_t * t)
+{
+    t->ready_prev = layer->ready_tail;
+    t->ready_next = NULL;
+    if(layer->ready_tail) layer->ready_tail->ready_next = t;
+    else layer->ready_head = t;
+    layer->ready_tail = t;
+    t->in_ready_queue = true;
+}
+
+/**
+ * Remove a draw task from the ready queue of a layer. Needs `task_lock`.
+ * @param layer     the layer of `t`
+ * @param t         a draw task in the ready queue
+ */
+static void ready_queue_remove(lv_layer_t * layer, lv_draw_task_t * t)
+{
+    if(t->ready_prev) t->ready_prev->ready_next = t->ready_next;
+    else layer->ready_head = t->ready_next;
+    if(t->ready_next) t->ready_next->ready_prev = t->ready_prev;
+    else layer->ready_tail = t->ready_prev;
+    t->ready_prev = NULL;
+    t->ready_next = NULL;
+    t->in_ready_queue = false;
+}
+
+/**
+ * Take the oldest queued task of the ready queue which is preferred by a draw unit.
+ * Needs `task_lock`.
+ * @param layer             the layer whose ready queue should be used
+ * @param draw_unit_id      the ID of the draw unit
+ * @return                  the task in `LV_DRAW_TASK_STATE_IN_PROGRESS` state or NULL
+ */
+static lv_draw_task_t * ready_queue_take(lv_layer_t * layer, uint8_t draw_unit_id)
+{
+    lv_draw_task_t * t = layer->ready_head;
+    while(t) {
+        if(t->preferred_draw_unit_id == draw_unit_id && t->state == LV_DRAW_TASK_STATE_QUEUED) {
+            ready_queue_remove(layer, t);
+            t->state = LV_DRAW_TASK_STATE_IN_PROGRESS;
+            return t;
+        }
+        t = t->ready_next;
+    }
+
+    return NULL;
+}
+
 /**
  * Get the size of the draw descriptor of a draw task
  * @param type      type of the draw task
@@ -649,6 +1140,7 @@ static void cleanup_task(lv_draw_task_t * t, lv_display_t * disp)
         draw_label_dsc->text = NULL;
     }
 
+    lv_free(t->dependents);
     lv_free(t);
     LV_PROFILER_DRAW_END;
 }
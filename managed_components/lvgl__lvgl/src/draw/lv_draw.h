@@ -114,6 +114,20 @@ struct _lv_layer_t  {
 
     /** Linked list of draw tasks */
     lv_draw_task_t * draw_task_head;
+    lv_draw_task_t * draw_task_tail;
+
+    /** Draw tasks whose overlapping older tasks are finished, linked by `ready_prev` and `ready_next` */
+    lv_draw_task_t * ready_head;
+    lv_draw_task_t * ready_tail;
+
+    /** The newest draw task whose dependencies are collected */
+    lv_draw_task_t * last_linked;
+
+    /** Number of draw tasks whose dependencies are collected and which are not removed yet */
+    uint32_t linked_cnt;
+
+    /** Grid of the not finished draw tasks to find the overlapping ones quickly */
+    struct _lv_draw_task_index_t * task_index;
 
     lv_layer_t * parent;
     lv_layer_t * next;
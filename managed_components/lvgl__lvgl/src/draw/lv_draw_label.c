@@ -112,6 +112,17 @@ void LV_ATTRIBUTE_FAST_MEM lv_draw_label(lv_layer_t * layer, const lv_draw_label
 
     lv_memcpy(t->draw_dsc, dsc, sizeof(*dsc));
 
+    /*Expanded or scrolled text can be drawn out of `coords`, only the clip area limits it.
+     *Let the newer overlapping draw tasks wait for it there too.*/
+    if((dsc->flag & LV_TEXT_FLAG_EXPAND) || dsc->ofs_x != 0) {
+        t->_real_area.x1 = LV_MIN(t->_real_area.x1, t->clip_area.x1);
+        t->_real_area.x2 = LV_MAX(t->_real_area.x2, t->clip_area.x2);
+    }
+    if(dsc->ofs_y != 0) {
+        t->_real_area.y1 = LV_MIN(t->_real_area.y1, t->clip_area.y1);
+        t->_real_area.y2 = LV_MAX(t->_real_area.y2, t->clip_area.y2);
+    }
+
     /*The text is stored in a local variable so malloc memory for it*/
     if(dsc->text_local) {
         lv_draw_label_dsc_t * new_dsc = t->draw_dsc;
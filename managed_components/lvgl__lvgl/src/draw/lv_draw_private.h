@@ -81,6 +81,41 @@ struct _lv_draw_task_t {
      */
     uint8_t preference_score;
 
+    /**
+     * Number of older, not finished draw tasks on the same layer which overlap this one.
+     * The task can be drawn when it's 0. Protected by `lv_draw_lock_tasks()`.
+     */
+    uint32_t dep_cnt;
+
+    /** Newer draw tasks waiting for this one to finish */
+    lv_draw_task_t ** dependents;
+    uint32_t dependent_cnt;
+    uint32_t dependent_size;
+
+    /** Previous and next task in the ready queue of the layer */
+    lv_draw_task_t * ready_prev;
+    lv_draw_task_t * ready_next;
+
+    /** The dependencies are collected, `dep_cnt` is valid */
+    bool linked;
+
+    /** The dependents were already notified that this task is finished */
+    bool released;
+
+    /** The task is in the ready queue of its layer */
+    bool in_ready_queue;
+
+    /**
+     * Not all the dependencies could be registered (out of memory).
+     * The task is not ready until all the older tasks of the layer are finished.
+     */
+    bool wait_for_older;
+
+    /** Column and row range of the cells of the layer's task index in which the task is listed */
+    lv_area_t index_cells;
+
+    /** Order of linking, older tasks have smaller value */
+    uint32_t index_seq;
 };
 
 struct _lv_draw_mask_t {
@@ -182,7 +217,7 @@ typedef struct {
 #else
     volatile int dispatch_req;
 #endif
-    lv_mutex_t circle_cache_mutex;
+    lv_mutex_t task_lock;   /**< Protects the dependencies and ready queues of the draw tasks, see `lv_draw_lock_tasks()`*/
     bool task_running;
 } lv_draw_global_info_t;
 
@@ -190,6 +225,42 @@ typedef struct {
  * GLOBAL PROTOTYPES
  **********************/
 
+/**
+ * Lock the dependencies and ready queues of the draw tasks.
+ * Draw units can protect their own task queues with it too,
+ * so that finishing a task and taking the next ones needs only one lock.
+ */
+void lv_draw_lock_tasks(void);
+
+/**
+ * Unlock the dependencies and ready queues of the draw tasks
+ */
+void lv_draw_unlock_tasks(void);
+
+/**
+ * Take the oldest ready draw task of a layer which is preferred by a draw unit.
+ * A task is ready when all the older tasks overlapping it are finished.
+ * The returned task is already in `LV_DRAW_TASK_STATE_IN_PROGRESS` state.
+ * Needs `lv_draw_lock_tasks()`.
+ * @param layer             the layer whose ready queue should be used
+ * @param draw_unit_id      take only tasks where `preferred_draw_unit_id` equals this value
+ * @return                  a draw task or NULL if there is no ready task for the draw unit
+ */
+lv_draw_task_t * lv_draw_take_ready_task(lv_layer_t * layer, uint8_t draw_unit_id);
+
+/**
+ * Mark a draw task as finished. The newer tasks waiting only for this one become ready
+ * and up to `take_max` of them preferred by `draw_unit_id` are taken right away,
+ * so a draw thread can continue without waiting for the next dispatch.
+ * Needs `lv_draw_lock_tasks()`. `t` must not be used after this call.
+ * @param t                 the finished draw task
+ * @param draw_unit_id      take tasks where `preferred_draw_unit_id` equals this value
+ * @param taken             store the taken tasks here (can be NULL if `take_max` is 0)
+ * @param take_max          maximum number of tasks to take
+ * @return                  number of tasks stored in `taken`
+ */
+uint32_t lv_draw_task_finish(lv_draw_task_t * t, uint8_t draw_unit_id, lv_draw_task_t ** taken, uint32_t take_max);
+
 /**********************
  *      MACROS
  **********************/
@@ -128,6 +128,12 @@ lv_result_t lv_image_decoder_open(lv_image_decoder_dsc_t * dsc, const void * src
      * */
     lv_result_t res = dsc->decoder->open_cb(dsc->decoder, dsc);
 
+    /*Use the cached image, it can be different if an other thread decoded and cached it meanwhile*/
+    if(res == LV_RESULT_OK && dsc->cache_entry) {
+        lv_image_cache_data_t * cached_data = lv_cache_entry_get_data(dsc->cache_entry);
+        dsc->decoded = cached_data->decoded;
+    }
+
     if(res == LV_RESULT_OK && dsc->decoded != NULL) {
         LV_ASSERT_MSG(dsc->decoded->unaligned_data && dsc->decoded->handlers, "Invalid draw buffer");
 
@@ -222,21 +228,27 @@ lv_cache_entry_t * lv_image_decoder_add_to_cache(lv_image_decoder_t * decoder,
                                                  lv_image_cache_data_t * search_key,
                                                  const lv_draw_buf_t * decoded, void * user_data)
 {
-    lv_cache_entry_t * cache_entry = lv_cache_add(img_cache_p, search_key, NULL);
+    lv_image_cache_data_t decoded_data = *search_key;
+    decoded_data.decoded = decoded;
+    decoded_data.decoder = decoder;
+    decoded_data.user_data = user_data;
+
+    /*Draw threads can decode the same image in parallel. Look it up again under the lock of the cache
+     *and create the entry only if it's still not there.*/
+    lv_cache_entry_t * cache_entry = lv_cache_acquire_or_create(img_cache_p, search_key, &decoded_data);
     if(cache_entry == NULL) {
         return NULL;
     }
 
-    lv_image_cache_data_t * cached_data;
-    cached_data = lv_cache_entry_get_data(cache_entry);
-
-    /*Set the cache entry to decoder data*/
-    cached_data->decoded = decoded;
-    if(cached_data->src_type == LV_IMAGE_SRC_FILE) {
-        cached_data->src = lv_strdup(cached_data->src);
+    lv_image_cache_data_t * cached_data = lv_cache_entry_get_data(cache_entry);
+    if(cached_data->decoded != decoded) {
+        /*An other thread was faster. Free this copy as the cache would and use the cached one,
+         *`lv_image_decoder_open()` updates the descriptor.*/
+        LV_LOG_TRACE("Image was cached meanwhile, drop the decoded copy");
+        if(lv_draw_buf_has_flag((lv_draw_buf_t *)decoded, LV_IMAGE_FLAGS_ALLOCATED)) {
+            lv_draw_buf_destroy((lv_draw_buf_t *)decoded);
+        }
     }
-    cached_data->user_data = user_data; /*Need to free data on cache invalidate instead of decoder_close*/
-    cached_data->decoder = decoder;
 
     return cache_entry;
 }
@@ -179,6 +179,16 @@ void lv_image_decoder_set_get_area_cb(lv_image_decoder_t * decoder, lv_image_dec
  */
 void lv_image_decoder_set_close_cb(lv_image_decoder_t * decoder, lv_image_decoder_close_f_t close_cb);
 
+/**
+ * Add a decoded image to the image cache. The cache takes over `decoded`.
+ * If the same image was cached meanwhile (e.g. decoded by an other draw thread),
+ * `decoded` is freed and the entry of the cached image is returned.
+ * @param decoder       the decoder which decoded the image
+ * @param search_key    the source of the image and the size of the decoded data
+ * @param decoded       the decoded image
+ * @param user_data     data of the decoder to keep in the cache
+ * @return              the acquired cache entry or NULL on error
+ */
 lv_cache_entry_t * lv_image_decoder_add_to_cache(lv_image_decoder_t * decoder,
                                                  lv_image_cache_data_t * search_key,
                                                  const lv_draw_buf_t * decoded, void * user_data);
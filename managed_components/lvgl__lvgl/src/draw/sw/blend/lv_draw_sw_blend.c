@@ -110,6 +110,13 @@ void lv_draw_sw_blend(lv_draw_task_t * t, const lv_draw_sw_blend_dsc_t * blend_d
             fill_dsc.mask_buf += fill_dsc.mask_stride * (blend_area.y1 - blend_dsc->mask_area->y1) +
                                  (blend_area.x1 - blend_dsc->mask_area->x1);
         }
+        /*Full rows without mask are continuous in the buffer: fill them as one long span.
+         *(I1 needs the real coordinates for the bit offset)*/
+        else if(fill_dsc.dest_h > 1 && layer->color_format != LV_COLOR_FORMAT_I1 &&
+                (uint32_t)fill_dsc.dest_w * lv_color_format_get_size(layer->color_format) == layer_stride_byte) {
+            fill_dsc.dest_w *= fill_dsc.dest_h;
+            fill_dsc.dest_h = 1;
+        }
 
         lv_draw_sw_blend_color(layer->color_format, &fill_dsc);
     }
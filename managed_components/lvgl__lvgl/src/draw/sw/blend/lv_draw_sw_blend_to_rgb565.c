@@ -262,37 +262,46 @@ void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_blend_color_to_rgb565(lv_draw_sw_blend_fil
     /*Simple fill*/
     if(mask == NULL && opa >= LV_OPA_MAX) {
         if(LV_RESULT_INVALID == LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc)) {
-            for(y = 0; y < h; y++) {
-                uint16_t * dest_end_final = dest_buf_u16 + w;
-                uint32_t * dest_end_mid = (uint32_t *)((uint16_t *) dest_buf_u16 + ((w - 1) & ~(0xF)));
-                if((lv_uintptr_t)&dest_buf_u16[0] & 0x3) {
-                    dest_buf_u16[0] = color16;
-                    dest_buf_u16++;
+            /*The same byte everywhere (e.g. black or white): let memset use its widest stores*/
+            if((color16 >> 8) == (color16 & 0xFF)) {
+                for(y = 0; y < h; y++) {
+                    lv_memset(dest_buf_u16, color16 & 0xFF, w * 2);
+                    dest_buf_u16 = drawbuf_next_row(dest_buf_u16, dest_stride);
                 }
+            }
+            else {
+                for(y = 0; y < h; y++) {
+                    uint16_t * dest_end_final = dest_buf_u16 + w;
+                    uint32_t * dest_end_mid = (uint32_t *)((uint16_t *) dest_buf_u16 + ((w - 1) & ~(0xF)));
+                    if((lv_uintptr_t)&dest_buf_u16[0] & 0x3) {
+                        dest_buf_u16[0] = color16;
+                        dest_buf_u16++;
+                    }
 
-                uint32_t c32 = (uint32_t)color16 + ((uint32_t)color16 << 16);
-                uint32_t * dest32 = (uint32_t *)dest_buf_u16;
-                while(dest32 < dest_end_mid) {
-                    dest32[0] = c32;
-                    dest32[1] = c32;
-                    dest32[2] = c32;
-                    dest32[3] = c32;
-                    dest32[4] = c32;
-                    dest32[5] = c32;
-                    dest32[6] = c32;
-                    dest32[7] = c32;
-                    dest32 += 8;
-                }
+                    uint32_t c32 = (uint32_t)color16 + ((uint32_t)color16 << 16);
+                    uint32_t * dest32 = (uint32_t *)dest_buf_u16;
+                    while(dest32 < dest_end_mid) {
+                        dest32[0] = c32;
+                        dest32[1] = c32;
+                        dest32[2] = c32;
+                        dest32[3] = c32;
+                        dest32[4] = c32;
+                        dest32[5] = c32;
+                        dest32[6] = c32;
+                        dest32[7] = c32;
+                        dest32 += 8;
+                    }
 
-                dest_buf_u16 = (uint16_t *)dest32;
+                    dest_buf_u16 = (uint16_t *)dest32;
 
-                while(dest_buf_u16 < dest_end_final) {
-                    *dest_buf_u16 = color16;
-                    dest_buf_u16++;
-                }
+                    while(dest_buf_u16 < dest_end_final) {
+                        *dest_buf_u16 = color16;
+                        dest_buf_u16++;
+                    }
 
-                dest_buf_u16 = drawbuf_next_row(dest_buf_u16, dest_stride);
-                dest_buf_u16 -= w;
+                    dest_buf_u16 = drawbuf_next_row(dest_buf_u16, dest_stride);
+                    dest_buf_u16 -= w;
+                }
             }
         }
 
@@ -48,6 +48,10 @@
  **********************/
 #if LV_USE_OS
     static void render_thread_cb(void * ptr);
+    static void queue_push(lv_draw_sw_thread_dsc_t * thread_dsc, lv_draw_task_t * t);
+    static lv_draw_task_t * queue_pop(lv_draw_sw_thread_dsc_t * thread_dsc);
+    static lv_draw_task_t * queue_steal(lv_draw_sw_unit_t * draw_sw_unit, lv_draw_sw_thread_dsc_t * thief_dsc);
+    static void wake_idle_threads(lv_draw_sw_unit_t * draw_sw_unit);
 #endif
 
 static void execute_drawing(lv_draw_task_t * t);
@@ -95,8 +99,13 @@ void lv_draw_sw_init(void)
         lv_draw_sw_thread_dsc_t * thread_dsc = &draw_sw_unit->thread_dscs[i];
         thread_dsc->idx = i;
         thread_dsc->draw_unit = (void *) draw_sw_unit;
+#if LV_USE_OS == LV_OS_FREERTOS && LV_DRAW_THREAD_PIN_CORES
+        lv_freertos_thread_init_pinned(&thread_dsc->thread, "swdraw", LV_DRAW_THREAD_PRIO, render_thread_cb,
+                                       LV_DRAW_THREAD_STACK_SIZE, thread_dsc, (int32_t)i);
+#else
         lv_thread_init(&thread_dsc->thread, "swdraw", LV_DRAW_THREAD_PRIO, render_thread_cb,
                        LV_DRAW_THREAD_STACK_SIZE, thread_dsc);
+#endif
     }
 #endif
 
@@ -263,47 +272,63 @@ static int32_t dispatch(lv_draw_unit_t * draw_unit, lv_layer_t * layer)
     /*If at least one is busy, it's not all idle*/
     bool all_idle = true;
     for(i = 0; i < LV_DRAW_SW_DRAW_UNIT_CNT; i++) {
-        if(draw_sw_unit->thread_dscs[i].task_act) {
+        if(draw_sw_unit->thread_dscs[i].task_act || draw_sw_unit->thread_dscs[i].queue_cnt) {
             all_idle = false;
             break;
         }
     }
 
-    lv_draw_task_t * t = NULL;
-    for(i = 0; i < LV_DRAW_SW_DRAW_UNIT_CNT; i++) {
-        lv_draw_sw_thread_dsc_t * thread_dsc = &draw_sw_unit->thread_dscs[i];
+    /*Nothing to do, don't allocate the layer's buffer needlessly*/
+    if(layer->ready_head == NULL) {
+        LV_PROFILER_DRAW_END;
+        return all_idle ? LV_DRAW_UNIT_IDLE : 0;
+    }
 
-        /*Do nothing if busy*/
-        if(thread_dsc->task_act) continue;
+    /*Allocate a buffer if not done yet.*/
+    void * buf = lv_draw_layer_alloc_buf(layer);
+    if(buf == NULL) {
+        LV_PROFILER_DRAW_END;
+        return all_idle ? LV_DRAW_UNIT_IDLE : 0;
+    }
 
-        /*Find an available task. Start from the previously taken task.*/
-        t = lv_draw_get_next_available_task(layer, t, DRAW_UNIT_ID_SW);
+    /*Deal the ready tasks to the threads in turns under one lock. Fill the queues only to half
+     *to leave room for the tasks the threads take themselves when they finish one.*/
+    bool wake[LV_DRAW_SW_DRAW_UNIT_CNT] = {false};
+    lv_draw_lock_tasks();
+    bool ready_left = true;
+    while(ready_left) {
+        bool queued = false;
+        for(i = 0; i < LV_DRAW_SW_DRAW_UNIT_CNT; i++) {
+            lv_draw_sw_thread_dsc_t * thread_dsc = &draw_sw_unit->thread_dscs[i];
+            if(thread_dsc->queue_cnt >= LV_DRAW_SW_THREAD_QUEUE_SIZE / 2) continue;
+
+            lv_draw_task_t * t = lv_draw_take_ready_task(layer, DRAW_UNIT_ID_SW);
+            if(t == NULL) {
+                ready_left = false;
+                break;
+            }
 
-        /*If there is not available task don't try other threads as there won't be available
-         *tasks for then either*/
-        if(t == NULL) {
-            LV_PROFILER_DRAW_END;
-            if(all_idle) return LV_DRAW_UNIT_IDLE;  /*Couldn't start rendering*/
-            else return taken_cnt;
+            queue_push(thread_dsc, t);
+            taken_cnt++;
+            queued = true;
+            /*A busy thread checks its queue anyway when it finishes the task*/
+            wake[i] = thread_dsc->task_act == NULL;
         }
 
-        /*Allocate a buffer if not done yet.*/
-        void * buf = lv_draw_layer_alloc_buf(layer);
-        /*Do not return is failed. The other thread might already have a buffer can do something. */
-        if(buf == NULL) continue;
-
-        /*Take the task*/
-        all_idle = false;
-        taken_cnt++;
-        t->state = LV_DRAW_TASK_STATE_IN_PROGRESS;
-        thread_dsc->task_act = t;
+        /*All the queues are full*/
+        if(!queued) break;
+    }
+    lv_draw_unlock_tasks();
 
-        /*Let the render thread work*/
-        if(thread_dsc->inited) lv_thread_sync_signal(&thread_dsc->sync);
+    /*Let the render threads work*/
+    for(i = 0; i < LV_DRAW_SW_DRAW_UNIT_CNT; i++) {
+        lv_draw_sw_thread_dsc_t * thread_dsc = &draw_sw_unit->thread_dscs[i];
+        if(wake[i] && thread_dsc->inited) lv_thread_sync_signal(&thread_dsc->sync);
     }
 
-    if(all_idle) return LV_DRAW_UNIT_IDLE;  /*Couldn't start rendering*/
-    else return taken_cnt;
+    LV_PROFILER_DRAW_END;
+    if(taken_cnt) return taken_cnt;
+    else return all_idle ? LV_DRAW_UNIT_IDLE : 0;
 
 #else
     /*Return immediately if it's busy with draw task*/
@@ -345,39 +370,121 @@ static int32_t dispatch(lv_draw_unit_t * draw_unit, lv_layer_t * layer)
 static void render_thread_cb(void * ptr)
 {
     lv_draw_sw_thread_dsc_t * thread_dsc = ptr;
+    lv_draw_sw_unit_t * draw_sw_unit = (lv_draw_sw_unit_t *) thread_dsc->draw_unit;
 
     lv_thread_sync_init(&thread_dsc->sync);
     thread_dsc->inited = true;
 
+    lv_draw_task_t * t = NULL;
     while(1) {
-        while(thread_dsc->task_act == NULL) {
-            if(thread_dsc->exit_status) {
-                break;
-            }
-            lv_thread_sync_wait(&thread_dsc->sync);
-        }
-
         if(thread_dsc->exit_status) {
             LV_LOG_INFO("ready to exit software rendering thread");
             break;
         }
 
-        execute_drawing(thread_dsc->task_act);
-#if LV_USE_PARALLEL_DRAW_DEBUG
-        parallel_debug_draw(thread_dsc->task_act, thread_dsc->idx);
-#endif
-        thread_dsc->task_act->state = LV_DRAW_TASK_STATE_READY;
-        thread_dsc->task_act = NULL;
+        lv_draw_lock_tasks();
+        if(t) {
+            /*Take the tasks which were waiting only for the finished one right away,
+             *they will probably draw to the same part of the buffer*/
+            lv_draw_task_t * taken[LV_DRAW_SW_THREAD_QUEUE_SIZE];
+            uint32_t free_cnt = LV_DRAW_SW_THREAD_QUEUE_SIZE - thread_dsc->queue_cnt;
+            uint32_t taken_cnt = lv_draw_task_finish(t, DRAW_UNIT_ID_SW, taken, free_cnt);
+            uint32_t i;
+            for(i = 0; i < taken_cnt; i++) {
+                queue_push(thread_dsc, taken[i]);
+            }
+        }
+
+        /*Prefer the own tasks, steal from the others only if there are none*/
+        t = queue_pop(thread_dsc);
+        if(t == NULL) t = queue_steal(draw_sw_unit, thread_dsc);
+        thread_dsc->task_act = t;
+        bool has_spare = thread_dsc->queue_cnt > 0;
+        lv_draw_unlock_tasks();
+
+        if(t == NULL) {
+            /*Out of tasks. Request a new dispatching only now, not after each task,
+             *to let the other threads work instead of waking the dispatcher.*/
+            lv_draw_dispatch_request();
+            lv_thread_sync_wait(&thread_dsc->sync);
+            continue;
+        }
 
-        /*The draw unit is free now. Request a new dispatching as it can get a new task*/
-        lv_draw_dispatch_request();
+        if(has_spare) wake_idle_threads(draw_sw_unit);
 
+        execute_drawing(t);
+#if LV_USE_PARALLEL_DRAW_DEBUG
+        parallel_debug_draw(t, thread_dsc->idx);
+#endif
     }
 
     thread_dsc->inited = false;
     lv_thread_sync_delete(&thread_dsc->sync);
     LV_LOG_INFO("exit software rendering thread");
 }
+
+/**
+ * Add a ready task to the queue of a render thread. Needs `lv_draw_lock_tasks()`.
+ * @param thread_dsc    the thread whose queue to use
+ * @param t             the task, already in `LV_DRAW_TASK_STATE_IN_PROGRESS` state
+ */
+static void queue_push(lv_draw_sw_thread_dsc_t * thread_dsc, lv_draw_task_t * t)
+{
+    LV_ASSERT(thread_dsc->queue_cnt < LV_DRAW_SW_THREAD_QUEUE_SIZE);
+
+    uint32_t tail = (thread_dsc->queue_head + thread_dsc->queue_cnt) % LV_DRAW_SW_THREAD_QUEUE_SIZE;
+    thread_dsc->queue[tail] = t;
+    thread_dsc->queue_cnt++;
+}
+
+/**
+ * Take the newest task from the own queue of a render thread. Needs `lv_draw_lock_tasks()`.
+ * @param thread_dsc    the thread whose queue to use
+ * @return              the task to draw or NULL if the queue is empty
+ */
+static lv_draw_task_t * queue_pop(lv_draw_sw_thread_dsc_t * thread_dsc)
+{
+    if(thread_dsc->queue_cnt == 0) return NULL;
+
+    thread_dsc->queue_cnt--;
+    uint32_t tail = (thread_dsc->queue_head + thread_dsc->queue_cnt) % LV_DRAW_SW_THREAD_QUEUE_SIZE;
+    return thread_dsc->queue[tail];
+}
+
+/**
+ * Take the oldest task from the queue of another render thread. Needs `lv_draw_lock_tasks()`.
+ * @param draw_sw_unit  the SW draw unit
+ * @param thief_dsc     the thread which has no tasks
+ * @return              the task to draw or NULL if all the queues are empty
+ */
+static lv_draw_task_t * queue_steal(lv_draw_sw_unit_t * draw_sw_unit, lv_draw_sw_thread_dsc_t * thief_dsc)
+{
+    uint32_t i;
+    for(i = 1; i < LV_DRAW_SW_DRAW_UNIT_CNT; i++) {
+        lv_draw_sw_thread_dsc_t * victim_dsc = &draw_sw_unit->thread_dscs[(thief_dsc->idx + i) % LV_DRAW_SW_DRAW_UNIT_CNT];
+        if(victim_dsc->queue_cnt == 0) continue;
+
+        lv_draw_task_t * t = victim_dsc->queue[victim_dsc->queue_head];
+        victim_dsc->queue_head = (victim_dsc->queue_head + 1) % LV_DRAW_SW_THREAD_QUEUE_SIZE;
+        victim_dsc->queue_cnt--;
+        return t;
+    }
+
+    return NULL;
+}
+
+/**
+ * Wake the render threads which have nothing to do to let them steal tasks
+ * @param draw_sw_unit  the SW draw unit
+ */
+static void wake_idle_threads(lv_draw_sw_unit_t * draw_sw_unit)
+{
+    uint32_t i;
+    for(i = 0; i < LV_DRAW_SW_DRAW_UNIT_CNT; i++) {
+        lv_draw_sw_thread_dsc_t * thread_dsc = &draw_sw_unit->thread_dscs[i];
+        if(thread_dsc->task_act == NULL && thread_dsc->inited) lv_thread_sync_signal(&thread_dsc->sync);
+    }
+}
 #endif
 
 static void execute_drawing(lv_draw_task_t * t)
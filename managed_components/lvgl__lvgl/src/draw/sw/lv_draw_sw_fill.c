@@ -32,6 +32,12 @@
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+#if LV_DRAW_SW_COMPLEX
+static void fill_with_corner_tile(lv_draw_task_t * t, lv_draw_sw_blend_dsc_t * blend_dsc, const lv_area_t * coords,
+                                  int32_t radius, lv_opa_t opa, const lv_opa_t * corner_tile);
+static void fill_row_spans(lv_draw_task_t * t, const lv_draw_sw_blend_dsc_t * blend_dsc, void * masks[],
+                           lv_opa_t * mask_buf, const lv_area_t * clipped_coords, int32_t mask_y, int32_t y, lv_opa_t opa);
+#endif
 
 /**********************
  *  STATIC VARIABLES
@@ -87,8 +93,17 @@ void lv_draw_sw_fill(lv_draw_task_t * t, lv_draw_fill_dsc_t * dsc, const lv_area
     lv_draw_sw_mask_radius_param_t mask_rout_param;
     void * mask_list[2] = {NULL, NULL};
     if(rout > 0) {
-        mask_buf = lv_malloc(clipped_w);
         lv_draw_sw_mask_radius_init(&mask_rout_param, &bg_coords, rout, false);
+
+        /*Without gradient only the corners need a mask: use the precomputed corner tile*/
+        const lv_opa_t * corner_tile = lv_draw_sw_mask_radius_get_corner_tile(&mask_rout_param);
+        if(grad_dir == LV_GRAD_DIR_NONE && corner_tile) {
+            fill_with_corner_tile(t, &blend_dsc, &bg_coords, rout, opa, corner_tile);
+            lv_draw_sw_mask_free_param(&mask_rout_param);
+            return;
+        }
+
+        mask_buf = lv_malloc(clipped_w);
         mask_list[0] = &mask_rout_param;
     }
 
@@ -149,12 +164,34 @@ void lv_draw_sw_fill(lv_draw_task_t * t, lv_draw_fill_dsc_t * dsc, const lv_area
     }
 #endif
 
+    /*With a single opaque color per line only the anti-aliased edges need the mask*/
+    bool span_fill = grad_dir == LV_GRAD_DIR_NONE;
+    if(grad && grad_dir == LV_GRAD_DIR_VER) {
+        span_fill = true;
+        uint32_t s;
+        for(s = 0; s < dsc->grad.stops_count; s++) {
+            if(dsc->grad.stops[s].opa != LV_OPA_COVER) span_fill = false;
+        }
+    }
+
     /* Draw the top of the rectangle line by line and mirror it to the bottom. */
     for(h = 0; h < rout; h++) {
         int32_t top_y = bg_coords.y1 + h;
         int32_t bottom_y = bg_coords.y2 - h;
         if(top_y < clipped_coords.y1 && bottom_y > clipped_coords.y2) continue;   /*This line is clipped now*/
 
+        if(span_fill) {
+            if(top_y >= clipped_coords.y1) {
+                if(grad_dir == LV_GRAD_DIR_VER) blend_dsc.color = grad->color_map[top_y - bg_coords.y1];
+                fill_row_spans(t, &blend_dsc, mask_list, mask_buf, &clipped_coords, top_y, top_y, opa);
+            }
+            if(bottom_y <= clipped_coords.y2) {
+                if(grad_dir == LV_GRAD_DIR_VER) blend_dsc.color = grad->color_map[bottom_y - bg_coords.y1];
+                fill_row_spans(t, &blend_dsc, mask_list, mask_buf, &clipped_coords, top_y, bottom_y, opa);
+            }
+            continue;
+        }
+
         bool preblend = false;
 
         /* Initialize the mask to opa instead of 0xFF and blend with LV_OPA_COVER.
@@ -347,4 +384,160 @@ void lv_draw_sw_fill(lv_draw_task_t * t, lv_draw_fill_dsc_t * dsc, const lv_area
 #endif
 }
 
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+#if LV_DRAW_SW_COMPLEX
+/**
+ * Fill a rounded rectangle without gradient: blend its corners through the corner tile
+ * and fill the rest as three rectangles without mask.
+ * The result is the same as applying the radius mask line by line.
+ * @param t             the draw task
+ * @param blend_dsc     blend descriptor with the color set
+ * @param coords        the rectangle
+ * @param radius        radius of the corners, at most the half of the shorter side
+ * @param opa           opacity of the rectangle
+ * @param corner_tile   the corner tile of `radius`
+ */
+static void fill_with_corner_tile(lv_draw_task_t * t, lv_draw_sw_blend_dsc_t * blend_dsc, const lv_area_t * coords,
+                                  int32_t radius, lv_opa_t opa, const lv_opa_t * corner_tile)
+{
+    int32_t tile_size = radius * 2;
+    lv_area_t area;
+    lv_area_t tile_area;
+
+    /*The middle part: full width between the top and bottom corners, then the stripes between the corners*/
+    blend_dsc->blend_area = &area;
+    blend_dsc->mask_buf = NULL;
+    blend_dsc->opa = opa;
+    lv_area_set(&area, coords->x1, coords->y1 + radius, coords->x2, coords->y2 - radius);
+    if(area.y1 <= area.y2) lv_draw_sw_blend(t, blend_dsc);
+
+    lv_area_set(&area, coords->x1 + radius, coords->y1, coords->x2 - radius, coords->y1 + radius - 1);
+    if(area.x1 <= area.x2) {
+        lv_draw_sw_blend(t, blend_dsc);
+        lv_area_set(&area, coords->x1 + radius, coords->y2 - radius + 1, coords->x2 - radius, coords->y2);
+        lv_draw_sw_blend(t, blend_dsc);
+    }
+
+    /*The corners: each one is a quarter of the tile, placed to the corner of the rectangle.
+     *The radius mask multiplies the opacity into the mask and blends with full opacity.*/
+    blend_dsc->mask_res = LV_DRAW_SW_MASK_RES_CHANGED;
+    blend_dsc->opa = LV_OPA_COVER;
+
+    uint32_t corner;
+    for(corner = 0; corner < 4; corner++) {
+        bool right = corner & 1;
+        bool bottom = corner & 2;
+        tile_area.x1 = right ? coords->x2 - tile_size + 1 : coords->x1;
+        tile_area.y1 = bottom ? coords->y2 - tile_size + 1 : coords->y1;
+        tile_area.x2 = tile_area.x1 + tile_size - 1;
+        tile_area.y2 = tile_area.y1 + tile_size - 1;
+
+        area.x1 = right ? coords->x2 - radius + 1 : coords->x1;
+        area.y1 = bottom ? coords->y2 - radius + 1 : coords->y1;
+        area.x2 = area.x1 + radius - 1;
+        area.y2 = area.y1 + radius - 1;
+        if(!lv_area_intersect(&area, &area, &t->clip_area)) continue;
+
+        if(opa >= LV_OPA_MAX) {
+            blend_dsc->mask_buf = (lv_opa_t *)corner_tile;
+            blend_dsc->mask_area = &tile_area;
+            blend_dsc->mask_stride = tile_size;
+            lv_draw_sw_blend(t, blend_dsc);
+            continue;
+        }
+
+        /*Scale only the visible rows of the quarter*/
+        lv_opa_t row_opa[LV_DRAW_SW_CORNER_TILE_MAX_RADIUS];
+        int32_t row_w = lv_area_get_width(&area);
+        lv_area_t row_area = area;
+        blend_dsc->blend_area = &row_area;
+        blend_dsc->mask_buf = row_opa;
+        blend_dsc->mask_area = &row_area;
+        blend_dsc->mask_stride = row_w;
+
+        int32_t y;
+        for(y = area.y1; y <= area.y2; y++) {
+            const lv_opa_t * tile_row = corner_tile + (y - tile_area.y1) * tile_size + (area.x1 - tile_area.x1);
+            int32_t i;
+            for(i = 0; i < row_w; i++) {
+                row_opa[i] = LV_UDIV255(tile_row[i] * opa);
+            }
+            row_area.y1 = y;
+            row_area.y2 = y;
+            lv_draw_sw_blend(t, blend_dsc);
+        }
+        blend_dsc->blend_area = &area;
+    }
+}
+
+/**
+ * Fill a row of a rounded rectangle in spans: the fully covered span is filled without mask,
+ * only the anti-aliased edges around it are masked.
+ * The result is the same as masking the whole row.
+ * @param t                 the draw task
+ * @param blend_dsc         blend descriptor with the color of the row set
+ * @param masks             the masks, the first is the radius mask of the rectangle
+ * @param mask_buf          buffer for the mask, at least as wide as `clipped_coords`
+ * @param clipped_coords    the visible part of the rectangle
+ * @param mask_y            the row of the mask to use (the top rows are mirrored to the bottom)
+ * @param y                 the row to fill
+ * @param opa               opacity of the rectangle
+ */
+static void fill_row_spans(lv_draw_task_t * t, const lv_draw_sw_blend_dsc_t * blend_dsc, void * masks[],
+                           lv_opa_t * mask_buf, const lv_area_t * clipped_coords, int32_t mask_y, int32_t y, lv_opa_t opa)
+{
+    lv_draw_sw_span_t span;
+    lv_draw_sw_mask_radius_get_cover_span(masks[0], mask_y, &span);
+
+    /*Pixels of the row outside of the covered span are the edges*/
+    int32_t cover_x1 = clipped_coords->x2 + 1;
+    int32_t cover_x2 = clipped_coords->x2;
+    if(span.coverage == LV_OPA_COVER) {
+        cover_x1 = LV_CLAMP(clipped_coords->x1, span.x_start, clipped_coords->x2 + 1);
+        cover_x2 = LV_CLAMP(cover_x1 - 1, span.x_end, clipped_coords->x2);
+    }
+
+    lv_draw_sw_blend_dsc_t dsc = *blend_dsc;
+    lv_area_t area;
+    area.y1 = y;
+    area.y2 = y;
+    dsc.blend_area = &area;
+    dsc.mask_area = &area;
+
+    /*Initialize the mask to opa and blend with LV_OPA_COVER as the whole row would be*/
+    dsc.mask_buf = mask_buf;
+    dsc.opa = LV_OPA_COVER;
+    if(cover_x1 > clipped_coords->x1) {
+        area.x1 = clipped_coords->x1;
+        area.x2 = cover_x1 - 1;
+        int32_t len = lv_area_get_width(&area);
+        lv_memset(mask_buf, opa, len);
+        dsc.mask_res = lv_draw_sw_mask_apply(masks, mask_buf, area.x1, mask_y, len);
+        if(dsc.mask_res == LV_DRAW_SW_MASK_RES_FULL_COVER) dsc.mask_res = LV_DRAW_SW_MASK_RES_CHANGED;
+        lv_draw_sw_blend(t, &dsc);
+    }
+
+    if(cover_x2 < clipped_coords->x2) {
+        area.x1 = cover_x2 + 1;
+        area.x2 = clipped_coords->x2;
+        int32_t len = lv_area_get_width(&area);
+        lv_memset(mask_buf, opa, len);
+        dsc.mask_res = lv_draw_sw_mask_apply(masks, mask_buf, area.x1, mask_y, len);
+        if(dsc.mask_res == LV_DRAW_SW_MASK_RES_FULL_COVER) dsc.mask_res = LV_DRAW_SW_MASK_RES_CHANGED;
+        lv_draw_sw_blend(t, &dsc);
+    }
+
+    if(cover_x1 <= cover_x2) {
+        area.x1 = cover_x1;
+        area.x2 = cover_x2;
+        dsc.mask_buf = NULL;
+        dsc.opa = opa;
+        lv_draw_sw_blend(t, &dsc);
+    }
+}
+#endif /*LV_DRAW_SW_COMPLEX*/
+
 #endif /*LV_USE_DRAW_SW*/
@@ -218,7 +218,14 @@ static void LV_ATTRIBUTE_FAST_MEM draw_line_ver(lv_draw_task_t * t, const lv_dra
         blend_dsc.mask_buf = mask_buf;
         blend_dsc.mask_area = &blend_area;
         blend_dsc.mask_res = LV_DRAW_SW_MASK_RES_CHANGED;
-        int32_t dash_start = (blend_area.y1) % (dsc->dash_gap + dsc->dash_width);
+        /*Take the phase from the start of the line, not from the clip area, so that
+         *tiles rendered separately continue each other's dash pattern*/
+        int32_t dash_period = dsc->dash_gap + dsc->dash_width;
+        int32_t line_y1 = (int32_t)LV_MIN(dsc->p1.y, dsc->p2.y);
+        int32_t dash_start = line_y1 % dash_period;
+        if(blend_area.y1 > line_y1) {
+            dash_start = ((dash_start + blend_area.y1 - line_y1 - 1) % dash_period) + 1;
+        }
 
         int32_t dash_cnt = dash_start;
 
@@ -17,14 +17,24 @@
 #include "../../misc/lv_assert.h"
 #include "../../osal/lv_os.h"
 #include "../../stdlib/lv_string.h"
+#include "../../misc/cache/lv_cache.h"
 
 /*********************
  *      DEFINES
  *********************/
-#define CIRCLE_CACHE_LIFE_MAX           1000
-#define CIRCLE_CACHE_AGING(life, r)     life = LV_MIN(life + (r < 16 ? 1 : (r >> 4)), 1000)
-#define circle_cache_mutex              LV_GLOBAL_DEFAULT()->draw_info.circle_cache_mutex
 #define _circle_cache                   LV_GLOBAL_DEFAULT()->sw_circle_cache
+#define _circle_hot                     LV_GLOBAL_DEFAULT()->sw_circle_hot
+
+/*The render threads find the circles pinned for the refresh without a lock.
+ *Without atomics nothing is pinned and every lookup goes through the (locked) cache.*/
+#if defined(__GNUC__) || defined(__clang__)
+    #define CIRCLE_HOT_LOAD(slot)                   __atomic_load_n(slot, __ATOMIC_ACQUIRE)
+    #define CIRCLE_HOT_PUBLISH(slot, expected, e)   __atomic_compare_exchange_n(slot, expected, e, false, \
+                                                                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+    #define CIRCLE_HOT_LOAD(slot)                   NULL
+    #define CIRCLE_HOT_PUBLISH(slot, expected, e)   false
+#endif
 
 /**********************
  *      TYPEDEFS
@@ -62,6 +72,12 @@ static void circ_init(lv_point_t * c, int32_t * tmp, int32_t radius);
 static bool circ_cont(lv_point_t * c);
 static void circ_next(lv_point_t * c, int32_t * tmp);
 static void circ_calc_aa4(lv_draw_sw_mask_radius_circle_dsc_t * c, int32_t radius);
+static void corner_tile_calc(lv_draw_sw_mask_radius_circle_dsc_t * c);
+static lv_draw_sw_mask_radius_circle_dsc_t * circle_get(int32_t radius, lv_cache_entry_t ** own_entry);
+static bool circle_create_cb(lv_draw_sw_mask_radius_circle_dsc_t * c, void * user_data);
+static void circle_free_cb(lv_draw_sw_mask_radius_circle_dsc_t * c, void * user_data);
+static lv_cache_compare_res_t circle_compare_cb(const lv_draw_sw_mask_radius_circle_dsc_t * lhs,
+                                                const lv_draw_sw_mask_radius_circle_dsc_t * rhs);
 static lv_opa_t * get_next_line(lv_draw_sw_mask_radius_circle_dsc_t * c, int32_t y, int32_t * len,
                                 int32_t * x_start);
 static inline lv_opa_t /* LV_ATTRIBUTE_FAST_MEM */ mask_mix(lv_opa_t mask_act, lv_opa_t mask_new);
@@ -80,12 +96,23 @@ static inline lv_opa_t /* LV_ATTRIBUTE_FAST_MEM */ mask_mix(lv_opa_t mask_act, l
 
 void lv_draw_sw_mask_init(void)
 {
-    lv_mutex_init(&circle_cache_mutex);
+    const lv_cache_ops_t ops = {
+        .compare_cb = (lv_cache_compare_cb_t)circle_compare_cb,
+        .create_cb = (lv_cache_create_cb_t)circle_create_cb,
+        .free_cb = (lv_cache_free_cb_t)circle_free_cb,
+    };
+    /*The pinned circles can't be evicted, keep some room for the others*/
+    _circle_cache = lv_cache_create(&lv_cache_class_lru_rb_count, sizeof(lv_draw_sw_mask_radius_circle_dsc_t),
+                                    LV_DRAW_SW_CIRCLE_HOT_SLOTS + LV_DRAW_SW_CIRCLE_CACHE_EXTRA, ops);
+    lv_cache_set_name(_circle_cache, "SW_CIRCLE");
+    lv_memzero(_circle_hot, sizeof(_circle_hot));
 }
 
 void lv_draw_sw_mask_deinit(void)
 {
-    lv_mutex_delete(&circle_cache_mutex);
+    lv_draw_sw_mask_cleanup();
+    lv_cache_destroy(_circle_cache, NULL);
+    _circle_cache = NULL;
 }
 
 lv_draw_sw_mask_res_t LV_ATTRIBUTE_FAST_MEM lv_draw_sw_mask_apply(void * masks[], lv_opa_t * mask_buf, int32_t abs_x,
@@ -109,35 +136,71 @@ lv_draw_sw_mask_res_t LV_ATTRIBUTE_FAST_MEM lv_draw_sw_mask_apply(void * masks[]
 
 void lv_draw_sw_mask_free_param(void * p)
 {
-    lv_mutex_lock(&circle_cache_mutex);
     lv_draw_sw_mask_common_dsc_t * pdsc = p;
     if(pdsc->type == LV_DRAW_SW_MASK_TYPE_RADIUS) {
         lv_draw_sw_mask_radius_param_t * radius_p = (lv_draw_sw_mask_radius_param_t *) p;
-        if(radius_p->circle) {
-            if(radius_p->circle->life < 0) {
-                lv_free(radius_p->circle->cir_opa);
-                lv_free(radius_p->circle);
-            }
-            else {
-                radius_p->circle->used_cnt--;
-            }
+        if(radius_p->circle_temp) {
+            circle_free_cb(radius_p->circle, NULL);
+            lv_free(radius_p->circle);
         }
-    }
+        else if(radius_p->circle_entry) {
+            lv_cache_release(_circle_cache, radius_p->circle_entry, NULL);
+        }
+        /*A pinned circle is released by lv_draw_sw_mask_cleanup()*/
 
-    lv_mutex_unlock(&circle_cache_mutex);
+        radius_p->circle = NULL;
+        radius_p->circle_entry = NULL;
+        radius_p->circle_temp = 0;
+    }
 }
 
 void lv_draw_sw_mask_cleanup(void)
 {
-    uint8_t i;
-    for(i = 0; i < LV_DRAW_SW_CIRCLE_CACHE_SIZE; i++) {
-        if(_circle_cache[i].buf) {
-            lv_free(_circle_cache[i].buf);
+    /*No rendering is in progress, so no one uses the pinned circles without a reference.
+     *Release them to let the cache evict them when it needs space.*/
+    uint32_t i;
+    for(i = 0; i < LV_DRAW_SW_CIRCLE_HOT_SLOTS; i++) {
+        if(_circle_hot[i]) {
+            lv_cache_release(_circle_cache, _circle_hot[i], NULL);
+            _circle_hot[i] = NULL;
         }
-        lv_memzero(&(_circle_cache[i]), sizeof(_circle_cache[i]));
     }
 }
 
+const lv_opa_t * lv_draw_sw_mask_radius_get_corner_tile(const lv_draw_sw_mask_radius_param_t * param)
+{
+    return param->circle ? param->circle->corner_tile : NULL;
+}
+
+void lv_draw_sw_mask_radius_get_cover_span(const lv_draw_sw_mask_radius_param_t * param, int32_t abs_y,
+                                           lv_draw_sw_span_t * span)
+{
+    const lv_area_t * rect = &param->cfg.rect;
+    int32_t radius = param->cfg.radius;
+
+    span->y = abs_y;
+    span->x_start = rect->x1;
+    span->x_end = rect->x2;
+    span->coverage = LV_OPA_COVER;
+
+    if(param->cfg.outer || abs_y < rect->y1 || abs_y > rect->y2) {
+        span->coverage = LV_OPA_TRANSP;
+        return;
+    }
+
+    /*In the straight part the whole row is covered*/
+    if(radius == 0 || (abs_y >= rect->y1 + radius && abs_y <= rect->y2 - radius)) return;
+
+    /*In the corners the circle tells where the anti-aliased pixels end. See lv_draw_mask_radius()*/
+    int32_t cir_y = abs_y < rect->y1 + radius ? rect->y1 + radius - abs_y - 1 : abs_y - (rect->y2 + 1 - radius);
+    int32_t aa_len;
+    int32_t x_start;
+    get_next_line(param->circle, cir_y, &aa_len, &x_start);
+    span->x_start = rect->x1 + radius - x_start;
+    span->x_end = rect->x2 - radius + x_start;
+    if(span->x_start > span->x_end) span->coverage = LV_OPA_TRANSP;
+}
+
 void lv_draw_sw_mask_line_points_init(lv_draw_sw_mask_line_param_t * param, int32_t p1x, int32_t p1y,
                                       int32_t p2x,
                                       int32_t p2y, lv_draw_sw_mask_line_side_t side)
@@ -306,52 +369,20 @@ void lv_draw_sw_mask_radius_init(lv_draw_sw_mask_radius_param_t * param, const l
     param->dsc.cb = (lv_draw_sw_mask_xcb_t)lv_draw_mask_radius;
     param->dsc.type = LV_DRAW_SW_MASK_TYPE_RADIUS;
 
-    if(radius == 0) {
-        param->circle = NULL;
-        return;
-    }
-
-    lv_mutex_lock(&circle_cache_mutex);
-
-    uint32_t i;
-
-    /*Try to reuse a circle cache entry*/
-    for(i = 0; i < LV_DRAW_SW_CIRCLE_CACHE_SIZE; i++) {
-        if(_circle_cache[i].radius == radius) {
-            _circle_cache[i].used_cnt++;
-            CIRCLE_CACHE_AGING(_circle_cache[i].life, radius);
-            param->circle = &(_circle_cache[i]);
-            lv_mutex_unlock(&circle_cache_mutex);
-            return;
-        }
-    }
-
-    /*If not cached use the free entry with lowest life*/
-    lv_draw_sw_mask_radius_circle_dsc_t * entry = NULL;
-    for(i = 0; i < LV_DRAW_SW_CIRCLE_CACHE_SIZE; i++) {
-        if(_circle_cache[i].used_cnt == 0) {
-            if(!entry) entry = &(_circle_cache[i]);
-            else if(_circle_cache[i].life < entry->life) entry = &(_circle_cache[i]);
-        }
-    }
-
-    /*There is no unused entry. Allocate one temporarily*/
-    if(!entry) {
-        entry = lv_malloc_zeroed(sizeof(lv_draw_sw_mask_radius_circle_dsc_t));
-        LV_ASSERT_MALLOC(entry);
-        entry->life = -1;
-    }
-    else {
-        entry->used_cnt++;
-        entry->life = 0;
-        CIRCLE_CACHE_AGING(entry->life, radius);
-    }
-
-    param->circle = entry;
+    param->circle = NULL;
+    param->circle_entry = NULL;
+    param->circle_temp = 0;
+    if(radius == 0) return;
 
-    circ_calc_aa4(param->circle, radius);
-    lv_mutex_unlock(&circle_cache_mutex);
+    param->circle = circle_get(radius, &param->circle_entry);
+    if(param->circle) return;
 
+    /*All the cached circles are in use. Allocate one temporarily*/
+    lv_draw_sw_mask_radius_circle_dsc_t * circle = lv_malloc_zeroed(sizeof(lv_draw_sw_mask_radius_circle_dsc_t));
+    LV_ASSERT_MALLOC(circle);
+    circ_calc_aa4(circle, radius);
+    param->circle = circle;
+    param->circle_temp = 1;
 }
 
 void lv_draw_sw_mask_fade_init(lv_draw_sw_mask_fade_param_t * param, const lv_area_t * coords, lv_opa_t opa_top,
@@ -1218,6 +1249,108 @@ static void circ_calc_aa4(lv_draw_sw_mask_radius_circle_dsc_t * c, int32_t radiu
     lv_free(cir_x);
 }
 
+/**
+ * Calculate the corner tile of a circle by applying its radius mask on a (2 * radius) x (2 * radius) square
+ */
+static void corner_tile_calc(lv_draw_sw_mask_radius_circle_dsc_t * c)
+{
+    int32_t size = c->radius * 2;
+    c->corner_tile = lv_malloc(size * size);
+    if(c->corner_tile == NULL) {
+        /*Not an error, the rectangles are drawn with the radius mask then*/
+        LV_LOG_WARN("no memory for the corner tile of radius %" LV_PRId32, c->radius);
+        return;
+    }
+
+    lv_draw_sw_mask_radius_param_t param;
+    lv_memzero(&param, sizeof(param));
+    lv_area_set(&param.cfg.rect, 0, 0, size - 1, size - 1);
+    param.cfg.radius = c->radius;
+    param.circle = c;
+
+    /*The bottom half is the mirror of the top half, as for every rectangle*/
+    int32_t y;
+    for(y = 0; y < c->radius; y++) {
+        lv_opa_t * line = &c->corner_tile[y * size];
+        lv_memset(line, LV_OPA_COVER, size);
+        lv_draw_mask_radius(line, 0, y, size, &param);
+        lv_memcpy(&c->corner_tile[(size - 1 - y) * size], line, size);
+    }
+}
+
+/**
+ * Find the circle of a radius: first among the ones pinned for the refresh without a lock,
+ * then in the cache. A circle taken from the cache is pinned if there is a free slot,
+ * else the caller gets the cache entry to release.
+ */
+static lv_draw_sw_mask_radius_circle_dsc_t * circle_get(int32_t radius, lv_cache_entry_t ** own_entry)
+{
+#if LV_DRAW_SW_CIRCLE_CACHE_SIZE == 0
+    LV_UNUSED(radius);
+    LV_UNUSED(own_entry);
+    return NULL;
+#else
+    uint32_t start = (uint32_t)radius % LV_DRAW_SW_CIRCLE_HOT_SLOTS;
+    uint32_t i;
+
+    /*Slots are only filled during the refresh, so the first empty one ends the search*/
+    for(i = 0; i < LV_DRAW_SW_CIRCLE_HOT_SLOTS; i++) {
+        lv_cache_entry_t * entry = CIRCLE_HOT_LOAD(&_circle_hot[(start + i) % LV_DRAW_SW_CIRCLE_HOT_SLOTS]);
+        if(entry == NULL) break;
+        lv_draw_sw_mask_radius_circle_dsc_t * c = lv_cache_entry_get_data(entry);
+        if(c->radius == radius) return c;
+    }
+
+    lv_draw_sw_mask_radius_circle_dsc_t search_key;
+    lv_memzero(&search_key, sizeof(search_key));
+    search_key.radius = radius;
+    lv_cache_entry_t * entry = lv_cache_acquire_or_create(_circle_cache, &search_key, NULL);
+    if(entry == NULL) return NULL;
+
+    /*Hand the reference over to the slot. If an other thread was faster, keep it for the caller.*/
+    for(; i < LV_DRAW_SW_CIRCLE_HOT_SLOTS; i++) {
+        lv_cache_entry_t * expected = NULL;
+        if(CIRCLE_HOT_PUBLISH(&_circle_hot[(start + i) % LV_DRAW_SW_CIRCLE_HOT_SLOTS], &expected, entry)) {
+            return lv_cache_entry_get_data(entry);
+        }
+        if(expected == NULL) break;
+        lv_draw_sw_mask_radius_circle_dsc_t * c = lv_cache_entry_get_data(expected);
+        if(c->radius == radius) break;
+    }
+
+    *own_entry = entry;
+    return lv_cache_entry_get_data(entry);
+#endif
+}
+
+static bool circle_create_cb(lv_draw_sw_mask_radius_circle_dsc_t * c, void * user_data)
+{
+    LV_UNUSED(user_data);
+
+    circ_calc_aa4(c, c->radius);
+    if(c->radius <= LV_DRAW_SW_CORNER_TILE_MAX_RADIUS) corner_tile_calc(c);
+    return true;
+}
+
+static void circle_free_cb(lv_draw_sw_mask_radius_circle_dsc_t * c, void * user_data)
+{
+    LV_UNUSED(user_data);
+
+    lv_free(c->buf);
+    lv_free(c->corner_tile);
+    c->buf = NULL;
+    c->corner_tile = NULL;
+}
+
+static lv_cache_compare_res_t circle_compare_cb(const lv_draw_sw_mask_radius_circle_dsc_t * lhs,
+                                                const lv_draw_sw_mask_radius_circle_dsc_t * rhs)
+{
+    if(lhs->radius != rhs->radius) {
+        return lhs->radius > rhs->radius ? 1 : -1;
+    }
+    return 0;
+}
+
 static lv_opa_t * get_next_line(lv_draw_sw_mask_radius_circle_dsc_t * c, int32_t y, int32_t * len,
                                 int32_t * x_start)
 {
@@ -22,17 +22,36 @@ extern "C" {
  *      DEFINES
  *********************/
 
+/** Slots of the lock-free table of the circles pinned for the current refresh */
+#define LV_DRAW_SW_CIRCLE_HOT_SLOTS     LV_MAX(LV_DRAW_SW_CIRCLE_CACHE_SIZE, 1)
+
+/** Extra cache entries for the circles used while all the slots are taken:
+ *  a draw unit uses at most two radius masks at once (e.g. the outer and inner radius of a border) */
+#define LV_DRAW_SW_CIRCLE_CACHE_EXTRA   (LV_DRAW_SW_DRAW_UNIT_CNT * 2)
+
+/** Radius up to which a circle has a corner tile too, the tile takes (2 * radius)^2 bytes */
+#define LV_DRAW_SW_CORNER_TILE_MAX_RADIUS   64
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+/** A horizontal run of pixels in a row of a shape with the same coverage */
+typedef struct {
+    int32_t y;
+    int32_t x_start;
+    int32_t x_end;
+    lv_opa_t coverage;          /**< LV_OPA_TRANSP if the span is empty */
+} lv_draw_sw_span_t;
+
 typedef struct  {
     uint8_t * buf;
     lv_opa_t * cir_opa;         /**< Opacity of values on the circumference of an 1/4 circle */
     uint16_t * x_start_on_y;    /**< The x coordinate of the circle for each y value */
     uint16_t * opa_start_on_y;  /**< The index of `cir_opa` for each y value */
-    int32_t life;               /**< How many times the entry way used */
-    uint32_t used_cnt;          /**< Like a semaphore to count the referencing masks */
+    lv_opa_t * corner_tile;     /**< The radius mask of a (2 * radius) x (2 * radius) square, i.e. the four corners of
+                                 *   every rectangle with this radius. NULL if the radius is larger than
+                                 *   `LV_DRAW_SW_CORNER_TILE_MAX_RADIUS` */
     int32_t radius;             /**< The radius of the entry */
 } lv_draw_sw_mask_radius_circle_dsc_t;
 
@@ -106,6 +125,13 @@ struct _lv_draw_sw_mask_radius_param_t {
     } cfg;
 
     lv_draw_sw_mask_radius_circle_dsc_t * circle;
+
+    /** The cache entry of `circle` to release when the mask is freed. NULL if the circle is pinned for the refresh
+     *  or it is a temporary one */
+    lv_cache_entry_t * circle_entry;
+
+    /** 1: `circle` is not cached (the cache was full), it's freed with the mask */
+    uint8_t circle_temp : 1;
 };
 
 struct _lv_draw_sw_mask_fade_param_t {
@@ -132,7 +158,7 @@ struct _lv_draw_sw_mask_map_param_t {
     } cfg;
 };
 
-typedef lv_draw_sw_mask_radius_circle_dsc_t lv_draw_sw_mask_radius_circle_dsc_arr_t[LV_DRAW_SW_CIRCLE_CACHE_SIZE];
+typedef lv_cache_entry_t * lv_draw_sw_mask_circle_hot_arr_t[LV_DRAW_SW_CIRCLE_HOT_SLOTS];
 
 /**********************
  * GLOBAL PROTOTYPES
@@ -144,6 +170,26 @@ typedef lv_draw_sw_mask_radius_circle_dsc_t lv_draw_sw_mask_radius_circle_dsc_ar
  */
 void lv_draw_sw_mask_cleanup(void);
 
+/**
+ * Get the corner tile of a radius mask: its coverage on a (2 * radius) x (2 * radius) square.
+ * The top left corner of a rectangle with this radius is the top left quarter of the tile, etc.
+ * It's valid until the mask is freed.
+ * @param param     an initialized radius mask
+ * @return          the corner tile, or NULL if the radius is 0 or too large to have one
+ */
+const lv_opa_t * lv_draw_sw_mask_radius_get_corner_tile(const lv_draw_sw_mask_radius_param_t * param);
+
+/**
+ * Get the fully covered span of a row of a (not inverted) radius mask,
+ * i.e. the pixels between the anti-aliased edges which the mask leaves unchanged.
+ * @param param     an initialized radius mask with `outer == false`
+ * @param abs_y     the row
+ * @param span      store the span here. Its coverage is LV_OPA_COVER, or LV_OPA_TRANSP if
+ *                  no pixel of the row is fully covered.
+ */
+void lv_draw_sw_mask_radius_get_cover_span(const lv_draw_sw_mask_radius_param_t * param, int32_t abs_y,
+                                           lv_draw_sw_span_t * span);
+
 /**********************
  *      MACROS
  **********************/
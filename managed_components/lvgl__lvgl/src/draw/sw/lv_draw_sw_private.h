@@ -23,6 +23,9 @@ extern "C" {
  *      DEFINES
  *********************/
 
+/** Number of ready draw tasks a render thread can hold in its own queue*/
+#define LV_DRAW_SW_THREAD_QUEUE_SIZE    8
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -39,6 +42,15 @@ typedef struct {
     uint32_t idx;
     volatile bool inited;
     volatile bool exit_status;
+
+    /**
+     * Ready draw tasks of this thread. The thread takes the newest one,
+     * the other threads steal the oldest one when they run out of tasks.
+     * Protected by `lv_draw_lock_tasks()`.
+     */
+    lv_draw_task_t * queue[LV_DRAW_SW_THREAD_QUEUE_SIZE];
+    uint32_t queue_head;
+    volatile uint32_t queue_cnt;
 } lv_draw_sw_thread_dsc_t;
 
 struct _lv_draw_sw_unit_t {
@@ -392,6 +392,17 @@
     #endif
 #endif
 
+/** Pin the drawing threads to the CPU cores in turn: thread `i` runs on core `i % core count`.
+ *  With `LV_DRAW_SW_DRAW_UNIT_CNT` set to the core count every core renders.
+ *  Only supported with `LV_OS_FREERTOS` on SMP targets (ESP-IDF), ignored otherwise. */
+#ifndef LV_DRAW_THREAD_PIN_CORES
+    #ifdef CONFIG_LV_DRAW_THREAD_PIN_CORES
+        #define LV_DRAW_THREAD_PIN_CORES CONFIG_LV_DRAW_THREAD_PIN_CORES
+    #else
+        #define LV_DRAW_THREAD_PIN_CORES 0
+    #endif
+#endif
+
 #ifndef LV_USE_DRAW_SW
     #ifdef LV_KCONFIG_PRESENT
         #ifdef CONFIG_LV_USE_DRAW_SW
@@ -605,6 +616,8 @@
         /** Set number of maximally-cached circle data.
          *  The circumference of 1/4 circle are saved for anti-aliasing.
          *  `radius * 4` bytes are used per circle (the most often used radiuses are saved).
+         *  Up to radius 64 the corners are saved too, `(2 * radius)^2` bytes per circle,
+         *  to fill rounded rectangles without line masks.
          *  - 0: disables caching */
         #ifndef LV_DRAW_SW_CIRCLE_CACHE_SIZE
             #ifdef CONFIG_LV_DRAW_SW_CIRCLE_CACHE_SIZE
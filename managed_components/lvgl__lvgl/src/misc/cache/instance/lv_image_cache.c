@@ -33,6 +33,7 @@
 
 static lv_cache_compare_res_t image_cache_compare_cb(const lv_image_cache_data_t * lhs,
                                                      const lv_image_cache_data_t * rhs);
+static bool image_cache_create_cb(lv_image_cache_data_t * entry, void * user_data);
 static void image_cache_free_cb(lv_image_cache_data_t * entry, void * user_data);
 static void iter_inspect_cb(void * elem);
 
@@ -61,7 +62,7 @@ lv_result_t lv_image_cache_init(uint32_t size)
     img_cache_p = lv_cache_create(&lv_cache_class_lru_rb_size,
     sizeof(lv_image_cache_data_t), size, (lv_cache_ops_t) {
         .compare_cb = (lv_cache_compare_cb_t) image_cache_compare_cb,
-        .create_cb = NULL,
+        .create_cb = (lv_cache_create_cb_t) image_cache_create_cb,
         .free_cb = (lv_cache_free_cb_t) image_cache_free_cb,
     });
 
@@ -146,6 +147,20 @@ static lv_cache_compare_res_t image_cache_compare_cb(
     return image_cache_common_compare(lhs->src, lhs->src_type, rhs->src, rhs->src_type);
 }
 
+static bool image_cache_create_cb(lv_image_cache_data_t * entry, void * user_data)
+{
+    /*`user_data` is the decoded image to cache, see `lv_image_decoder_add_to_cache()`*/
+    const lv_image_cache_data_t * decoded_data = user_data;
+    entry->decoded = decoded_data->decoded;
+    entry->decoder = decoded_data->decoder;
+    entry->user_data = decoded_data->user_data; /*Need to free data on cache invalidate instead of decoder_close*/
+
+    /*The key points to the source of the caller, keep a copy of the file name*/
+    if(entry->src_type == LV_IMAGE_SRC_FILE) entry->src = lv_strdup(entry->src);
+
+    return true;
+}
+
 static void image_cache_free_cb(lv_image_cache_data_t * entry, void * user_data)
 {
     LV_UNUSED(user_data);
@@ -86,10 +86,30 @@ lv_result_t lv_thread_init(lv_thread_t * pxThread,  const char * const name,
                            lv_thread_prio_t xSchedPriority,
                            void (*pvStartRoutine)(void *), size_t usStackSize,
                            void * xAttr)
+{
+    return lv_freertos_thread_init_pinned(pxThread, name, xSchedPriority, pvStartRoutine, usStackSize, xAttr, -1);
+}
+
+lv_result_t lv_freertos_thread_init_pinned(lv_thread_t * pxThread, const char * const name,
+                                           lv_thread_prio_t xSchedPriority,
+                                           void (*pvStartRoutine)(void *), size_t usStackSize,
+                                           void * xAttr, int32_t lCore)
 {
     pxThread->pTaskArg = xAttr;
     pxThread->pvStartRoutine = pvStartRoutine;
 
+#if defined(ESP_PLATFORM) && (portNUM_PROCESSORS > 1)
+    BaseType_t xCoreID = lCore < 0 ? tskNO_AFFINITY : (BaseType_t)(lCore % portNUM_PROCESSORS);
+    BaseType_t xTaskCreateStatus = xTaskCreatePinnedToCore(
+                                       prvRunThread,
+                                       name,
+                                       (configSTACK_DEPTH_TYPE)(usStackSize / sizeof(StackType_t)),
+                                       (void *)pxThread,
+                                       tskIDLE_PRIORITY + xSchedPriority,
+                                       &pxThread->xTaskHandle,
+                                       xCoreID);
+#else
+    LV_UNUSED(lCore);
     BaseType_t xTaskCreateStatus = xTaskCreate(
                                        prvRunThread,
                                        name,
@@ -97,6 +117,7 @@ lv_result_t lv_thread_init(lv_thread_t * pxThread,  const char * const name,
                                        (void *)pxThread,
                                        tskIDLE_PRIORITY + xSchedPriority,
                                        &pxThread->xTaskHandle);
+#endif
 
     /* Ensure that the FreeRTOS task was successfully created. */
     if(xTaskCreateStatus != pdPASS) {
@@ -136,6 +157,21 @@ lv_result_t lv_mutex_lock(lv_mutex_t * pxMutex)
     return LV_RESULT_OK;
 }
 
+lv_result_t lv_freertos_lock_timeout(uint32_t timeout_ms)
+{
+    lv_mutex_t * pxMutex = &LV_GLOBAL_DEFAULT()->lv_general_mutex;
+
+    /* If mutex in uninitialized, perform initialization. */
+    prvCheckMutexInit(pxMutex);
+
+    BaseType_t xMutexTakeStatus = xSemaphoreTakeRecursive(pxMutex->xMutex, pdMS_TO_TICKS(timeout_ms));
+    if(xMutexTakeStatus != pdTRUE) {
+        return LV_RESULT_INVALID;
+    }
+
+    return LV_RESULT_OK;
+}
+
 lv_result_t lv_mutex_lock_isr(lv_mutex_t * pxMutex)
 {
     /* If mutex in uninitialized, perform initialization. */
@@ -87,6 +87,24 @@ lv_result_t lv_thread_init(lv_thread_t * thread, const char * const name,
                            lv_thread_prio_t prio, void (*callback)(void *), size_t stack_size,
                            void * user_data);
 
+#if LV_USE_OS == LV_OS_FREERTOS
+/**
+ * Create a new thread pinned to a CPU core. Same as `lv_thread_init()` but on SMP FreeRTOS
+ * (ESP-IDF) the thread only runs on core `core % core count`; elsewhere `core` is ignored.
+ * @param thread        a variable in which the thread will be stored
+ * @param name          the name of the thread
+ * @param prio          priority of the thread
+ * @param callback      function of the thread
+ * @param stack_size    stack size in bytes
+ * @param user_data     arbitrary data, will be available in the callback
+ * @param core          core to run on, -1 for any core
+ * @return              LV_RESULT_OK: success; LV_RESULT_INVALID: failure
+ */
+lv_result_t lv_freertos_thread_init_pinned(lv_thread_t * thread, const char * const name,
+                                           lv_thread_prio_t prio, void (*callback)(void *), size_t stack_size,
+                                           void * user_data, int32_t core);
+#endif
+
 /**
  * Delete a thread
  * @param thread        the thread to delete
@@ -180,6 +198,15 @@ void lv_lock(void);
  */
 lv_result_t lv_lock_isr(void);
 
+#if LV_USE_OS == LV_OS_FREERTOS
+/**
+ * Same as `lv_lock()` but gives up after a timeout.
+ * @param timeout_ms    maximum time to wait in milliseconds, 0: don't wait
+ * @return              LV_RESULT_OK: the mutex is taken; LV_RESULT_INVALID: timeout
+ */
+lv_result_t lv_freertos_lock_timeout(uint32_t timeout_ms);
+#endif
+
 /**
  * The pair of `lv_lock()` and `lv_lock_isr()`.
  * It unlocks LVGL general mutex.
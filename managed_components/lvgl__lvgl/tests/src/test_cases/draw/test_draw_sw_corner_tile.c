@@ -0,0 +1,229 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../../lvgl_private.h"
+
+#include "unity/unity.h"
+#include "draw_helpers/lv_test_draw_helpers.h"
+
+#include <stdio.h>
+
+/* Rounded rectangles without gradient are filled by blending the corners from the cached
+ * corner tiles of the circles and filling the rest without mask.
+ *
+ * The correctness tests draw on a transparent ARGB8888 canvas, where the alpha of a pixel is
+ * the coverage of the rectangle, and compare it with the radius mask applied line by line.
+ * The benchmark prints how many "cards" (rounded rectangles of a typical dashboard) are drawn
+ * per second, and for reference the same with a vertical gradient which still uses the line masks.
+ */
+
+#define CANVAS_W        320
+#define CANVAS_H        240
+#define BENCH_CARDS     100
+#define BENCH_FRAMES    50
+
+static uint8_t ref_buf[CANVAS_W * CANVAS_H];
+static uint32_t rnd_state;
+
+void setUp(void)
+{
+    /* Function run before every test */
+    rnd_state = 0x12345678;
+
+    /*Release the circles pinned by the previous tests as at the end of a refresh*/
+    lv_draw_sw_mask_cleanup();
+}
+
+void tearDown(void)
+{
+    /* Function run after every test */
+    lv_obj_clean(lv_screen_active());
+}
+
+static uint32_t rnd(void)
+{
+    /*xorshift32*/
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+static lv_obj_t * canvas_create(void)
+{
+    LV_DRAW_BUF_DEFINE_STATIC(canvas_buf, CANVAS_W, CANVAS_H, LV_COLOR_FORMAT_ARGB8888);
+    LV_DRAW_BUF_INIT_STATIC(canvas_buf);
+
+    lv_obj_t * canvas = lv_canvas_create(lv_screen_active());
+    lv_canvas_set_draw_buf(canvas, &canvas_buf);
+    return canvas;
+}
+
+static void fill_and_compare(lv_obj_t * canvas, const lv_area_t * coords, int32_t radius, lv_opa_t opa)
+{
+    lv_canvas_fill_bg(canvas, lv_color_black(), LV_OPA_TRANSP);
+
+    lv_layer_t layer;
+    lv_canvas_init_layer(canvas, &layer);
+    lv_draw_fill_dsc_t fill_dsc;
+    lv_draw_fill_dsc_init(&fill_dsc);
+    fill_dsc.color = lv_color_hex(0x3080c0);
+    fill_dsc.radius = radius;
+    fill_dsc.opa = opa;
+    lv_draw_fill(&layer, &fill_dsc, coords);
+    lv_canvas_finish_layer(canvas, &layer);
+
+    lv_test_radius_ref_fill(ref_buf, CANVAS_W, CANVAS_H, coords, radius, opa);
+
+    char msg[96];
+    lv_snprintf(msg, sizeof(msg), "area %" LV_PRId32 ";%" LV_PRId32 " %" LV_PRId32 "x%" LV_PRId32
+                ", radius %" LV_PRId32 ", opa %d",
+                coords->x1, coords->y1, lv_area_get_width(coords), lv_area_get_height(coords), radius, opa);
+
+    if(!lv_test_alpha_compare(lv_canvas_get_draw_buf(canvas), ref_buf)) TEST_FAIL_MESSAGE(msg);
+}
+
+void test_draw_sw_corner_tile_matches_radius_mask(void)
+{
+    static const int32_t radii[] = {1, 2, 3, 5, 8, 13, 24, 40, LV_DRAW_SW_CORNER_TILE_MAX_RADIUS,
+                                    LV_DRAW_SW_CORNER_TILE_MAX_RADIUS + 1, 100
+                                   };
+    static const lv_opa_t opas[] = {LV_OPA_COVER, 252, LV_OPA_50, 3};
+
+    lv_obj_t * canvas = canvas_create();
+
+    uint32_t r;
+    for(r = 0; r < sizeof(radii) / sizeof(radii[0]); r++) {
+        int32_t radius = radii[r];
+        /*The shorter side exactly 2 * radius, larger with odd and even sizes, and smaller than 2 * radius*/
+        const int32_t sizes[][2] = {
+            {radius * 2, radius * 2}, {radius * 2 + 1, radius * 2 + 7}, {radius * 2 + 30, radius * 2},
+            {radius * 3 + 11, radius * 2 + 4}, {radius + 1, radius * 2 + 3},
+        };
+        uint32_t s;
+        for(s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            uint32_t o;
+            for(o = 0; o < sizeof(opas) / sizeof(opas[0]); o++) {
+                lv_area_t coords;
+                lv_area_set(&coords, 0, 0, sizes[s][0] - 1, sizes[s][1] - 1);
+                lv_area_move(&coords, 7 + (int32_t)(rnd() % 13), 5 + (int32_t)(rnd() % 11));
+                fill_and_compare(canvas, &coords, radius, opas[o]);
+            }
+        }
+    }
+}
+
+void test_draw_sw_corner_tile_clipped(void)
+{
+    lv_obj_t * canvas = canvas_create();
+
+    /*Partly out of the canvas on every side*/
+    uint32_t i;
+    for(i = 0; i < 200; i++) {
+        int32_t w = 2 + (int32_t)(rnd() % 120);
+        int32_t h = 2 + (int32_t)(rnd() % 120);
+        lv_area_t coords;
+        coords.x1 = (int32_t)(rnd() % (CANVAS_W + w)) - w;
+        coords.y1 = (int32_t)(rnd() % (CANVAS_H + h)) - h;
+        coords.x2 = coords.x1 + w - 1;
+        coords.y2 = coords.y1 + h - 1;
+        int32_t radius = 1 + (int32_t)(rnd() % 70);
+        lv_opa_t opa = i % 2 ? LV_OPA_COVER : (lv_opa_t)(4 + rnd() % 248);
+        fill_and_compare(canvas, &coords, radius, opa);
+    }
+}
+
+void test_draw_sw_corner_tile_circle_cache(void)
+{
+    /*Keep more circles in use than the cache can hold: the rest is allocated temporarily*/
+    enum { CACHED_CNT = LV_DRAW_SW_CIRCLE_HOT_SLOTS + LV_DRAW_SW_CIRCLE_CACHE_EXTRA, PARAM_CNT = CACHED_CNT + 4 };
+    lv_draw_sw_mask_radius_param_t params[PARAM_CNT];
+    lv_area_t coords;
+    lv_area_set(&coords, 0, 0, 199, 199);
+
+    int32_t i;
+    for(i = 0; i < PARAM_CNT; i++) {
+        lv_draw_sw_mask_radius_init(&params[i], &coords, 10 + i, false);
+        TEST_ASSERT_NOT_NULL(params[i].circle);
+        TEST_ASSERT_EQUAL_INT32(10 + i, params[i].circle->radius);
+    }
+    for(i = 0; i < PARAM_CNT; i++) {
+        if(i < CACHED_CNT) TEST_ASSERT_NOT_NULL(lv_draw_sw_mask_radius_get_corner_tile(&params[i]));
+        else TEST_ASSERT_NULL(lv_draw_sw_mask_radius_get_corner_tile(&params[i]));
+    }
+
+    /*The same radius again gives the same circle*/
+    lv_draw_sw_mask_radius_param_t again;
+    lv_draw_sw_mask_radius_init(&again, &coords, 10, false);
+    TEST_ASSERT_EQUAL_PTR(params[0].circle, again.circle);
+    lv_draw_sw_mask_free_param(&again);
+
+    const lv_draw_sw_mask_radius_circle_dsc_t * first = params[0].circle;
+    for(i = 0; i < PARAM_CNT; i++) lv_draw_sw_mask_free_param(&params[i]);
+
+    /*After the refresh the circle stays in the cache*/
+    lv_draw_sw_mask_cleanup();
+    lv_draw_sw_mask_radius_init(&again, &coords, 10, false);
+    TEST_ASSERT_EQUAL_PTR(first, again.circle);
+    lv_draw_sw_mask_free_param(&again);
+
+    /*New radii evict the old ones once they are not pinned anymore*/
+    lv_draw_sw_mask_cleanup();
+    for(i = 0; i < CACHED_CNT; i++) {
+        lv_draw_sw_mask_radius_init(&again, &coords, 50 + i, false);
+        TEST_ASSERT_NOT_NULL(lv_draw_sw_mask_radius_get_corner_tile(&again));
+        lv_draw_sw_mask_free_param(&again);
+        lv_draw_sw_mask_cleanup();
+    }
+}
+
+static double bench_cards(lv_obj_t * canvas, lv_grad_dir_t grad_dir)
+{
+    static const int32_t radii[] = {4, 8, 12, 16, 24};
+
+    lv_draw_rect_dsc_t rect_dsc;
+    lv_draw_rect_dsc_init(&rect_dsc);
+    rect_dsc.bg_color = lv_color_hex(0x2a3040);
+    rect_dsc.bg_grad.dir = grad_dir;
+    rect_dsc.bg_grad.stops_count = 2;
+    rect_dsc.bg_grad.stops[0].color = lv_color_hex(0x2a3040);
+    rect_dsc.bg_grad.stops[0].opa = LV_OPA_COVER;
+    rect_dsc.bg_grad.stops[1].color = lv_color_hex(0x404860);
+    rect_dsc.bg_grad.stops[1].opa = LV_OPA_COVER;
+    rect_dsc.bg_grad.stops[1].frac = 255;
+
+    uint64_t t_start = lv_test_time_us();
+    uint32_t frame;
+    for(frame = 0; frame < BENCH_FRAMES; frame++) {
+        rnd_state = 0x12345678;
+        lv_layer_t layer;
+        lv_canvas_init_layer(canvas, &layer);
+        uint32_t i;
+        for(i = 0; i < BENCH_CARDS; i++) {
+            lv_area_t area;
+            area.x1 = (int32_t)(rnd() % (CANVAS_W - 60));
+            area.y1 = (int32_t)(rnd() % (CANVAS_H - 40));
+            area.x2 = area.x1 + 59 + (int32_t)(rnd() % 60);
+            area.y2 = area.y1 + 39 + (int32_t)(rnd() % 40);
+            rect_dsc.radius = radii[i % (sizeof(radii) / sizeof(radii[0]))];
+            lv_draw_rect(&layer, &rect_dsc, &area);
+        }
+        lv_canvas_finish_layer(canvas, &layer);
+        lv_draw_sw_mask_cleanup();
+    }
+    uint64_t elapsed_us = lv_test_time_us() - t_start;
+
+    return (double)BENCH_CARDS * BENCH_FRAMES * 1000000.0 / (double)elapsed_us;
+}
+
+void test_draw_sw_corner_tile_benchmark(void)
+{
+    lv_obj_t * canvas = canvas_create();
+    lv_canvas_fill_bg(canvas, lv_color_black(), LV_OPA_COVER);
+
+    double tile = bench_cards(canvas, LV_GRAD_DIR_NONE);
+    double line_mask = bench_cards(canvas, LV_GRAD_DIR_VER);
+
+    printf("cards/sec: %.0f with corner tiles, %.0f with line masks (vertical gradient)\n", tile, line_mask);
+}
+
+#endif
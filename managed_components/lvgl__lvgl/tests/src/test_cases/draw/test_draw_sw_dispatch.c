@@ -0,0 +1,153 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../../lvgl_private.h"
+
+#include "unity/unity.h"
+#include "draw_helpers/lv_test_draw_helpers.h"
+
+#include <stdio.h>
+
+/* Stress the SW draw task dispatcher with thousands of small, overlapping draw tasks.
+ *
+ * The correctness test checks that overlapping tasks are still drawn in the order
+ * they were added, no matter which render thread takes them.
+ * The benchmark prints the time per frame. To see how it scales, build the tests with
+ * different number of render threads and compare the outputs, e.g.:
+ *
+ *   cmake -S tests -B build_8 -DOPTIONS_TEST_SYSHEAP=1 -DLVGL_TEST_DRAW_UNIT_CNT=8
+ *   cmake --build build_8 --target test_draw_sw_dispatch && ./build_8/test_draw_sw_dispatch
+ */
+
+#define CANVAS_W        240
+#define CANVAS_H        240
+#define FILL_CNT        3000
+#define LABEL_CNT       400
+#define BENCH_FRAMES    10
+
+static uint32_t ref_buf[CANVAS_W * CANVAS_H];
+static uint32_t rnd_state;
+
+void setUp(void)
+{
+    /* Function run before every test */
+    rnd_state = 0x12345678;
+}
+
+void tearDown(void)
+{
+    /* Function run after every test */
+    lv_obj_clean(lv_screen_active());
+}
+
+static uint32_t rnd(void)
+{
+    /*xorshift32*/
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+static void random_area(lv_area_t * area, int32_t max_size)
+{
+    int32_t w = 2 + rnd() % max_size;
+    int32_t h = 2 + rnd() % max_size;
+    area->x1 = (int32_t)(rnd() % CANVAS_W) - w / 2;
+    area->y1 = (int32_t)(rnd() % CANVAS_H) - h / 2;
+    area->x2 = area->x1 + w - 1;
+    area->y2 = area->y1 + h - 1;
+}
+
+static lv_obj_t * canvas_create(void)
+{
+    LV_DRAW_BUF_DEFINE_STATIC(canvas_buf, CANVAS_W, CANVAS_H, LV_COLOR_FORMAT_ARGB8888);
+    LV_DRAW_BUF_INIT_STATIC(canvas_buf);
+
+    lv_obj_t * canvas = lv_canvas_create(lv_screen_active());
+    lv_canvas_set_draw_buf(canvas, &canvas_buf);
+    lv_canvas_fill_bg(canvas, lv_color_black(), LV_OPA_COVER);
+    return canvas;
+}
+
+/*Add opaque fills and paint them to `ref_buf` too in the order they were added*/
+static void add_fills(lv_layer_t * layer, uint32_t cnt, bool paint_ref)
+{
+    lv_draw_fill_dsc_t fill_dsc;
+    lv_draw_fill_dsc_init(&fill_dsc);
+    fill_dsc.opa = LV_OPA_COVER;
+
+    uint32_t i;
+    for(i = 0; i < cnt; i++) {
+        lv_area_t area;
+        random_area(&area, 24);
+        uint32_t c = rnd() & 0xffffff;
+        fill_dsc.color = lv_color_hex(c);
+        lv_draw_fill(layer, &fill_dsc, &area);
+
+        if(!paint_ref) continue;
+        int32_t x, y;
+        for(y = LV_MAX(area.y1, 0); y <= LV_MIN(area.y2, CANVAS_H - 1); y++) {
+            for(x = LV_MAX(area.x1, 0); x <= LV_MIN(area.x2, CANVAS_W - 1); x++) {
+                ref_buf[y * CANVAS_W + x] = 0xff000000 | c;
+            }
+        }
+    }
+}
+
+static void add_labels(lv_layer_t * layer, uint32_t cnt)
+{
+    static const char * texts[] = {"12", "OK", "kW", "99%", "Wi-Fi", "A", "-3.5"};
+
+    lv_draw_label_dsc_t label_dsc;
+    lv_draw_label_dsc_init(&label_dsc);
+
+    uint32_t i;
+    for(i = 0; i < cnt; i++) {
+        lv_area_t area;
+        random_area(&area, 40);
+        label_dsc.color = lv_color_hex(rnd() & 0xffffff);
+        label_dsc.text = texts[i % (sizeof(texts) / sizeof(texts[0]))];
+        lv_draw_label(layer, &label_dsc, &area);
+    }
+}
+
+void test_draw_sw_dispatch_keeps_order_of_overlapping_tasks(void)
+{
+    lv_obj_t * canvas = canvas_create();
+
+    uint32_t i;
+    for(i = 0; i < CANVAS_W * CANVAS_H; i++) ref_buf[i] = 0xff000000;
+
+    lv_layer_t layer;
+    lv_canvas_init_layer(canvas, &layer);
+    add_fills(&layer, FILL_CNT, true);
+    lv_canvas_finish_layer(canvas, &layer);
+
+    lv_draw_buf_t * draw_buf = lv_canvas_get_draw_buf(canvas);
+    uint32_t y;
+    for(y = 0; y < CANVAS_H; y++) {
+        const uint32_t * row = (const uint32_t *)(draw_buf->data + y * draw_buf->header.stride);
+        TEST_ASSERT_EQUAL_HEX32_ARRAY(&ref_buf[y * CANVAS_W], row, CANVAS_W);
+    }
+}
+
+void test_draw_sw_dispatch_benchmark(void)
+{
+    lv_obj_t * canvas = canvas_create();
+
+    uint64_t t_start = lv_test_time_us();
+    uint32_t frame;
+    for(frame = 0; frame < BENCH_FRAMES; frame++) {
+        lv_layer_t layer;
+        lv_canvas_init_layer(canvas, &layer);
+        add_fills(&layer, FILL_CNT, false);
+        add_labels(&layer, LABEL_CNT);
+        lv_canvas_finish_layer(canvas, &layer);
+    }
+    uint64_t elapsed_us = lv_test_time_us() - t_start;
+
+    printf("draw units: %d, tasks/frame: %d, %.2f ms/frame\n", LV_DRAW_SW_DRAW_UNIT_CNT,
+           FILL_CNT + LABEL_CNT, (double)elapsed_us / BENCH_FRAMES / 1000.0);
+}
+
+#endif
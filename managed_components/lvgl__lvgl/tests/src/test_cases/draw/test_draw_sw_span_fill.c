@@ -0,0 +1,217 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../../lvgl_private.h"
+
+#include "unity/unity.h"
+#include "draw_helpers/lv_test_draw_helpers.h"
+
+#include <stdio.h>
+
+/* Solid fills are drawn in spans: rows of rounded rectangles which still use the line masks
+ * (large radius or vertical gradient) mask only their anti-aliased edges, and the
+ * fully covered span between them is filled without mask. Fills of full rows are
+ * blended as one long span.
+ *
+ * The correctness tests compare the result with the radius mask applied on the whole rows
+ * (`lv_test_radius_ref_fill()`) and with plain pixel loops.
+ * The benchmark prints the time of frames similar to the rectangle scenes of `demos/benchmark`.
+ */
+
+#define CANVAS_W        320
+#define CANVAS_H        240
+#define BENCH_W         480
+#define BENCH_H         480
+#define BENCH_FRAMES    100
+
+static uint8_t ref_buf[CANVAS_W * CANVAS_H];
+static uint32_t rnd_state;
+
+void setUp(void)
+{
+    /* Function run before every test */
+    rnd_state = 0x12345678;
+}
+
+void tearDown(void)
+{
+    /* Function run after every test */
+    lv_obj_clean(lv_screen_active());
+}
+
+static uint32_t rnd(void)
+{
+    /*xorshift32*/
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+static void fill_and_compare(lv_obj_t * canvas, const lv_area_t * coords, int32_t radius, lv_opa_t opa,
+                             lv_grad_dir_t grad_dir)
+{
+    lv_canvas_fill_bg(canvas, lv_color_black(), LV_OPA_TRANSP);
+
+    lv_layer_t layer;
+    lv_canvas_init_layer(canvas, &layer);
+    lv_draw_rect_dsc_t rect_dsc;
+    lv_draw_rect_dsc_init(&rect_dsc);
+    rect_dsc.bg_color = lv_color_hex(0x3080c0);
+    rect_dsc.bg_opa = opa;
+    rect_dsc.radius = radius;
+    rect_dsc.bg_grad.dir = grad_dir;
+    rect_dsc.bg_grad.stops_count = 2;
+    rect_dsc.bg_grad.stops[0].color = lv_color_hex(0x3080c0);
+    rect_dsc.bg_grad.stops[0].opa = LV_OPA_COVER;
+    rect_dsc.bg_grad.stops[1].color = lv_color_hex(0xc04020);
+    rect_dsc.bg_grad.stops[1].opa = LV_OPA_COVER;
+    rect_dsc.bg_grad.stops[1].frac = 255;
+    lv_draw_rect(&layer, &rect_dsc, coords);
+    lv_canvas_finish_layer(canvas, &layer);
+
+    lv_test_radius_ref_fill(ref_buf, CANVAS_W, CANVAS_H, coords, radius, opa);
+
+    char msg[112];
+    lv_snprintf(msg, sizeof(msg), "area %" LV_PRId32 ";%" LV_PRId32 " %" LV_PRId32 "x%" LV_PRId32
+                ", radius %" LV_PRId32 ", opa %d, grad %d",
+                coords->x1, coords->y1, lv_area_get_width(coords), lv_area_get_height(coords), radius, opa, grad_dir);
+
+    if(!lv_test_alpha_compare(lv_canvas_get_draw_buf(canvas), ref_buf)) TEST_FAIL_MESSAGE(msg);
+}
+
+void test_draw_sw_span_fill_matches_radius_mask(void)
+{
+    LV_DRAW_BUF_DEFINE_STATIC(canvas_buf, CANVAS_W, CANVAS_H, LV_COLOR_FORMAT_ARGB8888);
+    LV_DRAW_BUF_INIT_STATIC(canvas_buf);
+    lv_obj_t * canvas = lv_canvas_create(lv_screen_active());
+    lv_canvas_set_draw_buf(canvas, &canvas_buf);
+
+    static const lv_opa_t opas[] = {LV_OPA_COVER, 252, LV_OPA_50, 3};
+
+    /*Large radii use the line masks without gradient too*/
+    uint32_t i;
+    for(i = 0; i < 120; i++) {
+        int32_t w = 2 + (int32_t)(rnd() % 300);
+        int32_t h = 2 + (int32_t)(rnd() % 300);
+        lv_area_t coords;
+        coords.x1 = (int32_t)(rnd() % (CANVAS_W + w)) - w;
+        coords.y1 = (int32_t)(rnd() % (CANVAS_H + h)) - h;
+        coords.x2 = coords.x1 + w - 1;
+        coords.y2 = coords.y1 + h - 1;
+        int32_t radius = i % 4 == 0 ? LV_RADIUS_CIRCLE : 1 + (int32_t)(rnd() % 160);
+        /*The straight part of gradients scales the opacity with LV_OPA_MIX2(), test them only with full opacity*/
+        if(i % 2) fill_and_compare(canvas, &coords, radius, LV_OPA_COVER, LV_GRAD_DIR_VER);
+        else fill_and_compare(canvas, &coords, radius, opas[(i / 2) % 4], LV_GRAD_DIR_NONE);
+    }
+}
+
+static void full_row_fill_check(lv_color_format_t cf, lv_color_t color, lv_opa_t opa)
+{
+    /*A continuous buffer and one with padding at the end of the rows*/
+    static const uint32_t stride_pads[] = {0, 16};
+    uint32_t p;
+    for(p = 0; p < sizeof(stride_pads) / sizeof(stride_pads[0]); p++) {
+        uint32_t stride = lv_draw_buf_width_to_stride(CANVAS_W, cf) + stride_pads[p];
+        lv_draw_buf_t * draw_buf = lv_draw_buf_create(CANVAS_W, CANVAS_H, cf, stride);
+        TEST_ASSERT_NOT_NULL(draw_buf);
+
+        lv_obj_t * canvas = lv_canvas_create(lv_screen_active());
+        lv_canvas_set_draw_buf(canvas, draw_buf);
+        lv_canvas_fill_bg(canvas, lv_color_hex(0x102030), LV_OPA_COVER);
+
+        /*Expected: a pixel of an area filled with the same color on the same background*/
+        lv_layer_t layer;
+        lv_canvas_init_layer(canvas, &layer);
+        lv_draw_fill_dsc_t fill_dsc;
+        lv_draw_fill_dsc_init(&fill_dsc);
+        fill_dsc.color = color;
+        fill_dsc.opa = opa;
+        lv_area_t area = {10, 0, 10, 0};
+        lv_draw_fill(&layer, &fill_dsc, &area);
+
+        /*Full rows*/
+        lv_area_set(&area, 0, 20, CANVAS_W - 1, CANVAS_H - 21);
+        lv_draw_fill(&layer, &fill_dsc, &area);
+        lv_canvas_finish_layer(canvas, &layer);
+
+        uint32_t px_size = lv_color_format_get_size(cf);
+        const uint8_t * filled_px = draw_buf->data + 10 * px_size;
+        const uint8_t * bg_px = draw_buf->data + stride + 10 * px_size;
+        int32_t x, y;
+        for(y = 1; y < CANVAS_H; y++) {
+            const uint8_t * row = draw_buf->data + y * stride;
+            const uint8_t * exp_px = y >= 20 && y < CANVAS_H - 20 ? filled_px : bg_px;
+            for(x = 0; x < CANVAS_W; x++) {
+                TEST_ASSERT_EQUAL_UINT8_ARRAY(exp_px, &row[x * px_size], px_size);
+            }
+        }
+
+        lv_obj_delete(canvas);
+        lv_draw_buf_destroy(draw_buf);
+    }
+}
+
+void test_draw_sw_span_fill_full_rows(void)
+{
+    static const lv_color_format_t cfs[] = {LV_COLOR_FORMAT_RGB565, LV_COLOR_FORMAT_ARGB8888,
+                                            LV_COLOR_FORMAT_XRGB8888, LV_COLOR_FORMAT_RGB888, LV_COLOR_FORMAT_L8
+                                           };
+
+    uint32_t i;
+    for(i = 0; i < sizeof(cfs) / sizeof(cfs[0]); i++) {
+        full_row_fill_check(cfs[i], lv_color_hex(0x3080c0), LV_OPA_COVER);
+        full_row_fill_check(cfs[i], lv_color_hex(0x3080c0), LV_OPA_60);
+        full_row_fill_check(cfs[i], lv_color_black(), LV_OPA_COVER);
+        full_row_fill_check(cfs[i], lv_color_white(), LV_OPA_COVER);
+    }
+}
+
+/*A background and a grid of `cnt` x `cnt` rectangles with changing color*/
+static double bench_frames(lv_obj_t * canvas, int32_t cnt, int32_t size, int32_t radius)
+{
+    lv_draw_rect_dsc_t rect_dsc;
+    lv_draw_rect_dsc_init(&rect_dsc);
+
+    uint64_t t_start = lv_test_time_us();
+    uint32_t frame;
+    for(frame = 0; frame < BENCH_FRAMES; frame++) {
+        lv_layer_t layer;
+        lv_canvas_init_layer(canvas, &layer);
+
+        lv_area_t area = {0, 0, BENCH_W - 1, BENCH_H - 1};
+        rect_dsc.bg_color = lv_color_white();
+        rect_dsc.radius = 0;
+        lv_draw_rect(&layer, &rect_dsc, &area);
+
+        rect_dsc.radius = radius;
+        int32_t i;
+        for(i = 0; i < cnt * cnt; i++) {
+            area.x1 = (i % cnt) * BENCH_W / cnt + (BENCH_W / cnt - size) / 2;
+            area.y1 = (i / cnt) * BENCH_H / cnt + (BENCH_H / cnt - size) / 2;
+            area.x2 = area.x1 + size - 1;
+            area.y2 = area.y1 + size - 1;
+            rect_dsc.bg_color = lv_color_hsv_to_rgb((frame * 7 + i * 40) % 360, 80, 90);
+            lv_draw_rect(&layer, &rect_dsc, &area);
+        }
+        lv_canvas_finish_layer(canvas, &layer);
+    }
+
+    return (double)(lv_test_time_us() - t_start) / BENCH_FRAMES / 1000.0;
+}
+
+void test_draw_sw_span_fill_benchmark(void)
+{
+    LV_DRAW_BUF_DEFINE_STATIC(bench_buf, BENCH_W, BENCH_H, LV_COLOR_FORMAT_RGB565);
+    LV_DRAW_BUF_INIT_STATIC(bench_buf);
+    lv_obj_t * canvas = lv_canvas_create(lv_screen_active());
+    lv_canvas_set_draw_buf(canvas, &bench_buf);
+
+    /*As the "Single rectangle" and "Multiple rectangles" scenes, and rounded panels with large radius*/
+    double single = bench_frames(canvas, 1, BENCH_W * 3 / 10, 0);
+    double multiple = bench_frames(canvas, 3, BENCH_W / 4, 0);
+    double rounded = bench_frames(canvas, 2, BENCH_W * 2 / 5, 90);
+    printf("%dx%d RGB565, ms/frame: single rectangle %.3f, multiple rectangles %.3f, rounded panels %.3f\n",
+           BENCH_W, BENCH_H, single, multiple, rounded);
+}
+
+#endif
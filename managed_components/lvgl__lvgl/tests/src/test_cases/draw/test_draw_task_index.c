@@ -0,0 +1,177 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../../lvgl_private.h"
+
+#include "unity/unity.h"
+#include "draw_helpers/lv_test_draw_helpers.h"
+
+#include <stdio.h>
+
+/* Check the grid which is used to find the overlapping draw tasks of a layer.
+ *
+ * The correctness test mixes small tasks, which are listed in the cells of the grid,
+ * and large ones, which are kept in a separate list, and checks that they are drawn in order.
+ * The benchmark prints how much time adding and drawing a task takes with
+ * different number of tasks for separate, stacked and randomly overlapping tasks.
+ * Ideally the time per task doesn't depend on the number of tasks.
+ */
+
+#define CANVAS_W        480
+#define CANVAS_H        320
+#define MIXED_CNT       3000
+
+static uint32_t ref_buf[CANVAS_W * CANVAS_H];
+static uint32_t rnd_state;
+static lv_draw_buf_t * canvas_buf;
+
+void setUp(void)
+{
+    /* Function run before every test */
+    rnd_state = 0x9e3779b9;
+}
+
+void tearDown(void)
+{
+    /* Function run after every test */
+    lv_obj_clean(lv_screen_active());
+    if(canvas_buf) {
+        lv_draw_buf_destroy(canvas_buf);
+        canvas_buf = NULL;
+    }
+}
+
+static uint32_t rnd(void)
+{
+    /*xorshift32*/
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+static void random_area(lv_area_t * area, int32_t max_size)
+{
+    int32_t w = 2 + rnd() % max_size;
+    int32_t h = 2 + rnd() % max_size;
+    area->x1 = (int32_t)(rnd() % CANVAS_W) - w / 2;
+    area->y1 = (int32_t)(rnd() % CANVAS_H) - h / 2;
+    area->x2 = area->x1 + w - 1;
+    area->y2 = area->y1 + h - 1;
+}
+
+static lv_obj_t * canvas_create(void)
+{
+    canvas_buf = lv_draw_buf_create(CANVAS_W, CANVAS_H, LV_COLOR_FORMAT_ARGB8888, LV_STRIDE_AUTO);
+    TEST_ASSERT_NOT_NULL(canvas_buf);
+
+    lv_obj_t * canvas = lv_canvas_create(lv_screen_active());
+    lv_canvas_set_draw_buf(canvas, canvas_buf);
+    lv_canvas_fill_bg(canvas, lv_color_black(), LV_OPA_COVER);
+    return canvas;
+}
+
+static void add_fill(lv_layer_t * layer, const lv_area_t * area, uint32_t c)
+{
+    lv_draw_fill_dsc_t fill_dsc;
+    lv_draw_fill_dsc_init(&fill_dsc);
+    fill_dsc.opa = LV_OPA_COVER;
+    fill_dsc.color = lv_color_hex(c);
+    lv_draw_fill(layer, &fill_dsc, area);
+}
+
+static void paint_ref(const lv_area_t * area, uint32_t c)
+{
+    int32_t x, y;
+    for(y = LV_MAX(area->y1, 0); y <= LV_MIN(area->y2, CANVAS_H - 1); y++) {
+        for(x = LV_MAX(area->x1, 0); x <= LV_MIN(area->x2, CANVAS_W - 1); x++) {
+            ref_buf[y * CANVAS_W + x] = 0xff000000 | c;
+        }
+    }
+}
+
+void test_draw_task_index_keeps_order_of_large_and_small_tasks(void)
+{
+    lv_obj_t * canvas = canvas_create();
+
+    uint32_t i;
+    for(i = 0; i < CANVAS_W * CANVAS_H; i++) ref_buf[i] = 0xff000000;
+
+    lv_layer_t layer;
+    lv_canvas_init_layer(canvas, &layer);
+    for(i = 0; i < MIXED_CNT; i++) {
+        /*Mostly small tasks, some touching a few cells and some large ones, partly out of the canvas*/
+        uint32_t kind = rnd() % 10;
+        int32_t max_size = kind < 7 ? 24 : (kind < 9 ? 100 : 400);
+
+        lv_area_t area;
+        random_area(&area, max_size);
+        uint32_t c = rnd() & 0xffffff;
+        add_fill(&layer, &area, c);
+        paint_ref(&area, c);
+    }
+    lv_canvas_finish_layer(canvas, &layer);
+
+    lv_draw_buf_t * draw_buf = lv_canvas_get_draw_buf(canvas);
+    uint32_t y;
+    for(y = 0; y < CANVAS_H; y++) {
+        const uint32_t * row = (const uint32_t *)(draw_buf->data + y * draw_buf->header.stride);
+        TEST_ASSERT_EQUAL_HEX32_ARRAY(&ref_buf[y * CANVAS_W], row, CANVAS_W);
+    }
+}
+
+typedef enum {
+    PATTERN_SEPARATE,
+    PATTERN_STACKED,
+    PATTERN_SCATTERED,
+} pattern_t;
+
+static double bench_us_per_task(lv_obj_t * canvas, pattern_t pattern, uint32_t task_cnt)
+{
+    uint64_t t_start = lv_test_time_us();
+
+    lv_layer_t layer;
+    lv_canvas_init_layer(canvas, &layer);
+    uint32_t i;
+    for(i = 0; i < task_cnt; i++) {
+        lv_area_t area;
+        switch(pattern) {
+            case PATTERN_SEPARATE:
+                /*4x4 tiles next to each other*/
+                area.x1 = (i % (CANVAS_W / 4)) * 4;
+                area.y1 = ((i / (CANVAS_W / 4)) % (CANVAS_H / 4)) * 4;
+                lv_area_set_width(&area, 4);
+                lv_area_set_height(&area, 4);
+                break;
+            case PATTERN_STACKED:
+                /*Everything on the same spot*/
+                lv_area_set(&area, 100, 100, 131, 131);
+                break;
+            case PATTERN_SCATTERED:
+            default:
+                random_area(&area, 24);
+                break;
+        }
+        add_fill(&layer, &area, rnd() & 0xffffff);
+    }
+    lv_canvas_finish_layer(canvas, &layer);
+
+    return (double)(lv_test_time_us() - t_start) / task_cnt;
+}
+
+void test_draw_task_index_benchmark(void)
+{
+    static const uint32_t task_cnts[] = {250, 500, 1000, 2000, 4000};
+
+    lv_obj_t * canvas = canvas_create();
+
+    uint32_t i;
+    for(i = 0; i < sizeof(task_cnts) / sizeof(task_cnts[0]); i++) {
+        double separate = bench_us_per_task(canvas, PATTERN_SEPARATE, task_cnts[i]);
+        double stacked = bench_us_per_task(canvas, PATTERN_STACKED, task_cnts[i]);
+        double scattered = bench_us_per_task(canvas, PATTERN_SCATTERED, task_cnts[i]);
+        printf("tasks: %4d, us/task separate: %.2f, stacked: %.2f, scattered: %.2f\n",
+               (int)task_cnts[i], separate, stacked, scattered);
+    }
+}
+
+#endif
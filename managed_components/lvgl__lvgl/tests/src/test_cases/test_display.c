@@ -205,4 +205,101 @@ void test_display_triple_buffer(void)
     lv_draw_buf_destroy(buf3);
 }
 
+#define TILE_DISP_W     200
+#define TILE_DISP_H     150
+
+static uint16_t tile_frame[TILE_DISP_H][TILE_DISP_W];
+static lv_area_t tile_flushed_areas[32];
+static uint32_t tile_flush_cnt;
+
+static void frame_flush_cb(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map)
+{
+    int32_t w = lv_area_get_width(area);
+    uint32_t stride = lv_draw_buf_width_to_stride(w, LV_COLOR_FORMAT_RGB565);
+    int32_t y;
+    for(y = area->y1; y <= area->y2; y++) {
+        lv_memcpy(&tile_frame[y][area->x1], px_map + (y - area->y1) * stride, w * 2);
+    }
+
+    if(tile_flush_cnt < sizeof(tile_flushed_areas) / sizeof(tile_flushed_areas[0])) {
+        tile_flushed_areas[tile_flush_cnt] = *area;
+    }
+    tile_flush_cnt++;
+    lv_display_flush_ready(disp);
+}
+
+static void tile_scene_create(lv_obj_t * scr)
+{
+    lv_obj_set_style_bg_color(scr, lv_palette_main(LV_PALETTE_BLUE), 0);
+    lv_obj_set_style_bg_grad_color(scr, lv_palette_main(LV_PALETTE_GREEN), 0);
+    lv_obj_set_style_bg_grad_dir(scr, LV_GRAD_DIR_VER, 0);
+
+    lv_obj_t * card = lv_obj_create(scr);
+    lv_obj_set_size(card, 120, 90);
+    lv_obj_set_pos(card, 37, 25);
+    lv_obj_set_style_radius(card, 20, 0);
+    lv_obj_set_style_shadow_width(card, 25, 0);
+    lv_obj_set_style_border_width(card, 3, 0);
+
+    lv_obj_t * label = lv_label_create(card);
+    lv_label_set_text(label, "Tiled refresh\n12.3 kW");
+    lv_obj_center(label);
+}
+
+void test_display_tiled_refresh(void)
+{
+    /*Room for 40 lines, i.e. 2 tiles*/
+    static LV_ATTRIBUTE_MEM_ALIGN uint8_t buf[LV_DRAW_BUF_SIZE(TILE_DISP_W, 40, LV_COLOR_FORMAT_RGB565) + LV_DRAW_BUF_ALIGN];
+    static uint16_t ref_frame[TILE_DISP_H][TILE_DISP_W];
+
+    lv_display_t * disp_ori = lv_display_get_default();
+    lv_display_t * disp = lv_display_create(TILE_DISP_W, TILE_DISP_H);
+    lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB565);
+    lv_display_set_flush_cb(disp, frame_flush_cb);
+    lv_display_set_buffers(disp, lv_draw_buf_align(buf, LV_COLOR_FORMAT_RGB565), NULL,
+                           LV_DRAW_BUF_SIZE(TILE_DISP_W, 40, LV_COLOR_FORMAT_RGB565),
+                           LV_DISPLAY_RENDER_MODE_PARTIAL);
+    tile_scene_create(lv_display_get_screen_active(disp));
+
+    /*Render in stripes first*/
+    lv_obj_invalidate(lv_display_get_screen_active(disp));
+    lv_display_refr_timer(lv_display_get_refr_timer(disp));
+    lv_memcpy(ref_frame, tile_frame, sizeof(tile_frame));
+
+    /*200x150 is 4x4 tiles, the last column and row are smaller*/
+    lv_display_set_tile_size(disp, 64, 48);
+    TEST_ASSERT_EQUAL_INT32(64, lv_display_get_tile_width(disp));
+    TEST_ASSERT_EQUAL_INT32(48, lv_display_get_tile_height(disp));
+    lv_memzero(tile_frame, sizeof(tile_frame));
+    tile_flush_cnt = 0;
+    lv_obj_invalidate(lv_display_get_screen_active(disp));
+    lv_display_refr_timer(lv_display_get_refr_timer(disp));
+
+    TEST_ASSERT_EQUAL_UINT32(16, tile_flush_cnt);
+    uint32_t i;
+    for(i = 0; i < 16; i++) {
+        lv_area_t expected;
+        expected.x1 = (i % 4) * 64;
+        expected.y1 = (i / 4) * 48;
+        expected.x2 = LV_MIN(expected.x1 + 63, TILE_DISP_W - 1);
+        expected.y2 = LV_MIN(expected.y1 + 47, TILE_DISP_H - 1);
+        TEST_ASSERT_EQUAL_INT32(expected.x1, tile_flushed_areas[i].x1);
+        TEST_ASSERT_EQUAL_INT32(expected.y1, tile_flushed_areas[i].y1);
+        TEST_ASSERT_EQUAL_INT32(expected.x2, tile_flushed_areas[i].x2);
+        TEST_ASSERT_EQUAL_INT32(expected.y2, tile_flushed_areas[i].y2);
+    }
+    TEST_ASSERT_EQUAL_MEMORY(ref_frame, tile_frame, sizeof(tile_frame));
+
+    /*Fall back to stripes if not even 2 tiles fit into the buffer*/
+    lv_display_set_tile_size(disp, 200, 48);
+    tile_flush_cnt = 0;
+    lv_obj_invalidate(lv_display_get_screen_active(disp));
+    lv_display_refr_timer(lv_display_get_refr_timer(disp));
+    TEST_ASSERT_EQUAL_UINT32(4, tile_flush_cnt);
+    TEST_ASSERT_EQUAL_MEMORY(ref_frame, tile_frame, sizeof(tile_frame));
+
+    lv_display_delete(disp);
+    lv_display_set_default(disp_ori);
+}
+
 #endif
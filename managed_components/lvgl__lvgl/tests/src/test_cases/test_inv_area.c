@@ -0,0 +1,182 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../../lvgl_private.h"
+
+#include "unity/unity.h"
+#include "draw_helpers/lv_test_draw_helpers.h"
+
+#include <stdio.h>
+
+/* Check how the invalidated areas of many scattered widgets are joined.
+ *
+ * Once there are more areas than `LV_INV_BUF_SIZE` the cheapest ones are joined
+ * instead of redrawing the whole screen. The correctness test checks that
+ * the result is the same as redrawing everything. The benchmark updates K labels
+ * on a 800x1280 screen every frame and prints the time and overdraw per frame.
+ */
+
+#define DISP_W          800
+#define DISP_H          1280
+#define BUF_LINES       40
+#define CELL_W          100
+#define CELL_H          80
+#define CELL_CNT        ((DISP_W / CELL_W) * (DISP_H / CELL_H))
+#define BENCH_FRAMES    20
+
+static uint16_t frame[DISP_H][DISP_W];
+static uint64_t flushed_px;
+static lv_display_t * disp;
+static lv_obj_t * labels[CELL_CNT];
+
+static void frame_flush_cb(lv_display_t * d, const lv_area_t * area, uint8_t * px_map)
+{
+    int32_t w = lv_area_get_width(area);
+    uint32_t stride = lv_draw_buf_width_to_stride(w, LV_COLOR_FORMAT_RGB565);
+    int32_t y;
+    for(y = area->y1; y <= area->y2; y++) {
+        lv_memcpy(&frame[y][area->x1], px_map + (y - area->y1) * stride, w * 2);
+    }
+    flushed_px += lv_area_get_size(area);
+    lv_display_flush_ready(d);
+}
+
+void setUp(void)
+{
+    /* Function run before every test */
+    static LV_ATTRIBUTE_MEM_ALIGN uint8_t buf[LV_DRAW_BUF_SIZE(DISP_W, BUF_LINES, LV_COLOR_FORMAT_RGB565)];
+
+    disp = lv_display_create(DISP_W, DISP_H);
+    lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB565);
+    lv_display_set_flush_cb(disp, frame_flush_cb);
+    lv_display_set_buffers(disp, lv_draw_buf_align(buf, LV_COLOR_FORMAT_RGB565), NULL,
+                           LV_DRAW_BUF_STRIDE(DISP_W, LV_COLOR_FORMAT_RGB565) * BUF_LINES,
+                           LV_DISPLAY_RENDER_MODE_PARTIAL);
+}
+
+void tearDown(void)
+{
+    /* Function run after every test */
+    lv_display_delete(disp);
+}
+
+/*Put the labels into different cells of a grid, in a scattered order*/
+static void labels_create(uint32_t cnt)
+{
+    lv_obj_t * scr = lv_display_get_screen_active(disp);
+    uint32_t i;
+    for(i = 0; i < cnt; i++) {
+        uint32_t cell = (i * 37) % CELL_CNT;
+        labels[i] = lv_label_create(scr);
+        lv_obj_set_pos(labels[i], (cell % (DISP_W / CELL_W)) * CELL_W + (i * 7) % 30,
+                       (cell / (DISP_W / CELL_W)) * CELL_H + (i * 11) % 50);
+        lv_label_set_text(labels[i], "0.0 kW");
+    }
+    lv_refr_now(disp);
+}
+
+static void labels_update(uint32_t cnt, uint32_t value)
+{
+    uint32_t i;
+    for(i = 0; i < cnt; i++) {
+        lv_label_set_text_fmt(labels[i], "%d.%d kW", (int)((value + i) % 100), (int)(i % 10));
+    }
+}
+
+void test_inv_area_join_many_scattered_areas(void)
+{
+    static uint16_t ref_frame[DISP_H][DISP_W];
+
+    /*Each label invalidates its old and new area, that is more than the buffer can hold*/
+    uint32_t cnt = 48;
+    labels_create(cnt);
+
+    lv_display_reset_inv_stats(disp);
+    flushed_px = 0;
+    labels_update(cnt, 1);
+    lv_refr_now(disp);
+
+    lv_display_inv_stats_t stats;
+    lv_display_get_inv_stats(disp, &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.refr_cnt);
+    TEST_ASSERT_GREATER_THAN_UINT32(LV_INV_BUF_SIZE, stats.inv_area_cnt);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.inv_buf_full_cnt);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(LV_INV_BUF_SIZE, stats.refr_area_cnt);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT64(stats.inv_px, stats.refr_px);
+    TEST_ASSERT_EQUAL_UINT64(stats.refr_px, flushed_px);
+
+    /*Far from redrawing the whole screen*/
+    TEST_ASSERT_LESS_THAN_UINT64(DISP_W * DISP_H / 4, stats.refr_px);
+
+    /*The same as redrawing everything*/
+    lv_memcpy(ref_frame, frame, sizeof(frame));
+    lv_obj_invalidate(lv_display_get_screen_active(disp));
+    lv_refr_now(disp);
+    TEST_ASSERT_EQUAL_MEMORY(frame, ref_frame, sizeof(frame));
+
+    lv_display_get_inv_stats(disp, &stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.refr_cnt);
+
+    lv_display_reset_inv_stats(disp);
+    lv_display_get_inv_stats(disp, &stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.refr_cnt);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.refr_px);
+}
+
+void test_inv_area_join_overlapping_areas(void)
+{
+    lv_obj_t * scr = lv_display_get_screen_active(disp);
+    lv_refr_now(disp);
+
+    /*Overlapping areas are joined, areas far from each other are not*/
+    lv_display_reset_inv_stats(disp);
+    lv_area_t a;
+    lv_area_set(&a, 10, 10, 109, 109);
+    lv_obj_invalidate_area(scr, &a);
+    lv_area_set(&a, 60, 60, 159, 159);
+    lv_obj_invalidate_area(scr, &a);
+    lv_area_set(&a, 500, 1000, 599, 1099);
+    lv_obj_invalidate_area(scr, &a);
+    lv_refr_now(disp);
+
+    lv_display_inv_stats_t stats;
+    lv_display_get_inv_stats(disp, &stats);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.inv_area_cnt);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.refr_area_cnt);
+    TEST_ASSERT_EQUAL_UINT64(150 * 150 + 100 * 100, stats.refr_px);
+
+    /*The overlap of the first two areas is counted once*/
+    TEST_ASSERT_EQUAL_UINT64(2 * 100 * 100 - 50 * 50 + 100 * 100, stats.inv_px);
+}
+
+void test_inv_area_benchmark(void)
+{
+    static const uint32_t cnts[] = {8, 16, 32, 48, 64, 96};
+
+    uint32_t i;
+    for(i = 0; i < sizeof(cnts) / sizeof(cnts[0]); i++) {
+        lv_obj_clean(lv_display_get_screen_active(disp));
+        labels_create(cnts[i]);
+        lv_display_reset_inv_stats(disp);
+
+        uint64_t t_start = lv_test_time_us();
+        uint32_t f;
+        for(f = 0; f < BENCH_FRAMES; f++) {
+            labels_update(cnts[i], f);
+            lv_refr_now(disp);
+        }
+        uint64_t elapsed_us = lv_test_time_us() - t_start;
+
+        lv_display_inv_stats_t stats;
+        lv_display_get_inv_stats(disp, &stats);
+        printf("labels: %2d, %.2f ms/frame, areas/frame: %.1f, px/frame: %.0f (%.1f%% of the screen), overdraw: %.2f\n",
+               (int)cnts[i], (double)elapsed_us / BENCH_FRAMES / 1000.0,
+               (double)stats.refr_area_cnt / stats.refr_cnt, (double)stats.refr_px / stats.refr_cnt,
+               100.0 * stats.refr_px / stats.refr_cnt / (DISP_W * DISP_H),
+               (double)stats.refr_px / stats.inv_px);
+
+        /*At least every invalidated pixel is redrawn*/
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT64(stats.inv_px, stats.refr_px);
+    }
+}
+
+#endif
@@ -0,0 +1,99 @@
+/**
+* @file lv_test_draw_helpers.c
+*
+*/
+#if LV_BUILD_TEST
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_test_draw_helpers.h"
+#include "../../../../lvgl_private.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+/**********************
+ *  GLOBAL VARIABLES
+ **********************/
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+uint64_t lv_test_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void lv_test_radius_ref_fill(uint8_t * ref_buf, int32_t buf_w, int32_t buf_h, const lv_area_t * coords,
+                             int32_t radius, lv_opa_t opa)
+{
+    lv_memzero(ref_buf, buf_w * buf_h);
+
+    int32_t short_side = LV_MIN(lv_area_get_width(coords), lv_area_get_height(coords));
+    int32_t rout = LV_MIN(radius, short_side >> 1);
+    if(opa >= LV_OPA_MAX) opa = LV_OPA_COVER;
+
+    lv_draw_sw_mask_radius_param_t param;
+    lv_draw_sw_mask_radius_init(&param, coords, rout, false);
+    void * masks[2] = {&param, NULL};
+
+    int32_t x1 = LV_MAX(coords->x1, 0);
+    int32_t x2 = LV_MIN(coords->x2, buf_w - 1);
+    int32_t y;
+    for(y = LV_MAX(coords->y1, 0); y <= LV_MIN(coords->y2, buf_h - 1); y++) {
+        uint8_t * line = &ref_buf[y * buf_w + x1];
+        lv_memset(line, opa, x2 - x1 + 1);
+        lv_draw_sw_mask_res_t res = lv_draw_sw_mask_apply(masks, line, x1, y, x2 - x1 + 1);
+        if(res == LV_DRAW_SW_MASK_RES_TRANSP) lv_memzero(line, x2 - x1 + 1);
+    }
+
+    lv_draw_sw_mask_free_param(&param);
+}
+
+bool lv_test_alpha_compare(const lv_draw_buf_t * draw_buf, const uint8_t * ref_buf)
+{
+    int32_t w = draw_buf->header.w;
+    int32_t h = draw_buf->header.h;
+    int32_t x, y;
+    for(y = 0; y < h; y++) {
+        const uint8_t * row = draw_buf->data + y * draw_buf->header.stride;
+        for(x = 0; x < w; x++) {
+            if(row[x * 4 + 3] != ref_buf[y * w + x]) {
+                printf("%" LV_PRId32 ";%" LV_PRId32 ": alpha %d, expected %d\n", x, y, row[x * 4 + 3], ref_buf[y * w + x]);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+#endif /*LV_BUILD_TEST*/
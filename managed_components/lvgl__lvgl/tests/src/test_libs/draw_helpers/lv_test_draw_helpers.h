@@ -0,0 +1,72 @@
+/**
+* @file lv_test_draw_helpers.h
+*
+*/
+#if LV_BUILD_TEST
+
+#ifndef LV_TEST_DRAW_HELPERS_H
+#define LV_TEST_DRAW_HELPERS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../../../../lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Get the time of a monotonic clock for benchmarks.
+ * @return time in microseconds
+ */
+uint64_t lv_test_time_us(void);
+
+/**
+ * Calculate the expected alpha of a rounded rectangle by applying the radius mask line by line.
+ * @param ref_buf   `buf_w` x `buf_h` buffer for the result, the pixels outside of the rectangle are cleared
+ * @param buf_w     width of `ref_buf`
+ * @param buf_h     height of `ref_buf`
+ * @param coords    the rectangle, can be partly out of the buffer
+ * @param radius    radius of the corners, limited to the half of the shorter side
+ * @param opa       opacity of the rectangle
+ */
+void lv_test_radius_ref_fill(uint8_t * ref_buf, int32_t buf_w, int32_t buf_h, const lv_area_t * coords,
+                             int32_t radius, lv_opa_t opa);
+
+/**
+ * Compare the alpha channel of an ARGB8888 draw buffer with a reference.
+ * The first different pixel is printed.
+ * @param draw_buf  ARGB8888 draw buffer
+ * @param ref_buf   the expected alpha values, as large as `draw_buf`
+ * @return          true: all pixels are the same; false: there is a difference
+ */
+bool lv_test_alpha_compare(const lv_draw_buf_t * draw_buf, const uint8_t * ref_buf);
+
+/*************************
+ *    GLOBAL VARIABLES
+ *************************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_TEST_DRAW_HELPERS_H*/
+
+#endif /*LV_BUILD_TEST*/